@@ -0,0 +1,45 @@
+#shader vertex
+#version 330 core 
+
+layout(location = 0) in vec4 aPosition;
+layout(location = 1) in vec2 aTextureCord;
+
+out vec2 textureCord; 
+flat out uint materialIndex;
+
+// Bound per draw with glBindBufferRange, see Renderer::Execute
+layout(std140) uniform ObjectBlock {
+   mat4 u_model;
+   uint u_materialIndex;
+};
+
+uniform mat4 u_view;
+uniform mat4 u_projection;
+
+void main(){
+   gl_Position = u_projection * u_view * u_model * aPosition; 
+   textureCord = aTextureCord;
+   materialIndex = u_materialIndex;
+};
+
+#shader fragment
+#version 330 core 
+
+layout(location = 0) out vec4 color; 
+
+in vec2 textureCord;
+flat in uint materialIndex;
+
+// One element per instance of the material template, the length is the template's capacity (see MaterialSystem)
+struct Material {
+   vec4 color;
+};
+layout(std140) uniform MaterialBlock {
+   Material u_materials[256];
+};
+
+uniform sampler2D customTexture;
+
+void main(){
+   color = texture(customTexture, textureCord) * u_materials[materialIndex].color;
+};
@@ -0,0 +1,37 @@
+#shader vertex
+#version 330 core
+
+out vec2 textureCord;
+
+// One triangle covering the target, its corners come from the vertex index
+void main(){
+   vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+   textureCord = position;
+   gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 textureCord;
+
+uniform sampler2D u_source;
+uniform vec2 u_texelSize;
+// xy: blur direction, (1, 0) for the horizontal pass and (0, 1) for the vertical one
+uniform vec4 u_parameters;
+
+// 9 tap gaussian folded into 5 bilinear taps
+const float weights[3] = float[](0.2270270270, 0.3162162162, 0.0702702703);
+const float offsets[3] = float[](0.0, 1.3846153846, 3.2307692308);
+
+void main(){
+   vec2 step = u_parameters.xy * u_texelSize;
+   vec3 sum = texture(u_source, textureCord).rgb * weights[0];
+   for (int i = 1; i < 3; i++) {
+      sum += texture(u_source, textureCord + step * offsets[i]).rgb * weights[i];
+      sum += texture(u_source, textureCord - step * offsets[i]).rgb * weights[i];
+   }
+   color = vec4(sum, 1.0);
+}
@@ -0,0 +1,35 @@
+#shader vertex
+#version 330 core
+
+out vec2 textureCord;
+
+// One triangle covering the target, its corners come from the vertex index
+void main(){
+   vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+   textureCord = position;
+   gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 textureCord;
+
+uniform sampler2D u_source;
+uniform vec2 u_texelSize;
+// x: brightness where bloom starts
+uniform vec4 u_parameters;
+
+void main(){
+   // Four bilinear taps average the 4x4 source block under a quarter resolution texel, so every source texel
+   // counts and thin bright lines don't flicker
+   vec4 offset = u_texelSize.xyxy * vec4(-1.0, -1.0, 1.0, 1.0);
+   vec3 average = (texture(u_source, textureCord + offset.xy).rgb + texture(u_source, textureCord + offset.zy).rgb +
+      texture(u_source, textureCord + offset.xw).rgb + texture(u_source, textureCord + offset.zw).rgb) * 0.25;
+
+   float brightness = max(average.r, max(average.g, average.b));
+   float contribution = max(brightness - u_parameters.x, 0.0) / max(brightness, 0.0001);
+   color = vec4(average * contribution, 1.0);
+}
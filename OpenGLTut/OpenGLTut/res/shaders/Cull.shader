@@ -0,0 +1,115 @@
+#shader compute
+#version 430 core
+
+layout(local_size_x = 64) in;
+
+struct ObjectData {
+   vec4 boundingSphere;
+   uint meshIndex;
+   uint padding0;
+   uint padding1;
+   uint padding2;
+};
+
+struct MeshDrawArgs {
+   uint indexCount;
+   uint firstIndex;
+   int baseVertex;
+   uint padding;
+};
+
+struct DrawCommand {
+   uint count;
+   uint instanceCount;
+   uint firstIndex;
+   int baseVertex;
+   uint baseInstance;
+};
+
+layout(std430, binding = 0) readonly buffer Objects { ObjectData objects[]; };
+layout(std430, binding = 1) readonly buffer Meshes { MeshDrawArgs meshes[]; };
+layout(std430, binding = 2) writeonly buffer Commands { DrawCommand commands[]; };
+layout(binding = 0, offset = 0) uniform atomic_uint drawCount;
+
+uniform uint u_objectCount;
+// 1 - visible commands are packed at the front and counted, 0 - every object keeps its own slot
+uniform int u_compact;
+uniform vec4 u_frustumPlanes[6];
+
+uniform int u_occlusionEnabled;
+uniform sampler2D u_hiZ;
+uniform vec2 u_hiZSize;
+uniform int u_hiZMipCount;
+uniform mat4 u_previousViewProjection;
+
+bool frustumVisible(vec3 center, float radius) {
+   for (int i = 0; i < 6; i++) {
+      if (dot(u_frustumPlanes[i].xyz, center) + u_frustumPlanes[i].w < -radius)
+         return false;
+   }
+   return true;
+}
+
+bool occlusionVisible(vec3 center, float radius) {
+   // Screen space bounds of the sphere's box in the previous frame, that's what the hi-z was built from
+   vec2 uvMin = vec2(1.0);
+   vec2 uvMax = vec2(0.0);
+   float nearestDepth = 1.0;
+   for (int i = 0; i < 8; i++) {
+      vec3 corner = center + radius * vec3((i & 1) == 0 ? -1.0 : 1.0, (i & 2) == 0 ? -1.0 : 1.0, (i & 4) == 0 ? -1.0 : 1.0);
+      vec4 clip = u_previousViewProjection * vec4(corner, 1.0);
+      // Crossing the near plane, the projection is meaningless so keep the object
+      if (clip.w <= 0.0)
+         return true;
+      vec3 ndc = clip.xyz / clip.w;
+      vec2 uv = ndc.xy * 0.5 + 0.5;
+      uvMin = min(uvMin, uv);
+      uvMax = max(uvMax, uv);
+      nearestDepth = min(nearestDepth, ndc.z * 0.5 + 0.5);
+   }
+   uvMin = clamp(uvMin, 0.0, 1.0);
+   uvMax = clamp(uvMax, 0.0, 1.0);
+
+   // Pick the level where the bounds cover at most 2x2 texels so 4 samples are conservative
+   vec2 sizeInTexels = (uvMax - uvMin) * u_hiZSize;
+   float level = ceil(log2(max(max(sizeInTexels.x, sizeInTexels.y), 1.0)));
+   level = clamp(level, 0.0, float(u_hiZMipCount - 1));
+
+   float farthest = textureLod(u_hiZ, uvMin, level).r;
+   farthest = max(farthest, textureLod(u_hiZ, vec2(uvMax.x, uvMin.y), level).r);
+   farthest = max(farthest, textureLod(u_hiZ, vec2(uvMin.x, uvMax.y), level).r);
+   farthest = max(farthest, textureLod(u_hiZ, uvMax, level).r);
+
+   return nearestDepth <= farthest;
+}
+
+void main(){
+   uint objectIndex = gl_GlobalInvocationID.x;
+   if (objectIndex >= u_objectCount)
+      return;
+
+   ObjectData object = objects[objectIndex];
+   vec3 center = object.boundingSphere.xyz;
+   float radius = object.boundingSphere.w;
+
+   bool visible = frustumVisible(center, radius);
+   if (visible && u_occlusionEnabled != 0)
+      visible = occlusionVisible(center, radius);
+
+   MeshDrawArgs mesh = meshes[object.meshIndex];
+   DrawCommand command;
+   command.count = mesh.indexCount;
+   command.instanceCount = visible ? 1u : 0u;
+   command.firstIndex = mesh.firstIndex;
+   command.baseVertex = mesh.baseVertex;
+   // The per instance object id attribute is offset by baseInstance, so it ends up as objectIndex
+   command.baseInstance = objectIndex;
+
+   if (u_compact != 0) {
+      if (visible)
+         commands[atomicCounterIncrement(drawCount)] = command;
+   }
+   else {
+      commands[objectIndex] = command;
+   }
+}
@@ -0,0 +1,37 @@
+#shader compute
+#version 430 core
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(r32f, binding = 0) uniform writeonly image2D u_dest;
+
+uniform sampler2D u_source;
+// -1 copies the depth texture into level 0, otherwise the level of the pyramid to reduce
+uniform int u_sourceLevel;
+uniform vec2 u_destSize;
+
+void main(){
+   ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+   if (texel.x >= int(u_destSize.x) || texel.y >= int(u_destSize.y))
+      return;
+
+   float depth;
+   if (u_sourceLevel < 0) {
+      depth = texelFetch(u_source, texel, 0).r;
+   }
+   else {
+      ivec2 sourceSize = textureSize(u_source, u_sourceLevel);
+      ivec2 sourceMax = sourceSize - 1;
+      ivec2 source = texel * 2;
+      // Level sizes round down, an odd source row or column would be dropped, so odd sources take a
+      // 3 texel wide (or tall) footprint and every texel reaches the next level
+      ivec2 footprint = ivec2(2) + (sourceSize & 1);
+      depth = 0.0;
+      for (int y = 0; y < footprint.y; y++) {
+         for (int x = 0; x < footprint.x; x++)
+            depth = max(depth, texelFetch(u_source, min(source + ivec2(x, y), sourceMax), u_sourceLevel).r);
+      }
+   }
+
+   imageStore(u_dest, texel, vec4(depth));
+}
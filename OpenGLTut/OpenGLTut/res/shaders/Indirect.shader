@@ -0,0 +1,31 @@
+#shader vertex
+#version 430 core 
+
+layout(location = 0) in vec4 aPosition;
+layout(location = 1) in vec2 aTextureCord;
+layout(location = 2) in uint aObjectID;
+
+layout(std430, binding = 3) readonly buffer Transforms { mat4 models[]; };
+
+out vec2 textureCord; 
+
+uniform mat4 u_view;
+uniform mat4 u_projection;
+
+void main(){
+   gl_Position = u_projection * u_view * models[aObjectID] * aPosition; 
+   textureCord = aTextureCord;
+};
+
+#shader fragment
+#version 430 core 
+
+layout(location = 0) out vec4 color; 
+
+in vec2 textureCord;
+
+uniform sampler2D customTexture;
+
+void main(){
+   color = texture(customTexture, textureCord);
+};
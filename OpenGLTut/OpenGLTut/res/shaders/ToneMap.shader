@@ -0,0 +1,40 @@
+#shader vertex
+#version 330 core
+
+out vec2 textureCord;
+
+// One triangle covering the target, its corners come from the vertex index
+void main(){
+   vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+   textureCord = position;
+   gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 textureCord;
+
+// Blurred bloom
+uniform sampler2D u_source;
+uniform sampler2D u_scene;
+// x: bloom strength, y: exposure, z: operator (0 clamps, 1 Reinhard, 2 ACES fit)
+uniform vec4 u_parameters;
+
+vec3 Aces(vec3 x){
+   return clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0);
+}
+
+void main(){
+   vec3 hdr = (texture(u_scene, textureCord).rgb + texture(u_source, textureCord).rgb * u_parameters.x) * u_parameters.y;
+   vec3 mapped;
+   if (u_parameters.z > 1.5)
+      mapped = Aces(hdr);
+   else if (u_parameters.z > 0.5)
+      mapped = hdr / (hdr + 1.0);
+   else
+      mapped = clamp(hdr, 0.0, 1.0);
+   color = vec4(mapped, 1.0);
+}
@@ -0,0 +1,39 @@
+#shader vertex
+#version 330 core
+
+out vec2 textureCord;
+
+// One triangle covering the target, its corners come from the vertex index
+void main(){
+   vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+   textureCord = position;
+   gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 textureCord;
+
+// The scene at its reduced resolution
+uniform sampler2D u_source;
+uniform vec2 u_texelSize;
+// x: sharpening, 0 is a plain bilinear upscale
+uniform vec4 u_parameters;
+
+void main(){
+   // Bilinear upscale, then the center is pushed away from its neighbours in the source to win back the
+   // detail filtering took. Clamping to the neighbours' range keeps edges from ringing.
+   vec3 center = texture(u_source, textureCord).rgb;
+   vec3 up = texture(u_source, textureCord + vec2(0.0, u_texelSize.y)).rgb;
+   vec3 down = texture(u_source, textureCord - vec2(0.0, u_texelSize.y)).rgb;
+   vec3 left = texture(u_source, textureCord - vec2(u_texelSize.x, 0.0)).rgb;
+   vec3 right = texture(u_source, textureCord + vec2(u_texelSize.x, 0.0)).rgb;
+
+   vec3 minimum = min(center, min(min(up, down), min(left, right)));
+   vec3 maximum = max(center, max(max(up, down), max(left, right)));
+   vec3 sharpened = center + (center * 4.0 - up - down - left - right) * 0.25 * u_parameters.x;
+   color = vec4(clamp(sharpened, minimum, maximum), 1.0);
+}
@@ -11,11 +11,53 @@
 #include "VertexBufferLayout.h"
 #include "Texture.h"
 #include "Camera.h"
+#include "GpuCulling.h"
+#include "Registry.h"
+#include "TransformStorage.h"
+#include "Components.h"
+#include "Systems.h"
+#include "JobSystem.h"
+#include "CommandList.h"
+#include "Material.h"
+#include "Pipeline.h"
+#include "SamplerCache.h"
+#include "UniformBuffer.h"
+#include "Frustum.h"
+#include "RenderThread.h"
+#include "FixedTimestep.h"
+#include "FramePacer.h"
+#include "GpuProfiler.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include "HeadlessContext.h"
+#include "Framebuffer.h"
+#include "RenderTargetPool.h"
+#include "PostProcess.h"
+#include "RenderGraph.h"
+#include "DynamicResolution.h"
+#include "MeshSimplifier.h"
+#include "LODSelector.h"
+#include "ImageWriter.h"
+#include "Benchmark.h"
+#include "GLCapture.h"
+#include "CaptureReplay.h"
+#include "RenderDevice.h"
+#include "SoftwareDevice.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "imgui/imgui.h"
 #include "imgui/imgui_impl_glfw.h"
 #include "imgui/imgui_impl_opengl3.h"
@@ -36,44 +78,427 @@ Camera camera;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
-int main(void)
+// Frame spacing of headless rendering, which has no clock to follow
+const double HEADLESS_FRAME_TIME = 1.0 / 60.0;
+
+// The simulation always advances in steps of this size, independent of the frame rate
+const double SIMULATION_RATE = 120.0;
+
+// GPU driven path: a grid of cubes that a compute shader culls and writes draw commands for,
+// the whole grid is then submitted with a single multi draw indirect call
+const int GPU_GRID_SIZE = 100;
+const unsigned int GPU_OBJECT_COUNT = GPU_GRID_SIZE * GPU_GRID_SIZE;
+// Tessellation of the sphere the command list grid draws
+const unsigned int GRID_SPHERE_RINGS = 16;
+const unsigned int GRID_SPHERE_SEGMENTS = 32;
+
+// The demo cube, 36 vertices drawn without indices
+const int NUM_OF_POSITIONS = 180;
+// pos.x, pos.y, pos.z, texture.x, texture.y
+const float CUBE_VERTICES[NUM_OF_POSITIONS] = {
+    -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+     0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+    -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+    -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+    -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+     0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+};
+
+// Fills the registry with the demo cube and the grid, returns the cube
+Entity CreateScene(Registry& registry)
+{
+    TransformStorage& transforms = registry.Transforms();
+
+    Entity cube = registry.Create();
+    transforms.Add(cube, glm::vec3(0.0f));
+
+    for (unsigned int i = 0; i < GPU_OBJECT_COUNT; i++)
+    {
+        Entity entity = registry.Create();
+        transforms.Add(entity, glm::vec3(2.0f * (float)((int)(i % GPU_GRID_SIZE) - GPU_GRID_SIZE / 2), -2.0f, -2.0f * (float)(i / GPU_GRID_SIZE)));
+        // Unit cube, the radius is half of its diagonal
+        registry.Add<BoundsComponent>(entity, { glm::vec3(0.0f), 0.866f });
+        registry.Add<MeshComponent>(entity, { 0, 0 });
+    }
+    return cube;
+}
+
+// Mesh of the command list grid, a UV sphere of radius 0.5 in the cube's vertex layout so its LOD levels have
+// curvature to take away. The column at u = 1 repeats the one at u = 0, a uv seam the levels keep intact.
+// Returns the LOD chain, its indices are the index buffer. meshlets receives the meshlets of every level.
+LODChain CreateGridMesh(std::vector<float>& vertices, std::vector<MeshletCuller>& meshlets)
+{
+    const float PI = 3.14159265f;
+    vertices.clear();
+    for (unsigned int ring = 0; ring <= GRID_SPHERE_RINGS; ring++)
+    {
+        // Exact values at the poles and the seam, so the simplifier welds the vertices that share a position
+        float theta = PI * (float)ring / (float)GRID_SPHERE_RINGS;
+        float sinTheta = ring == 0 || ring == GRID_SPHERE_RINGS ? 0.0f : std::sin(theta);
+        float cosTheta = ring == 0 ? 1.0f : ring == GRID_SPHERE_RINGS ? -1.0f : std::cos(theta);
+        for (unsigned int segment = 0; segment <= GRID_SPHERE_SEGMENTS; segment++)
+        {
+            float phi = segment == GRID_SPHERE_SEGMENTS ? 0.0f : 2.0f * PI * (float)segment / (float)GRID_SPHERE_SEGMENTS;
+            float position[] = { 0.5f * sinTheta * std::cos(phi), 0.5f * cosTheta, 0.5f * sinTheta * std::sin(phi) };
+            vertices.insert(vertices.end(), position, position + 3);
+            vertices.push_back((float)segment / (float)GRID_SPHERE_SEGMENTS);
+            vertices.push_back(1.0f - (float)ring / (float)GRID_SPHERE_RINGS);
+        }
+    }
+
+    std::vector<unsigned int> indices;
+    for (unsigned int ring = 0; ring < GRID_SPHERE_RINGS; ring++)
+    {
+        for (unsigned int segment = 0; segment < GRID_SPHERE_SEGMENTS; segment++)
+        {
+            unsigned int a = ring * (GRID_SPHERE_SEGMENTS + 1) + segment, b = a + GRID_SPHERE_SEGMENTS + 1;
+            // The pole rows only have one triangle per segment
+            if (ring > 0)
+                indices.insert(indices.end(), { a, a + 1, b });
+            if (ring + 1 < GRID_SPHERE_RINGS)
+                indices.insert(indices.end(), { a + 1, b + 1, b });
+        }
+    }
+    LODChain chain = MeshSimplifier::GenerateLODChain(vertices.data(), (unsigned int)vertices.size() / 5, 5, indices);
+    meshlets = MeshletBuilder::BuildLODs(vertices.data(), (unsigned int)vertices.size() / 5, 5, chain);
+    return chain;
+}
+
+// One fixed step of the simulation, spinSpeed is in degrees per second
+void Simulate(Registry& registry, Entity cube, float step, float spinSpeed, const ParallelForFunction& parallelFor)
+{
+    TransformStorage& transforms = registry.Transforms();
+    if (spinSpeed != 0.0f)
+    {
+        glm::vec3 rotation = transforms.GetRotation(cube);
+        rotation.y = std::fmod(rotation.y + spinSpeed * step, 360.0f);
+        transforms.SetRotation(cube, rotation);
+    }
+    TransformSystem::Update(registry, parallelFor);
+}
+
+// Runs the simulation without a window as fast as it goes, for batch jobs that only need its results
+int RunHeadlessSimulation(double seconds, const ParallelForFunction& parallelFor)
+{
+    Registry registry;
+    Entity cube = CreateScene(registry);
+    FixedTimestep timestep(SIMULATION_RATE);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    unsigned long long steps = (unsigned long long)(seconds * SIMULATION_RATE);
+    for (unsigned long long i = 0; i < steps; i++)
+    {
+        Simulate(registry, cube, timestep.GetStep(), 90.0f, parallelFor);
+        timestep.CompleteStep();
+    }
+    double realSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    std::cout << "Simulated " << timestep.GetSimulationTime() << " s (" << timestep.GetStepCount() << " steps) in "
+        << realSeconds << " s, " << timestep.GetSimulationTime() / std::max(realSeconds, 1e-9) << "x real time" << std::endl;
+    return 0;
+}
+
+// Renders the demo scene without any GL on the software device, for machines without a GPU. The camera
+// looks at the spinning cube and the grid behind it, frames go to outputDirectory when one is given.
+int RunSoftwarePreview(unsigned int frames, const std::string& outputDirectory, const ParallelForFunction& parallelFor)
 {
-  
-    /* Initialize the library */
-    if (!glfwInit())
+    SoftwareDevice device(WINDOW_WIDTH, WINDOW_HEIGHT, parallelFor);
+    RenderDeviceScope deviceScope(&device);
+    std::cout << "Software preview, " << SoftwareRasterizer::GetSimdName() << std::endl;
+
+    VertexBuffer vb(CUBE_VERTICES, sizeof(CUBE_VERTICES));
+    VertexBufferLayout layout;
+    layout.Push<float>(3);
+    layout.Push<float>(2);
+    VertexArray va;
+    va.AddLayout(vb, layout, nullptr);
+    std::vector<float> sphereVertices;
+    std::vector<MeshletCuller> sphereMeshlets;
+    LODChain sphereLods = CreateGridMesh(sphereVertices, sphereMeshlets);
+    VertexBuffer sphereVb(sphereVertices.data(), (unsigned int)(sphereVertices.size() * sizeof(float)));
+    IndexBuffer sphereIb(sphereLods.indices.data(), (unsigned int)sphereLods.indices.size());
+    VertexArray gridVa;
+    gridVa.AddLayout(sphereVb, layout, &sphereIb);
+    Texture texture("./res/textures/brick_texture.jpeg", 1024, 1024, 3);
+
+    Shader batchedShader("res/shaders/Batched.shader");
+    batchedShader.SetUniformBlockBinding("ObjectBlock", 1);
+    RenderResources renderResources;
+    const Pipeline* scenePipeline = Pipeline::Create(PipelineDesc(&batchedShader));
+    MaterialLayout materialLayout;
+    materialLayout.Push("color", MATERIAL_VEC4, glm::vec4(1.0f));
+    MaterialSystem materials;
+    unsigned short sceneTemplateID = materials.AddTemplate(renderResources, scenePipeline, materialLayout, BATCHED_MATERIAL_CAPACITY);
+    MaterialInstance brick = materials.GetInstance(materials.AddInstance(sceneTemplateID, renderResources.AddTexture(&texture)));
+    unsigned short cubeVaID = renderResources.AddVertexArray(&va);
+    std::vector<MeshDraw> meshDraws = { {
+        brick.pipelineID, renderResources.AddVertexArray(&gridVa), brick.textureID, brick.index,
+        DrawMode::ELEMENTS, 0, sphereLods.levels[0].indexCount, &sphereLods, &sphereMeshlets } };
+    unsigned int uniformAlignment = UniformBuffer::GetOffsetAlignment();
+    UniformBuffer objectUniforms(GPU_OBJECT_COUNT * uniformAlignment);
+
+    Registry registry;
+    TransformStorage& transforms = registry.Transforms();
+    Entity cube = CreateScene(registry);
+    transforms.SetPosition(cube, glm::vec3(0.0f, 0.0f, -3.0f));
+
+    glm::vec3 eye(0.0f, 1.0f, 0.0f);
+    glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f, -0.5f, -6.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT, 0.1f, 100.0f);
+    LODSelector lodSelector;
+    RenderView gridView(projection * view, eye, LODSelector::ProjectionScale(45.0f, WINDOW_HEIGHT), &lodSelector);
+    Renderer renderer;
+    CommandList mainList(uniformAlignment);
+    std::vector<CommandList> gridLists;
+    std::vector<const CommandList*> submittedLists;
+    std::vector<unsigned char> pixels;
+    FixedTimestep timestep(SIMULATION_RATE);
+
+    double renderSeconds = 0.0;
+    for (unsigned int frame = 0; frame < frames; frame++)
+    {
+        PROFILE_SCOPE("Software preview frame");
+        unsigned int steps = timestep.Advance((float)HEADLESS_FRAME_TIME);
+        for (unsigned int step = 0; step < steps; step++)
+        {
+            Simulate(registry, cube, timestep.GetStep(), 90.0f, parallelFor);
+            timestep.CompleteStep();
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        mainList.Clear();
+        mainList.Draw(brick.pipelineID, cubeVaID, brick.textureID, brick.index, DrawMode::ARRAYS, 0, 36, transforms.WorldMatrix(cube));
+        RenderSystem::RecordDraws(registry, gridView, meshDraws, gridLists, uniformAlignment, 1.0f, parallelFor);
+
+        renderer.Clear();
+        materials.Upload();
+        batchedShader.Bind();
+        batchedShader.SetUniformMatrix4fv("u_projection", false, glm::value_ptr(projection));
+        batchedShader.SetUniformMatrix4fv("u_view", false, glm::value_ptr(view));
+        submittedLists.clear();
+        submittedLists.push_back(&mainList);
+        for (const CommandList& list : gridLists)
+            submittedLists.push_back(&list);
+        renderer.Execute(submittedLists, renderResources, objectUniforms);
+        device.ReadPixels(pixels);
+        renderSeconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+        if (!outputDirectory.empty())
+        {
+            PROFILE_SCOPE("Write frame");
+            char fileName[32];
+            snprintf(fileName, sizeof(fileName), "/frame_%05u.tga", frame);
+            ImageWriter::WriteTga(outputDirectory + fileName, WINDOW_WIDTH, WINDOW_HEIGHT, pixels.data());
+        }
+    }
+
+    std::cout << "Rendered " << frames << " frames, " << renderSeconds * 1000.0 / std::max(1u, frames) << " ms per frame" << std::endl;
+    Pipeline::ReleaseAll();
+    SamplerCache::ReleaseAll();
+    return device.GetErrorCount() == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+    bool threadedRendering = true;
+    double headlessSeconds = 0.0;
+    unsigned int headlessFrames = 0;
+    std::string outputDirectory;
+    bool benchmark = false;
+    BenchmarkSettings benchmarkSettings;
+    std::string capturePath;
+    unsigned int captureFrames = 300;
+    std::string replayPath;
+    ReplayBackend replayBackend = REPLAY_GL;
+    bool backendChosen = false;
+    RenderBackend backend = BACKEND_GL33;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--bench-jobs") == 0)
+        {
+            JobSystem::RunBenchmark(std::cout);
+            return 0;
+        }
+        if (strcmp(argv[i], "--no-render-thread") == 0)
+            threadedRendering = false;
+        if (strcmp(argv[i], "--simulate") == 0 && i + 1 < argc)
+            headlessSeconds = atof(argv[++i]);
+        if (strcmp(argv[i], "--headless") == 0 && i + 1 < argc)
+            headlessFrames = (unsigned int)atoi(argv[++i]);
+        // Has to exist already, every headless frame is written there as frame_00000.tga and so on
+        if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            outputDirectory = argv[++i];
+
+        // Benchmark scene, see BenchmarkSettings
+        if (strcmp(argv[i], "--benchmark") == 0)
+            benchmark = true;
+        if (strcmp(argv[i], "--objects") == 0 && i + 1 < argc)
+            benchmarkSettings.objects = (unsigned int)atoi(argv[++i]);
+        if (strcmp(argv[i], "--materials") == 0 && i + 1 < argc)
+            benchmarkSettings.materials = (unsigned int)atoi(argv[++i]);
+        if (strcmp(argv[i], "--textures") == 0 && i + 1 < argc)
+            benchmarkSettings.textures = (unsigned int)atoi(argv[++i]);
+        if (strcmp(argv[i], "--unique-meshes") == 0)
+            benchmarkSettings.uniqueMeshes = true;
+        if (strcmp(argv[i], "--shared-vertex-array") == 0)
+            benchmarkSettings.sharedVertexArray = true;
+        if (strcmp(argv[i], "--subdivisions") == 0 && i + 1 < argc)
+            benchmarkSettings.subdivisions = (unsigned int)atoi(argv[++i]);
+        if (strcmp(argv[i], "--meshlet-culling") == 0)
+            benchmarkSettings.meshletCulling = true;
+        if (strcmp(argv[i], "--dynamic") == 0)
+            benchmarkSettings.dynamicObjects = true;
+        if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+            benchmarkSettings.warmupFrames = (unsigned int)atoi(argv[++i]);
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            benchmarkSettings.frames = (unsigned int)atoi(argv[++i]);
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            benchmarkSettings.seed = (unsigned int)atoi(argv[++i]);
+        if (strcmp(argv[i], "--benchmark-output") == 0 && i + 1 < argc)
+            benchmarkSettings.outputPath = argv[++i];
+
+        // Records the GL calls of the next frames to a file, --replay plays such a file back headless
+        if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc)
+            capturePath = argv[++i];
+        if (strcmp(argv[i], "--capture-frames") == 0 && i + 1 < argc)
+            captureFrames = (unsigned int)atoi(argv[++i]);
+        if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            replayPath = argv[++i];
+        if (strcmp(argv[i], "--null-backend") == 0)
+            replayBackend = REPLAY_NULL;
+
+        // gl33, gl45, null, recording or software. Null and recording only work with --benchmark, software with
+        // --benchmark or --headless. Default is gl45 when the context has it.
+        if (strcmp(argv[i], "--backend") == 0 && i + 1 < argc)
+        {
+            backendChosen = RenderDevice::ParseBackend(argv[++i], backend);
+            if (!backendChosen)
+                std::cout << "Unknown backend " << argv[i] << std::endl;
+        }
+    }
+
+    if (!replayPath.empty())
+        return CaptureReplay::Run(replayPath, replayBackend, WINDOW_WIDTH, WINDOW_HEIGHT);
+    // Before any GL object exists, the replay has to see every resource being created
+    if (!capturePath.empty() && !GLCapture::Begin(capturePath, captureFrames))
         return -1;
 
+    PROFILE_THREAD("Main");
+    JobSystem jobSystem;
+    ParallelForFunction parallelFor = jobSystem.GetParallelFor();
+    if (headlessSeconds > 0.0)
+        return RunHeadlessSimulation(headlessSeconds, parallelFor);
+    if (benchmark)
+    {
+        benchmarkSettings.width = WINDOW_WIDTH;
+        benchmarkSettings.height = WINDOW_HEIGHT;
+        benchmarkSettings.backendChosen = backendChosen;
+        benchmarkSettings.backend = backend;
+        int result = Benchmark::Run(benchmarkSettings, parallelFor);
+        GLCapture::End();
+        return result;
+    }
+
+    // No context at all, the frames are rasterized on the job threads
+    if (backendChosen && backend == BACKEND_SOFTWARE)
+    {
+        if (headlessFrames > 0)
+            return RunSoftwarePreview(headlessFrames, outputDirectory, parallelFor);
+        std::cout << "The software backend only renders --headless previews, the window uses GL" << std::endl;
+    }
+
     // GL 3.0 + GLSL 130
     const char* glsl_version = "#version 130";
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);  // 3.2+ only
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);            // 3.0+ only
-
+    FramePacer framePacer;
 
-    /* Create a windowed mode window and its OpenGL context */
-    window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Hello World", NULL, NULL);
-    if (!window)
+    // Headless rendering has no window, frames go into an offscreen framebuffer and optionally to disk
+    std::unique_ptr<HeadlessContext> headlessContext;
+    if (headlessFrames > 0)
     {
-        glfwTerminate();
-        return -1;
+        headlessContext.reset(new HeadlessContext(WINDOW_WIDTH, WINDOW_HEIGHT));
+        if (!headlessContext->IsValid())
+            return -1;
+        std::cout << "Headless rendering through " << HeadlessContext::GetBackendName() << std::endl;
     }
+    else
+    {
+        /* Initialize the library */
+        if (!glfwInit())
+            return -1;
 
-    /* Make the window's context current */
-    glfwMakeContextCurrent(window);
-    
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);  // 3.2+ only
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);            // 3.0+ only
 
-    // Set the fps to match the refresh rate of the monitor (freesync)
-    glfwSwapInterval(1);
 
-    if (glewInit() != GLEW_OK) {
-        std::cout << "GLEW INIT ERROR!" << std::endl;
+        /* Create a windowed mode window and its OpenGL context */
+        window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Hello World", NULL, NULL);
+        if (!window)
+        {
+            glfwTerminate();
+            return -1;
+        }
+
+        /* Make the window's context current */
+        glfwMakeContextCurrent(window);
+    
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+        // Set the fps to match the refresh rate of the monitor (freesync), the frame pacer can change it later
+        glfwSwapInterval(1);
+        framePacer.QueryAdaptiveVsync();
     }
 
+    HeadlessContext::InitGlew();
+
     std::cout << "GL VESRION: " << glGetString(GL_VERSION) << std::endl;
 
-    glfwSetCursorPosCallback(window, mouse_callback);
+    // ImGui, the culling passes and the framebuffers call GL themselves, the window needs a GL device
+    if (!backendChosen || backend == BACKEND_NULL || backend == BACKEND_RECORDING || backend == BACKEND_SOFTWARE)
+        backend = RenderDevice::GetDefaultBackend();
+    // Declared before every GL object so it outlives them
+    std::unique_ptr<RenderDevice> renderDevice(RenderDevice::Create(backend));
+    RenderDeviceScope renderDeviceScope(renderDevice.get());
+    std::cout << "Render device: " << RenderDevice::Get().GetName() << std::endl;
+
+    if (window)
+        glfwSetCursorPosCallback(window, mouse_callback);
 
     ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
     // Setup Dear ImGui context
@@ -87,58 +512,16 @@ int main(void)
     ImGui::StyleColorsDark();
     //ImGui::StyleColorsLight();
 
-    // Setup Platform/Renderer backends
-    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    // Setup Platform/Renderer backends, headless the UI is still built but never drawn
+    if (window)
+        ImGui_ImplGlfw_InitForOpenGL(window, true);
+    else
+        io.DisplaySize = ImVec2((float)WINDOW_WIDTH, (float)WINDOW_HEIGHT);
     ImGui_ImplOpenGL3_Init(glsl_version);
 
 
-    const int NUM_OF_POSITIONS = 180;
-    // pos.x, pos.y, pos.z, texture.x, texture.y
-    float positions[] = {
-        -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
-         0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
-         0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-         0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-        -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
-
-        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-         0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-        -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
-        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-
-        -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-        -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-        -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-
-         0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-         0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-         0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-         0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-         0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-
-        -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-         0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
-         0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-         0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-
-        -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-         0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-        -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
-        -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
-    };
 
-    VertexBuffer vb(positions, sizeof(float) * NUM_OF_POSITIONS);
+    VertexBuffer vb(CUBE_VERTICES, sizeof(CUBE_VERTICES));
     VertexBufferLayout layout;
     // We create a definition of the attributes of our vertex buffer, 
     // in this case our vb only has a position attrib thats represented by 3 floats
@@ -151,8 +534,6 @@ int main(void)
     va.AddLayout(vb, layout, nullptr);
 
 
-    Shader shader("res/shaders/Basic.shader");
-
     Texture texture("./res/textures/brick_texture.jpeg", 1024, 1024, 3);
     //Texture texture("./res/textures/cube.jpg", 813, 610, 3);
 
@@ -160,88 +541,450 @@ int main(void)
     vb.Unbind();
     //ib.Unbind();
 
+    // GPU driven path: a grid of cubes that a compute shader culls and writes draw commands for,
+    // the whole grid is then submitted with a single multi draw indirect call
+    bool gpuDriven = false;
+    bool occlusionCulling = true;
+
+    std::vector<unsigned int> cubeIndices(NUM_OF_POSITIONS / 5);
+    for (unsigned int i = 0; i < cubeIndices.size(); i++)
+        cubeIndices[i] = i;
+    IndexBuffer cubeIb(cubeIndices.data(), (unsigned int)cubeIndices.size());
+    VertexArray gpuVa;
+    gpuVa.AddLayout(vb, layout, &cubeIb);
+    gpuVa.Unbind();
+
+    // Scene state lives in the registry, the renderer and culling read the component arrays directly
+    Registry registry;
+    TransformStorage& transforms = registry.Transforms();
+    Entity cube = CreateScene(registry);
+
+    std::unique_ptr<GpuCulling> gpuCulling;
+    std::unique_ptr<HiZBuffer> hiZBuffer;
+    std::unique_ptr<Shader> indirectShader;
+    if (GpuCulling::IsSupported())
+    {
+        std::vector<GpuMeshDrawArgs> meshes = { { cubeIb.getCount(), 0, 0, 0 } };
+        gpuCulling.reset(new GpuCulling(GPU_OBJECT_COUNT, meshes));
+        hiZBuffer.reset(new HiZBuffer(WINDOW_WIDTH, WINDOW_HEIGHT));
+        indirectShader.reset(new Shader("res/shaders/Indirect.shader"));
+        gpuCulling->AttachObjectIDs(gpuVa, 2);
+    }
+    else
+    {
+        std::cout << "GL 4.3 is not available, the GPU driven path is disabled" << std::endl;
+    }
+
+
+    // CPU path: job threads cull the grid and record command lists, the render thread submits them.
+    // It draws spheres whose level of detail is picked per instance.
+    bool commandListGrid = false;
+    std::vector<float> sphereVertices;
+    std::vector<MeshletCuller> sphereMeshlets;
+    LODChain sphereLods = CreateGridMesh(sphereVertices, sphereMeshlets);
+    VertexBuffer sphereVb(sphereVertices.data(), (unsigned int)(sphereVertices.size() * sizeof(float)));
+    IndexBuffer sphereIb(sphereLods.indices.data(), (unsigned int)sphereLods.indices.size());
+    VertexArray sphereVa;
+    sphereVa.AddLayout(sphereVb, layout, &sphereIb);
+    sphereVa.Unbind();
+    LODSelector lodSelector;
+    float lodThreshold = 1.0f;
+    bool meshletCulling = true;
+    Shader batchedShader("res/shaders/Batched.shader");
+    batchedShader.SetUniformBlockBinding("ObjectBlock", 1);
+    RenderResources renderResources;
+    // Depth tested and filled, a desc with state.polygonMode = GL_LINE would draw wireframes
+    const Pipeline* scenePipeline = Pipeline::Create(PipelineDesc(&batchedShader));
+    MaterialLayout materialLayout;
+    materialLayout.Push("color", MATERIAL_VEC4, glm::vec4(1.0f));
+    MaterialSystem materials;
+    unsigned short sceneTemplateID = materials.AddTemplate(renderResources, scenePipeline, materialLayout, BATCHED_MATERIAL_CAPACITY);
+    MaterialInstance brick = materials.GetInstance(materials.AddInstance(sceneTemplateID, renderResources.AddTexture(&texture)));
+    unsigned short cubeVaID = renderResources.AddVertexArray(&va);
+    std::vector<MeshDraw> meshDraws = { {
+        brick.pipelineID, renderResources.AddVertexArray(&sphereVa), brick.textureID, brick.index,
+        DrawMode::ELEMENTS, 0, sphereLods.levels[0].indexCount, &sphereLods, &sphereMeshlets } };
+    unsigned int uniformAlignment = UniformBuffer::GetOffsetAlignment();
+    UniformBuffer objectUniforms(GPU_OBJECT_COUNT * uniformAlignment);
+    std::vector<const CommandList*> submittedLists;
+
 
-    float modelPositionValues[] = {0.0, 0.0, 0.0};
-    float modelRotationValues[] = {0.0, 0.0, 0.0};
     float cameraPositionValues[] = { 0.0f, 0.0f, 0.0f };
 
     glm::vec3 worldUp(0.0f, 1.0f, 0.0f);
     float cameraFOV = 45.0f;
+    float spinSpeed = 0.0f;
+
+    FixedTimestep timestep(SIMULATION_RATE);
+    Camera previousCamera = camera;
+
+
+    // Records on the render thread, the main thread only reads finished results for the panel
+    GpuProfiler gpuProfiler;
+
+    std::unique_ptr<Framebuffer> offscreenTarget;
+    if (headlessContext)
+        offscreenTarget.reset(new Framebuffer(WINDOW_WIDTH, WINDOW_HEIGHT));
+    std::vector<unsigned char> capturedPixels;
+
+    // Bloom: bright parts downsampled straight to quarter resolution and blurred there, added back while tone mapping
+    bool postProcess = false;
+    float bloomThreshold = 0.8f, bloomStrength = 0.6f, exposure = 1.0f;
+    int toneMapOperator = 0;
+    RenderTargetPool renderTargets;
+    Shader bloomBrightShader("res/shaders/BloomBright.shader");
+    Shader bloomBlurShader("res/shaders/BloomBlur.shader");
+    Shader toneMapShader("res/shaders/ToneMap.shader");
+    PostProcessChain postProcessChain;
+    unsigned int brightPass = postProcessChain.AddPass("Bloom bright pass", &bloomBrightShader, POST_PROCESS_QUARTER);
+    unsigned int blurPass = postProcessChain.AddPass("Bloom horizontal blur", &bloomBlurShader, POST_PROCESS_QUARTER);
+    postProcessChain.SetParameters(blurPass, glm::vec4(1.0f, 0.0f, 0.0f, 0.0f));
+    blurPass = postProcessChain.AddPass("Bloom vertical blur", &bloomBlurShader, POST_PROCESS_QUARTER);
+    postProcessChain.SetParameters(blurPass, glm::vec4(0.0f, 1.0f, 0.0f, 0.0f));
+    unsigned int toneMapPass = postProcessChain.AddPass("Tone map", &toneMapShader, POST_PROCESS_FULL);
+    // Scene resolution follows the GPU frame time, the reduced image is upscaled with sharpening
+    bool dynamicResolutionEnabled = false;
+    float sharpness = 0.5f;
+    DynamicResolution dynamicResolution;
+    unsigned long long timedFrame = 0;
+    Shader upscaleShader("res/shaders/Upscale.shader");
+    PostProcessChain upscaleChain;
+    unsigned int upscalePass = upscaleChain.AddPass("Upscale", &upscaleShader, POST_PROCESS_FULL);
+    // The Hi-Z pyramid is built at window size, a scene drawn smaller leaves it without valid depth
+    bool hiZValid = false;
+    // Declared again every frame, what gets drawn depends on the packet
+    RenderGraph frameGraph;
+    // What the graph of the last packet that came back did, read on the main thread once the render thread is done with it
+    unsigned int graphPasses = 0, executedGraphPasses = 0;
+    unsigned long long transientMemory = 0, peakMemory = 0;
+
+    // Runs on the render thread, only reads the packet and the GL objects created above
+    auto renderFrame = [&](FramePacket& packet)
+    {
+        gpuProfiler.BeginFrame();
+        frameGraph.Reset();
+        // With post processing the scene goes to a half float texture first, the chain writes the final image.
+        // A scaled scene is drawn to a texture of its size and upscaled into the backbuffer last.
+        // Headless frames end up in the offscreen target.
+        unsigned int sceneWidth = DynamicResolution::ScaleSize(WINDOW_WIDTH, packet.renderScale);
+        unsigned int sceneHeight = DynamicResolution::ScaleSize(WINDOW_HEIGHT, packet.renderScale);
+        bool upscale = sceneWidth != WINDOW_WIDTH || sceneHeight != WINDOW_HEIGHT;
+        RenderGraphResource backbuffer = frameGraph.ImportTarget("Backbuffer", offscreenTarget.get(), WINDOW_WIDTH, WINDOW_HEIGHT);
+        RenderGraphResource sceneColor = backbuffer;
+        if (packet.postProcess)
+            sceneColor = frameGraph.CreateTexture("Scene color", FramebufferDesc(sceneWidth, sceneHeight, FRAMEBUFFER_RGBA16F));
+        else if (upscale)
+            sceneColor = frameGraph.CreateTexture("Scene color", FramebufferDesc(sceneWidth, sceneHeight));
+        RenderGraphResource sceneResult = sceneColor;
+        if (packet.postProcess)
+            sceneResult = upscale ? frameGraph.CreateTexture("Tone mapped", FramebufferDesc(sceneWidth, sceneHeight, FRAMEBUFFER_RGBA8, false)) : backbuffer;
+
+        // The pyramid is built from the depth the previous frame captured, culling in the scene pass reads it
+        bool testOcclusion = gpuCulling && packet.gpuDriven && packet.occlusionCulling && hiZValid;
+        RenderGraphResource hiZPyramid = 0;
+        if (testOcclusion)
+            hiZPyramid = hiZBuffer->AddToGraph(frameGraph);
+
+        unsigned int scenePass = frameGraph.AddPass("Scene", [&](const RenderGraphContext& context)
+        {
+            context.BindTarget(sceneColor);
+            {
+                GpuScope scope(&gpuProfiler, "Clear");
+                renderer.Clear();
+            }
+            // The indirect grid draws without a pipeline of its own and relies on this one's depth test.
+            // Binding it again every frame costs nothing when nothing else changed the state.
+            scenePipeline->Bind();
+
+            {
+                GpuScope scope(&gpuProfiler, "Command lists");
+                materials.Upload();
+                batchedShader.Bind();
+                batchedShader.SetUniformMatrix4fv("u_projection", false, glm::value_ptr(packet.projection));
+                batchedShader.SetUniformMatrix4fv("u_view", false, glm::value_ptr(packet.view));
+                submittedLists.clear();
+                submittedLists.push_back(&packet.mainList);
+                for (const CommandList& list : packet.commandLists)
+                    submittedLists.push_back(&list);
+                renderer.Execute(submittedLists, renderResources, objectUniforms);
+            }
 
+            if (gpuCulling && packet.gpuDriven)
+            {
+                GpuScope gridScope(&gpuProfiler, "GPU driven grid");
+                gpuCulling->SetObjects(packet.cullingObjects.data(), packet.cullingTransforms.data(), (unsigned int)packet.cullingObjects.size());
 
-    // enable wireframe mode, use GL_FILL for regural mode
-    // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+                glm::mat4 viewProjection = packet.projection * packet.view;
+                {
+                    GpuScope scope(&gpuProfiler, "Cull");
+                    gpuCulling->Cull(viewProjection, testOcclusion ? hiZBuffer.get() : nullptr);
+                }
+
+                {
+                    GpuScope scope(&gpuProfiler, "Draw indirect");
+                    indirectShader->Bind();
+                    indirectShader->SetUniformMatrix4fv("u_projection", false, glm::value_ptr(packet.projection));
+                    indirectShader->SetUniformMatrix4fv("u_view", false, glm::value_ptr(packet.view));
+                    texture.Bind();
+                    gpuCulling->Draw(renderer, gpuVa, *indirectShader);
+                }
+
+                // Next frame occlusion tests against this frame's depth
+                hiZValid = packet.occlusionCulling && !upscale;
+                if (hiZValid)
+                {
+                    GpuScope scope(&gpuProfiler, "Hi-Z depth copy");
+                    hiZBuffer->CaptureDepth(viewProjection);
+                }
+            }
+        });
+        frameGraph.Write(scenePass, sceneColor);
+        if (testOcclusion)
+            frameGraph.Read(scenePass, hiZPyramid);
+
+        if (packet.postProcess)
+        {
+            postProcessChain.SetParameters(brightPass, glm::vec4(packet.bloomThreshold, 0.0f, 0.0f, 0.0f));
+            postProcessChain.SetParameters(toneMapPass, glm::vec4(packet.bloomStrength, packet.exposure, (float)packet.toneMapOperator, 0.0f));
+            postProcessChain.AddToGraph(frameGraph, sceneColor, sceneResult);
+        }
+        if (upscale)
+        {
+            upscaleChain.SetParameters(upscalePass, glm::vec4(packet.sharpness, 0.0f, 0.0f, 0.0f));
+            upscaleChain.AddToGraph(frameGraph, sceneResult, backbuffer);
+        }
+
+        unsigned int imguiPass = frameGraph.AddPass("ImGui", [&](const RenderGraphContext& context)
+        {
+            context.BindTarget(backbuffer);
+            ImGui_ImplOpenGL3_RenderDrawData(packet.imgui.Get());
+        });
+        frameGraph.Write(imguiPass, backbuffer);
+
+        frameGraph.Execute(renderTargets, &gpuProfiler);
+        packet.graphPasses = frameGraph.GetPassCount();
+        packet.executedGraphPasses = frameGraph.GetExecutedPassCount();
+        packet.transientMemory = frameGraph.GetTransientMemory();
+        packet.peakMemory = frameGraph.GetPeakMemory();
+        renderTargets.EndFrame();
+        gpuProfiler.EndFrame();
+        RenderStats::EndFrame();
+        GLCapture::EndFrame();
+
+        if (offscreenTarget && !outputDirectory.empty())
+        {
+            PROFILE_SCOPE("Write frame");
+            offscreenTarget->ReadPixels(capturedPixels);
+            char fileName[32];
+            snprintf(fileName, sizeof(fileName), "/frame_%05llu.tga", packet.frameIndex);
+            ImageWriter::WriteTga(outputDirectory + fileName, offscreenTarget->getWidth(), offscreenTarget->getHeight(), capturedPixels.data());
+        }
+    };
+
+    // The ImGui backend creates its GL objects lazily, they have to exist before the context moves
+    ImGui_ImplOpenGL3_CreateDeviceObjects();
+    RenderThread renderThread(window, renderFrame, threadedRendering);
 
     /* Loop until the user closes the window */
-    while (!glfwWindowShouldClose(window))
+    unsigned long long frameIndex = 0;
+    while (headlessContext ? frameIndex < headlessFrames : !glfwWindowShouldClose(window))
     {
-        renderer.Clear();
-        glEnable(GL_DEPTH_TEST);  
+        {
+            PROFILE_SCOPE("Frame pacing");
+            framePacer.WaitForNextFrame();
+            // Input is sampled as late as possible, right after the GPU caught up with everything submitted
+            if (framePacer.WaitsForGpu())
+                renderThread.WaitIdle();
+        }
+        PROFILE_SCOPE("Frame");
 
-        float currentFrame = glfwGetTime();
+        /* Poll for and process events */
+        if (window)
+            glfwPollEvents();
+        // Headless frames are evenly spaced in time, so the same run always renders the same images
+        double inputTime = window ? glfwGetTime() : frameIndex * HEADLESS_FRAME_TIME;
+
+        float currentFrame = (float)inputTime;
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
-        processInput(window, &camera, deltaTime);
+        // Catches up on whole steps, a slow frame runs more of them instead of taking a bigger one
+        unsigned int steps = timestep.Advance(deltaTime);
+        for (unsigned int step = 0; step < steps; step++)
+        {
+            PROFILE_SCOPE("Simulation step");
+            previousCamera = camera;
+            if (window)
+                processInput(window, &camera, timestep.GetStep());
+            Simulate(registry, cube, timestep.GetStep(), spinSpeed, parallelFor);
+            timestep.CompleteStep();
+        }
+        // Rendering shows a blend of the last two steps, so motion stays smooth between them
+        float alpha = timestep.GetAlpha();
         
         // Start the Dear ImGui frame
         ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
+        if (window)
+            ImGui_ImplGlfw_NewFrame();
+        else
+            io.DeltaTime = (float)HEADLESS_FRAME_TIME;
         ImGui::NewFrame();
         
-        glm::mat4 modelMatrix(1.0);
-        modelMatrix = glm::translate(modelMatrix, glm::vec3(modelPositionValues[0], modelPositionValues[1], modelPositionValues[2]));
-        modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotationValues[0]), glm::vec3(1.0, 0.0, 0.0));
-        modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotationValues[1]), glm::vec3(0.0, 1.0, 0.0));
-        modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotationValues[2]), glm::vec3(0.0, 0.0, 1.0));
-        
-        glm::mat4 viewMatrix = camera.getCameraMatrix();
+        glm::mat4 viewMatrix = camera.getInterpolatedCameraMatrix(previousCamera, alpha);
       
+        camera.setFOV(cameraFOV);
         glm::mat4 projectionMatrix = glm::perspective(glm::radians(cameraFOV), (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT, 0.1f, 100.0f);
 
-        shader.Bind();
-
-        shader.SetUniform4f("u_Color", 0.0f, 0.749f, 0.498f, 1.0);
-        shader.SetUniformMatrix4fv("u_projection", false, glm::value_ptr(projectionMatrix));
-        shader.SetUniformMatrix4fv("u_view", false, glm::value_ptr(viewMatrix));
-        shader.SetUniformMatrix4fv("u_model", false, glm::value_ptr(modelMatrix));
-
-        texture.Bind();
-
         ImGui::Begin("Hello, world!");                          
 
         ImGui::ColorEdit3("clear color", (float*)&clear_color); // Edit 3 floats representing a color
         ImGui::Text("Model Position");
-        ImGui::SliderFloat3("Model Position", modelPositionValues, -10.0, 10.0);
+        glm::vec3 cubePosition = transforms.GetPosition(cube);
+        if (ImGui::SliderFloat3("Model Position", glm::value_ptr(cubePosition), -10.0, 10.0))
+            transforms.SetPosition(cube, cubePosition);
         ImGui::Text("Model Rotation");
-        ImGui::SliderFloat3("Model Rotation", modelRotationValues, 0.0, 360.0);
+        glm::vec3 cubeRotation = transforms.GetRotation(cube);
+        if (ImGui::SliderFloat3("Model Rotation", glm::value_ptr(cubeRotation), 0.0, 360.0))
+            transforms.SetRotation(cube, cubeRotation);
         ImGui::Text("Camera Position");
         ImGui::SliderFloat3("Camera Position", cameraPositionValues, -10.0, 10.0);
         ImGui::Text("Camera FOV");
         ImGui::SliderFloat("Camera FOV", &cameraFOV, 0.0, 180.0);
+        ImGui::SliderFloat("Spin speed", &spinSpeed, -360.0, 360.0);
+        if (gpuCulling)
+        {
+            ImGui::Checkbox("GPU driven grid", &gpuDriven);
+            ImGui::Checkbox("Occlusion culling", &occlusionCulling);
+        }
+        ImGui::Checkbox("CPU grid (command lists)", &commandListGrid);
+        if (commandListGrid)
+        {
+            if (ImGui::SliderFloat("LOD error (pixels)", &lodThreshold, 0.25f, 16.0f))
+                lodSelector.SetThreshold(lodThreshold);
+            ImGui::Checkbox("Meshlet culling", &meshletCulling);
+        }
+        ImGui::Checkbox("Bloom and tone mapping", &postProcess);
+        if (postProcess)
+        {
+            ImGui::SliderFloat("Bloom threshold", &bloomThreshold, 0.0f, 2.0f);
+            ImGui::SliderFloat("Bloom strength", &bloomStrength, 0.0f, 2.0f);
+            ImGui::SliderFloat("Exposure", &exposure, 0.1f, 4.0f);
+            ImGui::Combo("Tone mapping", &toneMapOperator, "Clamp\0Reinhard\0ACES\0");
+        }
+        if (ImGui::Checkbox("Dynamic resolution", &dynamicResolutionEnabled))
+            dynamicResolution.Reset();
+        if (dynamicResolutionEnabled)
+        {
+            float budget = dynamicResolution.GetBudget();
+            if (ImGui::SliderFloat("GPU budget (ms)", &budget, 2.0f, 50.0f))
+                dynamicResolution.SetBudget(budget);
+            float minScale = dynamicResolution.GetMinScale();
+            if (ImGui::SliderFloat("Minimum scale", &minScale, 0.25f, 1.0f))
+                dynamicResolution.SetMinScale(minScale);
+            ImGui::SliderFloat("Sharpness", &sharpness, 0.0f, 1.0f);
+            ImGui::Text("Scale %.2f (%ux%u), GPU %.2f ms", dynamicResolution.GetScale(), DynamicResolution::ScaleSize(WINDOW_WIDTH, dynamicResolution.GetScale()),
+                DynamicResolution::ScaleSize(WINDOW_HEIGHT, dynamicResolution.GetScale()), dynamicResolution.GetSmoothedTime());
+        }
            
         ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
+        int pacingMode = framePacer.GetMode();
+        if (ImGui::Combo("Frame pacing", &pacingMode, [](void*, int mode) { return FramePacer::GetModeName((PacingMode)mode); }, nullptr, PACING_MODE_COUNT))
+            framePacer.SetMode((PacingMode)pacingMode);
+        if (framePacer.GetMode() == PACING_ADAPTIVE_VSYNC && !framePacer.IsAdaptiveVsyncSupported())
+            ImGui::Text("swap_control_tear is not supported, using vsync");
+        if (framePacer.GetMode() == PACING_LIMITED)
+        {
+            float targetFrameRate = (float)framePacer.GetTargetFrameRate();
+            if (ImGui::SliderFloat("Target FPS", &targetFrameRate, 10.0f, 360.0f))
+                framePacer.SetTargetFrameRate(targetFrameRate);
+        }
+        ImGui::Text("Input to present latency %.2f ms", renderThread.GetLatency() * 1000.0);
+        ImGui::Text("Render graph %u of %u passes, transient targets %.2f MB, %.2f MB aliased", executedGraphPasses, graphPasses,
+            transientMemory / (1024.0 * 1024.0), peakMemory / (1024.0 * 1024.0));
+        ImGui::Text("Simulation %.0f Hz, %llu steps dropped", SIMULATION_RATE, timestep.GetDroppedSteps());
+#ifdef PROFILING_ENABLED
+        if (ImGui::Button("Export CPU trace"))
+            PROFILE_EXPORT("cpu_trace.json");
+#endif
         ImGui::End();
+        gpuProfiler.DrawImGuiPanel();
+        RenderStats::DrawImGuiOverlay();
 
-        renderer.Draw(DrawMode::ARRAYS, va, 180, shader);
+        // Waits only if the render thread is still on the frame before the previous one
+        PROFILE_SCOPE("Build frame packet");
+        FramePacket& packet = renderThread.BeginFrame();
+        graphPasses = packet.graphPasses;
+        executedGraphPasses = packet.executedGraphPasses;
+        transientMemory = packet.transientMemory;
+        peakMemory = packet.peakMemory;
+        packet.frameIndex = frameIndex;
+        packet.inputTime = inputTime;
+        packet.swapInterval = framePacer.GetSwapInterval();
+        packet.waitForGpu = framePacer.WaitsForGpu();
+        packet.view = viewMatrix;
+        packet.projection = projectionMatrix;
 
-        // Rendering
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        if (packet.mainList.GetUniformAlignment() != uniformAlignment)
+            packet.mainList = CommandList(uniformAlignment);
+        packet.mainList.Clear();
+        packet.mainList.Draw(brick.pipelineID, cubeVaID, brick.textureID, brick.index, DrawMode::ARRAYS, 0, 36, transforms.InterpolatedWorldMatrix(cube, alpha));
 
-        /* Swap front and back buffers */
-        glfwSwapBuffers(window);
+        packet.gpuDriven = gpuCulling && gpuDriven;
+        packet.occlusionCulling = occlusionCulling;
+        packet.postProcess = postProcess;
+        packet.bloomThreshold = bloomThreshold;
+        packet.bloomStrength = bloomStrength;
+        packet.exposure = exposure;
+        packet.toneMapOperator = toneMapOperator;
+        packet.sharpness = sharpness;
+        packet.renderScale = 1.0f;
+        if (dynamicResolutionEnabled)
+        {
+            // Fed once per frame the GPU finished, the whole frame's time is what has to fit the budget
+            unsigned long long resultFrame = 0;
+            std::vector<GpuTimerResult> gpuTimes = gpuProfiler.GetResults(&resultFrame);
+            if (resultFrame != timedFrame && !gpuTimes.empty() && gpuTimes[0].depth == 0)
+            {
+                timedFrame = resultFrame;
+                dynamicResolution.Update(gpuTimes[0].milliseconds);
+            }
+            packet.renderScale = dynamicResolution.GetScale();
+        }
+        packet.commandLists.clear();
+        if (packet.gpuDriven)
+            RenderSystem::GatherCullingObjects(registry, packet.cullingObjects, packet.cullingTransforms, alpha);
+        else if (commandListGrid)
+        {
+            // Levels are picked for the resolution the scene renders at
+            RenderView gridView(projectionMatrix * viewMatrix, glm::vec3(glm::inverse(viewMatrix)[3]),
+                LODSelector::ProjectionScale(cameraFOV, (int)DynamicResolution::ScaleSize(WINDOW_HEIGHT, packet.renderScale)), &lodSelector);
+            meshDraws[0].meshlets = meshletCulling ? &sphereMeshlets : nullptr;
+            RenderSystem::RecordDraws(registry, gridView, meshDraws, packet.commandLists, uniformAlignment, alpha, parallelFor);
+        }
 
-        /* Poll for and process events */
-        glfwPollEvents();
+        // Rendering
+        ImGui::Render();
+        packet.imgui.Capture(window ? ImGui::GetDrawData() : nullptr);
+        renderThread.Submit();
+        frameIndex++;
     }
 
+    // The remaining GL objects are destroyed on this thread
+    renderThread.Stop();
+    Pipeline::ReleaseAll();
+    SamplerCache::ReleaseAll();
+    GLCapture::End();
+
     ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
+    if (window)
+        ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
 
-    glfwDestroyWindow(window);
-    glfwTerminate();
+    if (window)
+    {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
 
     return 0;
 }
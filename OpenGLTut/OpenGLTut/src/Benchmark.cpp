@@ -0,0 +1,557 @@
+#include "Benchmark.h"
+#include "HeadlessContext.h"
+#include "Framebuffer.h"
+#include "Renderer.h"
+#include "CommandList.h"
+#include "Material.h"
+#include "Pipeline.h"
+#include "SamplerCache.h"
+#include "Registry.h"
+#include "Components.h"
+#include "Systems.h"
+#include "MeshSimplifier.h"
+#include "LODSelector.h"
+#include "GpuProfiler.h"
+#include "RenderStats.h"
+#include "Profiler.h"
+#include "GLCapture.h"
+#include "NullDevice.h"
+#include "RecordingDevice.h"
+#include "SoftwareDevice.h"
+#include "Utils.h"
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <unistd.h>
+#endif
+
+// RenderResources hands out unsigned short ids, unique meshes above this are reused round robin
+static const unsigned int MAX_UNIQUE_MESHES = 65535;
+// Every material is a template of its own
+static const unsigned int MAX_MATERIALS = MaterialSystem::MAX_TEMPLATES;
+// Each material has an instance per texture, the template's material array holds that many
+static const unsigned int MAX_TEXTURES = BATCHED_MATERIAL_CAPACITY;
+static const unsigned int MAX_SUBDIVISIONS = 64;
+// Unique meshes are cubes scaled by up to this much per axis
+static const float MAX_MESH_SCALE = 1.5f;
+static const unsigned int TEXTURE_SIZE = 256;
+// Objects sit on a grid with this spacing, the camera orbits the whole grid
+static const float OBJECT_SPACING = 3.0f;
+// Frames the CPU may run ahead of the GPU, a window's swap chain would give the same limit
+static const unsigned int FRAMES_IN_FLIGHT = 2;
+// Simulation step per frame, fixed so results don't depend on how fast the machine is
+static const float FRAME_STEP = 1.0f / 60.0f;
+
+// std:: distributions differ between standard libraries, this generator gives the same scene everywhere
+class BenchmarkRandom
+{
+private:
+	unsigned int _state;
+public:
+	BenchmarkRandom(unsigned int seed) : _state(seed ? seed : 1) {};
+
+	unsigned int Next()
+	{
+		_state ^= _state << 13;
+		_state ^= _state >> 17;
+		_state ^= _state << 5;
+		return _state;
+	};
+	// Uniform in [min, max)
+	float Range(float min, float max) { return min + (max - min) * (float)(Next() >> 8) / 16777216.0f; };
+};
+
+struct MetricSamples
+{
+	const char* name;
+	std::vector<double> values;
+
+	MetricSamples(const char* name) : name(name) {}
+};
+
+static unsigned long long GetResidentBytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return counters.WorkingSetSize;
+	return 0;
+#else
+	std::ifstream statm("/proc/self/statm");
+	unsigned long long size = 0, resident = 0;
+	if (!(statm >> size >> resident))
+		return 0;
+	return resident * (unsigned long long)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+// Nearest rank on sorted values
+static double Percentile(const std::vector<double>& sorted, double percent)
+{
+	if (sorted.empty())
+		return 0.0;
+	size_t rank = (size_t)std::ceil(percent / 100.0 * sorted.size());
+	return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+static void WriteMetric(std::ofstream& file, const MetricSamples& metric)
+{
+	std::vector<double> sorted = metric.values;
+	std::sort(sorted.begin(), sorted.end());
+	double sum = 0.0;
+	for (double value : sorted)
+		sum += value;
+
+	file << "\"" << metric.name << "\":{\"samples\":" << sorted.size();
+	if (!sorted.empty())
+	{
+		file << ",\"min\":" << sorted.front() << ",\"mean\":" << sum / sorted.size()
+			<< ",\"p50\":" << Percentile(sorted, 50.0) << ",\"p90\":" << Percentile(sorted, 90.0)
+			<< ",\"p95\":" << Percentile(sorted, 95.0) << ",\"p99\":" << Percentile(sorted, 99.0)
+			<< ",\"max\":" << sorted.back();
+	}
+	file << "}";
+}
+
+// Strings from the driver can contain anything
+static std::string EscapeJson(const char* text)
+{
+	std::string escaped;
+	for (const char* c = text ? text : ""; *c; c++)
+	{
+		if (*c == '"' || *c == '\\')
+			escaped += '\\';
+		if ((unsigned char)*c >= 0x20)
+			escaped += *c;
+	}
+	return escaped;
+}
+
+// Unit cube scaled per axis, every face split into subdivisions x subdivisions quads with texture coordinates
+// of its own, so the cube edges are uv seams
+static void BuildCube(const glm::vec3& scale, unsigned int subdivisions, std::vector<float>& vertices, std::vector<unsigned int>& indices)
+{
+	static const float FACES[6][4][3] = {
+		{ { -1, -1,  1 }, {  1, -1,  1 }, {  1,  1,  1 }, { -1,  1,  1 } },
+		{ {  1, -1, -1 }, { -1, -1, -1 }, { -1,  1, -1 }, {  1,  1, -1 } },
+		{ { -1, -1, -1 }, { -1, -1,  1 }, { -1,  1,  1 }, { -1,  1, -1 } },
+		{ {  1, -1,  1 }, {  1, -1, -1 }, {  1,  1, -1 }, {  1,  1,  1 } },
+		{ { -1,  1,  1 }, {  1,  1,  1 }, {  1,  1, -1 }, { -1,  1, -1 } },
+		{ { -1, -1, -1 }, {  1, -1, -1 }, {  1, -1,  1 }, { -1, -1,  1 } }
+	};
+
+	vertices.clear();
+	indices.clear();
+	unsigned int row = subdivisions + 1;
+	for (unsigned int face = 0; face < 6; face++)
+	{
+		glm::vec3 corner(FACES[face][0][0], FACES[face][0][1], FACES[face][0][2]);
+		glm::vec3 uAxis = glm::vec3(FACES[face][1][0], FACES[face][1][1], FACES[face][1][2]) - corner;
+		glm::vec3 vAxis = glm::vec3(FACES[face][3][0], FACES[face][3][1], FACES[face][3][2]) - corner;
+		unsigned int first = (unsigned int)vertices.size() / 5;
+		for (unsigned int y = 0; y <= subdivisions; y++)
+		{
+			for (unsigned int x = 0; x <= subdivisions; x++)
+			{
+				// Whole numbers until the division, so faces meeting at an edge get bit identical positions there
+				glm::vec3 position = (corner * (float)subdivisions + uAxis * (float)x + vAxis * (float)y) / (float)subdivisions * 0.5f * scale;
+				vertices.insert(vertices.end(), { position.x, position.y, position.z, (float)x / (float)subdivisions, (float)y / (float)subdivisions });
+			}
+		}
+		for (unsigned int y = 0; y < subdivisions; y++)
+		{
+			for (unsigned int x = 0; x < subdivisions; x++)
+			{
+				unsigned int a = first + y * row + x;
+				indices.insert(indices.end(), { a, a + 1, a + row + 1, a + row + 1, a + row, a });
+			}
+		}
+	}
+}
+
+int Benchmark::Run(const BenchmarkSettings& settings, const ParallelForFunction& parallelFor)
+{
+	bool useGL = !settings.backendChosen || settings.backend == BACKEND_GL33 || settings.backend == BACKEND_GL45;
+	std::unique_ptr<HeadlessContext> context;
+	if (useGL)
+	{
+		context.reset(new HeadlessContext(settings.width, settings.height));
+		if (!context->IsValid())
+			return -1;
+		if (!HeadlessContext::InitGlew())
+			return -1;
+	}
+	std::unique_ptr<RenderDevice> device(RenderDevice::Create(settings.backendChosen ? settings.backend : RenderDevice::GetDefaultBackend(),
+		settings.width, settings.height, parallelFor));
+	if (!device)
+		return -1;
+	RenderDeviceScope deviceScope(device.get());
+	std::string backendName = useGL ? HeadlessContext::GetBackendName() : "no context";
+	std::string rendererName = useGL ? (const char*)glGetString(GL_RENDERER) : device->GetName();
+	std::string versionName = useGL ? (const char*)glGetString(GL_VERSION) : device->GetBackend() == BACKEND_SOFTWARE ? SoftwareRasterizer::GetSimdName() : "";
+
+	unsigned int materialCount = std::max(1u, std::min(settings.materials, MAX_MATERIALS));
+	unsigned int textureCount = std::max(1u, std::min(settings.textures, MAX_TEXTURES));
+	unsigned int meshCount = settings.uniqueMeshes ? std::max(1u, std::min(settings.objects, MAX_UNIQUE_MESHES)) : 1;
+	unsigned int subdivisions = std::max(1u, std::min(settings.subdivisions, MAX_SUBDIVISIONS));
+	std::cout << "Benchmark: " << settings.objects << " objects, " << materialCount << " materials, " << textureCount << " textures, "
+		<< meshCount << " meshes, " << (settings.dynamicObjects ? "dynamic" : "static") << ", " << backendName
+		<< ", " << rendererName << ", " << device->GetName() << " device" << std::endl;
+
+	BenchmarkRandom random(settings.seed);
+	unsigned long long sceneGpuBytes = 0;
+
+	// Textures are checkerboards in a color of their own, generated instead of loaded so the benchmark needs no assets
+	std::vector<std::unique_ptr<Texture>> textures;
+	std::vector<unsigned char> pixels(TEXTURE_SIZE * TEXTURE_SIZE * 4);
+	for (unsigned int t = 0; t < textureCount; t++)
+	{
+		unsigned char color[3] = { (unsigned char)(random.Next() & 0xFF), (unsigned char)(random.Next() & 0xFF), (unsigned char)(random.Next() & 0xFF) };
+		for (unsigned int y = 0; y < TEXTURE_SIZE; y++)
+		{
+			for (unsigned int x = 0; x < TEXTURE_SIZE; x++)
+			{
+				bool dark = ((x / 32) + (y / 32)) & 1;
+				unsigned char* pixel = &pixels[(y * TEXTURE_SIZE + x) * 4];
+				for (int c = 0; c < 3; c++)
+					pixel[c] = dark ? color[c] / 2 : color[c];
+				pixel[3] = 255;
+			}
+		}
+		textures.emplace_back(new Texture(pixels.data(), TEXTURE_SIZE, TEXTURE_SIZE, 4));
+		// Mip chain adds a third
+		sceneGpuBytes += (unsigned long long)TEXTURE_SIZE * TEXTURE_SIZE * 4 * 4 / 3;
+	}
+
+	std::vector<std::unique_ptr<Shader>> shaders;
+	for (unsigned int m = 0; m < materialCount; m++)
+	{
+		shaders.emplace_back(new Shader("res/shaders/Batched.shader"));
+		shaders.back()->SetUniformBlockBinding("ObjectBlock", 1);
+	}
+
+	// A template per material shader with an instance per texture, instance m * textureCount + t draws material m
+	// with texture t. The pipelines only differ in their program so switching between them changes no other state.
+	RenderResources resources;
+	std::vector<unsigned short> textureIDs;
+	for (unsigned int t = 0; t < textureCount; t++)
+		textureIDs.push_back(resources.AddTexture(textures[t].get()));
+	MaterialLayout materialLayout;
+	materialLayout.Push("color", MATERIAL_VEC4, glm::vec4(1.0f));
+	MaterialSystem materials;
+	std::vector<MaterialInstance> materialInstances;
+	for (unsigned int m = 0; m < materialCount; m++)
+	{
+		unsigned short templateID = materials.AddTemplate(resources, Pipeline::Create(PipelineDesc(shaders[m].get())), materialLayout, BATCHED_MATERIAL_CAPACITY);
+		for (unsigned int t = 0; t < textureCount; t++)
+			materialInstances.push_back(materials.GetInstance(materials.AddInstance(templateID, textureIDs[t])));
+	}
+
+	// Instanced scenes share one cube, unique ones get a differently proportioned cube per object
+	VertexBufferLayout layout;
+	layout.Push<float>(3);
+	layout.Push<float>(2);
+	std::vector<std::unique_ptr<VertexBuffer>> vertexBuffers;
+	std::vector<std::unique_ptr<IndexBuffer>> indexBuffers;
+	std::vector<std::unique_ptr<VertexArray>> vertexArrays;
+	std::vector<unsigned short> vertexArrayIDs;
+	std::vector<glm::vec3> meshScales;
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+	// Scaling a cube changes none of the collapses the simplifier may make, so every mesh shares the LOD chain
+	// of the largest cube, whose errors bound those of the smaller ones
+	BuildCube(glm::vec3(settings.uniqueMeshes ? MAX_MESH_SCALE : 1.0f), subdivisions, vertices, indices);
+	LODChain lodChain = MeshSimplifier::GenerateLODChain(vertices.data(), (unsigned int)vertices.size() / 5, 5, indices);
+	std::vector<MeshletCuller> meshlets = MeshletBuilder::BuildLODs(vertices.data(), (unsigned int)vertices.size() / 5, 5, lodChain);
+	for (unsigned int mesh = 0; mesh < meshCount; mesh++)
+	{
+		glm::vec3 scale = settings.uniqueMeshes ? glm::vec3(random.Range(0.5f, MAX_MESH_SCALE), random.Range(0.5f, MAX_MESH_SCALE), random.Range(0.5f, MAX_MESH_SCALE)) : glm::vec3(1.0f);
+		BuildCube(scale, subdivisions, vertices, indices);
+		vertexBuffers.emplace_back(new VertexBuffer(vertices.data(), (unsigned int)(vertices.size() * sizeof(float))));
+		indexBuffers.emplace_back(new IndexBuffer(lodChain.indices.data(), (unsigned int)lodChain.indices.size()));
+		if (settings.sharedVertexArray)
+		{
+			if (vertexArrays.empty())
+			{
+				vertexArrays.emplace_back(new VertexArray());
+				vertexArrays.back()->SetFormat(layout);
+			}
+			vertexArrayIDs.push_back(resources.AddMesh(vertexArrays.back().get(), vertexBuffers.back().get(), indexBuffers.back().get()));
+		}
+		else
+		{
+			vertexArrays.emplace_back(new VertexArray());
+			vertexArrays.back()->AddLayout(*vertexBuffers.back(), layout, indexBuffers.back().get());
+			vertexArrayIDs.push_back(resources.AddVertexArray(vertexArrays.back().get()));
+		}
+		meshScales.push_back(scale);
+		sceneGpuBytes += vertices.size() * sizeof(float) + lodChain.indices.size() * sizeof(unsigned int);
+	}
+	vertexArrays.back()->Unbind();
+
+	// One MeshDraw per pair of mesh and material instance some object uses, MeshComponent::meshIndex points into
+	// this table. Filled while the objects are created, unique meshes would make a full table huge.
+	std::vector<MeshDraw> meshDraws;
+	std::unordered_map<unsigned long long, unsigned int> meshDrawIndices;
+
+	// Objects fill a cube shaped grid in random order, each with a random orientation and spin
+	Registry registry;
+	TransformStorage& transforms = registry.Transforms();
+	unsigned int gridSize = std::max(1u, (unsigned int)std::ceil(std::cbrt((double)settings.objects)));
+	float extent = gridSize * OBJECT_SPACING;
+	std::vector<Entity> entities;
+	std::vector<float> spinSpeeds;
+	entities.reserve(settings.objects);
+	for (unsigned int i = 0; i < settings.objects; i++)
+	{
+		glm::vec3 cell((float)(i % gridSize), (float)((i / gridSize) % gridSize), (float)(i / (gridSize * gridSize)));
+		glm::vec3 position = (cell + 0.5f) * OBJECT_SPACING - extent * 0.5f;
+		glm::vec3 rotation(random.Range(0.0f, 360.0f), random.Range(0.0f, 360.0f), random.Range(0.0f, 360.0f));
+
+		// Materials and textures are picked independently, so every texture shows up with every material
+		unsigned int mesh = i % meshCount;
+		unsigned int material = random.Next() % materialCount;
+		unsigned int instance = material * textureCount + random.Next() % textureCount;
+		unsigned long long key = (unsigned long long)mesh * materialInstances.size() + instance;
+		auto drawIndex = meshDrawIndices.find(key);
+		if (drawIndex == meshDrawIndices.end())
+		{
+			const MaterialInstance& materialInstance = materialInstances[instance];
+			drawIndex = meshDrawIndices.emplace(key, (unsigned int)meshDraws.size()).first;
+			meshDraws.push_back({ materialInstance.pipelineID, vertexArrayIDs[mesh], materialInstance.textureID, materialInstance.index,
+				DrawMode::ELEMENTS, 0, lodChain.levels[0].indexCount, &lodChain, settings.meshletCulling ? &meshlets : nullptr });
+		}
+
+		Entity entity = registry.Create();
+		transforms.Add(entity, position, rotation);
+		registry.Add<BoundsComponent>(entity, { glm::vec3(0.0f), 0.5f * glm::length(meshScales[mesh]) });
+		registry.Add<MeshComponent>(entity, { drawIndex->second, 0 });
+		entities.push_back(entity);
+		spinSpeeds.push_back(random.Range(-180.0f, 180.0f));
+	}
+	TransformSystem::Update(registry, parallelFor);
+
+	// The target, the timer queries and the fences are GL only
+	std::unique_ptr<Framebuffer> target;
+	std::unique_ptr<GpuProfiler> gpuProfiler;
+	if (useGL)
+	{
+		target.reset(new Framebuffer(settings.width, settings.height));
+		gpuProfiler.reset(new GpuProfiler());
+	}
+	sceneGpuBytes += (unsigned long long)settings.width * settings.height * 8;
+	Renderer renderer;
+	unsigned int uniformAlignment = UniformBuffer::GetOffsetAlignment();
+	UniformBuffer objectUniforms(std::max(1u, settings.objects) * uniformAlignment);
+	std::vector<CommandList> lists;
+	std::vector<const CommandList*> submittedLists;
+	LODSelector lodSelector;
+	GLsync fences[FRAMES_IN_FLIGHT] = {};
+
+	MetricSamples frameMs = { "frame_cpu_ms" }, simulationMs = { "simulation_cpu_ms" }, recordMs = { "cull_record_cpu_ms" },
+		submitMs = { "submit_cpu_ms" }, gpuWaitMs = { "gpu_wait_cpu_ms" }, gpuMs = { "gpu_ms" }, drawCalls = { "draw_calls" },
+		triangles = { "triangles" }, stateChanges = { "state_changes" }, uploadedBytes = { "uploaded_bytes" };
+	unsigned long long sampledGpuFrame = ~0ull;
+	unsigned long long peakResidentBytes = 0;
+	// The recording device's log is emptied after every frame so it doesn't grow with the run and inflate the
+	// resident memory, only its totals are kept
+	RecordingDevice* recording = device->GetBackend() == BACKEND_RECORDING ? static_cast<RecordingDevice*>(device.get()) : nullptr;
+	unsigned long long recordedCalls = 0;
+	size_t largestRecordedFrame = 0;
+
+	typedef std::chrono::high_resolution_clock Clock;
+	auto milliseconds = [](Clock::time_point begin, Clock::time_point end) { return std::chrono::duration<double, std::milli>(end - begin).count(); };
+
+	unsigned int totalFrames = settings.warmupFrames + settings.frames;
+	for (unsigned int frame = 0; frame < totalFrames; frame++)
+	{
+		PROFILE_SCOPE("Benchmark frame");
+		bool measured = frame >= settings.warmupFrames;
+		auto frameStart = Clock::now();
+
+		// Same number of frames in flight as with a window, otherwise the CPU could queue unlimited work
+		GLsync& fence = fences[frame % FRAMES_IN_FLIGHT];
+		if (useGL && fence)
+		{
+			GLCall(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000));
+			GLCall(glDeleteSync(fence));
+			fence = nullptr;
+		}
+		auto waitEnd = Clock::now();
+
+		if (settings.dynamicObjects)
+		{
+			PROFILE_SCOPE("Benchmark simulation");
+			for (size_t i = 0; i < entities.size(); i++)
+			{
+				glm::vec3 rotation = transforms.GetRotation(entities[i]);
+				rotation.y = std::fmod(rotation.y + spinSpeeds[i] * FRAME_STEP, 360.0f);
+				transforms.SetRotation(entities[i], rotation);
+			}
+			// One material changes per frame, its instances are the only range uploaded
+			float pulse = 0.75f + 0.25f * std::cos((float)frame * 0.1f);
+			for (unsigned int t = 0; t < textureCount; t++)
+				materials.SetParameter((unsigned short)((frame % materialCount) * textureCount + t), "color", glm::vec4(pulse, pulse, pulse, 1.0f));
+		}
+		TransformSystem::Update(registry, parallelFor);
+		auto simulationEnd = Clock::now();
+
+		// Orbits the grid once over the measured frames while bobbing up and down, so the visible set keeps changing
+		float angle = 2.0f * 3.14159265f * (float)((int)frame - (int)settings.warmupFrames) / (float)std::max(1u, settings.frames);
+		glm::vec3 eye(std::cos(angle) * extent * 0.9f, std::sin(angle * 2.0f) * extent * 0.3f, std::sin(angle) * extent * 0.9f);
+		glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)settings.width / (float)settings.height, 0.1f, extent * 3.0f);
+		RenderView renderView(projection * view, eye, LODSelector::ProjectionScale(45.0f, (int)settings.height), &lodSelector);
+		RenderSystem::RecordDraws(registry, renderView, meshDraws, lists, uniformAlignment, 1.0f, parallelFor);
+		auto recordEnd = Clock::now();
+
+		{
+			PROFILE_SCOPE("Benchmark submit");
+			if (target)
+			{
+				target->Bind();
+				gpuProfiler->BeginFrame();
+			}
+			renderer.Clear();
+			materials.Upload();
+			for (std::unique_ptr<Shader>& shader : shaders)
+			{
+				shader->Bind();
+				shader->SetUniformMatrix4fv("u_projection", false, glm::value_ptr(projection));
+				shader->SetUniformMatrix4fv("u_view", false, glm::value_ptr(view));
+			}
+			submittedLists.clear();
+			for (const CommandList& list : lists)
+				submittedLists.push_back(&list);
+			renderer.Execute(submittedLists, resources, objectUniforms);
+			if (gpuProfiler)
+				gpuProfiler->EndFrame();
+			RenderStats::EndFrame();
+			GLCapture::EndFrame();
+			if (useGL)
+			{
+				GLCall(fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+			}
+			// The software device rasterizes the whole frame here, so its submit time is its render time
+			device->Flush();
+		}
+		auto submitEnd = Clock::now();
+
+		if (recording)
+		{
+			recordedCalls += recording->GetCalls().size();
+			largestRecordedFrame = std::max(largestRecordedFrame, recording->GetCalls().size());
+			recording->ClearCalls();
+		}
+
+		peakResidentBytes = std::max(peakResidentBytes, GetResidentBytes());
+		if (!measured)
+			continue;
+
+		frameMs.values.push_back(milliseconds(frameStart, submitEnd));
+		gpuWaitMs.values.push_back(milliseconds(frameStart, waitEnd));
+		simulationMs.values.push_back(milliseconds(waitEnd, simulationEnd));
+		recordMs.values.push_back(milliseconds(simulationEnd, recordEnd));
+		submitMs.values.push_back(milliseconds(recordEnd, submitEnd));
+
+		RenderStatsFrame stats = RenderStats::GetLastFrame();
+		unsigned int changes = 0;
+		for (unsigned int count : stats.stateChanges)
+			changes += count;
+		drawCalls.values.push_back(stats.drawCalls);
+		triangles.values.push_back((double)stats.triangles);
+		stateChanges.values.push_back(changes);
+		uploadedBytes.values.push_back((double)(stats.bufferBytes + stats.textureBytes));
+
+		// Results arrive a few frames late, only frames past the warmup count
+		unsigned long long gpuFrame = 0;
+		std::vector<GpuTimerResult> gpuResults;
+		if (gpuProfiler)
+			gpuResults = gpuProfiler->GetResults(&gpuFrame);
+		if (!gpuResults.empty() && gpuFrame != sampledGpuFrame && gpuFrame >= settings.warmupFrames)
+		{
+			gpuMs.values.push_back(gpuResults[0].milliseconds);
+			sampledGpuFrame = gpuFrame;
+		}
+	}
+
+	if (useGL)
+	{
+		GLCall(glFinish());
+	}
+	for (GLsync fence : fences)
+	{
+		if (fence)
+		{
+			GLCall(glDeleteSync(fence));
+		}
+	}
+	// Pipelines point to shaders of this scope and the samplers live on its device
+	Pipeline::ReleaseAll();
+	SamplerCache::ReleaseAll();
+
+	std::ofstream file(settings.outputPath);
+	if (!file)
+	{
+		std::cout << "Could not write " << settings.outputPath << std::endl;
+		return -1;
+	}
+	file << "{\n\"settings\":{\"objects\":" << settings.objects << ",\"materials\":" << materialCount << ",\"textures\":" << textureCount
+		<< ",\"meshes\":" << meshCount << ",\"unique_meshes\":" << (settings.uniqueMeshes ? "true" : "false")
+		<< ",\"shared_vertex_array\":" << (settings.sharedVertexArray ? "true" : "false") << ",\"subdivisions\":" << subdivisions
+		<< ",\"lod_levels\":" << lodChain.levels.size() << ",\"meshlets\":" << meshlets[0].GetMeshletCount()
+		<< ",\"meshlet_culling\":" << (settings.meshletCulling ? "true" : "false")
+		<< ",\"dynamic\":" << (settings.dynamicObjects ? "true" : "false") << ",\"warmup_frames\":" << settings.warmupFrames
+		<< ",\"frames\":" << settings.frames << ",\"width\":" << settings.width << ",\"height\":" << settings.height
+		<< ",\"seed\":" << settings.seed << "},\n";
+	file << "\"context\":{\"backend\":\"" << backendName << "\",\"renderer\":\"" << EscapeJson(rendererName.c_str())
+		<< "\",\"version\":\"" << EscapeJson(versionName.c_str()) << "\",\"device\":\"" << device->GetName() << "\"},\n";
+	file << "\"metrics\":{";
+	const MetricSamples* metrics[] = { &frameMs, &gpuWaitMs, &simulationMs, &recordMs, &submitMs, &gpuMs, &drawCalls, &triangles, &stateChanges, &uploadedBytes };
+	for (size_t i = 0; i < sizeof(metrics) / sizeof(metrics[0]); i++)
+	{
+		file << (i ? ",\n" : "\n");
+		WriteMetric(file, *metrics[i]);
+	}
+	file << "\n},\n\"memory\":{\"peak_resident_bytes\":" << peakResidentBytes << ",\"scene_gpu_bytes\":" << sceneGpuBytes << "}\n}" << std::endl;
+
+	std::sort(frameMs.values.begin(), frameMs.values.end());
+	std::cout << "Frame CPU p50 " << Percentile(frameMs.values, 50.0) << " ms, p99 " << Percentile(frameMs.values, 99.0)
+		<< " ms, results in " << settings.outputPath << std::endl;
+
+	// What the CPU side asked for, any validation error means a bug in the renderer
+	unsigned long long validationErrors = 0;
+	NullDevice* nullDevice = nullptr;
+	if (device->GetBackend() == BACKEND_NULL)
+		nullDevice = static_cast<NullDevice*>(device.get());
+	if (recording)
+	{
+		recordedCalls += recording->GetCalls().size();
+		std::cout << recordedCalls << " calls recorded, " << largestRecordedFrame << " in the largest frame" << std::endl;
+		nullDevice = static_cast<NullDevice*>(&recording->GetTarget());
+	}
+	if (nullDevice)
+	{
+		nullDevice->PrintCounts(std::cout);
+		validationErrors = nullDevice->GetErrorCount();
+	}
+	if (device->GetBackend() == BACKEND_SOFTWARE)
+		validationErrors = static_cast<SoftwareDevice*>(device.get())->GetErrorCount();
+	return validationErrors == 0 ? 0 : 1;
+}
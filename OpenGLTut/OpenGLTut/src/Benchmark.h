@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+#include "JobSystem.h"
+#include "RenderDevice.h"
+
+// What the procedural benchmark scene is made of, the same settings always produce the same scene and frames
+struct BenchmarkSettings
+{
+	unsigned int objects = 10000;
+	// Every material is its own shader program, so materials cost program switches like they would in a real scene
+	unsigned int materials = 8;
+	unsigned int textures = 4;
+	// Unique gives every object its own vertex and index buffers, instanced has all objects share one mesh
+	bool uniqueMeshes = false;
+	// All meshes are drawn through one vertex array that gets their buffers attached, instead of one vertex array each
+	bool sharedVertexArray = false;
+	// Every cube face is split into subdivisions x subdivisions quads. The meshes get a LOD chain that simplifies
+	// the flat faces back down, so far objects draw fewer triangles.
+	unsigned int subdivisions = 1;
+	// Every LOD level is split into meshlets at load, with this they are culled per object and the visible
+	// ones drawn with one multi draw
+	bool meshletCulling = false;
+	// Dynamic objects spin every frame and one material changes color per frame, static ones never touch their
+	// transforms or materials after the first update
+	bool dynamicObjects = false;
+	// Warmup frames run the whole frame but aren't measured
+	unsigned int warmupFrames = 60;
+	unsigned int frames = 600;
+	unsigned int width = 1920;
+	unsigned int height = 1080;
+	unsigned int seed = 1;
+	std::string outputPath = "benchmark.json";
+	// Without a chosen backend the best GL device the context supports is used. The null and recording
+	// backends need no context at all, they measure the CPU side alone. The software backend needs
+	// none either, it rasterizes on the job threads.
+	bool backendChosen = false;
+	RenderBackend backend = BACKEND_GL33;
+};
+
+// Renders a generated scene along a fixed camera path on a headless context and writes per stage
+// percentiles of CPU time, GPU time, draw calls and memory as JSON
+class Benchmark
+{
+public:
+	// Returns the process exit code, 0 when the results were written
+	static int Run(const BenchmarkSettings& settings, const ParallelForFunction& parallelFor = nullptr);
+};
@@ -1,5 +1,6 @@
 #include "Camera.h"
 #include <glm/ext/matrix_transform.hpp>
+#include <glm/common.hpp>
 
 Camera::Camera(float FOV) : _fov(FOV)
 {
@@ -19,6 +20,13 @@ glm::mat4 Camera::getCameraMatrix() const
 	return matrix;
 }
 
+glm::mat4 Camera::getInterpolatedCameraMatrix(const Camera& previous, float alpha) const
+{
+	glm::vec3 pos = glm::mix(previous._pos, _pos, alpha);
+	glm::vec3 front = glm::normalize(glm::mix(previous._front, _front, alpha));
+	return glm::lookAt(pos, pos + front, _up);
+}
+
 void Camera::move(MovementDirection direction, float deltaTime)
 {
 	switch (direction)
@@ -44,3 +52,13 @@ void Camera::setFOV(float fov)
 {
 	_fov = fov;
 }
+
+float Camera::getFOV() const
+{
+	return _fov;
+}
+
+glm::vec3 Camera::getPosition() const
+{
+	return _pos;
+}
@@ -20,8 +20,12 @@ public:
 	~Camera();
 
 	glm::mat4 getCameraMatrix() const;
+	// View matrix part of the way from previous to this camera, alpha 0 is previous
+	glm::mat4 getInterpolatedCameraMatrix(const Camera& previous, float alpha) const;
 
 	void move(MovementDirection direction, float deltaTime);
 
 	void setFOV(float fov);
+	float getFOV() const;
+	glm::vec3 getPosition() const;
 };
@@ -0,0 +1,530 @@
+#include "CaptureReplay.h"
+#include "HeadlessContext.h"
+#include "Framebuffer.h"
+#include <GL/glew.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+static const char* const OP_NAMES[CAPTURE_OP_COUNT] = {
+	"blob", "frame_end",
+	"create_buffer", "delete_buffer", "bind_buffer", "bind_buffer_base", "bind_buffer_range",
+	"buffer_data", "buffer_sub_data", "clear_buffer_data",
+	"create_texture", "delete_texture", "active_texture", "bind_texture", "tex_image_2d",
+	"tex_storage_2d", "tex_parameter", "generate_mipmap", "pixel_store", "copy_tex_sub_image_2d",
+	"bind_image_texture",
+	"create_program", "delete_program", "use_program", "uniform", "uniform_block_binding",
+	"create_vertex_array", "delete_vertex_array", "bind_vertex_array", "enable_vertex_attrib",
+	"vertex_attrib_pointer", "vertex_attrib_divisor",
+	"create_framebuffer", "delete_framebuffer", "bind_framebuffer", "framebuffer_texture",
+	"create_renderbuffer", "delete_renderbuffer", "bind_renderbuffer", "renderbuffer_storage",
+	"framebuffer_renderbuffer",
+	"enable", "disable", "viewport", "clear",
+	"draw_arrays", "draw_elements", "multi_draw_elements", "multi_draw_indirect",
+	"multi_draw_indirect_count", "dispatch_compute", "memory_barrier",
+	"named_buffer_data", "named_buffer_sub_data", "clear_named_buffer_data",
+	"vertex_array_vertex_buffer", "vertex_array_binding_divisor", "enable_vertex_array_attrib",
+	"vertex_array_attrib_format", "vertex_array_attrib_binding", "vertex_array_element_buffer",
+	"texture_storage_2d", "texture_sub_image_2d", "generate_texture_mipmap",
+	"named_buffer_storage",
+	"depth_mask", "depth_func", "blend_func", "blend_equation", "cull_face",
+	"front_face", "polygon_mode", "stencil_func", "stencil_op", "stencil_mask",
+	"create_sampler", "delete_sampler", "sampler_parameter", "bind_sampler",
+	"bind_textures", "bind_samplers", "bind_texture_unit"
+};
+
+static unsigned int CompileStage(unsigned int type, const std::string& source)
+{
+	unsigned int shader = glCreateShader(type);
+	const char* text = source.c_str();
+	glShaderSource(shader, 1, &text, nullptr);
+	glCompileShader(shader);
+	int status = 0;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		char message[1024];
+		glGetShaderInfoLog(shader, sizeof(message), nullptr, message);
+		std::cout << "Replay could not compile a shader: " << message << std::endl;
+	}
+	return shader;
+}
+
+// Records name their program since the GL 4.5 device sets uniforms on programs that aren't in use.
+// Without GL 4.1 there is no glProgramUniform, such a capture can only come from the GL 3.3 device
+// which always sets uniforms on the program in use.
+static void SetUniform(unsigned int program, int location, UniformType type, const unsigned int* values, unsigned int wordCount)
+{
+	const float* floats = (const float*)values;
+	if (!GLEW_VERSION_4_1)
+	{
+		switch (type)
+		{
+		case UNIFORM_1I: glUniform1i(location, (int)values[0]); break;
+		case UNIFORM_1UI: glUniform1ui(location, values[0]); break;
+		case UNIFORM_2F: glUniform2f(location, floats[0], floats[1]); break;
+		case UNIFORM_4F: glUniform4f(location, floats[0], floats[1], floats[2], floats[3]); break;
+		case UNIFORM_4FV: glUniform4fv(location, wordCount / 4, floats); break;
+		case UNIFORM_MATRIX4FV: glUniformMatrix4fv(location, 1, GL_FALSE, floats); break;
+		}
+		return;
+	}
+	switch (type)
+	{
+	case UNIFORM_1I: glProgramUniform1i(program, location, (int)values[0]); break;
+	case UNIFORM_1UI: glProgramUniform1ui(program, location, values[0]); break;
+	case UNIFORM_2F: glProgramUniform2f(program, location, floats[0], floats[1]); break;
+	case UNIFORM_4F: glProgramUniform4f(program, location, floats[0], floats[1], floats[2], floats[3]); break;
+	case UNIFORM_4FV: glProgramUniform4fv(program, location, wordCount / 4, floats); break;
+	case UNIFORM_MATRIX4FV: glProgramUniformMatrix4fv(program, location, 1, GL_FALSE, floats); break;
+	}
+}
+
+CaptureReplay::CaptureReplay(ReplayBackend backend) : _backend(backend), _opCounts(), _invalidReferences(0)
+{
+}
+
+CaptureReplay::~CaptureReplay()
+{
+	if (_backend != REPLAY_GL)
+		return;
+	for (auto& buffer : _buffers)
+		glDeleteBuffers(1, &buffer.second);
+	for (auto& texture : _textures)
+		glDeleteTextures(1, &texture.second);
+	for (auto& sampler : _samplers)
+		glDeleteSamplers(1, &sampler.second);
+	for (auto& program : _programs)
+		glDeleteProgram(program.second);
+	for (auto& vertexArray : _vertexArrays)
+		glDeleteVertexArrays(1, &vertexArray.second);
+	for (auto& renderbuffer : _renderbuffers)
+		glDeleteRenderbuffers(1, &renderbuffer.second);
+	// Name 0 is the replay's own target, its owner deletes it
+	for (auto& framebuffer : _framebuffers)
+	{
+		if (framebuffer.first != 0)
+			glDeleteFramebuffers(1, &framebuffer.second);
+	}
+}
+
+bool CaptureReplay::Load(const std::string& filePath)
+{
+	std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+	if (!file)
+	{
+		std::cout << "Could not read " << filePath << std::endl;
+		return false;
+	}
+	size_t size = (size_t)file.tellg();
+	file.seekg(0);
+	_words.resize(size / sizeof(unsigned int));
+	file.read((char*)_words.data(), _words.size() * sizeof(unsigned int));
+
+	if (_words.size() < 2 || _words[0] != GLCapture::FILE_MAGIC || _words[1] != GLCapture::FILE_VERSION)
+	{
+		std::cout << filePath << " is not a capture of this version" << std::endl;
+		return false;
+	}
+
+	// Blobs are indexed up front so the replay loop never parses them
+	for (size_t position = 2; position < _words.size(); )
+	{
+		unsigned int op = _words[position] & 0xFF, count = _words[position] >> 8;
+		if (position + 1 + count > _words.size())
+		{
+			std::cout << filePath << " is truncated, the last record is dropped" << std::endl;
+			_words.resize(position);
+			break;
+		}
+		if (op == CAPTURE_BLOB && count >= 3)
+			_blobs[(unsigned long long)_words[position + 1] | ((unsigned long long)_words[position + 2] << 32)] = position + 4;
+		position += 1 + count;
+	}
+	return true;
+}
+
+const unsigned char* CaptureReplay::GetBlob(const unsigned int* reference)
+{
+	if (reference[2] == 0)
+		return nullptr;
+	auto blob = _blobs.find((unsigned long long)reference[0] | ((unsigned long long)reference[1] << 32));
+	if (blob == _blobs.end())
+	{
+		_invalidReferences++;
+		return nullptr;
+	}
+	return (const unsigned char*)&_words[blob->second];
+}
+
+unsigned int CaptureReplay::Find(const std::unordered_map<unsigned int, unsigned int>& names, unsigned int name)
+{
+	if (name == 0)
+		return 0;
+	auto found = names.find(name);
+	if (found == names.end())
+	{
+		_invalidReferences++;
+		return 0;
+	}
+	return found->second;
+}
+
+int CaptureReplay::GetUniformLocation(unsigned int program, const unsigned int* nameReference)
+{
+	unsigned long long key = (unsigned long long)nameReference[0] | ((unsigned long long)nameReference[1] << 32);
+	std::unordered_map<unsigned long long, int>& locations = _uniformLocations[program];
+	auto found = locations.find(key);
+	if (found != locations.end())
+		return found->second;
+
+	const unsigned char* name = GetBlob(nameReference);
+	int location = name ? glGetUniformLocation(program, std::string((const char*)name, nameReference[2]).c_str()) : -1;
+	locations[key] = location;
+	return location;
+}
+
+bool CaptureReplay::ReplayFrame(size_t& position)
+{
+	if (position < 2)
+		position = 2;
+	while (position < _words.size())
+	{
+		CaptureOp op = (CaptureOp)(_words[position] & 0xFF);
+		unsigned int count = _words[position] >> 8;
+		// May point one past the end for a record without arguments at the end of the file
+		const unsigned int* arguments = _words.data() + position + 1;
+		position += 1 + count;
+
+		if (op >= CAPTURE_OP_COUNT)
+		{
+			_invalidReferences++;
+			continue;
+		}
+		_opCounts[op]++;
+		if (op == CAPTURE_FRAME_END)
+			return true;
+		if (op != CAPTURE_BLOB)
+			Execute(op, arguments, count);
+	}
+	return false;
+}
+
+void CaptureReplay::Execute(CaptureOp op, const unsigned int* a, unsigned int count)
+{
+	// The null backend only keeps the name maps, which is all the validation needs
+	if (_backend == REPLAY_NULL)
+	{
+		switch (op)
+		{
+		case CAPTURE_CREATE_BUFFER: _buffers[a[0]] = a[0]; break;
+		case CAPTURE_CREATE_TEXTURE: _textures[a[0]] = a[0]; break;
+		case CAPTURE_CREATE_SAMPLER: _samplers[a[0]] = a[0]; break;
+		case CAPTURE_CREATE_PROGRAM: _programs[a[0]] = a[0]; break;
+		case CAPTURE_CREATE_VERTEX_ARRAY: _vertexArrays[a[0]] = a[0]; break;
+		case CAPTURE_CREATE_FRAMEBUFFER: _framebuffers[a[0]] = a[0]; break;
+		case CAPTURE_CREATE_RENDERBUFFER: _renderbuffers[a[0]] = a[0]; break;
+		case CAPTURE_DELETE_BUFFER: _buffers.erase(a[0]); break;
+		case CAPTURE_DELETE_TEXTURE: _textures.erase(a[0]); break;
+		case CAPTURE_DELETE_SAMPLER: _samplers.erase(a[0]); break;
+		case CAPTURE_DELETE_PROGRAM: _programs.erase(a[0]); break;
+		case CAPTURE_DELETE_VERTEX_ARRAY: _vertexArrays.erase(a[0]); break;
+		case CAPTURE_DELETE_FRAMEBUFFER: _framebuffers.erase(a[0]); break;
+		case CAPTURE_DELETE_RENDERBUFFER: _renderbuffers.erase(a[0]); break;
+		case CAPTURE_BIND_BUFFER: Find(_buffers, a[1]); break;
+		case CAPTURE_BIND_BUFFER_BASE: Find(_buffers, a[2]); break;
+		case CAPTURE_BIND_BUFFER_RANGE: Find(_buffers, a[2]); break;
+		case CAPTURE_BIND_TEXTURE: Find(_textures, a[1]); break;
+		case CAPTURE_BIND_IMAGE_TEXTURE: Find(_textures, a[1]); break;
+		case CAPTURE_USE_PROGRAM: Find(_programs, a[0]); break;
+		case CAPTURE_BIND_VERTEX_ARRAY: Find(_vertexArrays, a[0]); break;
+		case CAPTURE_BIND_RENDERBUFFER: Find(_renderbuffers, a[0]); break;
+		case CAPTURE_BUFFER_DATA: GetBlob(a + 3); break;
+		case CAPTURE_BUFFER_SUB_DATA: GetBlob(a + 3); break;
+		case CAPTURE_TEX_IMAGE_2D: GetBlob(a + 7); break;
+		case CAPTURE_UNIFORM: Find(_programs, a[0]); GetBlob(a + 2); break;
+		case CAPTURE_MULTI_DRAW_ELEMENTS: GetBlob(a + 3); break;
+		case CAPTURE_NAMED_BUFFER_DATA: Find(_buffers, a[0]); GetBlob(a + 3); break;
+		case CAPTURE_NAMED_BUFFER_SUB_DATA: Find(_buffers, a[0]); GetBlob(a + 3); break;
+		case CAPTURE_CLEAR_NAMED_BUFFER_DATA: Find(_buffers, a[0]); break;
+		case CAPTURE_VERTEX_ARRAY_VERTEX_BUFFER: Find(_vertexArrays, a[0]); Find(_buffers, a[2]); break;
+		case CAPTURE_VERTEX_ARRAY_ELEMENT_BUFFER: Find(_vertexArrays, a[0]); Find(_buffers, a[1]); break;
+		case CAPTURE_VERTEX_ARRAY_BINDING_DIVISOR:
+		case CAPTURE_ENABLE_VERTEX_ARRAY_ATTRIB:
+		case CAPTURE_VERTEX_ARRAY_ATTRIB_FORMAT:
+		case CAPTURE_VERTEX_ARRAY_ATTRIB_BINDING: Find(_vertexArrays, a[0]); break;
+		case CAPTURE_TEXTURE_STORAGE_2D: Find(_textures, a[0]); break;
+		case CAPTURE_TEXTURE_SUB_IMAGE_2D: Find(_textures, a[0]); GetBlob(a + 6); break;
+		case CAPTURE_GENERATE_TEXTURE_MIPMAP: Find(_textures, a[0]); break;
+		case CAPTURE_NAMED_BUFFER_STORAGE: Find(_buffers, a[0]); GetBlob(a + 3); break;
+		case CAPTURE_SAMPLER_PARAMETER: Find(_samplers, a[0]); break;
+		case CAPTURE_BIND_SAMPLER: Find(_samplers, a[1]); break;
+		case CAPTURE_BIND_TEXTURE_UNIT: Find(_textures, a[1]); break;
+		case CAPTURE_BIND_TEXTURES:
+			for (unsigned int i = 2; i < count; i++)
+				Find(_textures, a[i]);
+			break;
+		case CAPTURE_BIND_SAMPLERS:
+			for (unsigned int i = 2; i < count; i++)
+				Find(_samplers, a[i]);
+			break;
+		default: break;
+		}
+		return;
+	}
+
+	// Raw GL on purpose, GLCall's two glGetError per call would cost more than the calls being measured.
+	// Errors are collected once per frame instead.
+	switch (op)
+	{
+	// Created names are real objects right away, captures of the GL 4.5 device edit them before they are ever bound
+	case CAPTURE_CREATE_BUFFER:
+		if (GLEW_VERSION_4_5 || GLEW_ARB_direct_state_access)
+			glCreateBuffers(1, &_buffers[a[0]]);
+		else
+			glGenBuffers(1, &_buffers[a[0]]);
+		break;
+	case CAPTURE_DELETE_BUFFER: glDeleteBuffers(1, &_buffers[a[0]]); _buffers.erase(a[0]); break;
+	case CAPTURE_BIND_BUFFER: glBindBuffer(a[0], Find(_buffers, a[1])); break;
+	case CAPTURE_BIND_BUFFER_BASE: glBindBufferBase(a[0], a[1], Find(_buffers, a[2])); break;
+	case CAPTURE_BIND_BUFFER_RANGE: glBindBufferRange(a[0], a[1], Find(_buffers, a[2]), a[3], a[4]); break;
+	case CAPTURE_BUFFER_DATA: glBufferData(a[0], a[1], GetBlob(a + 3), a[2]); break;
+	case CAPTURE_BUFFER_SUB_DATA: glBufferSubData(a[0], a[1], a[2], GetBlob(a + 3)); break;
+	case CAPTURE_CLEAR_BUFFER_DATA: glClearBufferData(a[0], a[1], a[2], a[3], nullptr); break;
+
+	// A second argument is the target of a texture made with glCreateTextures
+	case CAPTURE_CREATE_TEXTURE:
+		if (count >= 2)
+			glCreateTextures(a[1], 1, &_textures[a[0]]);
+		else
+			glGenTextures(1, &_textures[a[0]]);
+		break;
+	case CAPTURE_DELETE_TEXTURE: glDeleteTextures(1, &_textures[a[0]]); _textures.erase(a[0]); break;
+	case CAPTURE_ACTIVE_TEXTURE: glActiveTexture(a[0]); break;
+	case CAPTURE_BIND_TEXTURE: glBindTexture(a[0], Find(_textures, a[1])); break;
+	case CAPTURE_TEX_IMAGE_2D: glTexImage2D(a[0], a[1], a[2], a[3], a[4], 0, a[5], a[6], GetBlob(a + 7)); break;
+	case CAPTURE_TEX_STORAGE_2D: glTexStorage2D(a[0], a[1], a[2], a[3], a[4]); break;
+	case CAPTURE_TEX_PARAMETER: glTexParameteri(a[0], a[1], a[2]); break;
+	case CAPTURE_GENERATE_MIPMAP: glGenerateMipmap(a[0]); break;
+	case CAPTURE_PIXEL_STORE: glPixelStorei(a[0], a[1]); break;
+	case CAPTURE_COPY_TEX_SUB_IMAGE_2D: glCopyTexSubImage2D(a[0], a[1], 0, 0, 0, 0, a[2], a[3]); break;
+	case CAPTURE_BIND_IMAGE_TEXTURE: glBindImageTexture(a[0], Find(_textures, a[1]), a[2], a[3], a[4], a[5], a[6]); break;
+	case CAPTURE_BIND_TEXTURE_UNIT: glBindTextureUnit(a[0], Find(_textures, a[1])); break;
+	case CAPTURE_BIND_TEXTURES:
+	case CAPTURE_BIND_SAMPLERS:
+	{
+		// Units beyond the arguments the record holds stay as they are
+		if (count < 2)
+			break;
+		unsigned int names[32];
+		unsigned int bound = std::min(std::min(a[1], count - 2), 32u);
+		for (unsigned int i = 0; i < bound; i++)
+			names[i] = Find(op == CAPTURE_BIND_TEXTURES ? _textures : _samplers, a[2 + i]);
+		if (op == CAPTURE_BIND_TEXTURES)
+			glBindTextures(a[0], bound, names);
+		else
+			glBindSamplers(a[0], bound, names);
+		break;
+	}
+
+	case CAPTURE_CREATE_SAMPLER: glGenSamplers(1, &_samplers[a[0]]); break;
+	case CAPTURE_DELETE_SAMPLER: glDeleteSamplers(1, &_samplers[a[0]]); _samplers.erase(a[0]); break;
+	case CAPTURE_SAMPLER_PARAMETER: glSamplerParameteri(Find(_samplers, a[0]), a[1], a[2]); break;
+	case CAPTURE_BIND_SAMPLER: glBindSampler(a[0], Find(_samplers, a[1])); break;
+
+	case CAPTURE_CREATE_PROGRAM:
+	{
+		const unsigned char* sources[3] = { GetBlob(a + 1), GetBlob(a + 4), GetBlob(a + 7) };
+		const unsigned int stages[3] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_COMPUTE_SHADER };
+		unsigned int program = glCreateProgram();
+		unsigned int shaders[3] = {};
+		for (int stage = 0; stage < 3; stage++)
+		{
+			if (!sources[stage])
+				continue;
+			shaders[stage] = CompileStage(stages[stage], std::string((const char*)sources[stage], a[3 + stage * 3]));
+			glAttachShader(program, shaders[stage]);
+		}
+		glLinkProgram(program);
+		for (unsigned int shader : shaders)
+		{
+			if (shader)
+				glDeleteShader(shader);
+		}
+		_programs[a[0]] = program;
+		break;
+	}
+	case CAPTURE_DELETE_PROGRAM:
+		_uniformLocations.erase(_programs[a[0]]);
+		glDeleteProgram(_programs[a[0]]);
+		_programs.erase(a[0]);
+		break;
+	case CAPTURE_USE_PROGRAM: glUseProgram(Find(_programs, a[0])); break;
+	case CAPTURE_UNIFORM:
+	{
+		unsigned int program = Find(_programs, a[0]);
+		SetUniform(program, GetUniformLocation(program, a + 2), (UniformType)a[1], a + 5, count - 5);
+		break;
+	}
+	case CAPTURE_UNIFORM_BLOCK_BINDING:
+	{
+		unsigned int program = Find(_programs, a[0]);
+		const unsigned char* name = GetBlob(a + 2);
+		unsigned int index = name ? glGetUniformBlockIndex(program, std::string((const char*)name, a[4]).c_str()) : GL_INVALID_INDEX;
+		if (index != GL_INVALID_INDEX)
+			glUniformBlockBinding(program, index, a[1]);
+		break;
+	}
+
+	case CAPTURE_CREATE_VERTEX_ARRAY:
+		if (GLEW_VERSION_4_5 || GLEW_ARB_direct_state_access)
+			glCreateVertexArrays(1, &_vertexArrays[a[0]]);
+		else
+			glGenVertexArrays(1, &_vertexArrays[a[0]]);
+		break;
+	case CAPTURE_DELETE_VERTEX_ARRAY: glDeleteVertexArrays(1, &_vertexArrays[a[0]]); _vertexArrays.erase(a[0]); break;
+	case CAPTURE_BIND_VERTEX_ARRAY: glBindVertexArray(Find(_vertexArrays, a[0])); break;
+	case CAPTURE_ENABLE_VERTEX_ATTRIB: glEnableVertexAttribArray(a[0]); break;
+	case CAPTURE_VERTEX_ATTRIB_POINTER:
+		if (a[6])
+			glVertexAttribIPointer(a[0], a[1], a[2], a[4], (const void*)(size_t)a[5]);
+		else
+			glVertexAttribPointer(a[0], a[1], a[2], (GLboolean)a[3], a[4], (const void*)(size_t)a[5]);
+		break;
+	case CAPTURE_VERTEX_ATTRIB_DIVISOR: glVertexAttribDivisor(a[0], a[1]); break;
+
+	case CAPTURE_CREATE_FRAMEBUFFER: glGenFramebuffers(1, &_framebuffers[a[0]]); break;
+	case CAPTURE_DELETE_FRAMEBUFFER: glDeleteFramebuffers(1, &_framebuffers[a[0]]); _framebuffers.erase(a[0]); break;
+	case CAPTURE_BIND_FRAMEBUFFER: glBindFramebuffer(a[0], a[1] ? Find(_framebuffers, a[1]) : _framebuffers[0]); break;
+	case CAPTURE_FRAMEBUFFER_TEXTURE: glFramebufferTexture2D(a[0], a[1], a[2], Find(_textures, a[3]), a[4]); break;
+	case CAPTURE_CREATE_RENDERBUFFER: glGenRenderbuffers(1, &_renderbuffers[a[0]]); break;
+	case CAPTURE_DELETE_RENDERBUFFER: glDeleteRenderbuffers(1, &_renderbuffers[a[0]]); _renderbuffers.erase(a[0]); break;
+	case CAPTURE_BIND_RENDERBUFFER: glBindRenderbuffer(GL_RENDERBUFFER, Find(_renderbuffers, a[0])); break;
+	case CAPTURE_RENDERBUFFER_STORAGE: glRenderbufferStorage(GL_RENDERBUFFER, a[0], a[1], a[2]); break;
+	case CAPTURE_FRAMEBUFFER_RENDERBUFFER: glFramebufferRenderbuffer(a[0], a[1], GL_RENDERBUFFER, Find(_renderbuffers, a[2])); break;
+
+	case CAPTURE_ENABLE: glEnable(a[0]); break;
+	case CAPTURE_DISABLE: glDisable(a[0]); break;
+	case CAPTURE_VIEWPORT: glViewport(a[0], a[1], a[2], a[3]); break;
+	case CAPTURE_CLEAR: glClear(a[0]); break;
+
+	case CAPTURE_DRAW_ARRAYS: glDrawArrays(a[0], a[1], a[2]); break;
+	case CAPTURE_DRAW_ELEMENTS: glDrawElements(a[0], a[1], a[2], (const void*)(size_t)a[3]); break;
+	case CAPTURE_MULTI_DRAW_ELEMENTS:
+	{
+		// Counts first, then the byte offsets
+		const unsigned int* ranges = (const unsigned int*)GetBlob(a + 3);
+		if (!ranges)
+			break;
+		std::vector<const void*> offsets(a[2]);
+		for (unsigned int i = 0; i < a[2]; i++)
+			offsets[i] = (const void*)(size_t)ranges[a[2] + i];
+		glMultiDrawElements(a[0], (const int*)ranges, a[1], offsets.data(), a[2]);
+		break;
+	}
+	case CAPTURE_MULTI_DRAW_INDIRECT: glMultiDrawElementsIndirect(a[0], a[1], (const void*)(size_t)a[2], a[3], a[4]); break;
+	case CAPTURE_MULTI_DRAW_INDIRECT_COUNT:
+		if (GLEW_VERSION_4_6)
+			glMultiDrawElementsIndirectCount(a[0], a[1], (const void*)(size_t)a[2], a[3], a[4], a[5]);
+		else
+			glMultiDrawElementsIndirectCountARB(a[0], a[1], (const void*)(size_t)a[2], a[3], a[4], a[5]);
+		break;
+	case CAPTURE_DISPATCH_COMPUTE: glDispatchCompute(a[0], a[1], a[2]); break;
+	case CAPTURE_MEMORY_BARRIER: glMemoryBarrier(a[0]); break;
+
+	case CAPTURE_NAMED_BUFFER_DATA: glNamedBufferData(Find(_buffers, a[0]), a[1], GetBlob(a + 3), a[2]); break;
+	case CAPTURE_NAMED_BUFFER_SUB_DATA: glNamedBufferSubData(Find(_buffers, a[0]), a[1], a[2], GetBlob(a + 3)); break;
+	case CAPTURE_CLEAR_NAMED_BUFFER_DATA: glClearNamedBufferData(Find(_buffers, a[0]), a[1], a[2], a[3], nullptr); break;
+	case CAPTURE_VERTEX_ARRAY_VERTEX_BUFFER: glVertexArrayVertexBuffer(Find(_vertexArrays, a[0]), a[1], Find(_buffers, a[2]), a[3], a[4]); break;
+	case CAPTURE_VERTEX_ARRAY_BINDING_DIVISOR: glVertexArrayBindingDivisor(Find(_vertexArrays, a[0]), a[1], a[2]); break;
+	case CAPTURE_ENABLE_VERTEX_ARRAY_ATTRIB: glEnableVertexArrayAttrib(Find(_vertexArrays, a[0]), a[1]); break;
+	case CAPTURE_VERTEX_ARRAY_ATTRIB_FORMAT:
+		if (a[6])
+			glVertexArrayAttribIFormat(Find(_vertexArrays, a[0]), a[1], a[2], a[3], a[5]);
+		else
+			glVertexArrayAttribFormat(Find(_vertexArrays, a[0]), a[1], a[2], a[3], (GLboolean)a[4], a[5]);
+		break;
+	case CAPTURE_VERTEX_ARRAY_ATTRIB_BINDING: glVertexArrayAttribBinding(Find(_vertexArrays, a[0]), a[1], a[2]); break;
+	case CAPTURE_VERTEX_ARRAY_ELEMENT_BUFFER: glVertexArrayElementBuffer(Find(_vertexArrays, a[0]), Find(_buffers, a[1])); break;
+	case CAPTURE_TEXTURE_STORAGE_2D: glTextureStorage2D(Find(_textures, a[0]), a[1], a[2], a[3], a[4]); break;
+	case CAPTURE_TEXTURE_SUB_IMAGE_2D: glTextureSubImage2D(Find(_textures, a[0]), a[1], 0, 0, a[2], a[3], a[4], a[5], GetBlob(a + 6)); break;
+	case CAPTURE_GENERATE_TEXTURE_MIPMAP: glGenerateTextureMipmap(Find(_textures, a[0])); break;
+	case CAPTURE_NAMED_BUFFER_STORAGE: glNamedBufferStorage(Find(_buffers, a[0]), a[1], GetBlob(a + 3), a[2]); break;
+
+	case CAPTURE_DEPTH_MASK: glDepthMask((GLboolean)a[0]); break;
+	case CAPTURE_DEPTH_FUNC: glDepthFunc(a[0]); break;
+	case CAPTURE_BLEND_FUNC: glBlendFunc(a[0], a[1]); break;
+	case CAPTURE_BLEND_EQUATION: glBlendEquation(a[0]); break;
+	case CAPTURE_CULL_FACE: glCullFace(a[0]); break;
+	case CAPTURE_FRONT_FACE: glFrontFace(a[0]); break;
+	case CAPTURE_POLYGON_MODE: glPolygonMode(GL_FRONT_AND_BACK, a[0]); break;
+	case CAPTURE_STENCIL_FUNC: glStencilFunc(a[0], (GLint)a[1], a[2]); break;
+	case CAPTURE_STENCIL_OP: glStencilOp(a[0], a[1], a[2]); break;
+	case CAPTURE_STENCIL_MASK: glStencilMask(a[0]); break;
+	default: break;
+	}
+}
+
+int CaptureReplay::Run(const std::string& filePath, ReplayBackend backend, unsigned int width, unsigned int height)
+{
+	std::unique_ptr<HeadlessContext> context;
+	std::unique_ptr<Framebuffer> target;
+	if (backend == REPLAY_GL)
+	{
+		context.reset(new HeadlessContext(width, height));
+		if (!context->IsValid())
+			return -1;
+		if (!HeadlessContext::InitGlew())
+			return -1;
+		target.reset(new Framebuffer(width, height));
+	}
+
+	int result = 0;
+	{
+		CaptureReplay replay(backend);
+		if (!replay.Load(filePath))
+			return -1;
+		// The captured default framebuffer becomes the offscreen target
+		replay._framebuffers[0] = target ? target->getRendererID() : 0;
+		if (target)
+			target->Bind();
+
+		typedef std::chrono::high_resolution_clock Clock;
+		std::vector<double> frameMs;
+		unsigned long long glErrors = 0;
+		size_t position = 0;
+		auto start = Clock::now();
+		while (true)
+		{
+			auto frameStart = Clock::now();
+			bool more = replay.ReplayFrame(position);
+			if (backend == REPLAY_GL)
+			{
+				while (glGetError() != GL_NO_ERROR)
+					glErrors++;
+			}
+			if (!more)
+				break;
+			frameMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count());
+		}
+		if (backend == REPLAY_GL)
+			glFinish();
+		double totalMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+		std::sort(frameMs.begin(), frameMs.end());
+		auto percentile = [&](double percent) { return frameMs.empty() ? 0.0 : frameMs[std::min(frameMs.size() - 1, (size_t)(percent / 100.0 * frameMs.size()))]; };
+		std::cout << "Replayed " << frameMs.size() << " frames on the " << (backend == REPLAY_GL ? "GL" : "null") << " backend in " << totalMs << " ms" << std::endl;
+		std::cout << "Frame CPU ms p50 " << percentile(50.0) << ", p90 " << percentile(90.0) << ", p99 " << percentile(99.0) << std::endl;
+		std::cout << replay._words.size() * sizeof(unsigned int) << " bytes, " << replay._blobs.size() << " unique payloads, "
+			<< replay.GetInvalidReferences() << " invalid references, " << glErrors << " GL errors" << std::endl;
+		for (int op = CAPTURE_CREATE_BUFFER; op < CAPTURE_OP_COUNT; op++)
+		{
+			if (replay.GetOpCount((CaptureOp)op) > 0)
+				std::cout << "  " << OP_NAMES[op] << ": " << replay.GetOpCount((CaptureOp)op) << std::endl;
+		}
+		result = replay.GetInvalidReferences() == 0 && glErrors == 0 ? 0 : 1;
+	}
+	return result;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "GLCapture.h"
+
+enum ReplayBackend {
+	// Issues every recorded call to GL on a headless context
+	REPLAY_GL,
+	// Decodes and validates the stream without touching GL, measures the cost of the replay itself
+	REPLAY_NULL
+};
+
+// Plays back a file written by GLCapture as fast as possible. Object names are remapped to the ones
+// created during the replay, and draws to the default framebuffer go to an offscreen target.
+class CaptureReplay
+{
+private:
+	ReplayBackend _backend;
+	std::vector<unsigned int> _words;
+	// Hash of every blob -> index of its first data word
+	std::unordered_map<unsigned long long, size_t> _blobs;
+
+	// Captured name -> replay name, one map per kind of object
+	std::unordered_map<unsigned int, unsigned int> _buffers;
+	std::unordered_map<unsigned int, unsigned int> _textures;
+	std::unordered_map<unsigned int, unsigned int> _samplers;
+	std::unordered_map<unsigned int, unsigned int> _programs;
+	std::unordered_map<unsigned int, unsigned int> _vertexArrays;
+	std::unordered_map<unsigned int, unsigned int> _framebuffers;
+	std::unordered_map<unsigned int, unsigned int> _renderbuffers;
+	// Replay program -> uniform name hash -> location, dropped with the program since GL reuses names
+	std::unordered_map<unsigned int, std::unordered_map<unsigned long long, int>> _uniformLocations;
+
+	unsigned long long _opCounts[CAPTURE_OP_COUNT];
+	unsigned long long _invalidReferences;
+
+	const unsigned char* GetBlob(const unsigned int* reference);
+	unsigned int Find(const std::unordered_map<unsigned int, unsigned int>& names, unsigned int name);
+	int GetUniformLocation(unsigned int program, const unsigned int* nameReference);
+	void Execute(CaptureOp op, const unsigned int* arguments, unsigned int count);
+public:
+	CaptureReplay(ReplayBackend backend);
+	~CaptureReplay();
+	CaptureReplay(const CaptureReplay&) = delete;
+	CaptureReplay& operator=(const CaptureReplay&) = delete;
+
+	bool Load(const std::string& filePath);
+	// Runs the records of one frame starting at position, returns false once the stream is exhausted
+	bool ReplayFrame(size_t& position);
+
+	inline unsigned long long GetOpCount(CaptureOp op) const { return _opCounts[op]; };
+	inline unsigned long long GetInvalidReferences() const { return _invalidReferences; };
+
+	// Replays the whole file once and prints per frame timings, returns the process exit code
+	static int Run(const std::string& filePath, ReplayBackend backend, unsigned int width, unsigned int height);
+};
@@ -0,0 +1,114 @@
+#include "CommandList.h"
+#include "RenderStats.h"
+#include "SamplerCache.h"
+#include <cstring>
+
+unsigned short RenderResources::AddPipeline(const Pipeline* pipeline)
+{
+	_pipelines.push_back(pipeline);
+	return (unsigned short)(_pipelines.size() - 1);
+}
+
+unsigned short RenderResources::AddVertexArray(VertexArray* vertexArray)
+{
+	_vertexArrays.push_back({ vertexArray, nullptr, nullptr });
+	return (unsigned short)(_vertexArrays.size() - 1);
+}
+
+unsigned short RenderResources::AddMesh(VertexArray* vertexArray, const VertexBuffer* vertices, const IndexBuffer* indices)
+{
+	_vertexArrays.push_back({ vertexArray, vertices, indices });
+	return (unsigned short)(_vertexArrays.size() - 1);
+}
+
+void RenderResources::BindVertexArray(unsigned short id, const VertexArray*& bound) const
+{
+	const VertexInput& input = _vertexArrays[id];
+	if (input.vertexArray != bound)
+	{
+		input.vertexArray->Bind();
+		bound = input.vertexArray;
+	}
+	if (input.vertices)
+		input.vertexArray->SetVertexBuffer(*input.vertices);
+	if (input.indices)
+		input.vertexArray->SetIndexBuffer(*input.indices);
+}
+
+unsigned short RenderResources::AddTexture(Texture* texture, const SamplerDesc& sampler)
+{
+	return AddTextureSet(&texture, &sampler, 1);
+}
+
+unsigned short RenderResources::AddTextureSet(Texture* const* textures, const SamplerDesc* samplers, unsigned int count)
+{
+	TextureSet set;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		set.textures.push_back(textures[i]->getRendererID());
+		set.samplers.push_back(SamplerCache::Get(samplers[i]));
+	}
+	_textureSets.push_back(set);
+	return (unsigned short)(_textureSets.size() - 1);
+}
+
+void RenderResources::BindTextures(unsigned short id, unsigned short previous) const
+{
+	const TextureSet& set = _textureSets[id];
+	if (set.textures.empty())
+		return;
+	RenderDevice& device = RenderDevice::Get();
+	RenderStats::CountStateChange(STATE_TEXTURE);
+	device.BindTextures(0, set.textures.data(), (unsigned int)set.textures.size());
+	// Most sets sample alike, so the sampler binding rarely changes between them
+	if (previous >= _textureSets.size() || _textureSets[previous].samplers != set.samplers)
+		device.BindSamplers(0, set.samplers.data(), (unsigned int)set.samplers.size());
+}
+
+CommandList::CommandList(unsigned int uniformAlignment) : _uniformAlignment(uniformAlignment)
+{
+}
+
+void CommandList::Clear()
+{
+	_commands.clear();
+	_uniformData.clear();
+	_rangeCounts.clear();
+	_rangeOffsets.clear();
+}
+
+unsigned int CommandList::PushUniforms(unsigned int materialIndex, const glm::mat4& model)
+{
+	unsigned int offset = (unsigned int)_uniformData.size();
+	_uniformData.resize(offset + ((sizeof(ObjectUniforms) + _uniformAlignment - 1) / _uniformAlignment) * _uniformAlignment);
+	ObjectUniforms uniforms = { model, materialIndex, { 0, 0, 0 } };
+	std::memcpy(&_uniformData[offset], &uniforms, sizeof(ObjectUniforms));
+	return offset;
+}
+
+void CommandList::Draw(unsigned short pipelineID, unsigned short vertexArrayID, unsigned short textureID, unsigned int materialIndex,
+	DrawMode mode, unsigned int first, unsigned int count, const glm::mat4& model)
+{
+	unsigned int offset = PushUniforms(materialIndex, model);
+	_commands.push_back({ MakeSortKey(pipelineID, vertexArrayID, textureID), pipelineID, vertexArrayID, textureID, mode, first, count, offset, 0, 0 });
+}
+
+void CommandList::DrawMulti(unsigned short pipelineID, unsigned short vertexArrayID, unsigned short textureID, unsigned int materialIndex,
+	const int* counts, const void* const* offsets, unsigned int drawCount, const glm::mat4& model)
+{
+	unsigned int offset = PushUniforms(materialIndex, model);
+	unsigned int firstRange = (unsigned int)_rangeCounts.size();
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < drawCount; i++)
+		count += counts[i];
+	_rangeCounts.insert(_rangeCounts.end(), counts, counts + drawCount);
+	_rangeOffsets.insert(_rangeOffsets.end(), offsets, offsets + drawCount);
+	_commands.push_back({ MakeSortKey(pipelineID, vertexArrayID, textureID), pipelineID, vertexArrayID, textureID, DrawMode::ELEMENTS,
+		0, count, offset, firstRange, drawCount });
+}
+
+unsigned long long CommandList::MakeSortKey(unsigned short pipelineID, unsigned short vertexArrayID, unsigned short textureID)
+{
+	// Pipeline switches (program and fixed function state) are the most expensive, then vertex arrays, then textures
+	return ((unsigned long long)pipelineID << 48) | ((unsigned long long)vertexArrayID << 32) | ((unsigned long long)textureID << 16);
+}
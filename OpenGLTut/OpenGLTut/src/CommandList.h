@@ -0,0 +1,109 @@
+#pragma once
+#include <vector>
+#include <glm/ext/matrix_float4x4.hpp>
+#include "Renderer.h"
+#include "Pipeline.h"
+#include "Texture.h"
+#include "VertexArray.h"
+
+// GL objects are referred to by small ids so command lists can be recorded without touching GL
+class RenderResources
+{
+private:
+	// A vertex array of its own, or a mesh drawn through a vertex array shared by its layout
+	struct VertexInput
+	{
+		VertexArray* vertexArray;
+		// Both null for a vertex array of its own
+		const VertexBuffer* vertices;
+		const IndexBuffer* indices;
+	};
+
+	// Textures bound together to the units from 0 on, with the sampler of each unit
+	struct TextureSet
+	{
+		std::vector<unsigned int> textures;
+		std::vector<unsigned int> samplers;
+	};
+
+	std::vector<const Pipeline*> _pipelines;
+	std::vector<VertexInput> _vertexArrays;
+	std::vector<TextureSet> _textureSets;
+public:
+	unsigned short AddPipeline(const Pipeline* pipeline);
+	unsigned short AddVertexArray(VertexArray* vertexArray);
+	// Gets a vertex array id too. vertexArray has its format set and is shared by every mesh with that layout,
+	// binding the id attaches the mesh's buffers to it.
+	unsigned short AddMesh(VertexArray* vertexArray, const VertexBuffer* vertices, const IndexBuffer* indices);
+	// Texture ids name texture sets, this one is a set of a single texture. Samplers come from SamplerCache.
+	unsigned short AddTexture(Texture* texture, const SamplerDesc& sampler = SamplerDesc::Default());
+	// Textures for units 0 to count - 1 (albedo, normal, roughness...), bound with one BindTextures and one BindSamplers
+	unsigned short AddTextureSet(Texture* const* textures, const SamplerDesc* samplers, unsigned int count);
+
+	// bound is the vertex array bound so far and is updated, a mesh of the same vertex array only swaps buffers
+	void BindVertexArray(unsigned short id, const VertexArray*& bound) const;
+	// previous is the texture set bound so far (0xffff for none or unknown), samplers it already bound aren't bound again
+	void BindTextures(unsigned short id, unsigned short previous) const;
+
+	inline const Pipeline* GetPipeline(unsigned short id) const { return _pipelines[id]; };
+	inline VertexArray* GetVertexArray(unsigned short id) const { return _vertexArrays[id].vertexArray; };
+};
+
+// Per draw uniform block, ObjectBlock in Batched.shader (std140)
+struct ObjectUniforms
+{
+	glm::mat4 model;
+	// Element of the material array the draw reads, see MaterialSystem
+	unsigned int materialIndex;
+	unsigned int padding[3];
+};
+
+struct RenderCommand
+{
+	// Commands are executed in key order, state changes only happen where the key changes
+	unsigned long long sortKey;
+	unsigned short pipelineID;
+	unsigned short vertexArrayID;
+	unsigned short textureID;
+	DrawMode mode;
+	unsigned int first;
+	unsigned int count;
+	// Byte offset of the per draw uniform block inside the list's uniform data
+	unsigned int uniformOffset;
+	// A multi draw of rangeCount index ranges starting at firstRange in the list's ranges, 0 draws first and count
+	unsigned int firstRange;
+	unsigned int rangeCount;
+};
+
+// Draws recorded by one thread, contains no GL calls so any thread can fill it
+class CommandList
+{
+private:
+	std::vector<RenderCommand> _commands;
+	std::vector<unsigned char> _uniformData;
+	// Index ranges of the multi draws, offsets are in bytes
+	std::vector<int> _rangeCounts;
+	std::vector<const void*> _rangeOffsets;
+	unsigned int _uniformAlignment;
+
+	unsigned int PushUniforms(unsigned int materialIndex, const glm::mat4& model);
+public:
+	// alignment - offset alignment of uniform block ranges, see UniformBuffer::GetOffsetAlignment
+	CommandList(unsigned int uniformAlignment = 256);
+
+	void Clear();
+	// model and materialIndex end up in the per draw uniform block, see ObjectUniforms
+	void Draw(unsigned short pipelineID, unsigned short vertexArrayID, unsigned short textureID, unsigned int materialIndex,
+		DrawMode mode, unsigned int first, unsigned int count, const glm::mat4& model);
+	// Several ranges of the bound index buffer in one draw (the visible meshlets of a mesh), offsets are in bytes
+	void DrawMulti(unsigned short pipelineID, unsigned short vertexArrayID, unsigned short textureID, unsigned int materialIndex,
+		const int* counts, const void* const* offsets, unsigned int drawCount, const glm::mat4& model);
+
+	inline const std::vector<RenderCommand>& GetCommands() const { return _commands; };
+	inline const std::vector<unsigned char>& GetUniformData() const { return _uniformData; };
+	inline const std::vector<int>& GetRangeCounts() const { return _rangeCounts; };
+	inline const std::vector<const void*>& GetRangeOffsets() const { return _rangeOffsets; };
+	inline unsigned int GetUniformAlignment() const { return _uniformAlignment; };
+
+	static unsigned long long MakeSortKey(unsigned short pipelineID, unsigned short vertexArrayID, unsigned short textureID);
+};
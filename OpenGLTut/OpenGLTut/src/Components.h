@@ -0,0 +1,17 @@
+#pragma once
+#include <glm/ext/vector_float3.hpp>
+
+// Bounding sphere in object space
+struct BoundsComponent
+{
+	glm::vec3 center;
+	float radius;
+};
+
+struct MeshComponent
+{
+	// Index of the render system's MeshDraw, which also carries the material
+	unsigned int meshIndex;
+	// Level of the mesh's LOD chain picked last frame, the next pick starts from it
+	unsigned int lod;
+};
@@ -0,0 +1,67 @@
+#include "DynamicResolution.h"
+#include <algorithm>
+#include <cmath>
+
+// The scale is raised once frames take less than this part of the budget, the gap keeps it from
+// going up and straight back down
+static const float RAISE_THRESHOLD = 0.8f;
+// Drops aim this far below the budget
+static const float DROP_TARGET = 0.9f;
+// Weight of a new frame in the average
+static const float SMOOTHING = 0.2f;
+
+DynamicResolution::DynamicResolution(float budgetMilliseconds, float minScale, float maxScale, float step)
+	: _budget(budgetMilliseconds), _minScale(minScale), _maxScale(maxScale), _step(step), _scale(maxScale),
+	_smoothedTime(0.0f), _framesSinceChange(0), _changes(0)
+{
+}
+
+float DynamicResolution::Quantize(float scale) const
+{
+	// Rounds down, the small epsilon keeps exact steps from falling to the one below
+	float quantized = std::floor(scale / _step + 0.001f) * _step;
+	return std::max(_minScale, std::min(_maxScale, quantized));
+}
+
+float DynamicResolution::Update(float gpuMilliseconds)
+{
+	if (_framesSinceChange < SETTLE_FRAMES)
+	{
+		_framesSinceChange++;
+		return _scale;
+	}
+	_smoothedTime = _smoothedTime == 0.0f ? gpuMilliseconds : _smoothedTime + (gpuMilliseconds - _smoothedTime) * SMOOTHING;
+
+	float scale = _scale;
+	if (_smoothedTime > _budget)
+		scale = Quantize(_scale * std::sqrt(_budget * DROP_TARGET / _smoothedTime));
+	else if (_smoothedTime < _budget * RAISE_THRESHOLD)
+		scale = Quantize(_scale + _step);
+
+	if (scale != _scale)
+	{
+		_scale = scale;
+		_smoothedTime = 0.0f;
+		_framesSinceChange = 0;
+		_changes++;
+	}
+	return _scale;
+}
+
+void DynamicResolution::Reset()
+{
+	_scale = _maxScale;
+	_smoothedTime = 0.0f;
+	_framesSinceChange = 0;
+}
+
+void DynamicResolution::SetMinScale(float scale)
+{
+	_minScale = std::min(scale, _maxScale);
+	_scale = std::max(_scale, _minScale);
+}
+
+unsigned int DynamicResolution::ScaleSize(unsigned int size, float scale)
+{
+	return std::max(1u, (unsigned int)(size * scale + 0.5f));
+}
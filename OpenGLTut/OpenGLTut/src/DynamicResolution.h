@@ -0,0 +1,43 @@
+#pragma once
+
+// Picks the resolution scale of the 3D scene from measured GPU frame times so frames stay within a budget.
+// GPU time is taken to grow with the pixel count, an over budget frame drops the scale straight to what
+// should fit, headroom raises it one step at a time. Scales are multiples of a fixed step, so render
+// targets only come in a few sizes and the pool keeps reusing them. After a change the controller waits
+// until the timings show the new scale (GPU results arrive a few frames late) before it moves again.
+class DynamicResolution
+{
+public:
+	// Frames ignored after a change, more than the GpuProfiler's FRAME_COUNT so the results are from the new scale
+	static const unsigned int SETTLE_FRAMES = 8;
+private:
+	float _budget;
+	float _minScale;
+	float _maxScale;
+	float _step;
+	float _scale;
+	// Average of the frames since the last change, 0 before the first one
+	float _smoothedTime;
+	unsigned int _framesSinceChange;
+	unsigned int _changes;
+
+	float Quantize(float scale) const;
+public:
+	DynamicResolution(float budgetMilliseconds = 16.6f, float minScale = 0.5f, float maxScale = 1.0f, float step = 0.05f);
+
+	// Feeds the GPU time of one finished frame, once per frame the profiler returned, gives the scale to render at
+	float Update(float gpuMilliseconds);
+	// Back to the largest scale with the timings forgotten
+	void Reset();
+
+	inline void SetBudget(float milliseconds) { _budget = milliseconds; };
+	void SetMinScale(float scale);
+	inline float GetBudget() const { return _budget; };
+	inline float GetMinScale() const { return _minScale; };
+	inline float GetScale() const { return _scale; };
+	inline float GetSmoothedTime() const { return _smoothedTime; };
+	inline unsigned int GetChangeCount() const { return _changes; };
+
+	// A side of the scaled target, never below one pixel
+	static unsigned int ScaleSize(unsigned int size, float scale);
+};
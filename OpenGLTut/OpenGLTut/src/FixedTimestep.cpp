@@ -0,0 +1,31 @@
+#include "FixedTimestep.h"
+#include <cmath>
+
+FixedTimestep::FixedTimestep(double stepsPerSecond, unsigned int maxSteps)
+	: _step(1.0 / stepsPerSecond), _maxSteps(maxSteps), _accumulator(0.0), _simulationTime(0.0), _stepCount(0), _droppedSteps(0)
+{
+}
+
+unsigned int FixedTimestep::Advance(double elapsedSeconds)
+{
+	_accumulator += elapsedSeconds > 0.0 ? elapsedSeconds : 0.0;
+
+	unsigned int steps = (unsigned int)std::floor(_accumulator / _step);
+	if (steps > _maxSteps)
+	{
+		_droppedSteps += steps - _maxSteps;
+		steps = _maxSteps;
+		// Keeps the fraction so the blend factor stays continuous
+		_accumulator = std::fmod(_accumulator, _step) + steps * _step;
+	}
+	return steps;
+}
+
+void FixedTimestep::CompleteStep()
+{
+	_accumulator -= _step;
+	if (_accumulator < 0.0)
+		_accumulator = 0.0;
+	_simulationTime += _step;
+	_stepCount++;
+}
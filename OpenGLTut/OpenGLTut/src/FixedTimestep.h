@@ -0,0 +1,30 @@
+#pragma once
+
+// Turns variable frame times into a whole number of fixed simulation steps, so the simulation behaves
+// the same at any frame rate. Whatever is left over is the blend factor between the last two states.
+class FixedTimestep
+{
+private:
+	double _step;
+	unsigned int _maxSteps;
+	double _accumulator;
+	double _simulationTime;
+	unsigned long long _stepCount;
+	unsigned long long _droppedSteps;
+public:
+	// maxSteps - catch up limit per frame, time beyond it is dropped so a long hitch doesn't turn into
+	// an ever growing backlog of steps (the simulation slows down instead)
+	FixedTimestep(double stepsPerSecond = 120.0, unsigned int maxSteps = 8);
+
+	// Adds the real time that passed since the last call, returns how many steps to run now
+	unsigned int Advance(double elapsedSeconds);
+	// To be called once per step that was run
+	void CompleteStep();
+
+	// Between 0 (previous state) and 1 (latest state), how far real time is past the latest state
+	inline float GetAlpha() const { return (float)(_accumulator / _step); };
+	inline float GetStep() const { return (float)_step; };
+	inline double GetSimulationTime() const { return _simulationTime; };
+	inline unsigned long long GetStepCount() const { return _stepCount; };
+	inline unsigned long long GetDroppedSteps() const { return _droppedSteps; };
+};
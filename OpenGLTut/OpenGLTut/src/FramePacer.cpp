@@ -0,0 +1,92 @@
+#include "FramePacer.h"
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+// The OS may oversleep by up to this much, the rest of the wait is spent spinning
+static const double SPIN_MARGIN = 0.002;
+
+FramePacer::FramePacer(PacingMode mode, double targetFrameRate) : _mode(mode), _targetFrameRate(targetFrameRate), _nextFrameTime(0.0), _adaptiveVsync(false)
+{
+#ifdef _WIN32
+	// The default scheduler tick is 15.6 ms, far too coarse for the limiter's sleep
+	timeBeginPeriod(1);
+#endif
+}
+
+FramePacer::~FramePacer()
+{
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+void FramePacer::SetMode(PacingMode mode)
+{
+	_mode = mode;
+	_nextFrameTime = 0.0;
+}
+
+void FramePacer::SetTargetFrameRate(double framesPerSecond)
+{
+	_targetFrameRate = framesPerSecond > 1.0 ? framesPerSecond : 1.0;
+}
+
+int FramePacer::GetSwapInterval() const
+{
+	switch (_mode)
+	{
+	case PACING_ADAPTIVE_VSYNC:
+		// Late frames are presented immediately (and tear) instead of waiting a whole extra refresh
+		return _adaptiveVsync ? -1 : 1;
+	case PACING_UNCAPPED:
+	case PACING_LIMITED:
+		return 0;
+	default:
+		return 1;
+	}
+}
+
+void FramePacer::WaitForNextFrame()
+{
+	if (_mode != PACING_LIMITED)
+		return;
+
+	double frameTime = 1.0 / _targetFrameRate;
+	double now = glfwGetTime();
+	// Too far behind (first frame, a hitch, a breakpoint), start counting from now instead of rushing to catch up
+	if (_nextFrameTime == 0.0 || now - _nextFrameTime > frameTime)
+		_nextFrameTime = now;
+
+	double sleepTime = _nextFrameTime - now - SPIN_MARGIN;
+	if (sleepTime > 0.0)
+		std::this_thread::sleep_for(std::chrono::duration<double>(sleepTime));
+	while (glfwGetTime() < _nextFrameTime)
+		std::this_thread::yield();
+
+	_nextFrameTime += frameTime;
+}
+
+const char* FramePacer::GetModeName(PacingMode mode)
+{
+	switch (mode)
+	{
+	case PACING_VSYNC: return "Vsync";
+	case PACING_ADAPTIVE_VSYNC: return "Adaptive vsync";
+	case PACING_UNCAPPED: return "Uncapped";
+	case PACING_LIMITED: return "Frame limiter";
+	case PACING_LOW_LATENCY: return "Low latency";
+	default: return "Unknown";
+	}
+}
+
+void FramePacer::QueryAdaptiveVsync()
+{
+	_adaptiveVsync = glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear");
+}
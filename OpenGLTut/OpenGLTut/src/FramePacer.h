@@ -0,0 +1,37 @@
+#pragma once
+
+enum PacingMode { PACING_VSYNC, PACING_ADAPTIVE_VSYNC, PACING_UNCAPPED, PACING_LIMITED, PACING_LOW_LATENCY, PACING_MODE_COUNT };
+
+// Decides when the main thread starts a frame and which swap interval the presenting thread uses.
+// VSYNC is smoothest, UNCAPPED has the lowest latency at the cost of tearing, LIMITED caps the frame
+// rate on the CPU and LOW_LATENCY keeps vsync but only samples input once the GPU finished the last frame.
+class FramePacer
+{
+private:
+	PacingMode _mode;
+	double _targetFrameRate;
+	double _nextFrameTime;
+	bool _adaptiveVsync;
+public:
+	FramePacer(PacingMode mode = PACING_VSYNC, double targetFrameRate = 60.0);
+	~FramePacer();
+
+	void SetMode(PacingMode mode);
+	void SetTargetFrameRate(double framesPerSecond);
+	inline PacingMode GetMode() const { return _mode; };
+	inline double GetTargetFrameRate() const { return _targetFrameRate; };
+
+	// Swap interval for the current mode, adaptive vsync falls back to 1 without the swap_control_tear extension
+	int GetSwapInterval() const;
+	// The main thread should wait for the previous frame on the GPU before it polls input
+	inline bool WaitsForGpu() const { return _mode == PACING_LOW_LATENCY; };
+
+	// Called before polling input, sleeps and then spins until the limiter's next frame is due
+	void WaitForNextFrame();
+
+	// Needs a current context, swap_control_tear is a window system extension
+	void QueryAdaptiveVsync();
+	inline bool IsAdaptiveVsyncSupported() const { return _adaptiveVsync; };
+
+	static const char* GetModeName(PacingMode mode);
+};
@@ -0,0 +1,30 @@
+#include "FramePacket.h"
+
+ImGuiDrawSnapshot::ImGuiDrawSnapshot()
+{
+}
+
+ImGuiDrawSnapshot::~ImGuiDrawSnapshot()
+{
+	Clear();
+}
+
+void ImGuiDrawSnapshot::Capture(const ImDrawData* drawData)
+{
+	Clear();
+	if (!drawData)
+		return;
+
+	// The header is copied as is, only the lists it points to need a deep copy
+	_drawData = *drawData;
+	_drawData.CmdLists.clear();
+	for (int i = 0; i < drawData->CmdLists.Size; i++)
+		_drawData.CmdLists.push_back(drawData->CmdLists[i]->CloneOutput());
+}
+
+void ImGuiDrawSnapshot::Clear()
+{
+	for (int i = 0; i < _drawData.CmdLists.Size; i++)
+		IM_DELETE(_drawData.CmdLists[i]);
+	_drawData.Clear();
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <vector>
+#include <glm/ext/matrix_float4x4.hpp>
+#include "imgui/imgui.h"
+#include "CommandList.h"
+#include "GpuCulling.h"
+
+// Copy of ImGui's draw data, ImGui reuses its draw lists as soon as the next frame starts
+class ImGuiDrawSnapshot
+{
+private:
+	ImDrawData _drawData;
+public:
+	ImGuiDrawSnapshot();
+	~ImGuiDrawSnapshot();
+	ImGuiDrawSnapshot(const ImGuiDrawSnapshot&) = delete;
+	ImGuiDrawSnapshot& operator=(const ImGuiDrawSnapshot&) = delete;
+
+	void Capture(const ImDrawData* drawData);
+	void Clear();
+
+	inline ImDrawData* Get() { return &_drawData; };
+};
+
+// Everything the render thread needs to draw one frame, written by the main thread while the previous packet renders
+struct FramePacket
+{
+	// Counts submitted frames, headless runs name their output images after it
+	unsigned long long frameIndex = 0;
+	// glfwGetTime when input for this frame was polled, the render thread measures latency from it
+	double inputTime = 0.0;
+	// Applied right before this frame is presented, see FramePacer
+	int swapInterval = 1;
+	// Block after the swap until the GPU finished the frame
+	bool waitForGpu = false;
+
+	glm::mat4 view;
+	glm::mat4 projection;
+
+	// Draws recorded on the main thread and by the job threads, submitted with Renderer::Execute
+	CommandList mainList;
+	std::vector<CommandList> commandLists;
+
+	// Input of the GPU driven grid, only used when gpuDriven is set
+	bool gpuDriven = false;
+	bool occlusionCulling = false;
+	std::vector<GpuObjectData> cullingObjects;
+	std::vector<glm::mat4> cullingTransforms;
+
+	// Bloom and tone mapping on the scene, see PostProcessChain
+	bool postProcess = false;
+	float bloomThreshold = 0.8f;
+	float bloomStrength = 0.6f;
+	float exposure = 1.0f;
+	// 0 clamps, 1 Reinhard, 2 ACES, as in ToneMap.shader
+	int toneMapOperator = 0;
+
+	// Size of the 3D scene relative to the window, see DynamicResolution. Below 1 the scene is upscaled
+	// and sharpened into the window before ImGui draws at full resolution.
+	float renderScale = 1.0f;
+	float sharpness = 0.5f;
+
+	ImGuiDrawSnapshot imgui;
+
+	// Written by the render thread, the main thread reads them when BeginFrame hands the packet back
+	unsigned int graphPasses = 0;
+	unsigned int executedGraphPasses = 0;
+	unsigned long long transientMemory = 0;
+	unsigned long long peakMemory = 0;
+};
@@ -0,0 +1,131 @@
+#include "Framebuffer.h"
+#include "Utils.h"
+#include "GLCapture.h"
+#include <iostream>
+
+bool FramebufferDesc::operator==(const FramebufferDesc& other) const
+{
+	return width == other.width && height == other.height && format == other.format && depth == other.depth;
+}
+
+unsigned int FramebufferDesc::GetMemorySize() const
+{
+	unsigned int colorBytes = format == FRAMEBUFFER_RGBA16F ? 8 : 4;
+	return width * height * (colorBytes + (depth ? 4 : 0));
+}
+
+Framebuffer::Framebuffer(unsigned int width, unsigned int height)
+	: Framebuffer(FramebufferDesc(width, height))
+{
+}
+
+Framebuffer::Framebuffer(const FramebufferDesc& desc)
+	: _rendererID(0), _colorTexture(0), _depthRenderbuffer(0), _desc(desc)
+{
+	unsigned int width = desc.width, height = desc.height;
+	unsigned int internalFormat = desc.format == FRAMEBUFFER_RGBA16F ? GL_RGBA16F : GL_RGBA8;
+	unsigned int type = desc.format == FRAMEBUFFER_RGBA16F ? GL_HALF_FLOAT : GL_UNSIGNED_BYTE;
+
+	GLCall(glGenTextures(1, &_colorTexture));
+	GLCall(glBindTexture(GL_TEXTURE_2D, _colorTexture));
+	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, GL_RGBA, type, nullptr));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	GLCapture::Call(CAPTURE_CREATE_TEXTURE, { _colorTexture });
+	GLCapture::Call(CAPTURE_BIND_TEXTURE, { GL_TEXTURE_2D, _colorTexture });
+	GLCapture::CallWithData(CAPTURE_TEX_IMAGE_2D, { GL_TEXTURE_2D, 0, internalFormat, width, height, GL_RGBA, type }, nullptr, 0);
+	GLCapture::Call(CAPTURE_TEX_PARAMETER, { GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR });
+	GLCapture::Call(CAPTURE_TEX_PARAMETER, { GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR });
+	GLCapture::Call(CAPTURE_TEX_PARAMETER, { GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE });
+	GLCapture::Call(CAPTURE_TEX_PARAMETER, { GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE });
+	GLCapture::Call(CAPTURE_BIND_TEXTURE, { GL_TEXTURE_2D, 0 });
+
+	if (desc.depth)
+	{
+		GLCall(glGenRenderbuffers(1, &_depthRenderbuffer));
+		GLCall(glBindRenderbuffer(GL_RENDERBUFFER, _depthRenderbuffer));
+		GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height));
+		GLCall(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+		GLCapture::Call(CAPTURE_CREATE_RENDERBUFFER, { _depthRenderbuffer });
+		GLCapture::Call(CAPTURE_BIND_RENDERBUFFER, { _depthRenderbuffer });
+		GLCapture::Call(CAPTURE_RENDERBUFFER_STORAGE, { GL_DEPTH_COMPONENT24, width, height });
+		GLCapture::Call(CAPTURE_BIND_RENDERBUFFER, { 0 });
+	}
+
+	GLCall(glGenFramebuffers(1, &_rendererID));
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, _rendererID));
+	GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _colorTexture, 0));
+	if (desc.depth)
+	{
+		GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _depthRenderbuffer));
+	}
+	if (!IsComplete())
+		std::cout << "Framebuffer " << width << "x" << height << " is incomplete" << std::endl;
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+	GLCapture::Call(CAPTURE_CREATE_FRAMEBUFFER, { _rendererID });
+	GLCapture::Call(CAPTURE_BIND_FRAMEBUFFER, { GL_FRAMEBUFFER, _rendererID });
+	GLCapture::Call(CAPTURE_FRAMEBUFFER_TEXTURE, { GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _colorTexture, 0 });
+	if (desc.depth)
+		GLCapture::Call(CAPTURE_FRAMEBUFFER_RENDERBUFFER, { GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, _depthRenderbuffer });
+	GLCapture::Call(CAPTURE_BIND_FRAMEBUFFER, { GL_FRAMEBUFFER, 0 });
+}
+
+Framebuffer::~Framebuffer()
+{
+	GLCall(glDeleteFramebuffers(1, &_rendererID));
+	GLCall(glDeleteTextures(1, &_colorTexture));
+	GLCapture::Call(CAPTURE_DELETE_FRAMEBUFFER, { _rendererID });
+	if (_depthRenderbuffer)
+	{
+		GLCall(glDeleteRenderbuffers(1, &_depthRenderbuffer));
+		GLCapture::Call(CAPTURE_DELETE_RENDERBUFFER, { _depthRenderbuffer });
+	}
+	GLCapture::Call(CAPTURE_DELETE_TEXTURE, { _colorTexture });
+}
+
+void Framebuffer::Bind() const
+{
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, _rendererID));
+	GLCall(glViewport(0, 0, _desc.width, _desc.height));
+	GLCapture::Call(CAPTURE_BIND_FRAMEBUFFER, { GL_FRAMEBUFFER, _rendererID });
+	GLCapture::Call(CAPTURE_VIEWPORT, { 0, 0, _desc.width, _desc.height });
+}
+
+void Framebuffer::Unbind() const
+{
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+	GLCapture::Call(CAPTURE_BIND_FRAMEBUFFER, { GL_FRAMEBUFFER, 0 });
+}
+
+void Framebuffer::BindDefault(unsigned int width, unsigned int height)
+{
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+	GLCall(glViewport(0, 0, width, height));
+	GLCapture::Call(CAPTURE_BIND_FRAMEBUFFER, { GL_FRAMEBUFFER, 0 });
+	GLCapture::Call(CAPTURE_VIEWPORT, { 0, 0, width, height });
+}
+
+void Framebuffer::Clear() const
+{
+	Bind();
+	unsigned int mask = GL_COLOR_BUFFER_BIT | (_desc.depth ? GL_DEPTH_BUFFER_BIT : 0);
+	GLCall(glClear(mask));
+	GLCapture::Call(CAPTURE_CLEAR, { mask });
+}
+
+bool Framebuffer::IsComplete() const
+{
+	GLCall(GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+	return status == GL_FRAMEBUFFER_COMPLETE;
+}
+
+void Framebuffer::ReadPixels(std::vector<unsigned char>& pixels) const
+{
+	pixels.resize((size_t)_desc.width * _desc.height * 4);
+	GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, _rendererID));
+	GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+	GLCall(glReadPixels(0, 0, _desc.width, _desc.height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data()));
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <vector>
+
+enum FramebufferFormat {
+	// 8 bits per channel, what the window shows
+	FRAMEBUFFER_RGBA8,
+	// Half floats, keeps values above 1 for effects like bloom until they are tone mapped
+	FRAMEBUFFER_RGBA16F
+};
+
+// Size and attachments of a framebuffer, render target pools match targets by it
+struct FramebufferDesc
+{
+	unsigned int width;
+	unsigned int height;
+	FramebufferFormat format;
+	// Adds a 24 bit depth buffer, post processing passes don't need one
+	bool depth;
+
+	FramebufferDesc(unsigned int width = 0, unsigned int height = 0, FramebufferFormat format = FRAMEBUFFER_RGBA8, bool depth = true)
+		: width(width), height(height), format(format), depth(depth) {};
+	bool operator==(const FramebufferDesc& other) const;
+	// Bytes of video memory the attachments take
+	unsigned int GetMemorySize() const;
+};
+
+// Offscreen render target with a color texture and optionally a 24 bit depth buffer. The color texture
+// is filtered linearly and clamped at the edges so passes can sample it directly.
+class Framebuffer
+{
+private:
+	unsigned int _rendererID;
+	unsigned int _colorTexture;
+	unsigned int _depthRenderbuffer;
+	FramebufferDesc _desc;
+public:
+	// RGBA8 with depth
+	Framebuffer(unsigned int width, unsigned int height);
+	Framebuffer(const FramebufferDesc& desc);
+	~Framebuffer();
+	Framebuffer(const Framebuffer&) = delete;
+	Framebuffer& operator=(const Framebuffer&) = delete;
+
+	// Also sets the viewport to cover the whole target
+	void Bind() const;
+	void Unbind() const;
+	// Binds the window's framebuffer with a viewport of the given size
+	static void BindDefault(unsigned int width, unsigned int height);
+	bool IsComplete() const;
+	// Clears the attachments the target has, binds it first
+	void Clear() const;
+
+	// Color attachment as RGBA, rows from bottom to top like GL returns them
+	void ReadPixels(std::vector<unsigned char>& pixels) const;
+
+	inline unsigned int getRendererID() const { return _rendererID; };
+	inline unsigned int getWidth() const { return _desc.width; };
+	inline unsigned int getHeight() const { return _desc.height; };
+	inline unsigned int getColorTexture() const { return _colorTexture; };
+	inline const FramebufferDesc& getDesc() const { return _desc; };
+};
@@ -0,0 +1,52 @@
+#include "Frustum.h"
+#include <glm/geometric.hpp>
+
+Frustum::Frustum()
+{
+	for (int i = 0; i < 6; i++)
+		_planes[i] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+Frustum::Frustum(const glm::mat4& viewProjection)
+{
+	// Gribb/Hartmann plane extraction, glm matrices are column major so rows are read across columns
+	glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+	glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+	glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+	glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+	_planes[PLANE_LEFT] = row3 + row0;
+	_planes[PLANE_RIGHT] = row3 - row0;
+	_planes[PLANE_BOTTOM] = row3 + row1;
+	_planes[PLANE_TOP] = row3 - row1;
+	_planes[PLANE_NEAR] = row3 + row2;
+	_planes[PLANE_FAR] = row3 - row2;
+
+	for (int i = 0; i < 6; i++)
+		_planes[i] /= glm::length(glm::vec3(_planes[i]));
+}
+
+bool Frustum::IntersectsSphere(const glm::vec3& center, float radius) const
+{
+	for (int i = 0; i < 6; i++)
+	{
+		if (glm::dot(glm::vec3(_planes[i]), center) + _planes[i].w < -radius)
+			return false;
+	}
+	return true;
+}
+
+bool Frustum::IntersectsBox(const glm::vec3& min, const glm::vec3& max) const
+{
+	for (int i = 0; i < 6; i++)
+	{
+		// Only the corner furthest along the plane normal has to be tested
+		glm::vec3 positive(
+			_planes[i].x >= 0.0f ? max.x : min.x,
+			_planes[i].y >= 0.0f ? max.y : min.y,
+			_planes[i].z >= 0.0f ? max.z : min.z);
+		if (glm::dot(glm::vec3(_planes[i]), positive) + _planes[i].w < 0.0f)
+			return false;
+	}
+	return true;
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
+#include <glm/ext/matrix_float4x4.hpp>
+
+enum FrustumPlane { PLANE_LEFT, PLANE_RIGHT, PLANE_BOTTOM, PLANE_TOP, PLANE_NEAR, PLANE_FAR };
+
+// View frustum in world space, the planes point inwards so a point is inside when all distances are positive
+class Frustum {
+private:
+	glm::vec4 _planes[6];
+public:
+	Frustum();
+	Frustum(const glm::mat4& viewProjection);
+
+	bool IntersectsSphere(const glm::vec3& center, float radius) const;
+	bool IntersectsBox(const glm::vec3& min, const glm::vec3& max) const;
+
+	inline const glm::vec4* GetPlanes() const { return _planes; };
+};
@@ -0,0 +1,188 @@
+#include "GLCapture.h"
+#include "Utils.h"
+#include <cstring>
+#include <iostream>
+
+bool GLCapture::s_active = false;
+std::ofstream GLCapture::s_file;
+std::vector<unsigned int> GLCapture::s_words;
+std::vector<unsigned int> GLCapture::s_arguments;
+std::unordered_set<unsigned long long> GLCapture::s_blobs;
+unsigned int GLCapture::s_framesLeft = 0;
+unsigned long long GLCapture::s_frames = 0;
+
+bool GLCapture::Begin(const std::string& filePath, unsigned int frameCount)
+{
+	End();
+	s_file.open(filePath, std::ios::binary);
+	if (!s_file)
+	{
+		std::cout << "Could not write " << filePath << std::endl;
+		return false;
+	}
+
+	s_words.clear();
+	s_blobs.clear();
+	s_words.insert(s_words.end(), { FILE_MAGIC, FILE_VERSION });
+	s_framesLeft = frameCount;
+	s_frames = 0;
+	s_active = true;
+	return true;
+}
+
+void GLCapture::End()
+{
+	if (!s_active)
+		return;
+
+	s_file.write((const char*)s_words.data(), s_words.size() * sizeof(unsigned int));
+	s_file.close();
+	s_words.clear();
+	s_blobs.clear();
+	s_active = false;
+	std::cout << "Captured " << s_frames << " frames" << std::endl;
+}
+
+void GLCapture::EndFrame()
+{
+	if (!s_active)
+		return;
+
+	Record(CAPTURE_FRAME_END, nullptr, 0);
+	s_frames++;
+	// Written per frame so a capture that is cut short still holds every finished frame
+	s_file.write((const char*)s_words.data(), s_words.size() * sizeof(unsigned int));
+	s_words.clear();
+
+	if (s_framesLeft > 0 && --s_framesLeft == 0)
+		End();
+}
+
+void GLCapture::Record(CaptureOp op, const unsigned int* arguments, unsigned int count)
+{
+	ASSERT(count <= MAX_RECORD_WORDS);
+	s_words.push_back((unsigned int)op | (count << 8));
+	s_words.insert(s_words.end(), arguments, arguments + count);
+}
+
+void GLCapture::AddBlob(const void* data, unsigned int size)
+{
+	if ((size + 3ull) / 4 > MAX_RECORD_WORDS - 3)
+	{
+		// 64 MB, more than any upload of the engine. The call is kept without its data rather than
+		// writing a count that wraps and breaks the rest of the stream.
+		std::cout << "Capture: dropped the data of a " << size << " byte upload, blobs are limited to "
+			<< (MAX_RECORD_WORDS - 3) * 4ull << " bytes" << std::endl;
+		data = nullptr;
+	}
+	if (!data || size == 0)
+	{
+		s_arguments.insert(s_arguments.end(), { 0u, 0u, 0u });
+		return;
+	}
+
+	unsigned long long hash = Hash(data, size);
+	unsigned int hashLow = (unsigned int)hash, hashHigh = (unsigned int)(hash >> 32);
+	if (s_blobs.insert(hash).second)
+	{
+		unsigned int words = (size + 3) / 4;
+		s_words.push_back((unsigned int)CAPTURE_BLOB | ((3 + words) << 8));
+		s_words.insert(s_words.end(), { hashLow, hashHigh, size });
+		size_t first = s_words.size();
+		s_words.resize(first + words, 0);
+		memcpy(&s_words[first], data, size);
+	}
+	s_arguments.insert(s_arguments.end(), { hashLow, hashHigh, size });
+}
+
+void GLCapture::CallWithData(CaptureOp op, std::initializer_list<unsigned int> arguments, const void* data, unsigned int size)
+{
+	if (!s_active)
+		return;
+	s_arguments.assign(arguments.begin(), arguments.end());
+	AddBlob(data, size);
+	Record(op, s_arguments.data(), (unsigned int)s_arguments.size());
+}
+
+void GLCapture::Program(unsigned int program, const std::string& vertexSource, const std::string& fragmentSource, const std::string& computeSource)
+{
+	if (!s_active)
+		return;
+	s_arguments.assign(1, program);
+	AddBlob(vertexSource.data(), (unsigned int)vertexSource.size());
+	AddBlob(fragmentSource.data(), (unsigned int)fragmentSource.size());
+	AddBlob(computeSource.data(), (unsigned int)computeSource.size());
+	Record(CAPTURE_CREATE_PROGRAM, s_arguments.data(), (unsigned int)s_arguments.size());
+}
+
+void GLCapture::Uniform(unsigned int program, const std::string& name, UniformType type, const void* values, unsigned int wordCount)
+{
+	if (!s_active)
+		return;
+	// Locations differ between drivers, the replay looks them up by name
+	s_arguments.assign({ program, (unsigned int)type });
+	AddBlob(name.data(), (unsigned int)name.size());
+	const unsigned int* words = (const unsigned int*)values;
+	s_arguments.insert(s_arguments.end(), words, words + wordCount);
+	Record(CAPTURE_UNIFORM, s_arguments.data(), (unsigned int)s_arguments.size());
+}
+
+unsigned int GLCapture::GetUniformWords(UniformType type, int count)
+{
+	switch (type)
+	{
+	case UNIFORM_2F: return 2;
+	case UNIFORM_4F: return 4;
+	case UNIFORM_4FV: return 4 * count;
+	case UNIFORM_MATRIX4FV: return 16;
+	default: return 1;
+	}
+}
+
+void GLCapture::MultiDrawElements(unsigned int mode, const int* counts, unsigned int type, const void* const* offsets, unsigned int drawCount)
+{
+	if (!s_active)
+		return;
+	std::vector<unsigned int> ranges(drawCount * 2);
+	for (unsigned int i = 0; i < drawCount; i++)
+	{
+		ranges[i] = (unsigned int)counts[i];
+		ranges[drawCount + i] = Offset(offsets[i]);
+	}
+	s_arguments.assign({ mode, type, drawCount });
+	AddBlob(ranges.data(), (unsigned int)(ranges.size() * sizeof(unsigned int)));
+	Record(CAPTURE_MULTI_DRAW_ELEMENTS, s_arguments.data(), (unsigned int)s_arguments.size());
+}
+
+static inline unsigned long long RotateLeft(unsigned long long value, int bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+unsigned long long GLCapture::Hash(const void* data, unsigned int size)
+{
+	// MurmurHash3 style mixing over 8 byte words, collisions would silently corrupt a replay so a weak hash won't do
+	const unsigned char* bytes = (const unsigned char*)data;
+	unsigned long long hash = 0x9E3779B97F4A7C15ull ^ size;
+	unsigned int i = 0;
+	for (; i + 8 <= size; i += 8)
+	{
+		unsigned long long word;
+		memcpy(&word, bytes + i, 8);
+		word *= 0x87C37B91114253D5ull;
+		word = RotateLeft(word, 31);
+		word *= 0x4CF5AD432745937Full;
+		hash ^= word;
+		hash = RotateLeft(hash, 27) * 5 + 0x52DCE729;
+	}
+	unsigned long long tail = 0;
+	memcpy(&tail, bytes + i, size - i);
+	hash ^= tail * 0x87C37B91114253D5ull;
+
+	hash ^= hash >> 33;
+	hash *= 0xFF51AFD7ED558CCDull;
+	hash ^= hash >> 33;
+	hash *= 0xC4CEB9FE1A85EC53ull;
+	hash ^= hash >> 33;
+	return hash;
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <fstream>
+#include <initializer_list>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "RenderDevice.h"
+
+// Recorded GL calls, each one replays as the GL function of the same name with the object names remapped
+enum CaptureOp {
+	CAPTURE_BLOB, CAPTURE_FRAME_END,
+	CAPTURE_CREATE_BUFFER, CAPTURE_DELETE_BUFFER, CAPTURE_BIND_BUFFER, CAPTURE_BIND_BUFFER_BASE, CAPTURE_BIND_BUFFER_RANGE,
+	CAPTURE_BUFFER_DATA, CAPTURE_BUFFER_SUB_DATA, CAPTURE_CLEAR_BUFFER_DATA,
+	CAPTURE_CREATE_TEXTURE, CAPTURE_DELETE_TEXTURE, CAPTURE_ACTIVE_TEXTURE, CAPTURE_BIND_TEXTURE, CAPTURE_TEX_IMAGE_2D,
+	CAPTURE_TEX_STORAGE_2D, CAPTURE_TEX_PARAMETER, CAPTURE_GENERATE_MIPMAP, CAPTURE_PIXEL_STORE, CAPTURE_COPY_TEX_SUB_IMAGE_2D,
+	CAPTURE_BIND_IMAGE_TEXTURE,
+	CAPTURE_CREATE_PROGRAM, CAPTURE_DELETE_PROGRAM, CAPTURE_USE_PROGRAM, CAPTURE_UNIFORM, CAPTURE_UNIFORM_BLOCK_BINDING,
+	CAPTURE_CREATE_VERTEX_ARRAY, CAPTURE_DELETE_VERTEX_ARRAY, CAPTURE_BIND_VERTEX_ARRAY, CAPTURE_ENABLE_VERTEX_ATTRIB,
+	CAPTURE_VERTEX_ATTRIB_POINTER, CAPTURE_VERTEX_ATTRIB_DIVISOR,
+	CAPTURE_CREATE_FRAMEBUFFER, CAPTURE_DELETE_FRAMEBUFFER, CAPTURE_BIND_FRAMEBUFFER, CAPTURE_FRAMEBUFFER_TEXTURE,
+	CAPTURE_CREATE_RENDERBUFFER, CAPTURE_DELETE_RENDERBUFFER, CAPTURE_BIND_RENDERBUFFER, CAPTURE_RENDERBUFFER_STORAGE,
+	CAPTURE_FRAMEBUFFER_RENDERBUFFER,
+	CAPTURE_ENABLE, CAPTURE_DISABLE, CAPTURE_VIEWPORT, CAPTURE_CLEAR,
+	CAPTURE_DRAW_ARRAYS, CAPTURE_DRAW_ELEMENTS, CAPTURE_MULTI_DRAW_ELEMENTS, CAPTURE_MULTI_DRAW_INDIRECT,
+	CAPTURE_MULTI_DRAW_INDIRECT_COUNT, CAPTURE_DISPATCH_COMPUTE, CAPTURE_MEMORY_BARRIER,
+	// Direct state access, recorded by the GL 4.5 device
+	CAPTURE_NAMED_BUFFER_DATA, CAPTURE_NAMED_BUFFER_SUB_DATA, CAPTURE_CLEAR_NAMED_BUFFER_DATA,
+	CAPTURE_VERTEX_ARRAY_VERTEX_BUFFER, CAPTURE_VERTEX_ARRAY_BINDING_DIVISOR, CAPTURE_ENABLE_VERTEX_ARRAY_ATTRIB,
+	CAPTURE_VERTEX_ARRAY_ATTRIB_FORMAT, CAPTURE_VERTEX_ARRAY_ATTRIB_BINDING, CAPTURE_VERTEX_ARRAY_ELEMENT_BUFFER,
+	CAPTURE_TEXTURE_STORAGE_2D, CAPTURE_TEXTURE_SUB_IMAGE_2D, CAPTURE_GENERATE_TEXTURE_MIPMAP,
+	CAPTURE_NAMED_BUFFER_STORAGE,
+	// Fixed function state, set by pipelines
+	CAPTURE_DEPTH_MASK, CAPTURE_DEPTH_FUNC, CAPTURE_BLEND_FUNC, CAPTURE_BLEND_EQUATION, CAPTURE_CULL_FACE,
+	CAPTURE_FRONT_FACE, CAPTURE_POLYGON_MODE, CAPTURE_STENCIL_FUNC, CAPTURE_STENCIL_OP, CAPTURE_STENCIL_MASK,
+	// Sampler objects and multi bind, the bind records are first and count followed by the names
+	CAPTURE_CREATE_SAMPLER, CAPTURE_DELETE_SAMPLER, CAPTURE_SAMPLER_PARAMETER, CAPTURE_BIND_SAMPLER,
+	CAPTURE_BIND_TEXTURES, CAPTURE_BIND_SAMPLERS, CAPTURE_BIND_TEXTURE_UNIT,
+	CAPTURE_OP_COUNT
+};
+
+// Writes the GL calls made through the GL render devices (and the few passes that still call GL themselves,
+// Framebuffer and the GPU culling) into a binary file that CaptureReplay plays back.
+// The file is a stream of 32 bit words, every record starts with op | wordCount << 8 followed by its arguments.
+// Payloads (buffer and texture data, shader sources, uniform names) are stored once as CAPTURE_BLOB records
+// and referenced by their 64 bit hash, so data that is uploaded every frame but rarely changes costs nothing.
+// Like RenderStats the hooks are only called by the thread that owns the context.
+class GLCapture
+{
+public:
+	static const unsigned int FILE_MAGIC = 0x50434C47; // "GLCP"
+	static const unsigned int FILE_VERSION = 2;
+	// The word count shares the first record word with the op, which leaves it 24 bits
+	static const unsigned int MAX_RECORD_WORDS = 0xFFFFFF;
+private:
+	static bool s_active;
+	static std::ofstream s_file;
+	static std::vector<unsigned int> s_words;
+	static std::vector<unsigned int> s_arguments;
+	static std::unordered_set<unsigned long long> s_blobs;
+	static unsigned int s_framesLeft;
+	static unsigned long long s_frames;
+
+	static void Record(CaptureOp op, const unsigned int* arguments, unsigned int count);
+	// Writes the blob the first time its hash shows up and appends hash and size to s_arguments, null data gives zeros
+	static void AddBlob(const void* data, unsigned int size);
+public:
+	// Everything from here on is recorded, resources should be created after this so the replay can recreate them.
+	// Capture ends by itself after frameCount frames, 0 keeps it going until End.
+	static bool Begin(const std::string& filePath, unsigned int frameCount = 0);
+	static void End();
+	static inline bool IsActive() { return s_active; };
+
+	// Marks the end of a frame and writes it to the file
+	static void EndFrame();
+
+	static inline void Call(CaptureOp op, std::initializer_list<unsigned int> arguments)
+	{
+		if (s_active)
+			Record(op, arguments.begin(), (unsigned int)arguments.size());
+	};
+	static inline void Call(CaptureOp op, const unsigned int* arguments, unsigned int count)
+	{
+		if (s_active)
+			Record(op, arguments, count);
+	};
+	// The payload is referenced after the plain arguments
+	static void CallWithData(CaptureOp op, std::initializer_list<unsigned int> arguments, const void* data, unsigned int size);
+
+	static void Program(unsigned int program, const std::string& vertexSource, const std::string& fragmentSource, const std::string& computeSource);
+	static void Uniform(unsigned int program, const std::string& name, UniformType type, const void* values, unsigned int wordCount);
+	// Size of the values of a uniform upload, count as in RenderDevice::SetUniform
+	static unsigned int GetUniformWords(UniformType type, int count);
+	static void MultiDrawElements(unsigned int mode, const int* counts, unsigned int type, const void* const* offsets, unsigned int drawCount);
+
+	static inline unsigned int Float(float value)
+	{
+		union { float f; unsigned int u; } bits;
+		bits.f = value;
+		return bits.u;
+	};
+	// Offsets into bound buffers, GL passes them as pointers
+	static inline unsigned int Offset(const void* offset) { return (unsigned int)(size_t)offset; };
+
+	static unsigned long long Hash(const void* data, unsigned int size);
+};
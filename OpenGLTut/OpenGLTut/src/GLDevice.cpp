@@ -0,0 +1,506 @@
+#include "GLDevice.h"
+#include "Utils.h"
+#include "GLCapture.h"
+#include <iostream>
+#include <malloc.h>
+
+unsigned int GLDevice::CreateBuffer(unsigned int target, const void* data, unsigned int size, unsigned int usage)
+{
+	unsigned int buffer;
+	GLCall(glGenBuffers(1, &buffer));
+	GLCall(glBindBuffer(target, buffer));
+	GLCall(glBufferData(target, size, data, usage));
+	GLCapture::Call(CAPTURE_CREATE_BUFFER, { buffer });
+	GLCapture::Call(CAPTURE_BIND_BUFFER, { target, buffer });
+	GLCapture::CallWithData(CAPTURE_BUFFER_DATA, { target, size, usage }, data, size);
+	return buffer;
+}
+
+void GLDevice::DeleteBuffer(unsigned int buffer)
+{
+	GLCall(glDeleteBuffers(1, &buffer));
+	GLCapture::Call(CAPTURE_DELETE_BUFFER, { buffer });
+}
+
+void GLDevice::BindBuffer(unsigned int target, unsigned int buffer)
+{
+	GLCall(glBindBuffer(target, buffer));
+	GLCapture::Call(CAPTURE_BIND_BUFFER, { target, buffer });
+}
+
+void GLDevice::BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer)
+{
+	GLCall(glBindBufferBase(target, index, buffer));
+	GLCapture::Call(CAPTURE_BIND_BUFFER_BASE, { target, index, buffer });
+}
+
+void GLDevice::BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, unsigned int offset, unsigned int size)
+{
+	GLCall(glBindBufferRange(target, index, buffer, offset, size));
+	GLCapture::Call(CAPTURE_BIND_BUFFER_RANGE, { target, index, buffer, offset, size });
+}
+
+void GLDevice::ResizeBuffer(unsigned int target, unsigned int buffer, unsigned int size, unsigned int usage)
+{
+	BindBuffer(target, buffer);
+	GLCall(glBufferData(target, size, nullptr, usage));
+	GLCapture::CallWithData(CAPTURE_BUFFER_DATA, { target, size, usage }, nullptr, 0);
+}
+
+void GLDevice::UpdateBuffer(unsigned int target, unsigned int buffer, unsigned int offset, unsigned int size, const void* data)
+{
+	BindBuffer(target, buffer);
+	GLCall(glBufferSubData(target, offset, size, data));
+	GLCapture::CallWithData(CAPTURE_BUFFER_SUB_DATA, { target, offset, size }, data, size);
+}
+
+void GLDevice::ClearBuffer(unsigned int target, unsigned int buffer)
+{
+	// Fills the whole buffer on the GPU, no client memory is involved
+	BindBuffer(target, buffer);
+	GLCall(glClearBufferData(target, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr));
+	GLCapture::Call(CAPTURE_CLEAR_BUFFER_DATA, { target, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT });
+}
+
+unsigned int GLDevice::CreateVertexArray()
+{
+	unsigned int vertexArray;
+	GLCall(glGenVertexArrays(1, &vertexArray));
+	GLCapture::Call(CAPTURE_CREATE_VERTEX_ARRAY, { vertexArray });
+	return vertexArray;
+}
+
+void GLDevice::DeleteVertexArray(unsigned int vertexArray)
+{
+	_vertexFormats.erase(vertexArray);
+	GLCall(glDeleteVertexArrays(1, &vertexArray));
+	GLCapture::Call(CAPTURE_DELETE_VERTEX_ARRAY, { vertexArray });
+}
+
+void GLDevice::BindVertexArray(unsigned int vertexArray)
+{
+	GLCall(glBindVertexArray(vertexArray));
+	GLCapture::Call(CAPTURE_BIND_VERTEX_ARRAY, { vertexArray });
+}
+
+void GLDevice::AttribPointer(const VertexAttribute& attribute, unsigned int stride, unsigned int offset)
+{
+	const void* pointer = (const void*)(size_t)(attribute.offset + offset);
+	if (attribute.integer)
+	{
+		GLCall(glVertexAttribIPointer(attribute.index, attribute.count, attribute.type, stride, pointer));
+	}
+	else
+	{
+		GLCall(glVertexAttribPointer(attribute.index, attribute.count, attribute.type, attribute.normalized, stride, pointer));
+	}
+	GLCapture::Call(CAPTURE_VERTEX_ATTRIB_POINTER, { attribute.index, attribute.count, attribute.type, attribute.normalized, stride, attribute.offset + offset, attribute.integer });
+}
+
+void GLDevice::SetVertexAttributes(unsigned int vertexArray, unsigned int buffer, const VertexAttribute* attributes, unsigned int count)
+{
+	BindVertexArray(vertexArray);
+	BindBuffer(GL_ARRAY_BUFFER, buffer);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const VertexAttribute& attribute = attributes[i];
+		GLCall(glEnableVertexAttribArray(attribute.index));
+		GLCapture::Call(CAPTURE_ENABLE_VERTEX_ATTRIB, { attribute.index });
+		AttribPointer(attribute, attribute.stride, 0);
+		if (attribute.divisor)
+		{
+			GLCall(glVertexAttribDivisor(attribute.index, attribute.divisor));
+			GLCapture::Call(CAPTURE_VERTEX_ATTRIB_DIVISOR, { attribute.index, attribute.divisor });
+		}
+	}
+}
+
+void GLDevice::SetIndexBuffer(unsigned int vertexArray, unsigned int buffer)
+{
+	// The element array binding is part of the vertex array state
+	BindVertexArray(vertexArray);
+	BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+}
+
+void GLDevice::SetVertexFormat(unsigned int vertexArray, unsigned int binding, const VertexAttribute* attributes, unsigned int count)
+{
+	if (count == 0)
+		return;
+	_vertexFormats[vertexArray][binding].assign(attributes, attributes + count);
+	// Enabling and the divisor stay with the attribute, only the pointers wait for a buffer
+	BindVertexArray(vertexArray);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		GLCall(glEnableVertexAttribArray(attributes[i].index));
+		GLCall(glVertexAttribDivisor(attributes[i].index, attributes[0].divisor));
+		GLCapture::Call(CAPTURE_ENABLE_VERTEX_ATTRIB, { attributes[i].index });
+		GLCapture::Call(CAPTURE_VERTEX_ATTRIB_DIVISOR, { attributes[i].index, attributes[0].divisor });
+	}
+}
+
+void GLDevice::SetVertexBuffer(unsigned int vertexArray, unsigned int binding, unsigned int buffer, unsigned int offset, unsigned int stride)
+{
+	auto formats = _vertexFormats.find(vertexArray);
+	if (formats == _vertexFormats.end() || formats->second.count(binding) == 0)
+	{
+		std::cout << "Vertex buffer set for binding " << binding << " before its format" << std::endl;
+		return;
+	}
+	BindVertexArray(vertexArray);
+	BindBuffer(GL_ARRAY_BUFFER, buffer);
+	for (const VertexAttribute& attribute : formats->second[binding])
+		AttribPointer(attribute, stride, offset);
+}
+
+unsigned int GLDevice::CreateTexture2D(const void* pixels, int width, int height, int channels)
+{
+	GLenum format = channels == 4 ? GL_RGBA : GL_RGB;
+	unsigned int texture;
+	GLCall(glGenTextures(1, &texture));
+	GLCall(glBindTexture(GL_TEXTURE_2D, texture));
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, pixels));
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+	GLCall(glGenerateMipmap(GL_TEXTURE_2D));
+	GLCapture::Call(CAPTURE_CREATE_TEXTURE, { texture });
+	GLCapture::Call(CAPTURE_BIND_TEXTURE, { GL_TEXTURE_2D, texture });
+	GLCapture::Call(CAPTURE_PIXEL_STORE, { GL_UNPACK_ALIGNMENT, 1 });
+	GLCapture::CallWithData(CAPTURE_TEX_IMAGE_2D, { GL_TEXTURE_2D, 0, format, (unsigned int)width, (unsigned int)height, format, GL_UNSIGNED_BYTE },
+		pixels, width * height * channels);
+	GLCapture::Call(CAPTURE_PIXEL_STORE, { GL_UNPACK_ALIGNMENT, 4 });
+	GLCapture::Call(CAPTURE_GENERATE_MIPMAP, { GL_TEXTURE_2D });
+	return texture;
+}
+
+void GLDevice::DeleteTexture(unsigned int texture)
+{
+	GLCall(glDeleteTextures(1, &texture));
+	GLCapture::Call(CAPTURE_DELETE_TEXTURE, { texture });
+}
+
+bool GLDevice::HasMultiBind()
+{
+	return GLEW_VERSION_4_4 || GLEW_ARB_multi_bind;
+}
+
+void GLDevice::CaptureNames(unsigned int op, unsigned int first, const unsigned int* names, unsigned int count)
+{
+	if (!GLCapture::IsActive())
+		return;
+	std::vector<unsigned int> arguments = { first, count };
+	for (unsigned int i = 0; i < count; i++)
+		arguments.push_back(names ? names[i] : 0);
+	GLCapture::Call((CaptureOp)op, arguments.data(), (unsigned int)arguments.size());
+}
+
+void GLDevice::BindTextures(unsigned int first, const unsigned int* textures, unsigned int count)
+{
+	if (HasMultiBind())
+	{
+		GLCall(glBindTextures(first, count, textures));
+		CaptureNames(CAPTURE_BIND_TEXTURES, first, textures, count);
+		return;
+	}
+
+	// Everything else binds to unit 0 and expects it to be the active one afterwards
+	for (unsigned int i = 0; i < count; i++)
+	{
+		unsigned int unit = first + i;
+		if (unit != 0)
+		{
+			GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+			GLCapture::Call(CAPTURE_ACTIVE_TEXTURE, { GL_TEXTURE0 + unit });
+		}
+		unsigned int texture = textures ? textures[i] : 0;
+		GLCall(glBindTexture(GL_TEXTURE_2D, texture));
+		GLCapture::Call(CAPTURE_BIND_TEXTURE, { GL_TEXTURE_2D, texture });
+	}
+	if (first + count > 1)
+	{
+		GLCall(glActiveTexture(GL_TEXTURE0));
+		GLCapture::Call(CAPTURE_ACTIVE_TEXTURE, { GL_TEXTURE0 });
+	}
+}
+
+unsigned int GLDevice::CreateSampler(const SamplerDesc& desc)
+{
+	unsigned int sampler;
+	GLCall(glGenSamplers(1, &sampler));
+	GLCapture::Call(CAPTURE_CREATE_SAMPLER, { sampler });
+	const unsigned int parameters[][2] = { { GL_TEXTURE_MIN_FILTER, desc.minFilter }, { GL_TEXTURE_MAG_FILTER, desc.magFilter },
+		{ GL_TEXTURE_WRAP_S, desc.wrapS }, { GL_TEXTURE_WRAP_T, desc.wrapT } };
+	for (const auto& parameter : parameters)
+	{
+		GLCall(glSamplerParameteri(sampler, parameter[0], parameter[1]));
+		GLCapture::Call(CAPTURE_SAMPLER_PARAMETER, { sampler, parameter[0], parameter[1] });
+	}
+	return sampler;
+}
+
+void GLDevice::DeleteSampler(unsigned int sampler)
+{
+	GLCall(glDeleteSamplers(1, &sampler));
+	GLCapture::Call(CAPTURE_DELETE_SAMPLER, { sampler });
+}
+
+void GLDevice::BindSamplers(unsigned int first, const unsigned int* samplers, unsigned int count)
+{
+	if (HasMultiBind())
+	{
+		GLCall(glBindSamplers(first, count, samplers));
+		CaptureNames(CAPTURE_BIND_SAMPLERS, first, samplers, count);
+		return;
+	}
+	// Samplers are bound by unit, the active one doesn't matter
+	for (unsigned int i = 0; i < count; i++)
+	{
+		unsigned int sampler = samplers ? samplers[i] : 0;
+		GLCall(glBindSampler(first + i, sampler));
+		GLCapture::Call(CAPTURE_BIND_SAMPLER, { first + i, sampler });
+	}
+}
+
+unsigned int GLDevice::CompileShader(unsigned int type, const std::string& source)
+{
+	// Creates a shader object
+	GLCall(unsigned int shaderId = glCreateShader(type));
+
+	const char* src = source.c_str();
+	// Copies the source code provided to the shader, any source code prevously stored in the shader is removed
+	// It doesnt compile the source code, it simply copies it to the shader
+	GLCall(glShaderSource(shaderId, 1, &src, nullptr));
+	// Actually compiles the source code strings that have been copied into the shader
+	// Any compilation states (success, error) will be stored in the shader objects state
+	GLCall(glCompileShader(shaderId));
+
+	int shaderCompileStatus;
+	// Returns a parameter from the shader object (in this case, a compile status),
+	GLCall(glGetShaderiv(shaderId, GL_COMPILE_STATUS, &shaderCompileStatus));
+	if (shaderCompileStatus != GL_TRUE) {
+		int shaderLogLength;
+		GLCall(glGetShaderiv(shaderId, GL_INFO_LOG_LENGTH, &shaderLogLength));
+
+		char* message = (char*)alloca(shaderLogLength * sizeof(char));
+		// Returns the information log for a shader object
+		GLCall(glGetShaderInfoLog(shaderId, shaderLogLength, &shaderLogLength, message));
+		std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : type == GL_FRAGMENT_SHADER ? "fragment" : "compute") << " shader!" << std::endl;
+		std::cout << message << std::endl;
+
+		GLCall(glDeleteShader(shaderId));
+		return 0;
+	}
+
+	return shaderId;
+}
+
+unsigned int GLDevice::LinkProgram(const unsigned int* shaders, unsigned int count)
+{
+	// Reference: https://open.gl/drawing
+
+	// Creates an empty program object
+	GLCall(unsigned int program = glCreateProgram());
+
+	// Attaches actual shader objects to the program
+	for (unsigned int i = 0; i < count; i++)
+	{
+		GLCall(glAttachShader(program, shaders[i]));
+	}
+
+	GLCall(glLinkProgram(program));
+	GLCall(glValidateProgram(program));
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		GLCall(glDeleteShader(shaders[i]));
+	}
+
+	return program;
+}
+
+unsigned int GLDevice::CreateProgram(const std::string& vertexSource, const std::string& fragmentSource, const std::string& computeSource)
+{
+	unsigned int program;
+	// Compute programs have a single stage, it can't be mixed with the graphics stages
+	if (!computeSource.empty())
+	{
+		unsigned int shader = CompileShader(GL_COMPUTE_SHADER, computeSource);
+		program = LinkProgram(&shader, 1);
+	}
+	else
+	{
+		unsigned int shaders[] = { CompileShader(GL_VERTEX_SHADER, vertexSource), CompileShader(GL_FRAGMENT_SHADER, fragmentSource) };
+		program = LinkProgram(shaders, 2);
+	}
+	GLCapture::Program(program, vertexSource, fragmentSource, computeSource);
+	return program;
+}
+
+void GLDevice::DeleteProgram(unsigned int program)
+{
+	GLCall(glDeleteProgram(program));
+	GLCapture::Call(CAPTURE_DELETE_PROGRAM, { program });
+}
+
+void GLDevice::UseProgram(unsigned int program)
+{
+	GLCall(glUseProgram(program));
+	GLCapture::Call(CAPTURE_USE_PROGRAM, { program });
+}
+
+void GLDevice::SetUniform(unsigned int program, const std::string& name, UniformType type, const void* values, int count)
+{
+	GLCall(int location = glGetUniformLocation(program, name.c_str()));
+	const float* floats = (const float*)values;
+	switch (type)
+	{
+	case UNIFORM_1I: GLCall(glUniform1i(location, *(const int*)values)); break;
+	case UNIFORM_1UI: GLCall(glUniform1ui(location, *(const unsigned int*)values)); break;
+	case UNIFORM_2F: GLCall(glUniform2f(location, floats[0], floats[1])); break;
+	case UNIFORM_4F: GLCall(glUniform4f(location, floats[0], floats[1], floats[2], floats[3])); break;
+	case UNIFORM_4FV: GLCall(glUniform4fv(location, count, floats)); break;
+	case UNIFORM_MATRIX4FV: GLCall(glUniformMatrix4fv(location, 1, GL_FALSE, floats)); break;
+	}
+	GLCapture::Uniform(program, name, type, values, GLCapture::GetUniformWords(type, count));
+}
+
+void GLDevice::SetUniformBlockBinding(unsigned int program, const std::string& name, unsigned int binding)
+{
+	GLCall(unsigned int index = glGetUniformBlockIndex(program, name.c_str()));
+	if (index != GL_INVALID_INDEX)
+	{
+		GLCall(glUniformBlockBinding(program, index, binding));
+		GLCapture::CallWithData(CAPTURE_UNIFORM_BLOCK_BINDING, { program, binding }, name.data(), (unsigned int)name.size());
+	}
+}
+
+void GLDevice::DrawElements(unsigned int count, unsigned int first)
+{
+	GLCall(glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, (const void*)(first * sizeof(unsigned int))));
+	GLCapture::Call(CAPTURE_DRAW_ELEMENTS, { GL_TRIANGLES, count, GL_UNSIGNED_INT, first * (unsigned int)sizeof(unsigned int) });
+}
+
+void GLDevice::DrawArrays(unsigned int count, unsigned int first)
+{
+	GLCall(glDrawArrays(GL_TRIANGLES, first, count));
+	GLCapture::Call(CAPTURE_DRAW_ARRAYS, { GL_TRIANGLES, first, count });
+}
+
+void GLDevice::MultiDrawElements(const int* counts, const void* const* offsets, unsigned int drawCount)
+{
+	GLCall(glMultiDrawElements(GL_TRIANGLES, counts, GL_UNSIGNED_INT, offsets, drawCount));
+	GLCapture::MultiDrawElements(GL_TRIANGLES, counts, GL_UNSIGNED_INT, offsets, drawCount);
+}
+
+void GLDevice::MultiDrawElementsIndirect(unsigned int drawCount, unsigned int stride)
+{
+	GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, drawCount, stride));
+	GLCapture::Call(CAPTURE_MULTI_DRAW_INDIRECT, { GL_TRIANGLES, GL_UNSIGNED_INT, 0, drawCount, stride });
+}
+
+void GLDevice::MultiDrawElementsIndirectCount(unsigned int maxDrawCount, unsigned int stride)
+{
+	if (GLEW_VERSION_4_6)
+	{
+		GLCall(glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 0, maxDrawCount, stride));
+	}
+	else
+	{
+		GLCall(glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 0, maxDrawCount, stride));
+	}
+	GLCapture::Call(CAPTURE_MULTI_DRAW_INDIRECT_COUNT, { GL_TRIANGLES, GL_UNSIGNED_INT, 0, 0, maxDrawCount, stride });
+}
+
+void GLDevice::Clear(unsigned int mask)
+{
+	GLCall(glClear(mask));
+	GLCapture::Call(CAPTURE_CLEAR, { mask });
+}
+
+void GLDevice::Enable(unsigned int capability)
+{
+	GLCall(glEnable(capability));
+	GLCapture::Call(CAPTURE_ENABLE, { capability });
+}
+
+void GLDevice::Disable(unsigned int capability)
+{
+	GLCall(glDisable(capability));
+	GLCapture::Call(CAPTURE_DISABLE, { capability });
+}
+
+void GLDevice::Flush()
+{
+	GLCall(glFlush());
+}
+
+void GLDevice::SetRenderState(const RenderState& state, unsigned int groups)
+{
+	if (groups & RENDER_STATE_DEPTH_TEST)
+		state.depthTest ? Enable(GL_DEPTH_TEST) : Disable(GL_DEPTH_TEST);
+	if (groups & RENDER_STATE_DEPTH_WRITE)
+	{
+		GLCall(glDepthMask(state.depthWrite ? GL_TRUE : GL_FALSE));
+		GLCapture::Call(CAPTURE_DEPTH_MASK, { state.depthWrite });
+	}
+	if (groups & RENDER_STATE_DEPTH_FUNC)
+	{
+		GLCall(glDepthFunc(state.depthFunc));
+		GLCapture::Call(CAPTURE_DEPTH_FUNC, { state.depthFunc });
+	}
+	if (groups & RENDER_STATE_BLEND)
+		state.blend ? Enable(GL_BLEND) : Disable(GL_BLEND);
+	if (groups & RENDER_STATE_BLEND_FUNC)
+	{
+		GLCall(glBlendFunc(state.blendSource, state.blendDestination));
+		GLCall(glBlendEquation(state.blendEquation));
+		GLCapture::Call(CAPTURE_BLEND_FUNC, { state.blendSource, state.blendDestination });
+		GLCapture::Call(CAPTURE_BLEND_EQUATION, { state.blendEquation });
+	}
+	if (groups & RENDER_STATE_CULL_FACE)
+		state.cullFace ? Enable(GL_CULL_FACE) : Disable(GL_CULL_FACE);
+	if (groups & RENDER_STATE_CULL_MODE)
+	{
+		GLCall(glCullFace(state.cullMode));
+		GLCapture::Call(CAPTURE_CULL_FACE, { state.cullMode });
+	}
+	if (groups & RENDER_STATE_FRONT_FACE)
+	{
+		GLCall(glFrontFace(state.frontFace));
+		GLCapture::Call(CAPTURE_FRONT_FACE, { state.frontFace });
+	}
+	if (groups & RENDER_STATE_POLYGON_MODE)
+	{
+		GLCall(glPolygonMode(GL_FRONT_AND_BACK, state.polygonMode));
+		GLCapture::Call(CAPTURE_POLYGON_MODE, { state.polygonMode });
+	}
+	if (groups & RENDER_STATE_STENCIL_TEST)
+		state.stencilTest ? Enable(GL_STENCIL_TEST) : Disable(GL_STENCIL_TEST);
+	if (groups & RENDER_STATE_STENCIL_FUNC)
+	{
+		GLCall(glStencilFunc(state.stencilFunc, (int)state.stencilReference, state.stencilReadMask));
+		GLCapture::Call(CAPTURE_STENCIL_FUNC, { state.stencilFunc, state.stencilReference, state.stencilReadMask });
+	}
+	if (groups & RENDER_STATE_STENCIL_OP)
+	{
+		GLCall(glStencilOp(state.stencilFail, state.stencilDepthFail, state.stencilPass));
+		GLCapture::Call(CAPTURE_STENCIL_OP, { state.stencilFail, state.stencilDepthFail, state.stencilPass });
+	}
+	if (groups & RENDER_STATE_STENCIL_WRITE)
+	{
+		GLCall(glStencilMask(state.stencilWriteMask));
+		GLCapture::Call(CAPTURE_STENCIL_MASK, { state.stencilWriteMask });
+	}
+}
+
+void GLDevice::Barrier(unsigned int barriers)
+{
+	GLCall(glMemoryBarrier(barriers));
+	GLCapture::Call(CAPTURE_MEMORY_BARRIER, { barriers });
+}
+
+unsigned int GLDevice::GetUniformBufferOffsetAlignment()
+{
+	int alignment = 256;
+	GLCall(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+	return (unsigned int)alignment;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "RenderDevice.h"
+#include <unordered_map>
+#include <vector>
+
+// GL 3.3 core backend. Objects are edited through the current bindings, so creating or updating
+// something leaves it bound. Every call is recorded by GLCapture while a capture is running.
+class GLDevice : public RenderDevice
+{
+private:
+	// Vertex array -> binding -> its format. GL 3.3 has no buffer bindings for attributes, so SetVertexBuffer
+	// points every attribute of the binding at the new buffer with glVertexAttribPointer.
+	std::unordered_map<unsigned int, std::unordered_map<unsigned int, std::vector<VertexAttribute>>> _vertexFormats;
+
+	// Points the attribute at the bound GL_ARRAY_BUFFER, offset is added to its own
+	static void AttribPointer(const VertexAttribute& attribute, unsigned int stride, unsigned int offset);
+protected:
+	// glBindTextures and glBindSamplers, core in GL 4.4
+	static bool HasMultiBind();
+	// Records first, count and the names, null names as zeros
+	static void CaptureNames(unsigned int op, unsigned int first, const unsigned int* names, unsigned int count);
+	static unsigned int CompileShader(unsigned int type, const std::string& source);
+	static unsigned int LinkProgram(const unsigned int* shaders, unsigned int count);
+public:
+	RenderBackend GetBackend() const override { return BACKEND_GL33; };
+	const char* GetName() const override { return "GL 3.3"; };
+
+	unsigned int CreateBuffer(unsigned int target, const void* data, unsigned int size, unsigned int usage) override;
+	void DeleteBuffer(unsigned int buffer) override;
+	void BindBuffer(unsigned int target, unsigned int buffer) override;
+	void BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer) override;
+	void BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, unsigned int offset, unsigned int size) override;
+	void ResizeBuffer(unsigned int target, unsigned int buffer, unsigned int size, unsigned int usage) override;
+	void UpdateBuffer(unsigned int target, unsigned int buffer, unsigned int offset, unsigned int size, const void* data) override;
+	void ClearBuffer(unsigned int target, unsigned int buffer) override;
+
+	unsigned int CreateVertexArray() override;
+	void DeleteVertexArray(unsigned int vertexArray) override;
+	void BindVertexArray(unsigned int vertexArray) override;
+	void SetVertexAttributes(unsigned int vertexArray, unsigned int buffer, const VertexAttribute* attributes, unsigned int count) override;
+	void SetIndexBuffer(unsigned int vertexArray, unsigned int buffer) override;
+	void SetVertexFormat(unsigned int vertexArray, unsigned int binding, const VertexAttribute* attributes, unsigned int count) override;
+	void SetVertexBuffer(unsigned int vertexArray, unsigned int binding, unsigned int buffer, unsigned int offset, unsigned int stride) override;
+
+	unsigned int CreateTexture2D(const void* pixels, int width, int height, int channels) override;
+	void DeleteTexture(unsigned int texture) override;
+	void BindTextures(unsigned int first, const unsigned int* textures, unsigned int count) override;
+
+	unsigned int CreateSampler(const SamplerDesc& desc) override;
+	void DeleteSampler(unsigned int sampler) override;
+	void BindSamplers(unsigned int first, const unsigned int* samplers, unsigned int count) override;
+
+	unsigned int CreateProgram(const std::string& vertexSource, const std::string& fragmentSource, const std::string& computeSource) override;
+	void DeleteProgram(unsigned int program) override;
+	void UseProgram(unsigned int program) override;
+	void SetUniform(unsigned int program, const std::string& name, UniformType type, const void* values, int count) override;
+	void SetUniformBlockBinding(unsigned int program, const std::string& name, unsigned int binding) override;
+
+	void DrawElements(unsigned int count, unsigned int first) override;
+	void DrawArrays(unsigned int count, unsigned int first) override;
+	void MultiDrawElements(const int* counts, const void* const* offsets, unsigned int drawCount) override;
+	void MultiDrawElementsIndirect(unsigned int drawCount, unsigned int stride) override;
+	void MultiDrawElementsIndirectCount(unsigned int maxDrawCount, unsigned int stride) override;
+
+	void Clear(unsigned int mask) override;
+	void Enable(unsigned int capability) override;
+	void Disable(unsigned int capability) override;
+	void Flush() override;
+	void SetRenderState(const RenderState& state, unsigned int groups) override;
+	void Barrier(unsigned int barriers) override;
+
+	unsigned int GetUniformBufferOffsetAlignment() override;
+};
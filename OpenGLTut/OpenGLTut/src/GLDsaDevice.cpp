@@ -0,0 +1,160 @@
+#include "GLDsaDevice.h"
+#include "Utils.h"
+#include "GLCapture.h"
+
+bool GLDsaDevice::IsSupported()
+{
+	// ARB_direct_state_access only has the entry points of features the context already has
+	return GLEW_VERSION_4_5 || (GLEW_ARB_direct_state_access && GLEW_ARB_buffer_storage && GLEW_ARB_texture_storage
+		&& GLEW_ARB_vertex_attrib_binding && GLEW_ARB_clear_buffer_object && GLEW_ARB_separate_shader_objects);
+}
+
+unsigned int GLDsaDevice::CreateBuffer(unsigned int /*target*/, const void* data, unsigned int size, unsigned int usage)
+{
+	unsigned int buffer;
+	GLCall(glCreateBuffers(1, &buffer));
+	GLCapture::Call(CAPTURE_CREATE_BUFFER, { buffer });
+	if (usage == GL_STATIC_DRAW)
+	{
+		// Never written again, so no storage flags at all and the driver can place it wherever reads are fastest
+		GLCall(glNamedBufferStorage(buffer, size, data, 0));
+		GLCapture::CallWithData(CAPTURE_NAMED_BUFFER_STORAGE, { buffer, size, 0 }, data, size);
+	}
+	else
+	{
+		GLCall(glNamedBufferData(buffer, size, data, usage));
+		GLCapture::CallWithData(CAPTURE_NAMED_BUFFER_DATA, { buffer, size, usage }, data, size);
+	}
+	return buffer;
+}
+
+void GLDsaDevice::ResizeBuffer(unsigned int /*target*/, unsigned int buffer, unsigned int size, unsigned int usage)
+{
+	GLCall(glNamedBufferData(buffer, size, nullptr, usage));
+	GLCapture::CallWithData(CAPTURE_NAMED_BUFFER_DATA, { buffer, size, usage }, nullptr, 0);
+}
+
+void GLDsaDevice::UpdateBuffer(unsigned int /*target*/, unsigned int buffer, unsigned int offset, unsigned int size, const void* data)
+{
+	GLCall(glNamedBufferSubData(buffer, offset, size, data));
+	GLCapture::CallWithData(CAPTURE_NAMED_BUFFER_SUB_DATA, { buffer, offset, size }, data, size);
+}
+
+void GLDsaDevice::ClearBuffer(unsigned int /*target*/, unsigned int buffer)
+{
+	GLCall(glClearNamedBufferData(buffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr));
+	GLCapture::Call(CAPTURE_CLEAR_NAMED_BUFFER_DATA, { buffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT });
+}
+
+unsigned int GLDsaDevice::CreateVertexArray()
+{
+	unsigned int vertexArray;
+	GLCall(glCreateVertexArrays(1, &vertexArray));
+	GLCapture::Call(CAPTURE_CREATE_VERTEX_ARRAY, { vertexArray });
+	return vertexArray;
+}
+
+void GLDsaDevice::SetVertexAttributes(unsigned int vertexArray, unsigned int buffer, const VertexAttribute* attributes, unsigned int count)
+{
+	if (count == 0)
+		return;
+	// One buffer binding per call, named after its first attribute so calls for different buffers never share one
+	unsigned int binding = attributes[0].index;
+	SetVertexFormat(vertexArray, binding, attributes, count);
+	SetVertexBuffer(vertexArray, binding, buffer, 0, attributes[0].stride);
+}
+
+void GLDsaDevice::SetVertexFormat(unsigned int vertexArray, unsigned int binding, const VertexAttribute* attributes, unsigned int count)
+{
+	if (count == 0)
+		return;
+	GLCall(glVertexArrayBindingDivisor(vertexArray, binding, attributes[0].divisor));
+	GLCapture::Call(CAPTURE_VERTEX_ARRAY_BINDING_DIVISOR, { vertexArray, binding, attributes[0].divisor });
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const VertexAttribute& attribute = attributes[i];
+		GLCall(glEnableVertexArrayAttrib(vertexArray, attribute.index));
+		if (attribute.integer)
+		{
+			GLCall(glVertexArrayAttribIFormat(vertexArray, attribute.index, attribute.count, attribute.type, attribute.offset));
+		}
+		else
+		{
+			GLCall(glVertexArrayAttribFormat(vertexArray, attribute.index, attribute.count, attribute.type, attribute.normalized, attribute.offset));
+		}
+		GLCall(glVertexArrayAttribBinding(vertexArray, attribute.index, binding));
+		GLCapture::Call(CAPTURE_ENABLE_VERTEX_ARRAY_ATTRIB, { vertexArray, attribute.index });
+		GLCapture::Call(CAPTURE_VERTEX_ARRAY_ATTRIB_FORMAT, { vertexArray, attribute.index, attribute.count, attribute.type, attribute.normalized, attribute.offset, attribute.integer });
+		GLCapture::Call(CAPTURE_VERTEX_ARRAY_ATTRIB_BINDING, { vertexArray, attribute.index, binding });
+	}
+}
+
+void GLDsaDevice::SetVertexBuffer(unsigned int vertexArray, unsigned int binding, unsigned int buffer, unsigned int offset, unsigned int stride)
+{
+	GLCall(glVertexArrayVertexBuffer(vertexArray, binding, buffer, offset, stride));
+	GLCapture::Call(CAPTURE_VERTEX_ARRAY_VERTEX_BUFFER, { vertexArray, binding, buffer, offset, stride });
+}
+
+void GLDsaDevice::SetIndexBuffer(unsigned int vertexArray, unsigned int buffer)
+{
+	GLCall(glVertexArrayElementBuffer(vertexArray, buffer));
+	GLCapture::Call(CAPTURE_VERTEX_ARRAY_ELEMENT_BUFFER, { vertexArray, buffer });
+}
+
+unsigned int GLDsaDevice::CreateTexture2D(const void* pixels, int width, int height, int channels)
+{
+	GLenum format = channels == 4 ? GL_RGBA : GL_RGB;
+	GLenum internalFormat = channels == 4 ? GL_RGBA8 : GL_RGB8;
+	// Immutable storage for the whole mip chain
+	unsigned int levels = 1;
+	while ((width >> levels) > 0 || (height >> levels) > 0)
+		levels++;
+
+	unsigned int texture;
+	GLCall(glCreateTextures(GL_TEXTURE_2D, 1, &texture));
+	GLCall(glTextureStorage2D(texture, levels, internalFormat, width, height));
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+	GLCall(glTextureSubImage2D(texture, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, pixels));
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+	GLCall(glGenerateTextureMipmap(texture));
+	// The target marks a texture that was created with glCreateTextures
+	GLCapture::Call(CAPTURE_CREATE_TEXTURE, { texture, GL_TEXTURE_2D });
+	GLCapture::Call(CAPTURE_TEXTURE_STORAGE_2D, { texture, levels, internalFormat, (unsigned int)width, (unsigned int)height });
+	GLCapture::Call(CAPTURE_PIXEL_STORE, { GL_UNPACK_ALIGNMENT, 1 });
+	GLCapture::CallWithData(CAPTURE_TEXTURE_SUB_IMAGE_2D, { texture, 0, (unsigned int)width, (unsigned int)height, format, GL_UNSIGNED_BYTE },
+		pixels, width * height * channels);
+	GLCapture::Call(CAPTURE_PIXEL_STORE, { GL_UNPACK_ALIGNMENT, 4 });
+	GLCapture::Call(CAPTURE_GENERATE_TEXTURE_MIPMAP, { texture });
+	return texture;
+}
+
+void GLDsaDevice::BindTextures(unsigned int first, const unsigned int* textures, unsigned int count)
+{
+	if (HasMultiBind())
+	{
+		GLDevice::BindTextures(first, textures, count);
+		return;
+	}
+	for (unsigned int i = 0; i < count; i++)
+	{
+		unsigned int texture = textures ? textures[i] : 0;
+		GLCall(glBindTextureUnit(first + i, texture));
+		GLCapture::Call(CAPTURE_BIND_TEXTURE_UNIT, { first + i, texture });
+	}
+}
+
+void GLDsaDevice::SetUniform(unsigned int program, const std::string& name, UniformType type, const void* values, int count)
+{
+	GLCall(int location = glGetUniformLocation(program, name.c_str()));
+	const float* floats = (const float*)values;
+	switch (type)
+	{
+	case UNIFORM_1I: GLCall(glProgramUniform1i(program, location, *(const int*)values)); break;
+	case UNIFORM_1UI: GLCall(glProgramUniform1ui(program, location, *(const unsigned int*)values)); break;
+	case UNIFORM_2F: GLCall(glProgramUniform2f(program, location, floats[0], floats[1])); break;
+	case UNIFORM_4F: GLCall(glProgramUniform4f(program, location, floats[0], floats[1], floats[2], floats[3])); break;
+	case UNIFORM_4FV: GLCall(glProgramUniform4fv(program, location, count, floats)); break;
+	case UNIFORM_MATRIX4FV: GLCall(glProgramUniformMatrix4fv(program, location, 1, GL_FALSE, floats)); break;
+	}
+	GLCapture::Uniform(program, name, type, values, GLCapture::GetUniformWords(type, count));
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "GLDevice.h"
+
+// GL 4.5 backend that creates and edits objects through direct state access, so nothing has to be
+// bound to change it and the bindings the renderer set up stay untouched. Uniforms are set with
+// glProgramUniform, the program doesn't have to be in use. Static buffers and textures get immutable
+// storage. Textures are bound by unit without touching the active one, other binds and draws are the
+// same as in GL 3.3.
+class GLDsaDevice : public GLDevice
+{
+public:
+	// GL 4.5, or an older context with ARB_direct_state_access and the extensions whose DSA entry points it uses
+	static bool IsSupported();
+
+	RenderBackend GetBackend() const override { return BACKEND_GL45; };
+	const char* GetName() const override { return "GL 4.5 DSA"; };
+
+	unsigned int CreateBuffer(unsigned int target, const void* data, unsigned int size, unsigned int usage) override;
+	void ResizeBuffer(unsigned int target, unsigned int buffer, unsigned int size, unsigned int usage) override;
+	void UpdateBuffer(unsigned int target, unsigned int buffer, unsigned int offset, unsigned int size, const void* data) override;
+	void ClearBuffer(unsigned int target, unsigned int buffer) override;
+
+	unsigned int CreateVertexArray() override;
+	void SetVertexAttributes(unsigned int vertexArray, unsigned int buffer, const VertexAttribute* attributes, unsigned int count) override;
+	void SetIndexBuffer(unsigned int vertexArray, unsigned int buffer) override;
+	void SetVertexFormat(unsigned int vertexArray, unsigned int binding, const VertexAttribute* attributes, unsigned int count) override;
+	void SetVertexBuffer(unsigned int vertexArray, unsigned int binding, unsigned int buffer, unsigned int offset, unsigned int stride) override;
+
+	unsigned int CreateTexture2D(const void* pixels, int width, int height, int channels) override;
+	void BindTextures(unsigned int first, const unsigned int* textures, unsigned int count) override;
+
+	void SetUniform(unsigned int program, const std::string& name, UniformType type, const void* values, int count) override;
+};
@@ -0,0 +1,218 @@
+#include "GpuCulling.h"
+#include "Frustum.h"
+#include "Utils.h"
+#include "GLCapture.h"
+#include "RenderDevice.h"
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/type_ptr.hpp>
+
+static std::vector<unsigned int> IdentityIndices(unsigned int count)
+{
+	std::vector<unsigned int> ids(count);
+	for (unsigned int i = 0; i < count; i++)
+		ids[i] = i;
+	return ids;
+}
+
+HiZBuffer::HiZBuffer(int width, int height)
+	: _depthTexture(0), _pyramidTexture(0), _width(width), _height(height), _mipCount(1),
+	_viewProjection(1.0f), _downsampleShader("res/shaders/HiZ.shader")
+{
+	_mipCount = 1 + (int)std::floor(std::log2((float)std::max(width, height)));
+
+	GLCall(glGenTextures(1, &_depthTexture));
+	GLCall(glBindTexture(GL_TEXTURE_2D, _depthTexture));
+	GLCall(glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT24, width, height));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+
+	GLCall(glGenTextures(1, &_pyramidTexture));
+	GLCall(glBindTexture(GL_TEXTURE_2D, _pyramidTexture));
+	GLCall(glTexStorage2D(GL_TEXTURE_2D, _mipCount, GL_R32F, width, height));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+
+	GLCapture::Call(CAPTURE_CREATE_TEXTURE, { _depthTexture });
+	GLCapture::Call(CAPTURE_BIND_TEXTURE, { GL_TEXTURE_2D, _depthTexture });
+	GLCapture::Call(CAPTURE_TEX_STORAGE_2D, { GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT24, (unsigned int)width, (unsigned int)height });
+	GLCapture::Call(CAPTURE_TEX_PARAMETER, { GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST });
+	GLCapture::Call(CAPTURE_TEX_PARAMETER, { GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST });
+	GLCapture::Call(CAPTURE_CREATE_TEXTURE, { _pyramidTexture });
+	GLCapture::Call(CAPTURE_BIND_TEXTURE, { GL_TEXTURE_2D, _pyramidTexture });
+	GLCapture::Call(CAPTURE_TEX_STORAGE_2D, { GL_TEXTURE_2D, (unsigned int)_mipCount, GL_R32F, (unsigned int)width, (unsigned int)height });
+	GLCapture::Call(CAPTURE_TEX_PARAMETER, { GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST });
+	GLCapture::Call(CAPTURE_TEX_PARAMETER, { GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST });
+	GLCapture::Call(CAPTURE_TEX_PARAMETER, { GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE });
+	GLCapture::Call(CAPTURE_TEX_PARAMETER, { GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE });
+	GLCapture::Call(CAPTURE_BIND_TEXTURE, { GL_TEXTURE_2D, 0 });
+}
+
+HiZBuffer::~HiZBuffer()
+{
+	GLCall(glDeleteTextures(1, &_depthTexture));
+	GLCall(glDeleteTextures(1, &_pyramidTexture));
+	GLCapture::Call(CAPTURE_DELETE_TEXTURE, { _depthTexture });
+	GLCapture::Call(CAPTURE_DELETE_TEXTURE, { _pyramidTexture });
+}
+
+void HiZBuffer::CaptureDepth(const glm::mat4& viewProjection)
+{
+	_viewProjection = viewProjection;
+
+	GLCall(glActiveTexture(GL_TEXTURE0));
+	GLCall(glBindTexture(GL_TEXTURE_2D, _depthTexture));
+	GLCall(glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, _width, _height));
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	GLCapture::Call(CAPTURE_ACTIVE_TEXTURE, { GL_TEXTURE0 });
+	GLCapture::Call(CAPTURE_BIND_TEXTURE, { GL_TEXTURE_2D, _depthTexture });
+	GLCapture::Call(CAPTURE_COPY_TEX_SUB_IMAGE_2D, { GL_TEXTURE_2D, 0, (unsigned int)_width, (unsigned int)_height });
+	GLCapture::Call(CAPTURE_BIND_TEXTURE, { GL_TEXTURE_2D, 0 });
+}
+
+RenderGraphResource HiZBuffer::AddToGraph(RenderGraph& graph)
+{
+	static const char* const LEVEL_NAMES[MAX_MIP_COUNT] = {
+		"Hi-Z level 0", "Hi-Z level 1", "Hi-Z level 2", "Hi-Z level 3", "Hi-Z level 4", "Hi-Z level 5", "Hi-Z level 6", "Hi-Z level 7",
+		"Hi-Z level 8", "Hi-Z level 9", "Hi-Z level 10", "Hi-Z level 11", "Hi-Z level 12", "Hi-Z level 13", "Hi-Z level 14", "Hi-Z level 15"
+	};
+	ASSERT(_mipCount <= MAX_MIP_COUNT);
+
+	RenderGraphResource pyramid = graph.ImportTexture("Hi-Z pyramid", _pyramidTexture, _width, _height);
+	for (int level = 0; level < _mipCount; level++)
+	{
+		unsigned int pass = graph.AddPass(LEVEL_NAMES[level], [this, level](const RenderGraphContext&) { BuildLevel(level); });
+		if (level > 0)
+			graph.Read(pass, pyramid);
+		graph.Write(pass, pyramid, RENDER_GRAPH_IMAGE);
+	}
+	return pyramid;
+}
+
+void HiZBuffer::BuildLevel(int level)
+{
+	// Sizes round down like a GL mip chain, HiZ.shader folds odd rows and columns into the next level
+	int width = std::max(1, _width >> level);
+	int height = std::max(1, _height >> level);
+
+	// Level 0 is a plain copy of the depth texture, every other level reduces the one above it
+	unsigned int source = level == 0 ? _depthTexture : _pyramidTexture;
+	GLCall(glActiveTexture(GL_TEXTURE0));
+	GLCall(glBindTexture(GL_TEXTURE_2D, source));
+	GLCapture::Call(CAPTURE_ACTIVE_TEXTURE, { GL_TEXTURE0 });
+	GLCapture::Call(CAPTURE_BIND_TEXTURE, { GL_TEXTURE_2D, source });
+
+	_downsampleShader.Bind();
+	_downsampleShader.SetUniform1i("u_source", 0);
+	_downsampleShader.SetUniform1i("u_sourceLevel", level - 1);
+	_downsampleShader.SetUniform2f("u_destSize", (float)width, (float)height);
+	GLCall(glBindImageTexture(0, _pyramidTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F));
+	GLCapture::Call(CAPTURE_BIND_IMAGE_TEXTURE, { 0, _pyramidTexture, (unsigned int)level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F });
+
+	GLCall(glDispatchCompute((width + 7) / 8, (height + 7) / 8, 1));
+	GLCapture::Call(CAPTURE_DISPATCH_COMPUTE, { (unsigned int)(width + 7) / 8, (unsigned int)(height + 7) / 8, 1 });
+
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	GLCapture::Call(CAPTURE_BIND_TEXTURE, { GL_TEXTURE_2D, 0 });
+}
+
+void HiZBuffer::Bind(unsigned int slot) const
+{
+	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+	GLCall(glBindTexture(GL_TEXTURE_2D, _pyramidTexture));
+	GLCall(glActiveTexture(GL_TEXTURE0));
+	GLCapture::Call(CAPTURE_ACTIVE_TEXTURE, { GL_TEXTURE0 + slot });
+	GLCapture::Call(CAPTURE_BIND_TEXTURE, { GL_TEXTURE_2D, _pyramidTexture });
+	GLCapture::Call(CAPTURE_ACTIVE_TEXTURE, { GL_TEXTURE0 });
+	// A sampler left on the unit by the material passes would override the nearest, clamped sampling the
+	// occlusion test needs to stay conservative
+	unsigned int noSampler = 0;
+	RenderDevice::Get().BindSamplers(slot, &noSampler, 1);
+}
+
+GpuCulling::GpuCulling(unsigned int maxObjects, const std::vector<GpuMeshDrawArgs>& meshes)
+	: _maxObjects(maxObjects), _objectCount(0),
+	_useDrawCount(GLEW_VERSION_4_6 || GLEW_ARB_indirect_parameters),
+	_meshes(meshes.data(), (unsigned int)(meshes.size() * sizeof(GpuMeshDrawArgs))),
+	_objects(nullptr, maxObjects * sizeof(GpuObjectData)),
+	_transforms(nullptr, maxObjects * sizeof(glm::mat4)),
+	_commands(nullptr, maxObjects * sizeof(DrawElementsIndirectCommand)),
+	_drawCount(nullptr, sizeof(unsigned int)),
+	_objectIDs(IdentityIndices(maxObjects).data(), maxObjects * sizeof(unsigned int)),
+	_cullShader("res/shaders/Cull.shader")
+{
+}
+
+GpuCulling::~GpuCulling()
+{
+}
+
+bool GpuCulling::IsSupported()
+{
+	return GLEW_VERSION_4_3 != 0;
+}
+
+void GpuCulling::SetObjects(const GpuObjectData* objects, const glm::mat4* transforms, unsigned int count)
+{
+	_objectCount = std::min(count, _maxObjects);
+	UpdateObjects(objects, transforms, 0, _objectCount);
+}
+
+void GpuCulling::UpdateObjects(const GpuObjectData* objects, const glm::mat4* transforms, unsigned int first, unsigned int count)
+{
+	ASSERT(first + count <= _maxObjects);
+	_objects.Update(objects, first * sizeof(GpuObjectData), count * sizeof(GpuObjectData));
+	_transforms.Update(transforms, first * sizeof(glm::mat4), count * sizeof(glm::mat4));
+}
+
+void GpuCulling::AttachObjectIDs(VertexArray& va, unsigned int attrib)
+{
+	// Every command uses its object index as baseInstance, so with a divisor of 1
+	// this identity buffer hands the vertex shader the index of the object it draws
+	VertexBufferLayout layout;
+	layout.Push<unsigned int>(1);
+	va.AddInstanceLayout(_objectIDs, layout, attrib);
+	va.Unbind();
+}
+
+void GpuCulling::Cull(const glm::mat4& viewProjection, const HiZBuffer* hiZ)
+{
+	Frustum frustum(viewProjection);
+
+	_drawCount.Clear();
+
+	_cullShader.Bind();
+	_cullShader.SetUniform1ui("u_objectCount", _objectCount);
+	_cullShader.SetUniform1i("u_compact", _useDrawCount ? 1 : 0);
+	_cullShader.SetUniform4fv("u_frustumPlanes", 6, glm::value_ptr(frustum.GetPlanes()[0]));
+	_cullShader.SetUniform1i("u_occlusionEnabled", hiZ ? 1 : 0);
+	if (hiZ)
+	{
+		glm::mat4 previousViewProjection = hiZ->GetViewProjection();
+		hiZ->Bind(0);
+		_cullShader.SetUniform1i("u_hiZ", 0);
+		_cullShader.SetUniform2f("u_hiZSize", (float)hiZ->GetWidth(), (float)hiZ->GetHeight());
+		_cullShader.SetUniform1i("u_hiZMipCount", hiZ->GetMipCount());
+		_cullShader.SetUniformMatrix4fv("u_previousViewProjection", false, glm::value_ptr(previousViewProjection));
+	}
+
+	_objects.BindBase(GL_SHADER_STORAGE_BUFFER, 0);
+	_meshes.BindBase(GL_SHADER_STORAGE_BUFFER, 1);
+	_commands.BindBase(GL_SHADER_STORAGE_BUFFER, 2);
+	_drawCount.BindBase(GL_ATOMIC_COUNTER_BUFFER, 0);
+
+	GLCall(glDispatchCompute((_objectCount + 63) / 64, 1, 1));
+	GLCall(glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_ATOMIC_COUNTER_BARRIER_BIT));
+	GLCapture::Call(CAPTURE_DISPATCH_COMPUTE, { (_objectCount + 63) / 64, 1, 1 });
+	GLCapture::Call(CAPTURE_MEMORY_BARRIER, { GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_ATOMIC_COUNTER_BARRIER_BIT });
+}
+
+void GpuCulling::Draw(const Renderer& renderer, VertexArray& va, Shader& shader) const
+{
+	_transforms.BindBase(GL_SHADER_STORAGE_BUFFER, 3);
+	renderer.DrawIndirect(va, shader, _commands, _useDrawCount ? &_drawCount : nullptr, _objectCount);
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <vector>
+#include <glm/ext/vector_float4.hpp>
+#include <glm/ext/matrix_float4x4.hpp>
+
+#include "Renderer.h"
+#include "RenderGraph.h"
+#include "Shader.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "ShaderStorageBuffer.h"
+
+// Layout of a single record in a GL_DRAW_INDIRECT_BUFFER, see glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+	unsigned int count;
+	unsigned int instanceCount;
+	unsigned int firstIndex;
+	int baseVertex;
+	unsigned int baseInstance;
+};
+
+// Where a mesh lives inside the shared vertex/index buffers
+struct GpuMeshDrawArgs
+{
+	unsigned int indexCount;
+	unsigned int firstIndex;
+	int baseVertex;
+	unsigned int padding;
+};
+
+// Per object data read by the culling shader, matches the std430 layout in Cull.shader
+struct GpuObjectData
+{
+	// xyz - world space center, w - radius
+	glm::vec4 boundingSphere;
+	unsigned int meshIndex;
+	unsigned int padding[3];
+};
+
+// Hierarchical depth buffer built from the depth of the previous frame, each mip stores the farthest depth of the texels below it
+class HiZBuffer
+{
+public:
+	// Levels AddToGraph can build, enough for a 32768 texel wide buffer
+	static const int MAX_MIP_COUNT = 16;
+private:
+	unsigned int _depthTexture;
+	unsigned int _pyramidTexture;
+	int _width;
+	int _height;
+	int _mipCount;
+	glm::mat4 _viewProjection;
+	Shader _downsampleShader;
+
+	void BuildLevel(int level);
+public:
+	HiZBuffer(int width, int height);
+	~HiZBuffer();
+
+	// Copies the depth of the currently bound framebuffer, AddToGraph builds the pyramid from it
+	void CaptureDepth(const glm::mat4& viewProjection);
+	// Adds a pass per level that writes it with image stores, every level reads the one above it and the
+	// graph puts the barriers between them. Returns the pyramid for the passes that cull against it to read.
+	RenderGraphResource AddToGraph(RenderGraph& graph);
+	void Bind(unsigned int slot) const;
+
+	inline int GetWidth() const { return _width; };
+	inline int GetHeight() const { return _height; };
+	inline int GetMipCount() const { return _mipCount; };
+	inline const glm::mat4& GetViewProjection() const { return _viewProjection; };
+};
+
+// Culls objects on the GPU and writes the draw commands of the visible ones, the whole set is
+// then submitted with a single multi draw call so the CPU cost doesn't depend on the object count
+class GpuCulling
+{
+private:
+	unsigned int _maxObjects;
+	unsigned int _objectCount;
+	bool _useDrawCount;
+
+	ShaderStorageBuffer _meshes;
+	ShaderStorageBuffer _objects;
+	ShaderStorageBuffer _transforms;
+	ShaderStorageBuffer _commands;
+	ShaderStorageBuffer _drawCount;
+	VertexBuffer _objectIDs;
+	Shader _cullShader;
+public:
+	GpuCulling(unsigned int maxObjects, const std::vector<GpuMeshDrawArgs>& meshes);
+	~GpuCulling();
+
+	// Compute shaders and SSBOs need GL 4.3
+	static bool IsSupported();
+
+	void SetObjects(const GpuObjectData* objects, const glm::mat4* transforms, unsigned int count);
+	void UpdateObjects(const GpuObjectData* objects, const glm::mat4* transforms, unsigned int first, unsigned int count);
+
+	// Adds the per instance object index attribute the indirect draws use to find their transform
+	void AttachObjectIDs(VertexArray& va, unsigned int attrib);
+
+	// Occlusion culling is skipped when no hi-z buffer is given
+	void Cull(const glm::mat4& viewProjection, const HiZBuffer* hiZ);
+	void Draw(const Renderer& renderer, VertexArray& va, Shader& shader) const;
+
+	inline unsigned int GetObjectCount() const { return _objectCount; };
+};
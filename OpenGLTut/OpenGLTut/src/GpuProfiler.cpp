@@ -0,0 +1,195 @@
+#include "GpuProfiler.h"
+#include "Utils.h"
+#include "imgui/imgui.h"
+#include <fstream>
+#include <iostream>
+
+GpuProfiler::GpuProfiler() : _frameIndex(0), _droppedFrames(0), _latestFrame(0)
+{
+}
+
+GpuProfiler::~GpuProfiler()
+{
+	for (FrameQueries& frame : _frames)
+	{
+		if (!frame.queries.empty())
+			glDeleteQueries((GLsizei)frame.queries.size(), frame.queries.data());
+	}
+}
+
+unsigned int GpuProfiler::NextQuery(FrameQueries& frame)
+{
+	if (frame.usedQueries == frame.queries.size())
+	{
+		// Grows in chunks, the pool settles after the first few frames
+		size_t first = frame.queries.size();
+		frame.queries.resize(first + 32);
+		GLCall(glGenQueries(32, &frame.queries[first]));
+	}
+	return frame.queries[frame.usedQueries++];
+}
+
+bool GpuProfiler::ReadBack(FrameQueries& frame)
+{
+	// Queries finish in submission order, once the last one is there all of them are
+	GLint available = 0;
+	GLCall(glGetQueryObjectiv(frame.scopes[0].endQuery, GL_QUERY_RESULT_AVAILABLE, &available));
+	if (!available)
+		return false;
+
+	std::vector<GpuTimerResult> results;
+	results.reserve(frame.scopes.size());
+	for (const Scope& scope : frame.scopes)
+	{
+		GLuint64 begin = 0, end = 0;
+		GLCall(glGetQueryObjectui64v(scope.beginQuery, GL_QUERY_RESULT, &begin));
+		GLCall(glGetQueryObjectui64v(scope.endQuery, GL_QUERY_RESULT, &end));
+		results.push_back({ scope.name, scope.depth, (float)((double)(end - begin) / 1000000.0) });
+	}
+	frame.pending = false;
+
+	std::lock_guard<std::mutex> lock(_resultsMutex);
+	_latest = results;
+	_latestFrame = frame.frameIndex;
+	_history.emplace_back(frame.frameIndex, std::move(results));
+	if (_history.size() > HISTORY_SIZE)
+		_history.pop_front();
+	return true;
+}
+
+void GpuProfiler::BeginFrame()
+{
+	// Oldest first so the newest published results really are the newest. The slot this frame reuses
+	// holds the oldest one, FRAME_COUNT frames back.
+	for (unsigned int i = 0; i < FRAME_COUNT; i++)
+	{
+		FrameQueries& frame = _frames[(_frameIndex % FRAME_COUNT + i) % FRAME_COUNT];
+		if (frame.pending)
+			ReadBack(frame);
+	}
+
+	FrameQueries& frame = _frames[_frameIndex % FRAME_COUNT];
+	if (frame.pending)
+	{
+		// The GPU is more than FRAME_COUNT frames behind, these results are given up rather than waited for
+		std::lock_guard<std::mutex> lock(_resultsMutex);
+		_droppedFrames++;
+	}
+	frame.usedQueries = 0;
+	frame.scopes.clear();
+	frame.frameIndex = _frameIndex;
+	frame.pending = false;
+	_openScopes.clear();
+
+	Push("Frame");
+}
+
+void GpuProfiler::EndFrame()
+{
+	while (!_openScopes.empty())
+		Pop();
+
+	FrameQueries& frame = _frames[_frameIndex % FRAME_COUNT];
+	frame.pending = !frame.scopes.empty();
+	_frameIndex++;
+}
+
+void GpuProfiler::Push(const char* name)
+{
+	FrameQueries& frame = _frames[_frameIndex % FRAME_COUNT];
+	// Timestamps instead of GL_TIME_ELAPSED, elapsed queries of the same target can't be nested
+	unsigned int query = NextQuery(frame);
+	GLCall(glQueryCounter(query, GL_TIMESTAMP));
+	_openScopes.push_back((unsigned int)frame.scopes.size());
+	frame.scopes.push_back({ name, (unsigned int)_openScopes.size() - 1, query, 0 });
+}
+
+void GpuProfiler::Pop()
+{
+	if (_openScopes.empty())
+	{
+		std::cout << "GpuProfiler::Pop without a matching Push" << std::endl;
+		return;
+	}
+	FrameQueries& frame = _frames[_frameIndex % FRAME_COUNT];
+	unsigned int query = NextQuery(frame);
+	GLCall(glQueryCounter(query, GL_TIMESTAMP));
+	frame.scopes[_openScopes.back()].endQuery = query;
+	_openScopes.pop_back();
+}
+
+std::vector<GpuTimerResult> GpuProfiler::GetResults(unsigned long long* frameIndex)
+{
+	std::lock_guard<std::mutex> lock(_resultsMutex);
+	if (frameIndex)
+		*frameIndex = _latestFrame;
+	return _latest;
+}
+
+unsigned long long GpuProfiler::GetDroppedFrames()
+{
+	std::lock_guard<std::mutex> lock(_resultsMutex);
+	return _droppedFrames;
+}
+
+void GpuProfiler::DrawImGuiPanel()
+{
+	std::vector<GpuTimerResult> results;
+	unsigned long long latestFrame, droppedFrames;
+	{
+		std::lock_guard<std::mutex> lock(_resultsMutex);
+		results = _latest;
+		latestFrame = _latestFrame;
+		droppedFrames = _droppedFrames;
+	}
+
+	ImGui::Begin("GPU timings");
+	ImGui::Text("Frame %llu, %llu frames dropped", latestFrame, droppedFrames);
+
+	// Scopes are stored depth first, a closed tree node skips everything deeper than itself
+	unsigned int openDepth = 0;
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const GpuTimerResult& result = results[i];
+		while (openDepth > result.depth)
+		{
+			ImGui::TreePop();
+			openDepth--;
+		}
+		if (result.depth > openDepth)
+			continue;
+
+		bool hasChildren = i + 1 < results.size() && results[i + 1].depth > result.depth;
+		ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_DefaultOpen | (hasChildren ? 0 : ImGuiTreeNodeFlags_Leaf);
+		if (ImGui::TreeNodeEx((void*)i, flags, "%s: %.3f ms", result.name, result.milliseconds))
+			openDepth++;
+	}
+	while (openDepth > 0)
+	{
+		ImGui::TreePop();
+		openDepth--;
+	}
+
+	if (ImGui::Button("Export gpu_timings.csv"))
+		Export("gpu_timings.csv");
+	ImGui::End();
+}
+
+bool GpuProfiler::Export(const std::string& filePath)
+{
+	std::ofstream file(filePath);
+	if (!file)
+	{
+		std::cout << "Could not write " << filePath << std::endl;
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(_resultsMutex);
+	file << "frame,scope,depth,ms" << std::endl;
+	for (const auto& frame : _history)
+	{
+		for (const GpuTimerResult& result : frame.second)
+			file << frame.first << "," << result.name << "," << result.depth << "," << result.milliseconds << std::endl;
+	}
+	return true;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct GpuTimerResult
+{
+	const char* name;
+	// Nesting level, 0 is the whole frame
+	unsigned int depth;
+	float milliseconds;
+};
+
+// Times passes on the GPU with GL_TIMESTAMP queries. Queries of the last FRAME_COUNT frames are kept in
+// flight and only read once the GPU says they are available, so profiling never stalls the pipeline.
+// Scopes are recorded on the thread that owns the context, results can be read from any thread.
+class GpuProfiler
+{
+public:
+	static const unsigned int FRAME_COUNT = 4;
+	// Frames kept for Export
+	static const unsigned int HISTORY_SIZE = 300;
+private:
+	struct Scope
+	{
+		const char* name;
+		unsigned int depth;
+		unsigned int beginQuery;
+		unsigned int endQuery;
+	};
+	struct FrameQueries
+	{
+		std::vector<unsigned int> queries;
+		unsigned int usedQueries = 0;
+		std::vector<Scope> scopes;
+		unsigned long long frameIndex = 0;
+		bool pending = false;
+	};
+
+	FrameQueries _frames[FRAME_COUNT];
+	unsigned long long _frameIndex;
+	std::vector<unsigned int> _openScopes;
+	unsigned long long _droppedFrames;
+
+	std::mutex _resultsMutex;
+	std::vector<GpuTimerResult> _latest;
+	unsigned long long _latestFrame;
+	std::deque<std::pair<unsigned long long, std::vector<GpuTimerResult>>> _history;
+
+	unsigned int NextQuery(FrameQueries& frame);
+	bool ReadBack(FrameQueries& frame);
+public:
+	GpuProfiler();
+	~GpuProfiler();
+
+	// Both wrap the whole frame in a scope called "Frame"
+	void BeginFrame();
+	void EndFrame();
+
+	// Scopes nest, every Push needs a Pop on the same frame. Names are kept as pointers, use string literals.
+	void Push(const char* name);
+	void Pop();
+
+	// Timings of the newest frame the GPU has finished, usually FRAME_COUNT - 1 frames old.
+	// frameIndex receives the index of that frame, counted by BeginFrame from 0.
+	std::vector<GpuTimerResult> GetResults(unsigned long long* frameIndex = nullptr);
+	unsigned long long GetDroppedFrames();
+
+	// Tree of the newest results with a button that writes the history to gpu_timings.csv
+	void DrawImGuiPanel();
+	// One line per frame and scope: frame, scope, depth, milliseconds
+	bool Export(const std::string& filePath);
+};
+
+// Times everything until the end of the C++ scope
+class GpuScope
+{
+private:
+	GpuProfiler* _profiler;
+public:
+	GpuScope(GpuProfiler* profiler, const char* name) : _profiler(profiler) { if (_profiler) _profiler->Push(name); };
+	~GpuScope() { if (_profiler) _profiler->Pop(); };
+	GpuScope(const GpuScope&) = delete;
+	GpuScope& operator=(const GpuScope&) = delete;
+};
@@ -0,0 +1,169 @@
+#include <GL/glew.h>
+#include "HeadlessContext.h"
+#include <iostream>
+
+#if defined(HEADLESS_EGL)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#elif defined(HEADLESS_OSMESA)
+#include <GL/osmesa.h>
+#else
+#include <GLFW/glfw3.h>
+#endif
+
+#if defined(HEADLESS_EGL)
+
+HeadlessContext::HeadlessContext(unsigned int width, unsigned int height)
+	: _display(nullptr), _context(nullptr), _window(nullptr), _valid(false)
+{
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (!getPlatformDisplay)
+	{
+		std::cout << "EGL_EXT_platform_base is not available" << std::endl;
+		return;
+	}
+
+	EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	EGLint major, minor;
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+	{
+		std::cout << "Could not initialize a surfaceless EGL display" << std::endl;
+		return;
+	}
+	_display = display;
+
+	const EGLint configAttributes[] = {
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_NONE
+	};
+	EGLConfig config;
+	EGLint configCount = 0;
+	if (!eglBindAPI(EGL_OPENGL_API) || !eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)
+	{
+		std::cout << "No EGL config supports desktop OpenGL" << std::endl;
+		return;
+	}
+
+	const EGLint contextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 3,
+		EGL_CONTEXT_MINOR_VERSION, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+	EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+	// EGL_KHR_surfaceless_context lets the context be current without any surface
+	if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+	{
+		std::cout << "Could not create a surfaceless GL 3.3 core context" << std::endl;
+		return;
+	}
+	_context = context;
+	_valid = true;
+}
+
+HeadlessContext::~HeadlessContext()
+{
+	if (_context)
+	{
+		eglMakeCurrent((EGLDisplay)_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		eglDestroyContext((EGLDisplay)_display, (EGLContext)_context);
+	}
+	if (_display)
+		eglTerminate((EGLDisplay)_display);
+}
+
+const char* HeadlessContext::GetBackendName()
+{
+	return "EGL surfaceless";
+}
+
+#elif defined(HEADLESS_OSMESA)
+
+HeadlessContext::HeadlessContext(unsigned int width, unsigned int height)
+	: _display(nullptr), _context(nullptr), _window(nullptr), _valid(false)
+{
+	const int attributes[] = {
+		OSMESA_FORMAT, OSMESA_RGBA,
+		OSMESA_DEPTH_BITS, 24,
+		OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+		OSMESA_CONTEXT_MAJOR_VERSION, 3,
+		OSMESA_CONTEXT_MINOR_VERSION, 3,
+		0
+	};
+	OSMesaContext context = OSMesaCreateContextAttribs(attributes, nullptr);
+	if (!context)
+	{
+		std::cout << "Could not create an OSMesa GL 3.3 core context" << std::endl;
+		return;
+	}
+	_context = context;
+
+	_buffer.resize((size_t)width * height * 4);
+	if (!OSMesaMakeCurrent(context, _buffer.data(), GL_UNSIGNED_BYTE, width, height))
+	{
+		std::cout << "Could not make the OSMesa context current" << std::endl;
+		return;
+	}
+	_valid = true;
+}
+
+HeadlessContext::~HeadlessContext()
+{
+	if (_context)
+		OSMesaDestroyContext((OSMesaContext)_context);
+}
+
+const char* HeadlessContext::GetBackendName()
+{
+	return "OSMesa";
+}
+
+#else
+
+HeadlessContext::HeadlessContext(unsigned int width, unsigned int height)
+	: _display(nullptr), _context(nullptr), _window(nullptr), _valid(false)
+{
+	if (!glfwInit())
+		return;
+
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+	_window = glfwCreateWindow(width, height, "Headless", NULL, NULL);
+	if (!_window)
+	{
+		std::cout << "Could not create a hidden window" << std::endl;
+		return;
+	}
+	glfwMakeContextCurrent(_window);
+	_valid = true;
+}
+
+HeadlessContext::~HeadlessContext()
+{
+	if (_window)
+		glfwDestroyWindow(_window);
+	glfwTerminate();
+}
+
+const char* HeadlessContext::GetBackendName()
+{
+	return "hidden GLFW window";
+}
+
+#endif
+
+bool HeadlessContext::InitGlew()
+{
+	// Under EGL there is no GLX display, GLEW still loads every GL function and only reports the missing GLX part
+	GLenum status = glewInit();
+	if (status != GLEW_OK && status != GLEW_ERROR_NO_GLX_DISPLAY)
+	{
+		std::cout << "GLEW INIT ERROR!" << std::endl;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <vector>
+
+struct GLFWwindow;
+
+// GL 3.3 core context that doesn't need a display. Which backend is used is decided at build time:
+// HEADLESS_EGL - surfaceless EGL (EGL_MESA_platform_surfaceless), works under Mesa llvmpipe without X
+// HEADLESS_OSMESA - OSMesa software rendering into a client side buffer
+// neither - a hidden GLFW window, the fallback for Windows where a desktop session is always around
+// There is no default framebuffer to draw to, render into a Framebuffer.
+class HeadlessContext
+{
+private:
+	void* _display;
+	void* _context;
+	GLFWwindow* _window;
+	// OSMesa needs some color buffer to make the context current
+	std::vector<unsigned char> _buffer;
+	bool _valid;
+public:
+	HeadlessContext(unsigned int width, unsigned int height);
+	~HeadlessContext();
+	HeadlessContext(const HeadlessContext&) = delete;
+	HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+	inline bool IsValid() const { return _valid; };
+	static const char* GetBackendName();
+	// glewInit for the current context, headless or not. Prints the error and returns false when it fails.
+	static bool InitGlew();
+};
@@ -0,0 +1,41 @@
+#include "ImageWriter.h"
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+bool ImageWriter::WriteTga(const std::string& filePath, unsigned int width, unsigned int height, const unsigned char* pixels)
+{
+	std::ofstream file(filePath, std::ios::binary);
+	if (!file)
+	{
+		std::cout << "Could not write " << filePath << std::endl;
+		return false;
+	}
+
+	// TGA's default origin is the bottom left corner, so GL's row order can be written as is
+	unsigned char header[18] = {};
+	header[2] = 2;
+	header[12] = width & 0xff;
+	header[13] = (width >> 8) & 0xff;
+	header[14] = height & 0xff;
+	header[15] = (height >> 8) & 0xff;
+	header[16] = 32;
+	header[17] = 8;
+	file.write((const char*)header, sizeof(header));
+
+	// TGA stores BGRA
+	std::vector<unsigned char> row(width * 4);
+	for (unsigned int y = 0; y < height; y++)
+	{
+		const unsigned char* source = pixels + (size_t)y * width * 4;
+		for (unsigned int x = 0; x < width; x++)
+		{
+			row[x * 4] = source[x * 4 + 2];
+			row[x * 4 + 1] = source[x * 4 + 1];
+			row[x * 4 + 2] = source[x * 4];
+			row[x * 4 + 3] = source[x * 4 + 3];
+		}
+		file.write((const char*)row.data(), row.size());
+	}
+	return (bool)file;
+}
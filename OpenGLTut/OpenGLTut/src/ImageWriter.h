@@ -0,0 +1,9 @@
+#pragma once
+#include <string>
+
+class ImageWriter
+{
+public:
+	// Uncompressed 32 bit TGA, pixels are RGBA with the bottom row first (as glReadPixels returns them)
+	static bool WriteTga(const std::string& filePath, unsigned int width, unsigned int height, const unsigned char* pixels);
+};
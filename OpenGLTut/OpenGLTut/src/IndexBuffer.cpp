@@ -1,27 +1,29 @@
 #include "Utils.h"
 #include "IndexBuffer.h"
+#include "RenderStats.h"
+#include "RenderDevice.h"
 #include <GL/glew.h>
 
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count): _count(count)
 {
-	GLCall(glGenBuffers(1, &_rendererID));
-	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _rendererID));
-	GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+	_rendererID = RenderDevice::Get().CreateBuffer(GL_ELEMENT_ARRAY_BUFFER, data, count * sizeof(unsigned int), GL_STATIC_DRAW);
+	RenderStats::CountBufferUpload(count * sizeof(unsigned int));
 }
 
 IndexBuffer::~IndexBuffer()
 {
-	GLCall(glDeleteBuffers(1, &_rendererID));
+	RenderDevice::Get().DeleteBuffer(_rendererID);
 }
 
 void IndexBuffer::Bind() const
 {
-	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _rendererID));
+	RenderStats::CountStateChange(STATE_BUFFER);
+	RenderDevice::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, _rendererID);
 }
  
 void IndexBuffer::Unbind() const
 {
-	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+	RenderDevice::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
 unsigned int IndexBuffer::getCount() const
@@ -12,4 +12,5 @@ class IndexBuffer
 		void Bind() const;
 		void Unbind() const;
 		unsigned int getCount() const;
+		inline unsigned int getRendererID() const { return _rendererID; };
 };
@@ -0,0 +1,191 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+
+// Which job system and queue the current thread belongs to, threads the pool didn't create use queue 0
+static thread_local const JobSystem* t_owner = nullptr;
+static thread_local unsigned int t_queueIndex = 0;
+
+JobSystem::JobSystem(unsigned int threadCount) : _running(true), _pendingJobs(0)
+{
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+	for (unsigned int i = 0; i < threadCount; i++)
+		_queues.emplace_back(new WorkQueue());
+
+	t_owner = this;
+	t_queueIndex = 0;
+	for (unsigned int i = 1; i < threadCount; i++)
+		_workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_running = false;
+	}
+	_wakeUp.notify_all();
+	for (std::thread& worker : _workers)
+		worker.join();
+	if (t_owner == this)
+		t_owner = nullptr;
+}
+
+unsigned int JobSystem::CurrentQueue() const
+{
+	return t_owner == this ? t_queueIndex : 0;
+}
+
+bool JobSystem::PopJob(unsigned int queue, Job& job)
+{
+	WorkQueue& workQueue = *_queues[queue];
+	std::lock_guard<std::mutex> lock(workQueue.mutex);
+	if (workQueue.jobs.empty())
+		return false;
+	// Newest first, its data is most likely still in this core's cache
+	job = std::move(workQueue.jobs.back());
+	workQueue.jobs.pop_back();
+	return true;
+}
+
+bool JobSystem::StealJob(unsigned int thief, Job& job)
+{
+	unsigned int count = (unsigned int)_queues.size();
+	for (unsigned int offset = 1; offset < count; offset++)
+	{
+		WorkQueue& victim = *_queues[(thief + offset) % count];
+		std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+		if (!lock.owns_lock() || victim.jobs.empty())
+			continue;
+		// Oldest first, those tend to be the bigger chunks of work
+		job = std::move(victim.jobs.front());
+		victim.jobs.pop_front();
+		return true;
+	}
+	return false;
+}
+
+bool JobSystem::RunOneJob(unsigned int queue)
+{
+	Job job;
+	if (!PopJob(queue, job) && !StealJob(queue, job))
+		return false;
+
+	_pendingJobs--;
+	job.function();
+	if (job.counter)
+		job.counter->fetch_sub(1, std::memory_order_release);
+	return true;
+}
+
+void JobSystem::WorkerLoop(unsigned int index)
+{
+	t_owner = this;
+	t_queueIndex = index;
+	PROFILE_THREAD("Job worker");
+
+	while (_running)
+	{
+		if (RunOneJob(index))
+			continue;
+
+		// Spin briefly before sleeping, jobs usually come in bursts within a frame
+		bool found = false;
+		for (int spin = 0; spin < 64 && !found; spin++)
+		{
+			std::this_thread::yield();
+			found = _pendingJobs > 0;
+		}
+		if (found)
+			continue;
+
+		std::unique_lock<std::mutex> lock(_sleepMutex);
+		_wakeUp.wait(lock, [this]() { return !_running || _pendingJobs > 0; });
+	}
+}
+
+void JobSystem::Run(const std::function<void()>& function, std::atomic<int>* counter)
+{
+	if (counter)
+		counter->fetch_add(1, std::memory_order_relaxed);
+
+	WorkQueue& queue = *_queues[CurrentQueue()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back({ function, counter });
+	}
+	_pendingJobs++;
+
+	if (!_workers.empty())
+	{
+		// Taking the lock keeps the notify from slipping in between a worker's check and its wait
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_wakeUp.notify_one();
+	}
+}
+
+void JobSystem::Wait(std::atomic<int>& counter)
+{
+	unsigned int queue = CurrentQueue();
+	while (counter.load(std::memory_order_acquire) > 0)
+	{
+		if (!RunOneJob(queue))
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::ParallelFor(unsigned int count, unsigned int batchSize, const std::function<void(unsigned int, unsigned int)>& kernel)
+{
+	if (count == 0)
+		return;
+	batchSize = std::max(1u, batchSize);
+
+	// The calling thread takes the first batch itself instead of idling in Wait
+	std::atomic<int> counter(0);
+	for (unsigned int begin = batchSize; begin < count; begin += batchSize)
+	{
+		unsigned int end = std::min(count, begin + batchSize);
+		Run([&kernel, begin, end]() { kernel(begin, end); }, &counter);
+	}
+	kernel(0, std::min(count, batchSize));
+	Wait(counter);
+}
+
+ParallelForFunction JobSystem::GetParallelFor()
+{
+	return [this](unsigned int count, unsigned int batchSize, const std::function<void(unsigned int, unsigned int)>& kernel)
+	{
+		ParallelFor(count, batchSize, kernel);
+	};
+}
+
+void JobSystem::RunBenchmark(std::ostream& stream)
+{
+	const unsigned int JOB_COUNT = 200000;
+	unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	stream << "threads, run+wait ns/job, parallel for ns/batch" << std::endl;
+	for (unsigned int threads = 1; ; threads = std::min(threads * 2, hardwareThreads))
+	{
+		JobSystem jobs(threads);
+
+		std::atomic<int> counter(0);
+		auto start = std::chrono::high_resolution_clock::now();
+		for (unsigned int i = 0; i < JOB_COUNT; i++)
+			jobs.Run([]() {}, &counter);
+		jobs.Wait(counter);
+		auto middle = std::chrono::high_resolution_clock::now();
+		jobs.ParallelFor(JOB_COUNT, 1, [](unsigned int, unsigned int) {});
+		auto end = std::chrono::high_resolution_clock::now();
+
+		double runNs = std::chrono::duration<double, std::nano>(middle - start).count() / JOB_COUNT;
+		double forNs = std::chrono::duration<double, std::nano>(end - middle).count() / JOB_COUNT;
+		stream << threads << ", " << runNs << ", " << forNs << std::endl;
+
+		if (threads == hardwareThreads)
+			break;
+	}
+}
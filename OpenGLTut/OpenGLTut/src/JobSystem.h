@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+// Runs kernel(begin, end) over [0, count) split into batches of batchSize, possibly on several threads
+typedef std::function<void(unsigned int count, unsigned int batchSize, const std::function<void(unsigned int, unsigned int)>& kernel)> ParallelForFunction;
+
+struct Job
+{
+	std::function<void()> function;
+	// Decremented once the job finished, whoever waits on it can then continue
+	std::atomic<int>* counter;
+};
+
+// Fixed pool of worker threads, every thread owns a deque it pushes to and pops from at the back,
+// idle threads steal from the front of the other deques
+class JobSystem
+{
+private:
+	struct WorkQueue
+	{
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+
+	std::vector<std::unique_ptr<WorkQueue>> _queues;
+	std::vector<std::thread> _workers;
+	std::atomic<bool> _running;
+	std::atomic<int> _pendingJobs;
+	std::mutex _sleepMutex;
+	std::condition_variable _wakeUp;
+
+	unsigned int CurrentQueue() const;
+	bool PopJob(unsigned int queue, Job& job);
+	bool StealJob(unsigned int thief, Job& job);
+	bool RunOneJob(unsigned int queue);
+	void WorkerLoop(unsigned int index);
+public:
+	// 0 uses every hardware thread, the thread that creates the job system counts as one of them
+	JobSystem(unsigned int threadCount = 0);
+	~JobSystem();
+
+	// Counters are incremented here and decremented when the job is done, so several jobs can share one
+	void Run(const std::function<void()>& function, std::atomic<int>* counter = nullptr);
+	// Executes other jobs while waiting, a job waiting on the jobs it spawned can't deadlock the pool
+	void Wait(std::atomic<int>& counter);
+
+	void ParallelFor(unsigned int count, unsigned int batchSize, const std::function<void(unsigned int, unsigned int)>& kernel);
+	ParallelForFunction GetParallelFor();
+
+	inline unsigned int GetThreadCount() const { return (unsigned int)_queues.size(); };
+
+	// Measures the cost of scheduling empty jobs for 1, 2, 4... threads up to the hardware thread count
+	static void RunBenchmark(std::ostream& stream);
+};
@@ -0,0 +1,43 @@
+#include "LODSelector.h"
+#include <algorithm>
+#include <cmath>
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
+
+LODSelector::LODSelector(float thresholdPixels, float hysteresis)
+	: _thresholdPixels(thresholdPixels), _hysteresis(hysteresis)
+{
+}
+
+float LODSelector::ProjectionScale(float fovDegrees, int viewportHeight)
+{
+	return (float)viewportHeight / (2.0f * std::tan(glm::radians(fovDegrees) * 0.5f));
+}
+
+unsigned int LODSelector::Select(const LODChain& chain, float distance, float projectionScale, unsigned int currentLod) const
+{
+	if (chain.levels.empty())
+		return 0;
+
+	float scale = projectionScale / std::max(distance, 0.0001f);
+	unsigned int lod = std::min(currentLod, (unsigned int)chain.levels.size() - 1);
+
+	// Refining happens right away, a visible error is worse than a late switch
+	while (lod > 0 && chain.levels[lod].error * scale > _thresholdPixels)
+		lod--;
+
+	// Coarsening waits until the next level is comfortably below the threshold
+	float coarsenThreshold = _thresholdPixels * (1.0f - _hysteresis);
+	while (lod + 1 < chain.levels.size() && chain.levels[lod + 1].error * scale <= coarsenThreshold)
+		lod++;
+
+	return lod;
+}
+
+void LODSelector::SelectAll(const LODChain& chain, const glm::vec3* centers, unsigned int count, const Camera& camera, int viewportHeight, unsigned int* lods) const
+{
+	float projectionScale = ProjectionScale(camera.getFOV(), viewportHeight);
+	glm::vec3 cameraPosition = camera.getPosition();
+	for (unsigned int i = 0; i < count; i++)
+		lods[i] = Select(chain, glm::distance(centers[i], cameraPosition), projectionScale, lods[i]);
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <glm/ext/vector_float3.hpp>
+#include "Camera.h"
+#include "MeshSimplifier.h"
+
+// Picks a LOD level per instance from the size its simplification error has on screen
+class LODSelector
+{
+private:
+	// Largest error in pixels that is allowed to be visible
+	float _thresholdPixels;
+	// Fraction of the threshold the error has to drop below before switching to a coarser level,
+	// keeps instances close to a switching distance from flickering between two levels
+	float _hysteresis;
+public:
+	LODSelector(float thresholdPixels = 1.0f, float hysteresis = 0.25f);
+
+	// Pixels covered by one world unit at distance 1, for a symmetric perspective projection
+	static float ProjectionScale(float fovDegrees, int viewportHeight);
+
+	unsigned int Select(const LODChain& chain, float distance, float projectionScale, unsigned int currentLod) const;
+	// lods holds the levels picked last frame and receives the new ones
+	void SelectAll(const LODChain& chain, const glm::vec3* centers, unsigned int count, const Camera& camera, int viewportHeight, unsigned int* lods) const;
+
+	inline void SetThreshold(float thresholdPixels) { _thresholdPixels = thresholdPixels; };
+	inline void SetHysteresis(float hysteresis) { _hysteresis = hysteresis; };
+};
@@ -0,0 +1,184 @@
+#include "Material.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+unsigned int MaterialLayout::GetSizeOfType(MaterialParameterType type)
+{
+	switch (type)
+	{
+		case MATERIAL_FLOAT: return 4;
+		case MATERIAL_VEC2: return 8;
+		case MATERIAL_VEC4: return 16;
+		case MATERIAL_UINT: return 4;
+	}
+	ASSERT(false);
+	return 0;
+}
+
+void MaterialLayout::Push(const std::string& name, MaterialParameterType type, const glm::vec4& defaultValue)
+{
+	// std140 aligns scalars, vec2 and vec4 to their own size
+	unsigned int size = GetSizeOfType(type);
+	unsigned int offset = (_size + size - 1) / size * size;
+	_parameters.push_back({ name, type, offset });
+	_size = offset + size;
+
+	_defaults.resize(GetStride(), 0);
+	if (type == MATERIAL_UINT)
+	{
+		unsigned int value = (unsigned int)defaultValue.x;
+		std::memcpy(&_defaults[offset], &value, size);
+	}
+	else
+	{
+		std::memcpy(&_defaults[offset], &defaultValue.x, size);
+	}
+}
+
+int MaterialLayout::Find(const std::string& name) const
+{
+	for (unsigned int i = 0; i < _parameters.size(); i++)
+	{
+		if (_parameters[i].name == name)
+			return (int)i;
+	}
+	return -1;
+}
+
+MaterialSystem::MaterialSystem(unsigned int firstBinding) : _firstBinding(firstBinding), _uploadedSize(0)
+{
+}
+
+unsigned short MaterialSystem::AddTemplate(RenderResources& resources, const Pipeline* pipeline, const MaterialLayout& layout, unsigned int capacity)
+{
+	ASSERT(_templates.size() < MAX_TEMPLATES && capacity > 0);
+	Template materialTemplate;
+	materialTemplate.pipelineID = resources.AddPipeline(pipeline);
+	materialTemplate.layout = layout;
+	materialTemplate.capacity = capacity;
+	materialTemplate.instanceCount = 0;
+	materialTemplate.binding = _firstBinding + (unsigned int)_templates.size();
+
+	// The range is bound with glBindBufferRange, its start has to be aligned like the per draw blocks
+	unsigned int alignment = UniformBuffer::GetOffsetAlignment();
+	materialTemplate.offset = ((unsigned int)_data.size() + alignment - 1) / alignment * alignment;
+	_data.resize(materialTemplate.offset + capacity * layout.GetStride(), 0);
+
+	if (pipeline->GetShader())
+		pipeline->GetShader()->SetUniformBlockBinding("MaterialBlock", materialTemplate.binding);
+	_templates.push_back(materialTemplate);
+	return (unsigned short)(_templates.size() - 1);
+}
+
+unsigned short MaterialSystem::AddInstance(unsigned short templateID, unsigned short textureID)
+{
+	Template& materialTemplate = _templates[templateID];
+	ASSERT(materialTemplate.instanceCount < materialTemplate.capacity);
+	unsigned int index = materialTemplate.instanceCount++;
+	const std::vector<unsigned char>& defaults = materialTemplate.layout.GetDefaults();
+	if (!defaults.empty())
+		std::memcpy(&_data[materialTemplate.offset + index * materialTemplate.layout.GetStride()], defaults.data(), defaults.size());
+
+	unsigned short material = (unsigned short)_instances.size();
+	_instances.push_back({ templateID, materialTemplate.pipelineID, textureID, index });
+	_instanceDirty.push_back(1);
+	_dirtyInstances.push_back(material);
+	return material;
+}
+
+unsigned char* MaterialSystem::FindParameter(unsigned short material, const std::string& name, MaterialParameterType type)
+{
+	const MaterialInstance& instance = _instances[material];
+	const Template& materialTemplate = _templates[instance.templateID];
+	int parameter = materialTemplate.layout.Find(name);
+	if (parameter < 0)
+	{
+		std::cout << "Warning: material parameter " << name << " doesn't exist" << std::endl;
+		return nullptr;
+	}
+	const MaterialParameter& found = materialTemplate.layout.GetParameters()[parameter];
+	ASSERT(found.type == type);
+
+	if (!_instanceDirty[material])
+	{
+		_instanceDirty[material] = 1;
+		_dirtyInstances.push_back(material);
+	}
+	return &_data[materialTemplate.offset + instance.index * materialTemplate.layout.GetStride() + found.offset];
+}
+
+void MaterialSystem::SetParameter(unsigned short material, const std::string& name, float value)
+{
+	if (unsigned char* destination = FindParameter(material, name, MATERIAL_FLOAT))
+		std::memcpy(destination, &value, sizeof(value));
+}
+
+void MaterialSystem::SetParameter(unsigned short material, const std::string& name, const glm::vec2& value)
+{
+	if (unsigned char* destination = FindParameter(material, name, MATERIAL_VEC2))
+		std::memcpy(destination, &value.x, sizeof(value));
+}
+
+void MaterialSystem::SetParameter(unsigned short material, const std::string& name, const glm::vec4& value)
+{
+	if (unsigned char* destination = FindParameter(material, name, MATERIAL_VEC4))
+		std::memcpy(destination, &value.x, sizeof(value));
+}
+
+void MaterialSystem::SetParameter(unsigned short material, const std::string& name, unsigned int value)
+{
+	if (unsigned char* destination = FindParameter(material, name, MATERIAL_UINT))
+		std::memcpy(destination, &value, sizeof(value));
+}
+
+void MaterialSystem::Upload()
+{
+	if (_data.empty())
+		return;
+
+	if (!_buffer || _uploadedSize != _data.size())
+	{
+		// First upload or new templates, everything goes at once
+		if (!_buffer)
+			_buffer.reset(new UniformBuffer((unsigned int)_data.size()));
+		_buffer->Upload(_data.data(), (unsigned int)_data.size());
+		_uploadedSize = (unsigned int)_data.size();
+	}
+	else if (!_dirtyInstances.empty())
+	{
+		_ranges.clear();
+		for (unsigned short material : _dirtyInstances)
+		{
+			const MaterialInstance& instance = _instances[material];
+			const Template& materialTemplate = _templates[instance.templateID];
+			unsigned int stride = materialTemplate.layout.GetStride();
+			_ranges.push_back({ materialTemplate.offset + instance.index * stride, stride });
+		}
+		std::sort(_ranges.begin(), _ranges.end());
+
+		// Instances next to each other go in one update
+		unsigned int start = _ranges[0].first, end = _ranges[0].first + _ranges[0].second;
+		for (size_t i = 1; i <= _ranges.size(); i++)
+		{
+			if (i < _ranges.size() && _ranges[i].first <= end)
+			{
+				end = std::max(end, _ranges[i].first + _ranges[i].second);
+				continue;
+			}
+			_buffer->Update(&_data[start], start, end - start);
+			if (i < _ranges.size())
+			{
+				start = _ranges[i].first;
+				end = start + _ranges[i].second;
+			}
+		}
+	}
+	for (unsigned short material : _dirtyInstances)
+		_instanceDirty[material] = 0;
+	_dirtyInstances.clear();
+
+	for (const Template& materialTemplate : _templates)
+		_buffer->BindRange(materialTemplate.binding, materialTemplate.offset, materialTemplate.capacity * materialTemplate.layout.GetStride());
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/ext/vector_float2.hpp>
+#include <glm/ext/vector_float4.hpp>
+#include "CommandList.h"
+#include "Pipeline.h"
+#include "UniformBuffer.h"
+
+// Length of the material array in Batched.shader, its Material struct is a single vec4 color
+static const unsigned int BATCHED_MATERIAL_CAPACITY = 256;
+
+// vec3 is left out, std140 pads it to a vec4 anyway and a following float would silently move into the padding
+enum MaterialParameterType { MATERIAL_FLOAT, MATERIAL_VEC2, MATERIAL_VEC4, MATERIAL_UINT };
+
+struct MaterialParameter
+{
+	std::string name;
+	MaterialParameterType type;
+	// Byte offset inside one instance
+	unsigned int offset;
+};
+
+// Parameters of a material template in the order the shader's Material struct declares them,
+// laid out by std140 rules so one instance matches one element of the shader's array
+class MaterialLayout
+{
+private:
+	std::vector<MaterialParameter> _parameters;
+	// Default values of a whole instance
+	std::vector<unsigned char> _defaults;
+	unsigned int _size;
+public:
+	MaterialLayout() : _size(0) {};
+
+	// Only the components the type has are taken from defaultValue
+	void Push(const std::string& name, MaterialParameterType type, const glm::vec4& defaultValue = glm::vec4(0.0f));
+	// Index of the parameter, -1 when there is none with that name
+	int Find(const std::string& name) const;
+
+	inline const std::vector<MaterialParameter>& GetParameters() const { return _parameters; };
+	inline const std::vector<unsigned char>& GetDefaults() const { return _defaults; };
+	// std140 rounds the elements of a struct array up to 16 bytes
+	inline unsigned int GetStride() const { return (_size + 15) / 16 * 16; };
+
+	static unsigned int GetSizeOfType(MaterialParameterType type);
+};
+
+// What a draw of a material instance needs, index goes into the per draw uniform block (see CommandList::Draw)
+struct MaterialInstance
+{
+	unsigned short templateID;
+	unsigned short pipelineID;
+	unsigned short textureID;
+	// Element of the template's array in MaterialBlock
+	unsigned int index;
+};
+
+// Material templates (a pipeline and the layout of its parameters) and their instances. The parameters of
+// every instance live in one uniform buffer, each template owns an aligned range of it holding its instances
+// as the std140 array the shader's MaterialBlock declares. Draws only carry the instance's index, so nothing
+// is set per draw. Edits are kept in a copy of the buffer and Upload sends the edited ranges once per frame.
+// Like command lists the system makes no GL calls except in Upload.
+class MaterialSystem
+{
+public:
+	// Templates get consecutive binding points from firstBinding, the GL minimum is 36 binding points
+	static const unsigned int MAX_TEMPLATES = 16;
+private:
+	struct Template
+	{
+		unsigned short pipelineID;
+		MaterialLayout layout;
+		unsigned int capacity;
+		unsigned int instanceCount;
+		unsigned int binding;
+		// Start of the template's range in the buffer
+		unsigned int offset;
+	};
+
+	std::vector<Template> _templates;
+	std::vector<MaterialInstance> _instances;
+	std::vector<unsigned char> _instanceDirty;
+	std::vector<unsigned short> _dirtyInstances;
+	// What the buffer should contain
+	std::vector<unsigned char> _data;
+	std::unique_ptr<UniformBuffer> _buffer;
+	unsigned int _firstBinding;
+	// Bytes the buffer got so far, templates added later need a full upload
+	unsigned int _uploadedSize;
+	// Reused by Upload
+	std::vector<std::pair<unsigned int, unsigned int>> _ranges;
+
+	unsigned char* FindParameter(unsigned short material, const std::string& name, MaterialParameterType type);
+public:
+	MaterialSystem(unsigned int firstBinding = 2);
+
+	// Adds the pipeline to resources and binds the MaterialBlock of its shader to the template's binding point.
+	// capacity has to be the length of the shader's material array, a shader belongs to one template.
+	unsigned short AddTemplate(RenderResources& resources, const Pipeline* pipeline, const MaterialLayout& layout, unsigned int capacity);
+	// The instance starts with the layout's defaults and is drawn with the texture
+	unsigned short AddInstance(unsigned short templateID, unsigned short textureID);
+
+	void SetParameter(unsigned short material, const std::string& name, float value);
+	void SetParameter(unsigned short material, const std::string& name, const glm::vec2& value);
+	void SetParameter(unsigned short material, const std::string& name, const glm::vec4& value);
+	void SetParameter(unsigned short material, const std::string& name, unsigned int value);
+
+	// Sends the instances edited since the last call, neighbours go in one range, and binds every template's
+	// range. Once per frame before the draws, on the thread that owns the context.
+	void Upload();
+
+	inline const MaterialInstance& GetInstance(unsigned short material) const { return _instances[material]; };
+	inline unsigned int GetInstanceCount() const { return (unsigned int)_instances.size(); };
+	inline unsigned int GetBufferSize() const { return (unsigned int)_data.size(); };
+};
@@ -0,0 +1,400 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <glm/glm.hpp>
+
+// Symmetric 4x4 matrix of the summed squared plane distances, plus the total weight of the planes
+struct Quadric
+{
+	double a00, a01, a02, a03;
+	double a11, a12, a13;
+	double a22, a23;
+	double a33;
+	double weight;
+
+	Quadric() : a00(0), a01(0), a02(0), a03(0), a11(0), a12(0), a13(0), a22(0), a23(0), a33(0), weight(0) {}
+
+	void AddPlane(const glm::dvec3& n, double d, double w)
+	{
+		a00 += w * n.x * n.x; a01 += w * n.x * n.y; a02 += w * n.x * n.z; a03 += w * n.x * d;
+		a11 += w * n.y * n.y; a12 += w * n.y * n.z; a13 += w * n.y * d;
+		a22 += w * n.z * n.z; a23 += w * n.z * d;
+		a33 += w * d * d;
+		weight += w;
+	}
+
+	void Add(const Quadric& q)
+	{
+		a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+		a11 += q.a11; a12 += q.a12; a13 += q.a13;
+		a22 += q.a22; a23 += q.a23;
+		a33 += q.a33;
+		weight += q.weight;
+	}
+
+	// Weighted mean squared distance of p to the accumulated planes
+	double Error(const glm::dvec3& p) const
+	{
+		double e = a00 * p.x * p.x + 2.0 * a01 * p.x * p.y + 2.0 * a02 * p.x * p.z + 2.0 * a03 * p.x
+			+ a11 * p.y * p.y + 2.0 * a12 * p.y * p.z + 2.0 * a13 * p.y
+			+ a22 * p.z * p.z + 2.0 * a23 * p.z
+			+ a33;
+		return weight > 0.0 ? std::fabs(e) / weight : 0.0;
+	}
+};
+
+struct Collapse
+{
+	double cost;
+	unsigned int from;
+	unsigned int to;
+	unsigned int fromVersion;
+	unsigned int toVersion;
+
+	bool operator>(const Collapse& other) const { return cost > other.cost; }
+};
+
+struct PositionHash
+{
+	size_t operator()(const glm::vec3& p) const
+	{
+		unsigned int bits[3];
+		std::memcpy(bits, &p, sizeof(bits));
+		return (size_t)(bits[0] * 73856093u ^ bits[1] * 19349663u ^ bits[2] * 83492791u);
+	}
+};
+
+static unsigned long long EdgeKey(unsigned int a, unsigned int b)
+{
+	if (a > b)
+		std::swap(a, b);
+	return ((unsigned long long)a << 32) | b;
+}
+
+std::vector<unsigned int> MeshSimplifier::Simplify(const float* vertices, unsigned int vertexCount, unsigned int stride,
+	const std::vector<unsigned int>& indices, unsigned int targetIndexCount, float targetError, float* resultError)
+{
+	std::vector<glm::dvec3> positions(vertexCount);
+	for (unsigned int i = 0; i < vertexCount; i++)
+		positions[i] = glm::dvec3(vertices[i * stride], vertices[i * stride + 1], vertices[i * stride + 2]);
+
+	// Vertices that only differ in their attributes (uv seams) are welded into one topological vertex,
+	// collapses happen on the welded vertices while triangles keep pointing at the original ones
+	std::vector<unsigned int> remap(vertexCount);
+	{
+		std::unordered_map<glm::vec3, unsigned int, PositionHash> unique;
+		for (unsigned int i = 0; i < vertexCount; i++)
+		{
+			glm::vec3 p(vertices[i * stride], vertices[i * stride + 1], vertices[i * stride + 2]);
+			auto it = unique.find(p);
+			if (it == unique.end())
+			{
+				unique[p] = i;
+				remap[i] = i;
+			}
+			else
+			{
+				remap[i] = it->second;
+			}
+		}
+	}
+
+	unsigned int triangleCount = (unsigned int)indices.size() / 3;
+	std::vector<unsigned int> triangles(indices.begin(), indices.begin() + triangleCount * 3);
+	std::vector<bool> triangleAlive(triangleCount, true);
+	std::vector<std::vector<unsigned int>> vertexTriangles(vertexCount);
+	std::vector<Quadric> quadrics(vertexCount);
+	std::unordered_map<unsigned long long, unsigned int> edgeUse;
+
+	for (unsigned int t = 0; t < triangleCount; t++)
+	{
+		unsigned int a = remap[triangles[t * 3]], b = remap[triangles[t * 3 + 1]], c = remap[triangles[t * 3 + 2]];
+		vertexTriangles[a].push_back(t);
+		vertexTriangles[b].push_back(t);
+		vertexTriangles[c].push_back(t);
+
+		glm::dvec3 n = glm::cross(positions[b] - positions[a], positions[c] - positions[a]);
+		double length = glm::length(n);
+		if (length > 0.0)
+		{
+			n /= length;
+			double area = length * 0.5;
+			double d = -glm::dot(n, positions[a]);
+			quadrics[a].AddPlane(n, d, area);
+			quadrics[b].AddPlane(n, d, area);
+			quadrics[c].AddPlane(n, d, area);
+		}
+
+		edgeUse[EdgeKey(a, b)]++;
+		edgeUse[EdgeKey(b, c)]++;
+		edgeUse[EdgeKey(c, a)]++;
+	}
+
+	// Open borders get a heavily weighted plane perpendicular to the surface so they don't shrink
+	const double BORDER_WEIGHT = 10.0;
+	for (unsigned int t = 0; t < triangleCount; t++)
+	{
+		for (int e = 0; e < 3; e++)
+		{
+			unsigned int a = remap[triangles[t * 3 + e]], b = remap[triangles[t * 3 + (e + 1) % 3]];
+			unsigned int c = remap[triangles[t * 3 + (e + 2) % 3]];
+			if (edgeUse[EdgeKey(a, b)] != 1)
+				continue;
+			glm::dvec3 edge = positions[b] - positions[a];
+			glm::dvec3 normal = glm::cross(edge, positions[c] - positions[a]);
+			glm::dvec3 n = glm::cross(edge, normal);
+			double length = glm::length(n);
+			if (length <= 0.0)
+				continue;
+			n /= length;
+			double d = -glm::dot(n, positions[a]);
+			double w = glm::length(edge) * glm::length(edge) * BORDER_WEIGHT;
+			quadrics[a].AddPlane(n, d, w);
+			quadrics[b].AddPlane(n, d, w);
+		}
+	}
+
+	std::vector<unsigned int> version(vertexCount, 0);
+	std::vector<bool> vertexAlive(vertexCount, true);
+	std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue;
+
+	auto pushCollapse = [&](unsigned int from, unsigned int to)
+	{
+		Quadric q = quadrics[from];
+		q.Add(quadrics[to]);
+		queue.push({ q.Error(positions[to]), from, to, version[from], version[to] });
+	};
+
+	for (const auto& edge : edgeUse)
+	{
+		unsigned int a = (unsigned int)(edge.first >> 32), b = (unsigned int)(edge.first & 0xffffffffu);
+		pushCollapse(a, b);
+		pushCollapse(b, a);
+	}
+
+	// Pairs of (wedge of from, wedge of to) for the collapse being tried
+	const unsigned int NO_WEDGE = 0xffffffffu;
+	std::vector<std::pair<unsigned int, unsigned int>> wedgeMap;
+
+	unsigned int indexCount = triangleCount * 3;
+	double maxError = 0.0;
+	double errorLimit = (double)targetError * (double)targetError;
+
+	while (indexCount > targetIndexCount && !queue.empty())
+	{
+		Collapse collapse = queue.top();
+		queue.pop();
+
+		if (!vertexAlive[collapse.from] || !vertexAlive[collapse.to])
+			continue;
+		if (collapse.fromVersion != version[collapse.from] || collapse.toVersion != version[collapse.to])
+			continue;
+		if (collapse.cost > errorLimit)
+			break;
+
+		// Every attribute wedge of from moves onto the wedge of to it shares a triangle with, so both sides of a
+		// uv seam keep their own uvs. A wedge of from without a partner, or two of them landing on the same
+		// wedge of to, would tear the seam open.
+		bool tears = false;
+		wedgeMap.clear();
+		for (unsigned int t : vertexTriangles[collapse.from])
+		{
+			if (!triangleAlive[t])
+				continue;
+			const unsigned int* tri = &triangles[t * 3];
+			unsigned int fromWedge = NO_WEDGE, toWedge = NO_WEDGE;
+			for (int k = 0; k < 3; k++)
+			{
+				if (remap[tri[k]] == collapse.from)
+					fromWedge = tri[k];
+				else if (remap[tri[k]] == collapse.to)
+					toWedge = tri[k];
+			}
+			if (toWedge == NO_WEDGE)
+				continue;
+			for (const std::pair<unsigned int, unsigned int>& wedge : wedgeMap)
+			{
+				if ((wedge.first == fromWedge) != (wedge.second == toWedge))
+					tears = true;
+			}
+			wedgeMap.push_back({ fromWedge, toWedge });
+		}
+		auto targetWedge = [&](unsigned int fromWedge)
+		{
+			for (const std::pair<unsigned int, unsigned int>& wedge : wedgeMap)
+			{
+				if (wedge.first == fromWedge)
+					return wedge.second;
+			}
+			return NO_WEDGE;
+		};
+
+		// Reject the collapse when it would flip any of the triangles that survive it
+		bool flips = false;
+		for (unsigned int t : vertexTriangles[collapse.from])
+		{
+			if (!triangleAlive[t] || tears)
+				continue;
+			unsigned int* tri = &triangles[t * 3];
+			if (remap[tri[0]] == collapse.to || remap[tri[1]] == collapse.to || remap[tri[2]] == collapse.to)
+				continue;
+
+			glm::dvec3 p[3], q[3];
+			for (int k = 0; k < 3; k++)
+			{
+				if (remap[tri[k]] == collapse.from && targetWedge(tri[k]) == NO_WEDGE)
+					tears = true;
+				p[k] = positions[remap[tri[k]]];
+				q[k] = remap[tri[k]] == collapse.from ? positions[collapse.to] : p[k];
+			}
+			glm::dvec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+			glm::dvec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+			if (glm::dot(before, after) <= 0.0)
+			{
+				flips = true;
+				break;
+			}
+		}
+		if (flips || tears)
+			continue;
+
+		for (unsigned int t : vertexTriangles[collapse.from])
+		{
+			if (!triangleAlive[t])
+				continue;
+			unsigned int* tri = &triangles[t * 3];
+			bool hasTarget = remap[tri[0]] == collapse.to || remap[tri[1]] == collapse.to || remap[tri[2]] == collapse.to;
+			if (hasTarget)
+			{
+				triangleAlive[t] = false;
+				indexCount -= 3;
+				continue;
+			}
+			for (int k = 0; k < 3; k++)
+			{
+				if (remap[tri[k]] == collapse.from)
+					tri[k] = targetWedge(tri[k]);
+			}
+			vertexTriangles[collapse.to].push_back(t);
+		}
+
+		maxError = std::max(maxError, collapse.cost);
+		quadrics[collapse.to].Add(quadrics[collapse.from]);
+		vertexAlive[collapse.from] = false;
+		version[collapse.to]++;
+
+		// Every edge around the surviving vertex has a new cost now, the version bump above
+		// invalidates the queued ones
+		for (unsigned int t : vertexTriangles[collapse.to])
+		{
+			if (!triangleAlive[t])
+				continue;
+			for (int k = 0; k < 3; k++)
+			{
+				unsigned int neighbour = remap[triangles[t * 3 + k]];
+				if (neighbour == collapse.to)
+					continue;
+				pushCollapse(neighbour, collapse.to);
+				pushCollapse(collapse.to, neighbour);
+			}
+		}
+	}
+
+	std::vector<unsigned int> result;
+	result.reserve(indexCount);
+	for (unsigned int t = 0; t < triangleCount; t++)
+	{
+		if (triangleAlive[t])
+			result.insert(result.end(), triangles.begin() + t * 3, triangles.begin() + t * 3 + 3);
+	}
+
+	if (resultError)
+		*resultError = (float)std::sqrt(maxError);
+	return result;
+}
+
+LODChain MeshSimplifier::GenerateLODChain(const float* vertices, unsigned int vertexCount, unsigned int stride,
+	const std::vector<unsigned int>& indices, unsigned int maxLevels, float reduction)
+{
+	LODChain chain;
+	chain.indices = indices;
+	chain.levels.push_back({ 0, (unsigned int)indices.size(), 0.0f });
+
+	float error = 0.0f;
+	unsigned int previousCount = (unsigned int)indices.size();
+	while (chain.levels.size() < maxLevels)
+	{
+		unsigned int target = (unsigned int)(previousCount * reduction) / 3 * 3;
+		if (target < 3)
+			break;
+
+		// Every level starts from the full mesh so errors don't compound across levels
+		float levelError = 0.0f;
+		std::vector<unsigned int> lod = Simplify(vertices, vertexCount, stride, indices, target, FLT_MAX, &levelError);
+
+		// Locked seams or borders can keep the mesh from getting meaningfully smaller
+		if (lod.empty() || lod.size() > previousCount * 0.9f)
+			break;
+
+		error = std::max(error, levelError);
+		chain.levels.push_back({ (unsigned int)chain.indices.size(), (unsigned int)lod.size(), error });
+		chain.indices.insert(chain.indices.end(), lod.begin(), lod.end());
+		previousCount = (unsigned int)lod.size();
+	}
+
+	return chain;
+}
+
+bool LODChain::Save(const std::string& filePath) const
+{
+	std::ofstream stream(filePath, std::ios::binary);
+	if (!stream)
+		return false;
+
+	unsigned int header[3] = { 0x43444f4c /* LODC */, (unsigned int)levels.size(), (unsigned int)indices.size() };
+	stream.write((const char*)header, sizeof(header));
+	stream.write((const char*)levels.data(), levels.size() * sizeof(LODLevel));
+	stream.write((const char*)indices.data(), indices.size() * sizeof(unsigned int));
+	return (bool)stream;
+}
+
+bool LODChain::Load(const std::string& filePath)
+{
+	std::ifstream stream(filePath, std::ios::binary | std::ios::ate);
+	if (!stream)
+		return false;
+	unsigned long long fileSize = (unsigned long long)stream.tellg();
+	stream.seekg(0);
+
+	unsigned int header[3];
+	stream.read((char*)header, sizeof(header));
+	if (!stream || header[0] != 0x43444f4c)
+		return false;
+
+	// The counts come from the file, so a truncated or corrupt one must not size the allocations
+	unsigned long long dataSize = (unsigned long long)header[1] * sizeof(LODLevel) + (unsigned long long)header[2] * sizeof(unsigned int);
+	if (dataSize > fileSize - sizeof(header))
+		return false;
+
+	std::vector<LODLevel> loadedLevels(header[1]);
+	std::vector<unsigned int> loadedIndices(header[2]);
+	stream.read((char*)loadedLevels.data(), loadedLevels.size() * sizeof(LODLevel));
+	stream.read((char*)loadedIndices.data(), loadedIndices.size() * sizeof(unsigned int));
+	if (!stream)
+		return false;
+	for (const LODLevel& level : loadedLevels)
+	{
+		if ((unsigned long long)level.firstIndex + level.indexCount > loadedIndices.size())
+			return false;
+	}
+
+	levels.swap(loadedLevels);
+	indices.swap(loadedIndices);
+	return true;
+}
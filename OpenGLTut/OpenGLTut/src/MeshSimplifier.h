@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// One level of detail, a range inside LODChain::indices
+struct LODLevel
+{
+	unsigned int firstIndex;
+	unsigned int indexCount;
+	// Largest distance (in object space units) the simplified surface moved away from the original one
+	float error;
+};
+
+// All LOD levels of a mesh share the vertex buffer, their indices are stored back to back
+// so the whole chain can be uploaded as a single index buffer
+struct LODChain
+{
+	std::vector<unsigned int> indices;
+	std::vector<LODLevel> levels;
+
+	bool Save(const std::string& filePath) const;
+	bool Load(const std::string& filePath);
+};
+
+// Offline mesh simplification based on quadric error metrics (Garland & Heckbert), using half edge
+// collapses so simplified meshes keep referencing the original vertices
+class MeshSimplifier
+{
+public:
+	// vertices - interleaved vertex data with the position in the first 3 floats, stride is in floats
+	// Stops once the index count reaches targetIndexCount or the next collapse would exceed targetError
+	static std::vector<unsigned int> Simplify(const float* vertices, unsigned int vertexCount, unsigned int stride,
+		const std::vector<unsigned int>& indices, unsigned int targetIndexCount, float targetError, float* resultError);
+
+	// Level 0 is the original mesh, each following level targets reduction times the triangles of the previous one
+	static LODChain GenerateLODChain(const float* vertices, unsigned int vertexCount, unsigned int stride,
+		const std::vector<unsigned int>& indices, unsigned int maxLevels = 6, float reduction = 0.5f);
+};
@@ -0,0 +1,236 @@
+#include "Meshlet.h"
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MESHLET_SIMD 1
+#include <emmintrin.h>
+#endif
+
+static void ComputeBounds(const float* vertices, unsigned int stride, const unsigned int* indices, unsigned int indexCount, Meshlet& meshlet)
+{
+	auto position = [&](unsigned int index)
+	{
+		return glm::vec3(vertices[index * stride], vertices[index * stride + 1], vertices[index * stride + 2]);
+	};
+
+	// Sphere around the center of the box, cheap and tight enough for clusters this small
+	glm::vec3 min(position(indices[0])), max(min);
+	for (unsigned int i = 1; i < indexCount; i++)
+	{
+		min = glm::min(min, position(indices[i]));
+		max = glm::max(max, position(indices[i]));
+	}
+	meshlet.center = (min + max) * 0.5f;
+	meshlet.radius = 0.0f;
+	for (unsigned int i = 0; i < indexCount; i++)
+		meshlet.radius = std::max(meshlet.radius, glm::distance(meshlet.center, position(indices[i])));
+
+	std::vector<glm::vec3> normals;
+	normals.reserve(indexCount / 3);
+	glm::vec3 axis(0.0f);
+	for (unsigned int i = 0; i + 2 < indexCount; i += 3)
+	{
+		glm::vec3 a = position(indices[i]), b = position(indices[i + 1]), c = position(indices[i + 2]);
+		glm::vec3 n = glm::cross(b - a, c - a);
+		float length = glm::length(n);
+		if (length <= 0.0f)
+			continue;
+		normals.push_back(n / length);
+		axis += normals.back();
+	}
+
+	meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+	meshlet.coneCutoff = 1.0f;
+	float axisLength = glm::length(axis);
+	if (normals.empty() || axisLength <= 0.0f)
+		return;
+
+	axis /= axisLength;
+	float minDot = 1.0f;
+	for (const glm::vec3& n : normals)
+		minDot = std::min(minDot, glm::dot(axis, n));
+
+	meshlet.coneAxis = axis;
+	// Normals spread over more than a hemisphere, some triangle always faces the camera
+	if (minDot <= 0.0f)
+		return;
+	meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+}
+
+std::vector<Meshlet> MeshletBuilder::Build(const float* vertices, unsigned int vertexCount, unsigned int stride,
+	const std::vector<unsigned int>& indices, std::vector<unsigned int>& meshletIndices,
+	unsigned int maxVertices, unsigned int maxTriangles)
+{
+	std::vector<Meshlet> meshlets;
+	meshletIndices.clear();
+	meshletIndices.reserve(indices.size());
+
+	// Which meshlet last referenced a vertex, saves clearing a set every time a meshlet is closed
+	std::vector<unsigned int> lastMeshlet(vertexCount, ~0u);
+
+	Meshlet current = {};
+	auto flush = [&]()
+	{
+		if (current.indexCount == 0)
+			return;
+		ComputeBounds(vertices, stride, &meshletIndices[current.firstIndex], current.indexCount, current);
+		meshlets.push_back(current);
+		current = {};
+		current.firstIndex = (unsigned int)meshletIndices.size();
+	};
+
+	// Triangles are taken in order, so index buffers that were optimized for vertex locality produce compact meshlets
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		unsigned int meshletId = (unsigned int)meshlets.size();
+		unsigned int newVertices = 0;
+		for (int k = 0; k < 3; k++)
+		{
+			if (lastMeshlet[indices[i + k]] != meshletId)
+				newVertices++;
+		}
+		if (current.vertexCount + newVertices > maxVertices || current.indexCount / 3 + 1 > maxTriangles)
+		{
+			flush();
+			meshletId = (unsigned int)meshlets.size();
+		}
+
+		for (int k = 0; k < 3; k++)
+		{
+			unsigned int index = indices[i + k];
+			if (lastMeshlet[index] != meshletId)
+			{
+				lastMeshlet[index] = meshletId;
+				current.vertexCount++;
+			}
+			meshletIndices.push_back(index);
+		}
+		current.indexCount += 3;
+	}
+	flush();
+
+	return meshlets;
+}
+
+std::vector<MeshletCuller> MeshletBuilder::BuildLODs(const float* vertices, unsigned int vertexCount, unsigned int stride, LODChain& chain,
+	unsigned int maxVertices, unsigned int maxTriangles)
+{
+	std::vector<MeshletCuller> cullers;
+	std::vector<unsigned int> levelIndices, meshletIndices;
+	for (const LODLevel& level : chain.levels)
+	{
+		levelIndices.assign(chain.indices.begin() + level.firstIndex, chain.indices.begin() + level.firstIndex + level.indexCount);
+		std::vector<Meshlet> meshlets = Build(vertices, vertexCount, stride, levelIndices, meshletIndices, maxVertices, maxTriangles);
+		std::copy(meshletIndices.begin(), meshletIndices.end(), chain.indices.begin() + level.firstIndex);
+		cullers.emplace_back(meshlets);
+	}
+	return cullers;
+}
+
+MeshletCuller::MeshletCuller(const std::vector<Meshlet>& meshlets) : _meshlets(meshlets)
+{
+	// Padded to a multiple of 4 with meshlets that always fail the frustum test
+	size_t padded = (meshlets.size() + 3) & ~(size_t)3;
+	_centerX.assign(padded, 0.0f); _centerY.assign(padded, 0.0f); _centerZ.assign(padded, 0.0f);
+	_radius.assign(padded, -1e30f);
+	_axisX.assign(padded, 0.0f); _axisY.assign(padded, 0.0f); _axisZ.assign(padded, 1.0f);
+	_cutoff.assign(padded, 1.0f);
+
+	for (size_t i = 0; i < meshlets.size(); i++)
+	{
+		_centerX[i] = meshlets[i].center.x;
+		_centerY[i] = meshlets[i].center.y;
+		_centerZ[i] = meshlets[i].center.z;
+		_radius[i] = meshlets[i].radius;
+		_axisX[i] = meshlets[i].coneAxis.x;
+		_axisY[i] = meshlets[i].coneAxis.y;
+		_axisZ[i] = meshlets[i].coneAxis.z;
+		_cutoff[i] = meshlets[i].coneCutoff;
+	}
+}
+
+void MeshletCuller::Cull(const glm::mat4& model, const Frustum& frustum, const glm::vec3& cameraPosition, MeshletDrawList& drawList,
+	unsigned int firstIndex) const
+{
+	drawList.counts.clear();
+	drawList.offsets.clear();
+	drawList.visibleMeshlets = 0;
+
+	// Bring the planes and the camera into object space instead of moving every meshlet into world space,
+	// radii stay valid as long as the model matrix has a uniform scale
+	glm::vec4 planes[6];
+	glm::mat4 transposed = glm::transpose(model);
+	for (int p = 0; p < 6; p++)
+	{
+		planes[p] = transposed * frustum.GetPlanes()[p];
+		planes[p] /= glm::length(glm::vec3(planes[p]));
+	}
+	glm::vec3 camera = glm::vec3(glm::inverse(model) * glm::vec4(cameraPosition, 1.0f));
+
+	std::vector<unsigned char> visible(_centerX.size(), 0);
+
+#ifdef MESHLET_SIMD
+	__m128 zero = _mm_setzero_ps();
+	__m128 camX = _mm_set1_ps(camera.x), camY = _mm_set1_ps(camera.y), camZ = _mm_set1_ps(camera.z);
+	for (size_t i = 0; i < _centerX.size(); i += 4)
+	{
+		__m128 cx = _mm_loadu_ps(&_centerX[i]), cy = _mm_loadu_ps(&_centerY[i]), cz = _mm_loadu_ps(&_centerZ[i]);
+		__m128 r = _mm_loadu_ps(&_radius[i]);
+		__m128 negR = _mm_sub_ps(zero, r);
+
+		__m128 inside = _mm_cmpge_ps(r, zero);
+		for (int p = 0; p < 6; p++)
+		{
+			__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(planes[p].x)), _mm_mul_ps(cy, _mm_set1_ps(planes[p].y))),
+				_mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(planes[p].z)), _mm_set1_ps(planes[p].w)));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(d, negR));
+		}
+
+		// Backfacing when dot(center - camera, axis) >= cutoff * |center - camera| + radius
+		__m128 vx = _mm_sub_ps(cx, camX), vy = _mm_sub_ps(cy, camY), vz = _mm_sub_ps(cz, camZ);
+		__m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz)));
+		__m128 along = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, _mm_loadu_ps(&_axisX[i])), _mm_mul_ps(vy, _mm_loadu_ps(&_axisY[i]))),
+			_mm_mul_ps(vz, _mm_loadu_ps(&_axisZ[i])));
+		__m128 backfacing = _mm_cmpge_ps(along, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&_cutoff[i]), distance), r));
+
+		int mask = _mm_movemask_ps(_mm_andnot_ps(backfacing, inside));
+		visible[i] = mask & 1;
+		visible[i + 1] = (mask >> 1) & 1;
+		visible[i + 2] = (mask >> 2) & 1;
+		visible[i + 3] = (mask >> 3) & 1;
+	}
+#else
+	for (size_t i = 0; i < _meshlets.size(); i++)
+	{
+		glm::vec3 center(_centerX[i], _centerY[i], _centerZ[i]);
+		bool inside = true;
+		for (int p = 0; p < 6 && inside; p++)
+			inside = glm::dot(glm::vec3(planes[p]), center) + planes[p].w >= -_radius[i];
+
+		glm::vec3 view = center - camera;
+		bool backfacing = glm::dot(view, glm::vec3(_axisX[i], _axisY[i], _axisZ[i])) >= _cutoff[i] * glm::length(view) + _radius[i];
+		visible[i] = inside && !backfacing;
+	}
+#endif
+
+	for (size_t i = 0; i < _meshlets.size(); i++)
+	{
+		if (!visible[i])
+			continue;
+		drawList.visibleMeshlets++;
+
+		const Meshlet& meshlet = _meshlets[i];
+		const void* offset = (const void*)((size_t)(firstIndex + meshlet.firstIndex) * sizeof(unsigned int));
+		// Meshlets are stored back to back, so consecutive visible ones extend the previous range
+		if (!drawList.counts.empty() && (const char*)drawList.offsets.back() + drawList.counts.back() * sizeof(unsigned int) == (const char*)offset)
+			drawList.counts.back() += meshlet.indexCount;
+		else
+		{
+			drawList.counts.push_back(meshlet.indexCount);
+			drawList.offsets.push_back(offset);
+		}
+	}
+}
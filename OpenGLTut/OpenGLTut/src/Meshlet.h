@@ -0,0 +1,65 @@
+#pragma once
+#include <vector>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/matrix_float4x4.hpp>
+#include "Frustum.h"
+
+struct LODChain;
+class MeshletCuller;
+
+// A small cluster of triangles, its indices are a range inside the meshlet index buffer
+struct Meshlet
+{
+	unsigned int firstIndex;
+	unsigned int indexCount;
+	unsigned int vertexCount;
+
+	// Bounding sphere in object space
+	glm::vec3 center;
+	float radius;
+
+	// All triangle normals lie within the cone around coneAxis, coneCutoff is the sine of its
+	// half angle (1 when the cone is too wide to ever cull the meshlet)
+	glm::vec3 coneAxis;
+	float coneCutoff;
+};
+
+class MeshletBuilder
+{
+public:
+	// Splits the triangles into meshlets, meshletIndices receives the reordered index buffer the meshlets point into
+	static std::vector<Meshlet> Build(const float* vertices, unsigned int vertexCount, unsigned int stride,
+		const std::vector<unsigned int>& indices, std::vector<unsigned int>& meshletIndices,
+		unsigned int maxVertices = 64, unsigned int maxTriangles = 124);
+	// Splits every level of the chain into meshlets of its own and rewrites the level's indices in meshlet order,
+	// returns a culler per level. Meshlet ranges start at the first index of their level.
+	static std::vector<MeshletCuller> BuildLODs(const float* vertices, unsigned int vertexCount, unsigned int stride, LODChain& chain,
+		unsigned int maxVertices = 64, unsigned int maxTriangles = 124);
+};
+
+// Index ranges of the meshlets that survived culling, ready for glMultiDrawElements
+struct MeshletDrawList
+{
+	std::vector<int> counts;
+	std::vector<const void*> offsets;
+	unsigned int visibleMeshlets;
+};
+
+// Culls meshlets of one mesh on the CPU, bounds are kept as structure of arrays so 4 meshlets are tested at once
+class MeshletCuller
+{
+private:
+	std::vector<Meshlet> _meshlets;
+	std::vector<float> _centerX, _centerY, _centerZ, _radius;
+	std::vector<float> _axisX, _axisY, _axisZ, _cutoff;
+public:
+	MeshletCuller(const std::vector<Meshlet>& meshlets);
+
+	// Removes meshlets outside the frustum and meshlets whose triangles all face away from the camera,
+	// neighbouring visible meshlets are merged into a single range. firstIndex is where the meshlet indices
+	// start in the bound index buffer, the offsets include it.
+	void Cull(const glm::mat4& model, const Frustum& frustum, const glm::vec3& cameraPosition, MeshletDrawList& drawList,
+		unsigned int firstIndex = 0) const;
+
+	inline unsigned int GetMeshletCount() const { return (unsigned int)_meshlets.size(); };
+};
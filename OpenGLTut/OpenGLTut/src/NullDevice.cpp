@@ -0,0 +1,317 @@
+#include "NullDevice.h"
+#include "Utils.h"
+#include <iostream>
+
+NullDevice::NullDevice() : _nextName(1), _program(0), _vertexArray(0), _calls(), _errors(0), _uploadedBytes(0)
+{
+}
+
+bool NullDevice::Check(bool condition, DeviceCall call, const char* message)
+{
+	if (condition)
+		return true;
+	if (_errors++ < PRINTED_ERRORS)
+		std::cout << "Null device: " << GetCallName(call) << ": " << message << std::endl;
+	return false;
+}
+
+bool NullDevice::CheckBuffer(unsigned int buffer, DeviceCall call)
+{
+	return Check(_bufferSizes.count(buffer) != 0, call, "unknown buffer");
+}
+
+bool NullDevice::CheckMutable(unsigned int buffer, DeviceCall call)
+{
+	return Check(_staticBuffers.count(buffer) == 0, call, "static buffers are immutable");
+}
+
+void NullDevice::CheckDraw(DeviceCall call, bool indexed)
+{
+	_calls[call]++;
+	if (!Check(_program != 0, call, "no program in use"))
+		return;
+	auto vertexArray = _vertexArrays.find(_vertexArray);
+	if (!Check(vertexArray != _vertexArrays.end(), call, "no vertex array bound"))
+		return;
+	if (indexed)
+		Check(vertexArray->second != 0, call, "the vertex array has no index buffer");
+}
+
+unsigned int NullDevice::CreateBuffer(unsigned int /*target*/, const void* data, unsigned int size, unsigned int usage)
+{
+	_calls[CALL_CREATE_BUFFER]++;
+	if (data)
+		_uploadedBytes += size;
+	unsigned int buffer = _nextName++;
+	_bufferSizes[buffer] = size;
+	if (usage == GL_STATIC_DRAW)
+		_staticBuffers.insert(buffer);
+	return buffer;
+}
+
+void NullDevice::DeleteBuffer(unsigned int buffer)
+{
+	_calls[CALL_DELETE_BUFFER]++;
+	if (CheckBuffer(buffer, CALL_DELETE_BUFFER))
+		_bufferSizes.erase(buffer);
+	_staticBuffers.erase(buffer);
+	for (auto& bound : _boundBuffers)
+	{
+		if (bound.second == buffer)
+			bound.second = 0;
+	}
+}
+
+void NullDevice::BindBuffer(unsigned int target, unsigned int buffer)
+{
+	_calls[CALL_BIND_BUFFER]++;
+	if (buffer == 0 || CheckBuffer(buffer, CALL_BIND_BUFFER))
+		_boundBuffers[target] = buffer;
+}
+
+void NullDevice::BindBufferBase(unsigned int /*target*/, unsigned int /*index*/, unsigned int buffer)
+{
+	_calls[CALL_BIND_BUFFER_BASE]++;
+	CheckBuffer(buffer, CALL_BIND_BUFFER_BASE);
+}
+
+void NullDevice::BindBufferRange(unsigned int target, unsigned int /*index*/, unsigned int buffer, unsigned int offset, unsigned int size)
+{
+	_calls[CALL_BIND_BUFFER_RANGE]++;
+	if (CheckBuffer(buffer, CALL_BIND_BUFFER_RANGE))
+	{
+		Check((unsigned long long)offset + size <= _bufferSizes[buffer], CALL_BIND_BUFFER_RANGE, "range past the end of the buffer");
+		Check(target != GL_UNIFORM_BUFFER || offset % GetUniformBufferOffsetAlignment() == 0, CALL_BIND_BUFFER_RANGE, "misaligned uniform buffer offset");
+	}
+}
+
+void NullDevice::ResizeBuffer(unsigned int /*target*/, unsigned int buffer, unsigned int size, unsigned int /*usage*/)
+{
+	_calls[CALL_RESIZE_BUFFER]++;
+	if (CheckBuffer(buffer, CALL_RESIZE_BUFFER) && CheckMutable(buffer, CALL_RESIZE_BUFFER))
+		_bufferSizes[buffer] = size;
+}
+
+void NullDevice::UpdateBuffer(unsigned int /*target*/, unsigned int buffer, unsigned int offset, unsigned int size, const void* /*data*/)
+{
+	_calls[CALL_UPDATE_BUFFER]++;
+	_uploadedBytes += size;
+	if (CheckBuffer(buffer, CALL_UPDATE_BUFFER) && CheckMutable(buffer, CALL_UPDATE_BUFFER))
+		Check((unsigned long long)offset + size <= _bufferSizes[buffer], CALL_UPDATE_BUFFER, "write past the end of the buffer");
+}
+
+void NullDevice::ClearBuffer(unsigned int /*target*/, unsigned int buffer)
+{
+	_calls[CALL_CLEAR_BUFFER]++;
+	if (CheckBuffer(buffer, CALL_CLEAR_BUFFER))
+		CheckMutable(buffer, CALL_CLEAR_BUFFER);
+}
+
+unsigned int NullDevice::CreateVertexArray()
+{
+	_calls[CALL_CREATE_VERTEX_ARRAY]++;
+	unsigned int vertexArray = _nextName++;
+	_vertexArrays[vertexArray] = 0;
+	return vertexArray;
+}
+
+void NullDevice::DeleteVertexArray(unsigned int vertexArray)
+{
+	_calls[CALL_DELETE_VERTEX_ARRAY]++;
+	if (Check(_vertexArrays.erase(vertexArray) != 0, CALL_DELETE_VERTEX_ARRAY, "unknown vertex array") && _vertexArray == vertexArray)
+		_vertexArray = 0;
+}
+
+void NullDevice::BindVertexArray(unsigned int vertexArray)
+{
+	_calls[CALL_BIND_VERTEX_ARRAY]++;
+	if (vertexArray == 0 || Check(_vertexArrays.count(vertexArray) != 0, CALL_BIND_VERTEX_ARRAY, "unknown vertex array"))
+		_vertexArray = vertexArray;
+}
+
+void NullDevice::SetVertexAttributes(unsigned int vertexArray, unsigned int buffer, const VertexAttribute* attributes, unsigned int count)
+{
+	_calls[CALL_SET_VERTEX_ATTRIBUTES]++;
+	Check(_vertexArrays.count(vertexArray) != 0, CALL_SET_VERTEX_ATTRIBUTES, "unknown vertex array");
+	CheckBuffer(buffer, CALL_SET_VERTEX_ATTRIBUTES);
+	for (unsigned int i = 0; i < count; i++)
+		Check(attributes[i].count >= 1 && attributes[i].count <= 4, CALL_SET_VERTEX_ATTRIBUTES, "attributes have 1 to 4 components");
+}
+
+void NullDevice::SetIndexBuffer(unsigned int vertexArray, unsigned int buffer)
+{
+	_calls[CALL_SET_INDEX_BUFFER]++;
+	auto found = _vertexArrays.find(vertexArray);
+	if (Check(found != _vertexArrays.end(), CALL_SET_INDEX_BUFFER, "unknown vertex array") && CheckBuffer(buffer, CALL_SET_INDEX_BUFFER))
+		found->second = buffer;
+}
+
+void NullDevice::SetVertexFormat(unsigned int vertexArray, unsigned int /*binding*/, const VertexAttribute* attributes, unsigned int count)
+{
+	_calls[CALL_SET_VERTEX_FORMAT]++;
+	Check(_vertexArrays.count(vertexArray) != 0, CALL_SET_VERTEX_FORMAT, "unknown vertex array");
+	for (unsigned int i = 0; i < count; i++)
+		Check(attributes[i].count >= 1 && attributes[i].count <= 4, CALL_SET_VERTEX_FORMAT, "attributes have 1 to 4 components");
+}
+
+void NullDevice::SetVertexBuffer(unsigned int vertexArray, unsigned int /*binding*/, unsigned int buffer, unsigned int offset, unsigned int /*stride*/)
+{
+	_calls[CALL_SET_VERTEX_BUFFER]++;
+	Check(_vertexArrays.count(vertexArray) != 0, CALL_SET_VERTEX_BUFFER, "unknown vertex array");
+	if (CheckBuffer(buffer, CALL_SET_VERTEX_BUFFER))
+		Check(offset < _bufferSizes[buffer], CALL_SET_VERTEX_BUFFER, "offset past the end of the buffer");
+}
+
+unsigned int NullDevice::CreateTexture2D(const void* /*pixels*/, int width, int height, int channels)
+{
+	_calls[CALL_CREATE_TEXTURE]++;
+	Check(width > 0 && height > 0 && (channels == 3 || channels == 4), CALL_CREATE_TEXTURE, "invalid size or channel count");
+	_uploadedBytes += (unsigned long long)width * height * channels;
+	unsigned int texture = _nextName++;
+	_textures.insert(texture);
+	return texture;
+}
+
+void NullDevice::DeleteTexture(unsigned int texture)
+{
+	_calls[CALL_DELETE_TEXTURE]++;
+	Check(_textures.erase(texture) != 0, CALL_DELETE_TEXTURE, "unknown texture");
+}
+
+void NullDevice::BindTextures(unsigned int first, const unsigned int* textures, unsigned int count)
+{
+	_calls[CALL_BIND_TEXTURES]++;
+	Check(first + count <= TEXTURE_UNITS, CALL_BIND_TEXTURES, "texture unit out of range");
+	for (unsigned int i = 0; textures && i < count; i++)
+		Check(textures[i] == 0 || _textures.count(textures[i]) != 0, CALL_BIND_TEXTURES, "unknown texture");
+}
+
+unsigned int NullDevice::CreateSampler(const SamplerDesc& /*desc*/)
+{
+	_calls[CALL_CREATE_SAMPLER]++;
+	unsigned int sampler = _nextName++;
+	_samplers.insert(sampler);
+	return sampler;
+}
+
+void NullDevice::DeleteSampler(unsigned int sampler)
+{
+	_calls[CALL_DELETE_SAMPLER]++;
+	Check(_samplers.erase(sampler) != 0, CALL_DELETE_SAMPLER, "unknown sampler");
+}
+
+void NullDevice::BindSamplers(unsigned int first, const unsigned int* samplers, unsigned int count)
+{
+	_calls[CALL_BIND_SAMPLERS]++;
+	Check(first + count <= TEXTURE_UNITS, CALL_BIND_SAMPLERS, "texture unit out of range");
+	for (unsigned int i = 0; samplers && i < count; i++)
+		Check(samplers[i] == 0 || _samplers.count(samplers[i]) != 0, CALL_BIND_SAMPLERS, "unknown sampler");
+}
+
+unsigned int NullDevice::CreateProgram(const std::string& vertexSource, const std::string& fragmentSource, const std::string& computeSource)
+{
+	_calls[CALL_CREATE_PROGRAM]++;
+	// Like a failed compile in GL, a program without stages is 0
+	if (!Check(!computeSource.empty() || (!vertexSource.empty() && !fragmentSource.empty()), CALL_CREATE_PROGRAM, "missing shader stages"))
+		return 0;
+	unsigned int program = _nextName++;
+	_programs.insert(program);
+	return program;
+}
+
+void NullDevice::DeleteProgram(unsigned int program)
+{
+	_calls[CALL_DELETE_PROGRAM]++;
+	if (Check(_programs.erase(program) != 0, CALL_DELETE_PROGRAM, "unknown program") && _program == program)
+		_program = 0;
+}
+
+void NullDevice::UseProgram(unsigned int program)
+{
+	_calls[CALL_USE_PROGRAM]++;
+	if (program == 0 || Check(_programs.count(program) != 0, CALL_USE_PROGRAM, "unknown program"))
+		_program = program;
+}
+
+void NullDevice::SetUniform(unsigned int program, const std::string& /*name*/, UniformType /*type*/, const void* values, int count)
+{
+	_calls[CALL_SET_UNIFORM]++;
+	Check(_programs.count(program) != 0, CALL_SET_UNIFORM, "unknown program");
+	Check(values != nullptr && count > 0, CALL_SET_UNIFORM, "no values");
+}
+
+void NullDevice::SetUniformBlockBinding(unsigned int program, const std::string& /*name*/, unsigned int /*binding*/)
+{
+	_calls[CALL_SET_UNIFORM_BLOCK_BINDING]++;
+	Check(_programs.count(program) != 0, CALL_SET_UNIFORM_BLOCK_BINDING, "unknown program");
+}
+
+void NullDevice::DrawElements(unsigned int /*count*/, unsigned int /*first*/)
+{
+	CheckDraw(CALL_DRAW_ELEMENTS, true);
+}
+
+void NullDevice::DrawArrays(unsigned int /*count*/, unsigned int /*first*/)
+{
+	CheckDraw(CALL_DRAW_ARRAYS, false);
+}
+
+void NullDevice::MultiDrawElements(const int* /*counts*/, const void* const* /*offsets*/, unsigned int /*drawCount*/)
+{
+	CheckDraw(CALL_MULTI_DRAW_ELEMENTS, true);
+}
+
+void NullDevice::MultiDrawElementsIndirect(unsigned int /*drawCount*/, unsigned int /*stride*/)
+{
+	CheckDraw(CALL_MULTI_DRAW_INDIRECT, true);
+	Check(_boundBuffers[GL_DRAW_INDIRECT_BUFFER] != 0, CALL_MULTI_DRAW_INDIRECT, "no indirect buffer bound");
+}
+
+void NullDevice::MultiDrawElementsIndirectCount(unsigned int /*maxDrawCount*/, unsigned int /*stride*/)
+{
+	CheckDraw(CALL_MULTI_DRAW_INDIRECT_COUNT, true);
+	Check(_boundBuffers[GL_DRAW_INDIRECT_BUFFER] != 0, CALL_MULTI_DRAW_INDIRECT_COUNT, "no indirect buffer bound");
+	Check(_boundBuffers[GL_PARAMETER_BUFFER_ARB] != 0, CALL_MULTI_DRAW_INDIRECT_COUNT, "no parameter buffer bound");
+}
+
+void NullDevice::Clear(unsigned int /*mask*/)
+{
+	_calls[CALL_CLEAR]++;
+}
+
+void NullDevice::Enable(unsigned int /*capability*/)
+{
+	_calls[CALL_ENABLE]++;
+}
+
+void NullDevice::Disable(unsigned int /*capability*/)
+{
+	_calls[CALL_DISABLE]++;
+}
+
+void NullDevice::Flush()
+{
+	_calls[CALL_FLUSH]++;
+}
+
+void NullDevice::SetRenderState(const RenderState& /*state*/, unsigned int groups)
+{
+	_calls[CALL_SET_RENDER_STATE]++;
+	Check(groups != 0 && (groups & ~(unsigned int)RENDER_STATE_ALL) == 0, CALL_SET_RENDER_STATE, "invalid state groups");
+}
+
+void NullDevice::Barrier(unsigned int barriers)
+{
+	_calls[CALL_BARRIER]++;
+	Check(barriers != 0, CALL_BARRIER, "no barrier bits");
+}
+
+void NullDevice::PrintCounts(std::ostream& stream) const
+{
+	for (int call = 0; call < DEVICE_CALL_COUNT; call++)
+	{
+		if (_calls[call] > 0)
+			stream << "  " << GetCallName((DeviceCall)call) << ": " << _calls[call] << std::endl;
+	}
+	stream << "  errors: " << _errors << std::endl;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "RenderDevice.h"
+#include <ostream>
+#include <unordered_map>
+#include <unordered_set>
+
+// Backend without GL. It hands out names, keeps just enough state to catch what GL would reject
+// (unknown or deleted objects, draws without a program or vertex array, indexed draws without an
+// index buffer, buffer writes out of range or into immutable static buffers, units past the fragment shader's
+// 16) and counts every call. Errors are counted and the first few are printed.
+class NullDevice : public RenderDevice
+{
+public:
+	static const unsigned int PRINTED_ERRORS = 16;
+	// Texture units GL 3.3 guarantees to a fragment shader
+	static const unsigned int TEXTURE_UNITS = 16;
+private:
+	unsigned int _nextName;
+	std::unordered_map<unsigned int, unsigned int> _bufferSizes;
+	// GL_STATIC_DRAW buffers, the GL 4.5 device gives them immutable storage
+	std::unordered_set<unsigned int> _staticBuffers;
+	// Vertex array -> its index buffer, 0 until one is set
+	std::unordered_map<unsigned int, unsigned int> _vertexArrays;
+	std::unordered_set<unsigned int> _textures;
+	std::unordered_set<unsigned int> _samplers;
+	std::unordered_set<unsigned int> _programs;
+	// Target -> bound buffer
+	std::unordered_map<unsigned int, unsigned int> _boundBuffers;
+	unsigned int _program;
+	unsigned int _vertexArray;
+
+	unsigned long long _calls[DEVICE_CALL_COUNT];
+	unsigned long long _errors;
+	unsigned long long _uploadedBytes;
+
+	bool Check(bool condition, DeviceCall call, const char* message);
+	bool CheckBuffer(unsigned int buffer, DeviceCall call);
+	bool CheckMutable(unsigned int buffer, DeviceCall call);
+	void CheckDraw(DeviceCall call, bool indexed);
+public:
+	NullDevice();
+
+	RenderBackend GetBackend() const override { return BACKEND_NULL; };
+	const char* GetName() const override { return "Null"; };
+
+	unsigned int CreateBuffer(unsigned int target, const void* data, unsigned int size, unsigned int usage) override;
+	void DeleteBuffer(unsigned int buffer) override;
+	void BindBuffer(unsigned int target, unsigned int buffer) override;
+	void BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer) override;
+	void BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, unsigned int offset, unsigned int size) override;
+	void ResizeBuffer(unsigned int target, unsigned int buffer, unsigned int size, unsigned int usage) override;
+	void UpdateBuffer(unsigned int target, unsigned int buffer, unsigned int offset, unsigned int size, const void* data) override;
+	void ClearBuffer(unsigned int target, unsigned int buffer) override;
+
+	unsigned int CreateVertexArray() override;
+	void DeleteVertexArray(unsigned int vertexArray) override;
+	void BindVertexArray(unsigned int vertexArray) override;
+	void SetVertexAttributes(unsigned int vertexArray, unsigned int buffer, const VertexAttribute* attributes, unsigned int count) override;
+	void SetIndexBuffer(unsigned int vertexArray, unsigned int buffer) override;
+	void SetVertexFormat(unsigned int vertexArray, unsigned int binding, const VertexAttribute* attributes, unsigned int count) override;
+	void SetVertexBuffer(unsigned int vertexArray, unsigned int binding, unsigned int buffer, unsigned int offset, unsigned int stride) override;
+
+	unsigned int CreateTexture2D(const void* pixels, int width, int height, int channels) override;
+	void DeleteTexture(unsigned int texture) override;
+	void BindTextures(unsigned int first, const unsigned int* textures, unsigned int count) override;
+
+	unsigned int CreateSampler(const SamplerDesc& desc) override;
+	void DeleteSampler(unsigned int sampler) override;
+	void BindSamplers(unsigned int first, const unsigned int* samplers, unsigned int count) override;
+
+	unsigned int CreateProgram(const std::string& vertexSource, const std::string& fragmentSource, const std::string& computeSource) override;
+	void DeleteProgram(unsigned int program) override;
+	void UseProgram(unsigned int program) override;
+	void SetUniform(unsigned int program, const std::string& name, UniformType type, const void* values, int count) override;
+	void SetUniformBlockBinding(unsigned int program, const std::string& name, unsigned int binding) override;
+
+	void DrawElements(unsigned int count, unsigned int first) override;
+	void DrawArrays(unsigned int count, unsigned int first) override;
+	void MultiDrawElements(const int* counts, const void* const* offsets, unsigned int drawCount) override;
+	void MultiDrawElementsIndirect(unsigned int drawCount, unsigned int stride) override;
+	void MultiDrawElementsIndirectCount(unsigned int maxDrawCount, unsigned int stride) override;
+
+	void Clear(unsigned int mask) override;
+	void Enable(unsigned int capability) override;
+	void Disable(unsigned int capability) override;
+	void Flush() override;
+	void SetRenderState(const RenderState& state, unsigned int groups) override;
+	void Barrier(unsigned int barriers) override;
+
+	unsigned int GetUniformBufferOffsetAlignment() override { return 256; };
+
+	inline unsigned long long GetCallCount(DeviceCall call) const { return _calls[call]; };
+	inline unsigned long long GetErrorCount() const { return _errors; };
+	inline unsigned long long GetUploadedBytes() const { return _uploadedBytes; };
+	// Every call made at least once with its count, then the error count
+	void PrintCounts(std::ostream& stream) const;
+};
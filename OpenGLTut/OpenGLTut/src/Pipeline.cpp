@@ -0,0 +1,93 @@
+#include "Pipeline.h"
+#include "RenderStats.h"
+
+std::unordered_map<unsigned long long, std::vector<std::unique_ptr<Pipeline>>> Pipeline::s_pipelines;
+const Pipeline* Pipeline::s_bound = nullptr;
+RenderDevice* Pipeline::s_boundDevice = nullptr;
+bool Pipeline::s_bindingsValid = false;
+
+bool PipelineDesc::operator==(const PipelineDesc& other) const
+{
+	return shader == other.shader && vertexFormat == other.vertexFormat && state.Diff(other.state) == 0;
+}
+
+unsigned long long Pipeline::Hash(const PipelineDesc& desc)
+{
+	// Field by field, the padding inside RenderState is never read
+	const RenderState& s = desc.state;
+	unsigned long long words[] = { (unsigned long long)(size_t)desc.shader, (unsigned long long)(size_t)desc.vertexFormat,
+		s.depthTest, s.depthWrite, s.depthFunc, s.blend, s.blendSource, s.blendDestination, s.blendEquation,
+		s.cullFace, s.cullMode, s.frontFace, s.polygonMode, s.stencilTest, s.stencilFunc, s.stencilReference,
+		s.stencilReadMask, s.stencilWriteMask, s.stencilFail, s.stencilDepthFail, s.stencilPass };
+	// FNV-1a over the words, equal hashes are still compared field by field
+	unsigned long long hash = 14695981039346656037ull;
+	for (unsigned long long word : words)
+	{
+		hash ^= word;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+const Pipeline* Pipeline::Create(const PipelineDesc& desc)
+{
+	unsigned long long hash = Hash(desc);
+	std::vector<std::unique_ptr<Pipeline>>& bucket = s_pipelines[hash];
+	for (const std::unique_ptr<Pipeline>& pipeline : bucket)
+	{
+		if (pipeline->_desc == desc)
+			return pipeline.get();
+	}
+	bucket.emplace_back(new Pipeline(desc, hash));
+	return bucket.back().get();
+}
+
+void Pipeline::ReleaseAll()
+{
+	s_pipelines.clear();
+	Invalidate();
+}
+
+unsigned int Pipeline::GetCount()
+{
+	unsigned int count = 0;
+	for (const auto& bucket : s_pipelines)
+		count += (unsigned int)bucket.second.size();
+	return count;
+}
+
+void Pipeline::Bind() const
+{
+	RenderDevice& device = RenderDevice::Get();
+	const Pipeline* previous = &device == s_boundDevice ? s_bound : nullptr;
+	if (previous == this && s_bindingsValid)
+		return;
+
+	unsigned int groups = previous ? _desc.state.Diff(previous->_desc.state) : (unsigned int)RENDER_STATE_ALL;
+	if (groups)
+	{
+		RenderStats::CountStateChange(STATE_RENDER);
+		device.SetRenderState(_desc.state, groups);
+	}
+	bool rebind = !previous || !s_bindingsValid;
+	if (_desc.shader && (rebind || previous->_desc.shader != _desc.shader))
+		_desc.shader->Bind();
+	if (_desc.vertexFormat && (rebind || previous->_desc.vertexFormat != _desc.vertexFormat))
+		_desc.vertexFormat->Bind();
+
+	s_bound = this;
+	s_boundDevice = &device;
+	s_bindingsValid = true;
+}
+
+void Pipeline::InvalidateBindings()
+{
+	s_bindingsValid = false;
+}
+
+void Pipeline::Invalidate()
+{
+	s_bound = nullptr;
+	s_boundDevice = nullptr;
+	s_bindingsValid = false;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "RenderDevice.h"
+#include "Shader.h"
+#include "VertexArray.h"
+
+// What a pipeline is made of
+struct PipelineDesc
+{
+	Shader* shader;
+	// Vertex array that carries the vertex format (see VertexArray::SetFormat) and is bound with the pipeline,
+	// nullptr when every draw brings its own vertex array
+	VertexArray* vertexFormat;
+	RenderState state;
+
+	PipelineDesc(Shader* shader = nullptr, VertexArray* vertexFormat = nullptr)
+		: shader(shader), vertexFormat(vertexFormat), state(RenderState::Default()) {};
+	bool operator==(const PipelineDesc& other) const;
+};
+
+// Shader, vertex format and fixed function state bundled into one immutable object. Pipelines are hashed and
+// interned when created, equal descriptions give the same pipeline, so comparing pointers compares pipelines.
+// Binding one only applies what differs from the pipeline bound before it, draws sorted by pipeline change
+// as little state as possible. Like the device a pipeline is only bound by the thread that owns the context.
+class Pipeline
+{
+private:
+	PipelineDesc _desc;
+	unsigned long long _hash;
+
+	static std::unordered_map<unsigned long long, std::vector<std::unique_ptr<Pipeline>>> s_pipelines;
+	static const Pipeline* s_bound;
+	// Device s_bound was bound on, another device starts from unknown state
+	static RenderDevice* s_boundDevice;
+	static bool s_bindingsValid;
+
+	Pipeline(const PipelineDesc& desc, unsigned long long hash) : _desc(desc), _hash(hash) {};
+	static unsigned long long Hash(const PipelineDesc& desc);
+public:
+	// The interned pipeline for desc, created on first use and kept until ReleaseAll
+	static const Pipeline* Create(const PipelineDesc& desc);
+	// Deletes every pipeline, the shaders and vertex arrays they point to are not owned and stay
+	static void ReleaseAll();
+	static unsigned int GetCount();
+
+	void Bind() const;
+	// Shaders and vertex arrays bound directly (to set uniforms, by ImGui or passes without a pipeline) leave the
+	// tracked ones stale. The next Bind rebinds them, fixed function state is still only applied where it differs.
+	static void InvalidateBindings();
+	// Forgets everything, the next Bind applies its whole state
+	static void Invalidate();
+
+	inline const PipelineDesc& GetDesc() const { return _desc; };
+	inline Shader* GetShader() const { return _desc.shader; };
+	inline VertexArray* GetVertexFormat() const { return _desc.vertexFormat; };
+	inline unsigned long long GetHash() const { return _hash; };
+};
@@ -0,0 +1,76 @@
+#include "PostProcess.h"
+#include "Utils.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include "SamplerCache.h"
+#include <algorithm>
+
+PostProcessChain::PostProcessChain()
+{
+	SamplerDesc desc = SamplerDesc::Default();
+	desc.minFilter = GL_LINEAR;
+	desc.magFilter = GL_LINEAR;
+	desc.wrapS = GL_CLAMP_TO_EDGE;
+	desc.wrapT = GL_CLAMP_TO_EDGE;
+	_sampler = SamplerCache::Get(desc);
+}
+
+unsigned int PostProcessChain::AddPass(const char* name, Shader* shader, PostProcessScale scale, FramebufferFormat format)
+{
+	PipelineDesc desc(shader, &_emptyVertexArray);
+	desc.state.depthTest = false;
+	desc.state.depthWrite = false;
+	_passes.push_back({ name, Pipeline::Create(desc), scale, format, glm::vec4(0.0f) });
+	return (unsigned int)_passes.size() - 1;
+}
+
+void PostProcessChain::AddToGraph(RenderGraph& graph, RenderGraphResource source, RenderGraphResource destination) const
+{
+	ASSERT(!_passes.empty());
+	const FramebufferDesc& sourceDesc = graph.GetDesc(source);
+	RenderGraphResource input = source;
+	for (size_t i = 0; i < _passes.size(); i++)
+	{
+		const Pass& pass = _passes[i];
+		RenderGraphResource output = destination;
+		if (i + 1 < _passes.size())
+		{
+			output = graph.CreateTexture(pass.name, FramebufferDesc(std::max(1u, sourceDesc.width / pass.scale),
+				std::max(1u, sourceDesc.height / pass.scale), pass.format, false));
+		}
+
+		unsigned int graphPass = graph.AddPass(pass.name, [this, &pass, input, source, output](const RenderGraphContext& context)
+		{
+			context.BindTarget(output);
+			Draw(pass, context, input, source);
+		});
+		graph.Read(graphPass, input);
+		if (input != source)
+			graph.Read(graphPass, source);
+		graph.Write(graphPass, output);
+		input = output;
+	}
+}
+
+void PostProcessChain::Draw(const Pass& pass, const RenderGraphContext& context, RenderGraphResource input, RenderGraphResource source) const
+{
+	RenderDevice& device = RenderDevice::Get();
+	unsigned int samplers[] = { _sampler, _sampler };
+	device.BindSamplers(0, samplers, 2);
+	unsigned int textures[] = { context.GetTexture(input), context.GetTexture(source) };
+	device.BindTextures(0, textures, 2);
+
+	pass.pipeline->Bind();
+	Shader* shader = pass.pipeline->GetShader();
+	const FramebufferDesc& inputDesc = context.GetDesc(input);
+	shader->SetUniform1i("u_source", 0);
+	shader->SetUniform1i("u_scene", 1);
+	shader->SetUniform2f("u_texelSize", 1.0f / inputDesc.width, 1.0f / inputDesc.height);
+	shader->SetUniform4f("u_parameters", pass.parameters.x, pass.parameters.y, pass.parameters.z, pass.parameters.w);
+	device.DrawArrays(3, 0);
+	RenderStats::CountDraw(1);
+
+	// Meshes drawn later expect their own samplers, or none
+	unsigned int noSamplers[] = { 0, 0 };
+	device.BindSamplers(0, noSamplers, 2);
+}
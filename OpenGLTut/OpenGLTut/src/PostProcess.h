@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+#include <glm/ext/vector_float4.hpp>
+#include "Framebuffer.h"
+#include "Pipeline.h"
+#include "RenderGraph.h"
+#include "Shader.h"
+#include "VertexArray.h"
+
+// Resolution of a pass as a divisor of the chain's source
+enum PostProcessScale { POST_PROCESS_FULL = 1, POST_PROCESS_HALF = 2, POST_PROCESS_QUARTER = 4 };
+
+// Fullscreen passes run one after another on an image. Every pass draws a triangle covering its target and
+// samples the previous pass's output as u_source (unit 0) and the chain's source as u_scene (unit 1),
+// u_texelSize is the size of one u_source texel and u_parameters is free for the pass. The passes go into
+// a render graph with a transient texture for every intermediate output, the graph frees each one once the
+// next pass has read it, so passes of the same size and format ping-pong between two targets. The last
+// pass writes to the destination.
+class PostProcessChain
+{
+private:
+	struct Pass
+	{
+		// GPU timer scope of the pass, kept as a pointer
+		const char* name;
+		const Pipeline* pipeline;
+		PostProcessScale scale;
+		FramebufferFormat format;
+		glm::vec4 parameters;
+	};
+	std::vector<Pass> _passes;
+	// The triangle's corners come from gl_VertexID, GL core still wants a vertex array bound to draw
+	VertexArray _emptyVertexArray;
+	// Linear and clamped, the pipelines don't know the samplers meshes left bound
+	unsigned int _sampler;
+
+	void Draw(const Pass& pass, const RenderGraphContext& context, RenderGraphResource input, RenderGraphResource source) const;
+public:
+	PostProcessChain();
+	PostProcessChain(const PostProcessChain&) = delete;
+	PostProcessChain& operator=(const PostProcessChain&) = delete;
+
+	// The shader has to stay alive as long as the chain. scale and format are ignored for the last pass.
+	unsigned int AddPass(const char* name, Shader* shader, PostProcessScale scale, FramebufferFormat format = FRAMEBUFFER_RGBA16F);
+	inline void SetParameters(unsigned int pass, const glm::vec4& parameters) { _passes[pass].parameters = parameters; };
+
+	// Adds every pass to the graph, the first one reads source and the last one writes destination.
+	// Intermediate sizes are fractions of the source's.
+	void AddToGraph(RenderGraph& graph, RenderGraphResource source, RenderGraphResource destination) const;
+
+	inline unsigned int GetPassCount() const { return (unsigned int)_passes.size(); };
+};
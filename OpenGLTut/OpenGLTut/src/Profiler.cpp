@@ -0,0 +1,114 @@
+#include "Profiler.h"
+
+#ifdef PROFILING_ENABLED
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+std::mutex Profiler::s_mutex;
+std::vector<std::unique_ptr<ProfileThreadBuffer>> Profiler::s_buffers;
+
+ProfileThreadBuffer::ProfileThreadBuffer(unsigned int threadID)
+	: _events(new ProfileEvent[CAPACITY]), _written(0), _name(nullptr), _threadID(threadID)
+{
+}
+
+void ProfileThreadBuffer::Read(std::vector<ProfileEvent>& events) const
+{
+	unsigned long long end = _written.load(std::memory_order_acquire);
+	unsigned long long begin = end > CAPACITY ? end - CAPACITY : 0;
+	size_t first = events.size();
+	for (unsigned long long i = begin; i < end; i++)
+		events.push_back(_events[i & (CAPACITY - 1)]);
+
+	// The owner kept writing meanwhile, the slots it reached (and the one it may be writing right now)
+	// hold newer or half written events
+	unsigned long long written = _written.load(std::memory_order_acquire);
+	unsigned long long valid = written + 1 > CAPACITY ? written + 1 - CAPACITY : 0;
+	if (valid > begin)
+		events.erase(events.begin() + first, events.begin() + first + (size_t)std::min(valid - begin, end - begin));
+}
+
+unsigned long long Profiler::Now()
+{
+	return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ProfileThreadBuffer* Profiler::RegisterThread()
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+	s_buffers.emplace_back(new ProfileThreadBuffer((unsigned int)s_buffers.size() + 1));
+	return s_buffers.back().get();
+}
+
+// Scope names are literals from our own code, only quotes and backslashes need escaping
+static void WriteJsonString(std::ostream& stream, const char* text)
+{
+	stream << '"';
+	for (const char* c = text; *c; c++)
+	{
+		if (*c == '"' || *c == '\\')
+			stream << '\\';
+		stream << *c;
+	}
+	stream << '"';
+}
+
+bool Profiler::ExportChromeTrace(const std::string& filePath)
+{
+	std::ofstream file(filePath);
+	if (!file)
+	{
+		std::cout << "Could not write " << filePath << std::endl;
+		return false;
+	}
+
+	std::vector<ProfileThreadBuffer*> buffers;
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		for (const auto& buffer : s_buffers)
+			buffers.push_back(buffer.get());
+	}
+
+	// Timestamps are relative to the oldest event, the trace format uses microseconds
+	std::vector<std::vector<ProfileEvent>> events(buffers.size());
+	unsigned long long origin = ~0ull;
+	for (size_t i = 0; i < buffers.size(); i++)
+	{
+		buffers[i]->Read(events[i]);
+		for (const ProfileEvent& event : events[i])
+			origin = std::min(origin, event.begin);
+	}
+
+	file << std::fixed << std::setprecision(3);
+	file << "{\"traceEvents\":[";
+	bool first = true;
+	for (size_t i = 0; i < buffers.size(); i++)
+	{
+		unsigned int tid = buffers[i]->GetThreadID();
+		if (buffers[i]->GetName())
+		{
+			file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid << ",\"args\":{\"name\":";
+			WriteJsonString(file, buffers[i]->GetName());
+			file << "}}";
+			first = false;
+		}
+		for (const ProfileEvent& event : events[i])
+		{
+			file << (first ? "" : ",") << "\n{\"name\":";
+			WriteJsonString(file, event.name);
+			file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+				<< ",\"ts\":" << (double)(event.begin - origin) / 1000.0
+				<< ",\"dur\":" << (double)(event.end - event.begin) / 1000.0 << "}";
+			first = false;
+		}
+	}
+	file << "\n],\"displayTimeUnit\":\"ms\"}" << std::endl;
+	return true;
+}
+
+#endif
@@ -0,0 +1,98 @@
+#pragma once
+
+// CPU instrumentation, PROFILE_SCOPE("Name") times the enclosing C++ scope on the calling thread.
+// Without PROFILING_ENABLED the macros expand to nothing and none of this is compiled in.
+#ifdef PROFILING_ENABLED
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct ProfileEvent
+{
+	// Names are kept as pointers, use string literals
+	const char* name;
+	unsigned long long begin;
+	unsigned long long end;
+};
+
+// Events of one thread. Only the owning thread writes, so recording needs no lock; once full the
+// oldest events are overwritten.
+class ProfileThreadBuffer
+{
+public:
+	static const unsigned int CAPACITY = 1 << 16;
+private:
+	std::unique_ptr<ProfileEvent[]> _events;
+	std::atomic<unsigned long long> _written;
+	const char* _name;
+	unsigned int _threadID;
+public:
+	ProfileThreadBuffer(unsigned int threadID);
+
+	inline void Record(const char* name, unsigned long long begin, unsigned long long end)
+	{
+		unsigned long long index = _written.load(std::memory_order_relaxed);
+		_events[index & (CAPACITY - 1)] = { name, begin, end };
+		_written.store(index + 1, std::memory_order_release);
+	};
+
+	// Copies the newest events, ones that are being overwritten while copying are left out
+	void Read(std::vector<ProfileEvent>& events) const;
+
+	inline void SetName(const char* name) { _name = name; };
+	inline const char* GetName() const { return _name; };
+	inline unsigned int GetThreadID() const { return _threadID; };
+};
+
+class Profiler
+{
+private:
+	static std::mutex s_mutex;
+	static std::vector<std::unique_ptr<ProfileThreadBuffer>> s_buffers;
+
+	static ProfileThreadBuffer* RegisterThread();
+public:
+	// Nanoseconds on a monotonic clock
+	static unsigned long long Now();
+
+	static inline ProfileThreadBuffer& GetThreadBuffer()
+	{
+		// Buffers are never freed, threads that exit keep their events for the next export
+		static thread_local ProfileThreadBuffer* buffer = RegisterThread();
+		return *buffer;
+	};
+
+	// Writes Chrome trace_event JSON, open it in Perfetto or chrome://tracing
+	static bool ExportChromeTrace(const std::string& filePath);
+};
+
+class ProfileScope
+{
+private:
+	const char* _name;
+	unsigned long long _begin;
+public:
+	inline ProfileScope(const char* name) : _name(name), _begin(Profiler::Now()) {};
+	inline ~ProfileScope() { Profiler::GetThreadBuffer().Record(_name, _begin, Profiler::Now()); };
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+#define PROFILE_THREAD(name) Profiler::GetThreadBuffer().SetName(name)
+#define PROFILE_EXPORT(filePath) Profiler::ExportChromeTrace(filePath)
+
+#else
+
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_THREAD(name)
+#define PROFILE_EXPORT(filePath) false
+
+#endif
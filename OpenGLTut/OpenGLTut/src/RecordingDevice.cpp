@@ -0,0 +1,248 @@
+#include "RecordingDevice.h"
+#include "NullDevice.h"
+
+RecordingDevice::RecordingDevice(RenderDevice* target) : _target(target)
+{
+	if (!_target)
+	{
+		_ownedTarget.reset(new NullDevice());
+		_target = _ownedTarget.get();
+	}
+}
+
+unsigned int RecordingDevice::CreateBuffer(unsigned int target, const void* data, unsigned int size, unsigned int usage)
+{
+	unsigned int buffer = _target->CreateBuffer(target, data, size, usage);
+	Record(CALL_CREATE_BUFFER, buffer, target, size, usage);
+	return buffer;
+}
+
+void RecordingDevice::DeleteBuffer(unsigned int buffer)
+{
+	Record(CALL_DELETE_BUFFER, buffer);
+	_target->DeleteBuffer(buffer);
+}
+
+void RecordingDevice::BindBuffer(unsigned int target, unsigned int buffer)
+{
+	Record(CALL_BIND_BUFFER, buffer, target);
+	_target->BindBuffer(target, buffer);
+}
+
+void RecordingDevice::BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer)
+{
+	Record(CALL_BIND_BUFFER_BASE, buffer, target, index);
+	_target->BindBufferBase(target, index, buffer);
+}
+
+void RecordingDevice::BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, unsigned int offset, unsigned int size)
+{
+	Record(CALL_BIND_BUFFER_RANGE, buffer, index, offset, size);
+	_target->BindBufferRange(target, index, buffer, offset, size);
+}
+
+void RecordingDevice::ResizeBuffer(unsigned int target, unsigned int buffer, unsigned int size, unsigned int usage)
+{
+	Record(CALL_RESIZE_BUFFER, buffer, target, size, usage);
+	_target->ResizeBuffer(target, buffer, size, usage);
+}
+
+void RecordingDevice::UpdateBuffer(unsigned int target, unsigned int buffer, unsigned int offset, unsigned int size, const void* data)
+{
+	Record(CALL_UPDATE_BUFFER, buffer, target, offset, size);
+	_target->UpdateBuffer(target, buffer, offset, size, data);
+}
+
+void RecordingDevice::ClearBuffer(unsigned int target, unsigned int buffer)
+{
+	Record(CALL_CLEAR_BUFFER, buffer, target);
+	_target->ClearBuffer(target, buffer);
+}
+
+unsigned int RecordingDevice::CreateVertexArray()
+{
+	unsigned int vertexArray = _target->CreateVertexArray();
+	Record(CALL_CREATE_VERTEX_ARRAY, vertexArray);
+	return vertexArray;
+}
+
+void RecordingDevice::DeleteVertexArray(unsigned int vertexArray)
+{
+	Record(CALL_DELETE_VERTEX_ARRAY, vertexArray);
+	_target->DeleteVertexArray(vertexArray);
+}
+
+void RecordingDevice::BindVertexArray(unsigned int vertexArray)
+{
+	Record(CALL_BIND_VERTEX_ARRAY, vertexArray);
+	_target->BindVertexArray(vertexArray);
+}
+
+void RecordingDevice::SetVertexAttributes(unsigned int vertexArray, unsigned int buffer, const VertexAttribute* attributes, unsigned int count)
+{
+	Record(CALL_SET_VERTEX_ATTRIBUTES, vertexArray, buffer, count);
+	_target->SetVertexAttributes(vertexArray, buffer, attributes, count);
+}
+
+void RecordingDevice::SetIndexBuffer(unsigned int vertexArray, unsigned int buffer)
+{
+	Record(CALL_SET_INDEX_BUFFER, vertexArray, buffer);
+	_target->SetIndexBuffer(vertexArray, buffer);
+}
+
+void RecordingDevice::SetVertexFormat(unsigned int vertexArray, unsigned int binding, const VertexAttribute* attributes, unsigned int count)
+{
+	Record(CALL_SET_VERTEX_FORMAT, vertexArray, binding, count);
+	_target->SetVertexFormat(vertexArray, binding, attributes, count);
+}
+
+void RecordingDevice::SetVertexBuffer(unsigned int vertexArray, unsigned int binding, unsigned int buffer, unsigned int offset, unsigned int stride)
+{
+	Record(CALL_SET_VERTEX_BUFFER, vertexArray, binding, buffer, offset);
+	_target->SetVertexBuffer(vertexArray, binding, buffer, offset, stride);
+}
+
+unsigned int RecordingDevice::CreateTexture2D(const void* pixels, int width, int height, int channels)
+{
+	unsigned int texture = _target->CreateTexture2D(pixels, width, height, channels);
+	Record(CALL_CREATE_TEXTURE, texture, width, height, channels);
+	return texture;
+}
+
+void RecordingDevice::DeleteTexture(unsigned int texture)
+{
+	Record(CALL_DELETE_TEXTURE, texture);
+	_target->DeleteTexture(texture);
+}
+
+void RecordingDevice::BindTextures(unsigned int first, const unsigned int* textures, unsigned int count)
+{
+	// The object is the texture of the first unit
+	Record(CALL_BIND_TEXTURES, textures && count > 0 ? textures[0] : 0, first, count);
+	_target->BindTextures(first, textures, count);
+}
+
+unsigned int RecordingDevice::CreateSampler(const SamplerDesc& desc)
+{
+	unsigned int sampler = _target->CreateSampler(desc);
+	Record(CALL_CREATE_SAMPLER, sampler, desc.minFilter, desc.magFilter, desc.wrapS);
+	return sampler;
+}
+
+void RecordingDevice::DeleteSampler(unsigned int sampler)
+{
+	Record(CALL_DELETE_SAMPLER, sampler);
+	_target->DeleteSampler(sampler);
+}
+
+void RecordingDevice::BindSamplers(unsigned int first, const unsigned int* samplers, unsigned int count)
+{
+	Record(CALL_BIND_SAMPLERS, samplers && count > 0 ? samplers[0] : 0, first, count);
+	_target->BindSamplers(first, samplers, count);
+}
+
+unsigned int RecordingDevice::CreateProgram(const std::string& vertexSource, const std::string& fragmentSource, const std::string& computeSource)
+{
+	unsigned int program = _target->CreateProgram(vertexSource, fragmentSource, computeSource);
+	Record(CALL_CREATE_PROGRAM, program, !computeSource.empty());
+	return program;
+}
+
+void RecordingDevice::DeleteProgram(unsigned int program)
+{
+	Record(CALL_DELETE_PROGRAM, program);
+	_target->DeleteProgram(program);
+}
+
+void RecordingDevice::UseProgram(unsigned int program)
+{
+	Record(CALL_USE_PROGRAM, program);
+	_target->UseProgram(program);
+}
+
+void RecordingDevice::SetUniform(unsigned int program, const std::string& name, UniformType type, const void* values, int count)
+{
+	Record(CALL_SET_UNIFORM, program, type, count);
+	_target->SetUniform(program, name, type, values, count);
+}
+
+void RecordingDevice::SetUniformBlockBinding(unsigned int program, const std::string& name, unsigned int binding)
+{
+	Record(CALL_SET_UNIFORM_BLOCK_BINDING, program, binding);
+	_target->SetUniformBlockBinding(program, name, binding);
+}
+
+void RecordingDevice::DrawElements(unsigned int count, unsigned int first)
+{
+	Record(CALL_DRAW_ELEMENTS, 0, count, first);
+	_target->DrawElements(count, first);
+}
+
+void RecordingDevice::DrawArrays(unsigned int count, unsigned int first)
+{
+	Record(CALL_DRAW_ARRAYS, 0, count, first);
+	_target->DrawArrays(count, first);
+}
+
+void RecordingDevice::MultiDrawElements(const int* counts, const void* const* offsets, unsigned int drawCount)
+{
+	Record(CALL_MULTI_DRAW_ELEMENTS, 0, drawCount);
+	_target->MultiDrawElements(counts, offsets, drawCount);
+}
+
+void RecordingDevice::MultiDrawElementsIndirect(unsigned int drawCount, unsigned int stride)
+{
+	Record(CALL_MULTI_DRAW_INDIRECT, 0, drawCount, stride);
+	_target->MultiDrawElementsIndirect(drawCount, stride);
+}
+
+void RecordingDevice::MultiDrawElementsIndirectCount(unsigned int maxDrawCount, unsigned int stride)
+{
+	Record(CALL_MULTI_DRAW_INDIRECT_COUNT, 0, maxDrawCount, stride);
+	_target->MultiDrawElementsIndirectCount(maxDrawCount, stride);
+}
+
+void RecordingDevice::Clear(unsigned int mask)
+{
+	Record(CALL_CLEAR, 0, mask);
+	_target->Clear(mask);
+}
+
+void RecordingDevice::Enable(unsigned int capability)
+{
+	Record(CALL_ENABLE, 0, capability);
+	_target->Enable(capability);
+}
+
+void RecordingDevice::Disable(unsigned int capability)
+{
+	Record(CALL_DISABLE, 0, capability);
+	_target->Disable(capability);
+}
+
+void RecordingDevice::Flush()
+{
+	Record(CALL_FLUSH, 0);
+	_target->Flush();
+}
+
+void RecordingDevice::SetRenderState(const RenderState& state, unsigned int groups)
+{
+	Record(CALL_SET_RENDER_STATE, 0, groups);
+	_target->SetRenderState(state, groups);
+}
+
+void RecordingDevice::Barrier(unsigned int barriers)
+{
+	Record(CALL_BARRIER, 0, barriers);
+	_target->Barrier(barriers);
+}
+
+void RecordingDevice::Print(std::ostream& stream) const
+{
+	for (const RecordedCall& call : _calls)
+	{
+		stream << GetCallName(call.call) << " " << call.object << " " << call.arguments[0] << " " << call.arguments[1] << " " << call.arguments[2] << "\n";
+	}
+	stream.flush();
+}
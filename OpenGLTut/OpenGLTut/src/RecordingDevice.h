@@ -0,0 +1,87 @@
+#pragma once
+#include "RenderDevice.h"
+#include <memory>
+#include <ostream>
+#include <vector>
+
+// One logged call. object is the buffer, vertex array, texture, sampler or program the call is about (0 for
+// draws and state), arguments are up to three of its scalar parameters, the ones that tell calls apart.
+struct RecordedCall
+{
+	DeviceCall call;
+	unsigned int object;
+	unsigned int arguments[3];
+};
+
+// Logs every call and forwards it to another device, so the exact sequence the renderer produces for a
+// scene (state changes, draw order, uploads) can be inspected without reading GL traces
+class RecordingDevice : public RenderDevice
+{
+private:
+	std::unique_ptr<RenderDevice> _ownedTarget;
+	RenderDevice* _target;
+	std::vector<RecordedCall> _calls;
+
+	inline void Record(DeviceCall call, unsigned int object, unsigned int a0 = 0, unsigned int a1 = 0, unsigned int a2 = 0)
+	{
+		_calls.push_back({ call, object, { a0, a1, a2 } });
+	};
+public:
+	// target stays owned by the caller, without one the calls go to a NullDevice owned by the recorder
+	RecordingDevice(RenderDevice* target = nullptr);
+
+	RenderBackend GetBackend() const override { return BACKEND_RECORDING; };
+	const char* GetName() const override { return "Recording"; };
+
+	unsigned int CreateBuffer(unsigned int target, const void* data, unsigned int size, unsigned int usage) override;
+	void DeleteBuffer(unsigned int buffer) override;
+	void BindBuffer(unsigned int target, unsigned int buffer) override;
+	void BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer) override;
+	void BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, unsigned int offset, unsigned int size) override;
+	void ResizeBuffer(unsigned int target, unsigned int buffer, unsigned int size, unsigned int usage) override;
+	void UpdateBuffer(unsigned int target, unsigned int buffer, unsigned int offset, unsigned int size, const void* data) override;
+	void ClearBuffer(unsigned int target, unsigned int buffer) override;
+
+	unsigned int CreateVertexArray() override;
+	void DeleteVertexArray(unsigned int vertexArray) override;
+	void BindVertexArray(unsigned int vertexArray) override;
+	void SetVertexAttributes(unsigned int vertexArray, unsigned int buffer, const VertexAttribute* attributes, unsigned int count) override;
+	void SetIndexBuffer(unsigned int vertexArray, unsigned int buffer) override;
+	void SetVertexFormat(unsigned int vertexArray, unsigned int binding, const VertexAttribute* attributes, unsigned int count) override;
+	void SetVertexBuffer(unsigned int vertexArray, unsigned int binding, unsigned int buffer, unsigned int offset, unsigned int stride) override;
+
+	unsigned int CreateTexture2D(const void* pixels, int width, int height, int channels) override;
+	void DeleteTexture(unsigned int texture) override;
+	void BindTextures(unsigned int first, const unsigned int* textures, unsigned int count) override;
+
+	unsigned int CreateSampler(const SamplerDesc& desc) override;
+	void DeleteSampler(unsigned int sampler) override;
+	void BindSamplers(unsigned int first, const unsigned int* samplers, unsigned int count) override;
+
+	unsigned int CreateProgram(const std::string& vertexSource, const std::string& fragmentSource, const std::string& computeSource) override;
+	void DeleteProgram(unsigned int program) override;
+	void UseProgram(unsigned int program) override;
+	void SetUniform(unsigned int program, const std::string& name, UniformType type, const void* values, int count) override;
+	void SetUniformBlockBinding(unsigned int program, const std::string& name, unsigned int binding) override;
+
+	void DrawElements(unsigned int count, unsigned int first) override;
+	void DrawArrays(unsigned int count, unsigned int first) override;
+	void MultiDrawElements(const int* counts, const void* const* offsets, unsigned int drawCount) override;
+	void MultiDrawElementsIndirect(unsigned int drawCount, unsigned int stride) override;
+	void MultiDrawElementsIndirectCount(unsigned int maxDrawCount, unsigned int stride) override;
+
+	void Clear(unsigned int mask) override;
+	void Enable(unsigned int capability) override;
+	void Disable(unsigned int capability) override;
+	void Flush() override;
+	void SetRenderState(const RenderState& state, unsigned int groups) override;
+	void Barrier(unsigned int barriers) override;
+
+	unsigned int GetUniformBufferOffsetAlignment() override { return _target->GetUniformBufferOffsetAlignment(); };
+
+	inline const std::vector<RecordedCall>& GetCalls() const { return _calls; };
+	inline RenderDevice& GetTarget() const { return *_target; };
+	void ClearCalls() { _calls.clear(); };
+	// One line per call
+	void Print(std::ostream& stream) const;
+};
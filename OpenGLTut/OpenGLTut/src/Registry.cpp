@@ -0,0 +1,64 @@
+#include "Registry.h"
+#include "TransformStorage.h"
+
+unsigned int Registry::NextComponentId()
+{
+	static unsigned int nextId = 0;
+	return nextId++;
+}
+
+Registry::Registry() : _transforms(new TransformStorage()), _aliveCount(0)
+{
+}
+
+Registry::~Registry()
+{
+}
+
+Entity Registry::Create()
+{
+	unsigned int index;
+	if (!_freeIndices.empty())
+	{
+		index = _freeIndices.back();
+		_freeIndices.pop_back();
+	}
+	else
+	{
+		index = (unsigned int)_generations.size();
+		ASSERT(index <= ENTITY_INDEX_MASK);
+		_generations.push_back(0);
+	}
+	_aliveCount++;
+	return (_generations[index] << ENTITY_INDEX_BITS) | index;
+}
+
+void Registry::Destroy(Entity entity)
+{
+	if (!IsAlive(entity))
+		return;
+
+	for (auto& pool : _pools)
+	{
+		if (pool && pool->Has(entity))
+			pool->Remove(entity);
+	}
+	if (_transforms->Has(entity))
+		_transforms->Remove(entity);
+
+	unsigned int index = EntityIndex(entity);
+	_generations[index] = (_generations[index] + 1) & (~0u >> ENTITY_INDEX_BITS);
+	_freeIndices.push_back(index);
+	_aliveCount--;
+}
+
+bool Registry::IsAlive(Entity entity) const
+{
+	unsigned int index = EntityIndex(entity);
+	return index < _generations.size() && _generations[index] == EntityGeneration(entity);
+}
+
+TransformStorage& Registry::Transforms()
+{
+	return *_transforms;
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "Utils.h"
+
+// Entities are plain handles, the low 20 bits index the sparse arrays and the high 12 bits are a
+// generation so handles of destroyed entities can't alias newly created ones
+typedef unsigned int Entity;
+const Entity NULL_ENTITY = ~0u;
+const unsigned int ENTITY_INDEX_BITS = 20;
+const unsigned int ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+
+const unsigned int INVALID_SPARSE_INDEX = ~0u;
+
+inline unsigned int EntityIndex(Entity entity) { return entity & ENTITY_INDEX_MASK; }
+inline unsigned int EntityGeneration(Entity entity) { return entity >> ENTITY_INDEX_BITS; }
+
+// Maps entities to a densely packed array, components are stored in that dense order so systems
+// walk contiguous memory no matter how entities were created and destroyed
+class SparseSet
+{
+protected:
+	std::vector<unsigned int> _sparse;
+	std::vector<Entity> _dense;
+public:
+	virtual ~SparseSet() {};
+
+	inline bool Has(Entity entity) const
+	{
+		unsigned int index = EntityIndex(entity);
+		return index < _sparse.size() && _sparse[index] != INVALID_SPARSE_INDEX && _dense[_sparse[index]] == entity;
+	};
+	inline unsigned int IndexOf(Entity entity) const { return _sparse[EntityIndex(entity)]; };
+	inline unsigned int Size() const { return (unsigned int)_dense.size(); };
+	inline const Entity* Entities() const { return _dense.data(); };
+
+	virtual void Remove(Entity entity) = 0;
+protected:
+	// Returns the dense index of the new element
+	unsigned int Insert(Entity entity)
+	{
+		unsigned int index = EntityIndex(entity);
+		if (index >= _sparse.size())
+			_sparse.resize(index + 1, INVALID_SPARSE_INDEX);
+		ASSERT(_sparse[index] == INVALID_SPARSE_INDEX);
+		_sparse[index] = (unsigned int)_dense.size();
+		_dense.push_back(entity);
+		return _sparse[index];
+	}
+
+	// Moves the last element into the hole, derived storages have to mirror that move in their arrays
+	unsigned int Erase(Entity entity)
+	{
+		unsigned int hole = _sparse[EntityIndex(entity)];
+		Entity last = _dense.back();
+		_dense[hole] = last;
+		_sparse[EntityIndex(last)] = hole;
+		_dense.pop_back();
+		_sparse[EntityIndex(entity)] = INVALID_SPARSE_INDEX;
+		return hole;
+	}
+};
+
+template<typename T>
+class ComponentPool : public SparseSet
+{
+private:
+	std::vector<T> _components;
+public:
+	T& Add(Entity entity, const T& component)
+	{
+		Insert(entity);
+		_components.push_back(component);
+		return _components.back();
+	}
+
+	void Remove(Entity entity) override
+	{
+		unsigned int hole = Erase(entity);
+		_components[hole] = _components.back();
+		_components.pop_back();
+	}
+
+	inline T& Get(Entity entity) { return _components[IndexOf(entity)]; };
+	inline T* Data() { return _components.data(); };
+	inline const T* Data() const { return _components.data(); };
+};
+
+class TransformStorage;
+
+class Registry
+{
+private:
+	std::vector<unsigned int> _generations;
+	std::vector<unsigned int> _freeIndices;
+	std::vector<std::unique_ptr<SparseSet>> _pools;
+	std::unique_ptr<TransformStorage> _transforms;
+	unsigned int _aliveCount;
+
+	static unsigned int NextComponentId();
+
+	template<typename T>
+	static unsigned int ComponentId()
+	{
+		static unsigned int id = NextComponentId();
+		return id;
+	}
+public:
+	Registry();
+	~Registry();
+
+	Entity Create();
+	void Destroy(Entity entity);
+	bool IsAlive(Entity entity) const;
+	inline unsigned int GetAliveCount() const { return _aliveCount; };
+
+	// Transforms are the hottest component, they get their own structure of arrays storage
+	TransformStorage& Transforms();
+
+	template<typename T>
+	ComponentPool<T>& Pool()
+	{
+		unsigned int id = ComponentId<T>();
+		if (id >= _pools.size())
+			_pools.resize(id + 1);
+		if (!_pools[id])
+			_pools[id].reset(new ComponentPool<T>());
+		return *static_cast<ComponentPool<T>*>(_pools[id].get());
+	}
+
+	template<typename T>
+	T& Add(Entity entity, const T& component = T()) { return Pool<T>().Add(entity, component); }
+
+	template<typename T>
+	T& Get(Entity entity) { return Pool<T>().Get(entity); }
+
+	template<typename T>
+	bool Has(Entity entity) { return Pool<T>().Has(entity); }
+
+	template<typename T>
+	void Remove(Entity entity) { Pool<T>().Remove(entity); }
+};
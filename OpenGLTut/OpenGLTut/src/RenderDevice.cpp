@@ -0,0 +1,143 @@
+#include "RenderDevice.h"
+#include "GLDevice.h"
+#include "GLDsaDevice.h"
+#include "NullDevice.h"
+#include "RecordingDevice.h"
+#include "SoftwareDevice.h"
+#include "Utils.h"
+#include <cstring>
+#include <iostream>
+
+static const char* const CALL_NAMES[DEVICE_CALL_COUNT] = {
+	"create_buffer", "delete_buffer", "bind_buffer", "bind_buffer_base", "bind_buffer_range",
+	"resize_buffer", "update_buffer", "clear_buffer",
+	"create_vertex_array", "delete_vertex_array", "bind_vertex_array", "set_vertex_attributes", "set_index_buffer",
+	"set_vertex_format", "set_vertex_buffer",
+	"create_texture", "delete_texture", "bind_textures", "create_sampler", "delete_sampler", "bind_samplers",
+	"create_program", "delete_program", "use_program", "set_uniform", "set_uniform_block_binding",
+	"draw_elements", "draw_arrays", "multi_draw_elements", "multi_draw_indirect", "multi_draw_indirect_count",
+	"clear", "enable", "disable", "flush", "set_render_state", "barrier"
+};
+
+SamplerDesc SamplerDesc::Default()
+{
+	SamplerDesc desc;
+	desc.minFilter = GL_NEAREST_MIPMAP_LINEAR;
+	desc.magFilter = GL_LINEAR;
+	desc.wrapS = GL_REPEAT;
+	desc.wrapT = GL_REPEAT;
+	return desc;
+}
+
+bool SamplerDesc::operator==(const SamplerDesc& other) const
+{
+	return minFilter == other.minFilter && magFilter == other.magFilter && wrapS == other.wrapS && wrapT == other.wrapT;
+}
+
+RenderState RenderState::Default()
+{
+	RenderState state;
+	state.depthTest = true;
+	state.depthWrite = true;
+	state.depthFunc = GL_LESS;
+	state.blend = false;
+	state.blendSource = GL_ONE;
+	state.blendDestination = GL_ZERO;
+	state.blendEquation = GL_FUNC_ADD;
+	state.cullFace = false;
+	state.cullMode = GL_BACK;
+	state.frontFace = GL_CCW;
+	state.polygonMode = GL_FILL;
+	state.stencilTest = false;
+	state.stencilFunc = GL_ALWAYS;
+	state.stencilReference = 0;
+	state.stencilReadMask = 0xFF;
+	state.stencilWriteMask = 0xFF;
+	state.stencilFail = GL_KEEP;
+	state.stencilDepthFail = GL_KEEP;
+	state.stencilPass = GL_KEEP;
+	return state;
+}
+
+unsigned int RenderState::Diff(const RenderState& other) const
+{
+	unsigned int groups = 0;
+	if (depthTest != other.depthTest) groups |= RENDER_STATE_DEPTH_TEST;
+	if (depthWrite != other.depthWrite) groups |= RENDER_STATE_DEPTH_WRITE;
+	if (depthFunc != other.depthFunc) groups |= RENDER_STATE_DEPTH_FUNC;
+	if (blend != other.blend) groups |= RENDER_STATE_BLEND;
+	if (blendSource != other.blendSource || blendDestination != other.blendDestination || blendEquation != other.blendEquation)
+		groups |= RENDER_STATE_BLEND_FUNC;
+	if (cullFace != other.cullFace) groups |= RENDER_STATE_CULL_FACE;
+	if (cullMode != other.cullMode) groups |= RENDER_STATE_CULL_MODE;
+	if (frontFace != other.frontFace) groups |= RENDER_STATE_FRONT_FACE;
+	if (polygonMode != other.polygonMode) groups |= RENDER_STATE_POLYGON_MODE;
+	if (stencilTest != other.stencilTest) groups |= RENDER_STATE_STENCIL_TEST;
+	if (stencilFunc != other.stencilFunc || stencilReference != other.stencilReference || stencilReadMask != other.stencilReadMask)
+		groups |= RENDER_STATE_STENCIL_FUNC;
+	if (stencilFail != other.stencilFail || stencilDepthFail != other.stencilDepthFail || stencilPass != other.stencilPass)
+		groups |= RENDER_STATE_STENCIL_OP;
+	if (stencilWriteMask != other.stencilWriteMask) groups |= RENDER_STATE_STENCIL_WRITE;
+	return groups;
+}
+
+// Wrappers that exist before main picks a device (and everything when it never does) use this one
+static GLDevice s_defaultDevice;
+RenderDevice* RenderDevice::s_device = &s_defaultDevice;
+
+void RenderDevice::Set(RenderDevice* device)
+{
+	s_device = device ? device : &s_defaultDevice;
+}
+
+RenderBackend RenderDevice::GetDefaultBackend()
+{
+	return GLDsaDevice::IsSupported() ? BACKEND_GL45 : BACKEND_GL33;
+}
+
+RenderDevice* RenderDevice::Create(RenderBackend backend, unsigned int width, unsigned int height, const ParallelForFunction& parallelFor)
+{
+	switch (backend)
+	{
+	case BACKEND_GL33:
+		return new GLDevice();
+	case BACKEND_GL45:
+		if (!GLDsaDevice::IsSupported())
+		{
+			std::cout << "The GL 4.5 device needs a GL 4.5 context or ARB_direct_state_access" << std::endl;
+			return nullptr;
+		}
+		return new GLDsaDevice();
+	case BACKEND_NULL:
+		return new NullDevice();
+	case BACKEND_RECORDING:
+		return new RecordingDevice();
+	case BACKEND_SOFTWARE:
+		if (width == 0 || height == 0)
+		{
+			std::cout << "The software device needs the size of its target" << std::endl;
+			return nullptr;
+		}
+		return new SoftwareDevice(width, height, parallelFor);
+	}
+	return nullptr;
+}
+
+bool RenderDevice::ParseBackend(const char* name, RenderBackend& backend)
+{
+	const char* names[] = { "gl33", "gl45", "null", "recording", "software" };
+	for (int i = 0; i < 5; i++)
+	{
+		if (strcmp(name, names[i]) == 0)
+		{
+			backend = (RenderBackend)i;
+			return true;
+		}
+	}
+	return false;
+}
+
+const char* RenderDevice::GetCallName(DeviceCall call)
+{
+	return call < DEVICE_CALL_COUNT ? CALL_NAMES[call] : "unknown";
+}
@@ -0,0 +1,209 @@
+#pragma once
+#include <string>
+#include "JobSystem.h"
+
+enum RenderBackend {
+	// Bind to edit GL 3.3, every edit goes through the current bindings
+	BACKEND_GL33,
+	// GL 4.5 direct state access, objects are edited by name without touching the bindings
+	BACKEND_GL45,
+	// No GL at all, calls are validated and counted so the CPU side can run and be measured anywhere
+	BACKEND_NULL,
+	// Keeps a log of every call and forwards it to another backend (the null one by default)
+	BACKEND_RECORDING,
+	// No GL at all, draws are rasterized on the CPU into the device's own color and depth target
+	BACKEND_SOFTWARE
+};
+
+// Which glUniform* a uniform upload turns into, values are always column major
+enum UniformType { UNIFORM_1I, UNIFORM_1UI, UNIFORM_2F, UNIFORM_4F, UNIFORM_4FV, UNIFORM_MATRIX4FV };
+
+// Every entry point of RenderDevice, the null and recording backends count and log by it
+enum DeviceCall {
+	CALL_CREATE_BUFFER, CALL_DELETE_BUFFER, CALL_BIND_BUFFER, CALL_BIND_BUFFER_BASE, CALL_BIND_BUFFER_RANGE,
+	CALL_RESIZE_BUFFER, CALL_UPDATE_BUFFER, CALL_CLEAR_BUFFER,
+	CALL_CREATE_VERTEX_ARRAY, CALL_DELETE_VERTEX_ARRAY, CALL_BIND_VERTEX_ARRAY, CALL_SET_VERTEX_ATTRIBUTES, CALL_SET_INDEX_BUFFER,
+	CALL_SET_VERTEX_FORMAT, CALL_SET_VERTEX_BUFFER,
+	CALL_CREATE_TEXTURE, CALL_DELETE_TEXTURE, CALL_BIND_TEXTURES, CALL_CREATE_SAMPLER, CALL_DELETE_SAMPLER, CALL_BIND_SAMPLERS,
+	CALL_CREATE_PROGRAM, CALL_DELETE_PROGRAM, CALL_USE_PROGRAM, CALL_SET_UNIFORM, CALL_SET_UNIFORM_BLOCK_BINDING,
+	CALL_DRAW_ELEMENTS, CALL_DRAW_ARRAYS, CALL_MULTI_DRAW_ELEMENTS, CALL_MULTI_DRAW_INDIRECT, CALL_MULTI_DRAW_INDIRECT_COUNT,
+	CALL_CLEAR, CALL_ENABLE, CALL_DISABLE, CALL_FLUSH, CALL_SET_RENDER_STATE, CALL_BARRIER,
+	DEVICE_CALL_COUNT
+};
+
+// Groups of RenderState that are applied together, each one is a single GL call or capability
+enum RenderStateGroup {
+	RENDER_STATE_DEPTH_TEST = 1 << 0, RENDER_STATE_DEPTH_WRITE = 1 << 1, RENDER_STATE_DEPTH_FUNC = 1 << 2,
+	RENDER_STATE_BLEND = 1 << 3, RENDER_STATE_BLEND_FUNC = 1 << 4,
+	RENDER_STATE_CULL_FACE = 1 << 5, RENDER_STATE_CULL_MODE = 1 << 6, RENDER_STATE_FRONT_FACE = 1 << 7, RENDER_STATE_POLYGON_MODE = 1 << 8,
+	RENDER_STATE_STENCIL_TEST = 1 << 9, RENDER_STATE_STENCIL_FUNC = 1 << 10, RENDER_STATE_STENCIL_OP = 1 << 11, RENDER_STATE_STENCIL_WRITE = 1 << 12,
+	RENDER_STATE_ALL = (1 << 13) - 1
+};
+
+// Fixed function state of a pipeline, GL enums throughout
+struct RenderState
+{
+	bool depthTest;
+	bool depthWrite;
+	unsigned int depthFunc;
+	bool blend;
+	unsigned int blendSource;
+	unsigned int blendDestination;
+	unsigned int blendEquation;
+	bool cullFace;
+	// GL_BACK, GL_FRONT or GL_FRONT_AND_BACK
+	unsigned int cullMode;
+	unsigned int frontFace;
+	// For GL_FRONT_AND_BACK, GL_LINE draws wireframes
+	unsigned int polygonMode;
+	bool stencilTest;
+	unsigned int stencilFunc;
+	unsigned int stencilReference;
+	unsigned int stencilReadMask;
+	unsigned int stencilWriteMask;
+	unsigned int stencilFail;
+	unsigned int stencilDepthFail;
+	unsigned int stencilPass;
+
+	// GL's initial state, except that the depth test is on
+	static RenderState Default();
+	// RenderStateGroup bits of every group that differs
+	unsigned int Diff(const RenderState& other) const;
+};
+
+// Sampling parameters of a sampler object, GL enums
+struct SamplerDesc
+{
+	unsigned int minFilter;
+	unsigned int magFilter;
+	unsigned int wrapS;
+	unsigned int wrapT;
+
+	// The parameters a GL texture starts with
+	static SamplerDesc Default();
+	bool operator==(const SamplerDesc& other) const;
+};
+
+// One vertex attribute the way glVertexAttribPointer describes it, stride and offset in bytes
+struct VertexAttribute
+{
+	unsigned int index;
+	unsigned int count;
+	unsigned int type;
+	bool normalized;
+	// Read by the shader as an integer, never converted to float
+	bool integer;
+	unsigned int stride;
+	unsigned int offset;
+	// 0 advances per vertex, 1 per instance
+	unsigned int divisor;
+};
+
+// The rendering hardware interface the GL wrappers (buffers, vertex arrays, textures, shaders and Renderer) go through.
+// Objects are plain unsigned names like in GL, 0 is never a valid object. Draws always use triangles and 32 bit indices.
+// Like GL itself a device is only used by the thread that owns the context.
+class RenderDevice
+{
+private:
+	static RenderDevice* s_device;
+public:
+	virtual ~RenderDevice() {};
+
+	virtual RenderBackend GetBackend() const = 0;
+	virtual const char* GetName() const = 0;
+
+	// target is the binding point the buffer is meant for, the GL 3.3 backend leaves the buffer bound there.
+	// GL_STATIC_DRAW buffers get immutable storage on GL 4.5, they can't be resized, updated or cleared afterwards.
+	virtual unsigned int CreateBuffer(unsigned int target, const void* data, unsigned int size, unsigned int usage) = 0;
+	virtual void DeleteBuffer(unsigned int buffer) = 0;
+	virtual void BindBuffer(unsigned int target, unsigned int buffer) = 0;
+	virtual void BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer) = 0;
+	virtual void BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, unsigned int offset, unsigned int size) = 0;
+	// Replaces the storage with size undefined bytes, orphaning the old storage
+	virtual void ResizeBuffer(unsigned int target, unsigned int buffer, unsigned int size, unsigned int usage) = 0;
+	virtual void UpdateBuffer(unsigned int target, unsigned int buffer, unsigned int offset, unsigned int size, const void* data) = 0;
+	// Fills the whole buffer with zeros
+	virtual void ClearBuffer(unsigned int target, unsigned int buffer) = 0;
+
+	virtual unsigned int CreateVertexArray() = 0;
+	virtual void DeleteVertexArray(unsigned int vertexArray) = 0;
+	virtual void BindVertexArray(unsigned int vertexArray) = 0;
+	// All attributes are read from buffer
+	virtual void SetVertexAttributes(unsigned int vertexArray, unsigned int buffer, const VertexAttribute* attributes, unsigned int count) = 0;
+	virtual void SetIndexBuffer(unsigned int vertexArray, unsigned int buffer) = 0;
+	// Format and buffer set apart, like glVertexArrayAttribFormat and glVertexArrayVertexBuffer: the attributes read
+	// from the buffer binding, whatever buffer is attached to it. Changing the buffer keeps the format, so one vertex
+	// array serves every mesh of that format. Attribute offsets are relative to the offset the buffer is attached at,
+	// the stride and divisor of the first attribute apply to the whole binding.
+	virtual void SetVertexFormat(unsigned int vertexArray, unsigned int binding, const VertexAttribute* attributes, unsigned int count) = 0;
+	virtual void SetVertexBuffer(unsigned int vertexArray, unsigned int binding, unsigned int buffer, unsigned int offset, unsigned int stride) = 0;
+
+	// 8 bit RGB or RGBA texture with a full mip chain, rows are tightly packed
+	virtual unsigned int CreateTexture2D(const void* pixels, int width, int height, int channels) = 0;
+	virtual void DeleteTexture(unsigned int texture) = 0;
+	// Binds textures[i] to unit first + i like glBindTextures, one call for all of them where GL 4.4 multi bind is
+	// available. Null textures unbind the units.
+	virtual void BindTextures(unsigned int first, const unsigned int* textures, unsigned int count) = 0;
+	inline void BindTexture(unsigned int unit, unsigned int texture) { BindTextures(unit, &texture, 1); };
+
+	// Sampler objects override the sampling parameters of whatever texture is bound to their unit, see SamplerCache
+	virtual unsigned int CreateSampler(const SamplerDesc& desc) = 0;
+	virtual void DeleteSampler(unsigned int sampler) = 0;
+	// Same as BindTextures, sampler 0 leaves the unit to the texture's own parameters
+	virtual void BindSamplers(unsigned int first, const unsigned int* samplers, unsigned int count) = 0;
+
+	// A non empty compute source makes a compute program and the other stages are ignored
+	virtual unsigned int CreateProgram(const std::string& vertexSource, const std::string& fragmentSource, const std::string& computeSource) = 0;
+	virtual void DeleteProgram(unsigned int program) = 0;
+	virtual void UseProgram(unsigned int program) = 0;
+	// count is the number of array elements for UNIFORM_4FV and 1 otherwise, the GL 3.3 backend needs the program in use
+	virtual void SetUniform(unsigned int program, const std::string& name, UniformType type, const void* values, int count) = 0;
+	virtual void SetUniformBlockBinding(unsigned int program, const std::string& name, unsigned int binding) = 0;
+
+	// first is in indices for elements and in vertices for arrays
+	virtual void DrawElements(unsigned int count, unsigned int first) = 0;
+	virtual void DrawArrays(unsigned int count, unsigned int first) = 0;
+	// offsets are in bytes into the bound index buffer
+	virtual void MultiDrawElements(const int* counts, const void* const* offsets, unsigned int drawCount) = 0;
+	// Commands come from the bound GL_DRAW_INDIRECT_BUFFER, the count variant reads the draw count from offset 0 of GL_PARAMETER_BUFFER
+	virtual void MultiDrawElementsIndirect(unsigned int drawCount, unsigned int stride) = 0;
+	virtual void MultiDrawElementsIndirectCount(unsigned int maxDrawCount, unsigned int stride) = 0;
+
+	virtual void Clear(unsigned int mask) = 0;
+	virtual void Enable(unsigned int capability) = 0;
+	virtual void Disable(unsigned int capability) = 0;
+	// Starts everything queued so far, the software backend rasterizes here
+	virtual void Flush() = 0;
+	// Applies the groups of state (RenderStateGroup bits), everything else stays as it is. Pipeline works out the groups.
+	virtual void SetRenderState(const RenderState& state, unsigned int groups) = 0;
+	// glMemoryBarrier, image and buffer stores of earlier shaders become visible to the accesses in barriers
+	virtual void Barrier(unsigned int barriers) = 0;
+
+	virtual unsigned int GetUniformBufferOffsetAlignment() = 0;
+
+	// The device every wrapper uses, a GL 3.3 device until Set is called
+	static inline RenderDevice& Get() { return *s_device; };
+	// Doesn't take ownership, nullptr goes back to the default GL 3.3 device
+	static void Set(RenderDevice* device);
+	// GL 4.5 when the context is 4.5 or has ARB_direct_state_access, GL 3.3 otherwise. Needs a current context with GLEW initialized.
+	static RenderBackend GetDefaultBackend();
+	// Caller owns the device, returns nullptr when the backend can't run on the current context.
+	// The size and parallelFor are only used by the software backend, which renders into a target of that size.
+	static RenderDevice* Create(RenderBackend backend, unsigned int width = 0, unsigned int height = 0, const ParallelForFunction& parallelFor = nullptr);
+	// gl33, gl45, null, recording or software, returns false for anything else
+	static bool ParseBackend(const char* name, RenderBackend& backend);
+	static const char* GetCallName(DeviceCall call);
+};
+
+// Makes a device current for its lifetime and restores the previous one after, declare it right after
+// the device and before the objects created on it
+class RenderDeviceScope
+{
+private:
+	RenderDevice* _previous;
+public:
+	RenderDeviceScope(RenderDevice* device) : _previous(&RenderDevice::Get()) { RenderDevice::Set(device); };
+	~RenderDeviceScope() { RenderDevice::Set(_previous); };
+	RenderDeviceScope(const RenderDeviceScope&) = delete;
+	RenderDeviceScope& operator=(const RenderDeviceScope&) = delete;
+};
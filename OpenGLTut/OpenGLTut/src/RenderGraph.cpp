@@ -0,0 +1,327 @@
+#include "RenderGraph.h"
+#include "Utils.h"
+#include "GpuProfiler.h"
+#include "Profiler.h"
+#include "RenderDevice.h"
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <queue>
+
+Framebuffer* RenderGraphContext::GetTarget(RenderGraphResource resource) const
+{
+	return _graph._resources[resource].target;
+}
+
+unsigned int RenderGraphContext::GetTexture(RenderGraphResource resource) const
+{
+	const RenderGraph::Resource& found = _graph._resources[resource];
+	ASSERT(found.target || found.texture);
+	return found.target ? found.target->getColorTexture() : found.texture;
+}
+
+const FramebufferDesc& RenderGraphContext::GetDesc(RenderGraphResource resource) const
+{
+	return _graph._resources[resource].desc;
+}
+
+void RenderGraphContext::BindTarget(RenderGraphResource resource) const
+{
+	const RenderGraph::Resource& found = _graph._resources[resource];
+	ASSERT(!found.texture);
+	if (found.target)
+		found.target->Bind();
+	else
+		Framebuffer::BindDefault(found.desc.width, found.desc.height);
+}
+
+RenderGraph::RenderGraph() : _compiled(false), _transientMemory(0), _peakMemory(0)
+{
+}
+
+void RenderGraph::Reset()
+{
+	for (const Resource& resource : _resources)
+		ASSERT(resource.imported || !resource.target);
+	_resources.clear();
+	_passes.clear();
+	_order.clear();
+	_compiled = false;
+}
+
+RenderGraphResource RenderGraph::CreateTexture(const char* name, const FramebufferDesc& desc)
+{
+	_resources.push_back({ name, desc, false, nullptr, 0, -1, -1 });
+	_compiled = false;
+	return (RenderGraphResource)_resources.size() - 1;
+}
+
+RenderGraphResource RenderGraph::ImportTarget(const char* name, Framebuffer* target, unsigned int width, unsigned int height)
+{
+	FramebufferDesc desc = target ? target->getDesc() : FramebufferDesc(width, height);
+	_resources.push_back({ name, desc, true, target, 0, -1, -1 });
+	_compiled = false;
+	return (RenderGraphResource)_resources.size() - 1;
+}
+
+RenderGraphResource RenderGraph::ImportTexture(const char* name, unsigned int texture, unsigned int width, unsigned int height)
+{
+	ASSERT(texture);
+	_resources.push_back({ name, FramebufferDesc(width, height), true, nullptr, texture, -1, -1 });
+	_compiled = false;
+	return (RenderGraphResource)_resources.size() - 1;
+}
+
+unsigned int RenderGraph::AddPass(const char* name, const ExecuteFunction& execute)
+{
+	Pass pass;
+	pass.name = name;
+	pass.execute = execute;
+	pass.sideEffects = false;
+	pass.culled = false;
+	pass.barrierBits = 0;
+	_passes.push_back(std::move(pass));
+	_compiled = false;
+	return (unsigned int)_passes.size() - 1;
+}
+
+void RenderGraph::Read(unsigned int pass, RenderGraphResource resource, RenderGraphAccess access)
+{
+	ASSERT(access != RENDER_GRAPH_ATTACHMENT);
+	_passes[pass].accesses.push_back({ resource, access, false });
+	_compiled = false;
+}
+
+void RenderGraph::Write(unsigned int pass, RenderGraphResource resource, RenderGraphAccess access)
+{
+	ASSERT(access != RENDER_GRAPH_SAMPLED);
+	_passes[pass].accesses.push_back({ resource, access, true });
+	if (_resources[resource].imported)
+		_passes[pass].sideEffects = true;
+	_compiled = false;
+}
+
+void RenderGraph::AddDependency(unsigned int from, unsigned int to)
+{
+	if (from == to)
+		return;
+	_dependents[from].push_back(to);
+	_dependencyCounts[to]++;
+}
+
+void RenderGraph::Compile()
+{
+	PROFILE_SCOPE("RenderGraph::Compile");
+	unsigned int passCount = (unsigned int)_passes.size();
+	_dependents.resize(passCount);
+	for (std::vector<unsigned int>& dependents : _dependents)
+		dependents.clear();
+	_dependencyCounts.assign(passCount, 0);
+	// Passes whose results a pass builds on, the ones that keep it from being culled
+	std::vector<std::vector<unsigned int>> producers(passCount);
+
+	// Walks the passes in the order they were added, a read depends on the last write before it and a write
+	// on the last write and on every read since then
+	std::vector<int> lastWriter(_resources.size(), -1);
+	std::vector<std::vector<unsigned int>> readers(_resources.size());
+	for (unsigned int pass = 0; pass < passCount; pass++)
+	{
+		for (const Access& access : _passes[pass].accesses)
+		{
+			if (access.write)
+				continue;
+			int writer = lastWriter[access.resource];
+			if (writer >= 0)
+			{
+				AddDependency(writer, pass);
+				producers[pass].push_back(writer);
+			}
+			else if (!_resources[access.resource].imported)
+			{
+				std::cout << "Render graph: " << _passes[pass].name << " reads " << _resources[access.resource].name << " before anything wrote it" << std::endl;
+			}
+			readers[access.resource].push_back(pass);
+		}
+		for (const Access& access : _passes[pass].accesses)
+		{
+			if (!access.write)
+				continue;
+			int writer = lastWriter[access.resource];
+			if (writer >= 0 && writer != (int)pass)
+			{
+				AddDependency(writer, pass);
+				producers[pass].push_back(writer);
+			}
+			for (unsigned int reader : readers[access.resource])
+				AddDependency(reader, pass);
+			readers[access.resource].clear();
+			lastWriter[access.resource] = pass;
+		}
+	}
+
+	// Culling: only passes with side effects and what they build on survive
+	std::vector<unsigned int> stack;
+	for (unsigned int pass = 0; pass < passCount; pass++)
+	{
+		_passes[pass].culled = !_passes[pass].sideEffects;
+		if (_passes[pass].sideEffects)
+			stack.push_back(pass);
+	}
+	while (!stack.empty())
+	{
+		unsigned int pass = stack.back();
+		stack.pop_back();
+		for (unsigned int producer : producers[pass])
+		{
+			if (_passes[producer].culled)
+			{
+				_passes[producer].culled = false;
+				stack.push_back(producer);
+			}
+		}
+	}
+
+	// Topological order, among the passes that are ready the one added first goes first
+	_order.clear();
+	std::priority_queue<unsigned int, std::vector<unsigned int>, std::greater<unsigned int>> ready;
+	for (unsigned int pass = 0; pass < passCount; pass++)
+	{
+		if (_dependencyCounts[pass] == 0)
+			ready.push(pass);
+	}
+	while (!ready.empty())
+	{
+		unsigned int pass = ready.top();
+		ready.pop();
+		if (!_passes[pass].culled)
+			_order.push_back(pass);
+		for (unsigned int dependent : _dependents[pass])
+		{
+			if (--_dependencyCounts[dependent] == 0)
+				ready.push(dependent);
+		}
+	}
+	for (unsigned int pass = 0; pass < passCount; pass++)
+		ASSERT(_dependencyCounts[pass] == 0);
+
+	// Lifetimes and barriers follow the execution order
+	for (Resource& resource : _resources)
+	{
+		resource.firstUse = -1;
+		resource.lastUse = -1;
+	}
+	// Per resource, whether its last write was an image store and the barrier bits issued since
+	std::vector<unsigned char> imageWritten(_resources.size(), 0);
+	std::vector<unsigned int> issuedBarriers(_resources.size(), 0);
+	for (unsigned int position = 0; position < _order.size(); position++)
+	{
+		Pass& pass = _passes[_order[position]];
+		pass.barrierBits = 0;
+		for (const Access& access : pass.accesses)
+		{
+			Resource& resource = _resources[access.resource];
+			if (resource.firstUse < 0)
+				resource.firstUse = (int)position;
+			resource.lastUse = (int)position;
+
+			if (!imageWritten[access.resource])
+				continue;
+			unsigned int bits = access.access == RENDER_GRAPH_SAMPLED ? GL_TEXTURE_FETCH_BARRIER_BIT
+				: access.access == RENDER_GRAPH_IMAGE ? GL_SHADER_IMAGE_ACCESS_BARRIER_BIT : GL_FRAMEBUFFER_BARRIER_BIT;
+			pass.barrierBits |= bits & ~issuedBarriers[access.resource];
+		}
+		for (const Access& access : pass.accesses)
+		{
+			if (imageWritten[access.resource])
+				issuedBarriers[access.resource] |= pass.barrierBits;
+			if (access.write)
+			{
+				imageWritten[access.resource] = access.access == RENDER_GRAPH_IMAGE;
+				issuedBarriers[access.resource] = 0;
+			}
+		}
+	}
+
+	ComputeMemory();
+	_compiled = true;
+}
+
+void RenderGraph::ComputeMemory()
+{
+	// Plays the pool's acquires and releases through, a released target is reused by the next texture like it
+	struct Slot
+	{
+		FramebufferDesc desc;
+		bool inUse;
+	};
+	std::vector<Slot> slots;
+	std::vector<int> slotOf(_resources.size(), -1);
+	_transientMemory = 0;
+	_peakMemory = 0;
+	for (unsigned int position = 0; position < _order.size(); position++)
+	{
+		for (const Access& access : _passes[_order[position]].accesses)
+		{
+			const Resource& resource = _resources[access.resource];
+			if (resource.imported || resource.firstUse != (int)position || slotOf[access.resource] >= 0)
+				continue;
+			_transientMemory += resource.desc.GetMemorySize();
+			for (unsigned int slot = 0; slot < slots.size() && slotOf[access.resource] < 0; slot++)
+			{
+				if (!slots[slot].inUse && slots[slot].desc == resource.desc)
+				{
+					slots[slot].inUse = true;
+					slotOf[access.resource] = (int)slot;
+				}
+			}
+			if (slotOf[access.resource] < 0)
+			{
+				slots.push_back({ resource.desc, true });
+				slotOf[access.resource] = (int)slots.size() - 1;
+				_peakMemory += resource.desc.GetMemorySize();
+			}
+		}
+		for (const Access& access : _passes[_order[position]].accesses)
+		{
+			const Resource& resource = _resources[access.resource];
+			if (!resource.imported && resource.lastUse == (int)position)
+				slots[slotOf[access.resource]].inUse = false;
+		}
+	}
+}
+
+void RenderGraph::Execute(RenderTargetPool& pool, GpuProfiler* profiler)
+{
+	PROFILE_SCOPE("RenderGraph::Execute");
+	if (!_compiled)
+		Compile();
+
+	RenderGraphContext context(*this);
+	for (unsigned int position = 0; position < _order.size(); position++)
+	{
+		Pass& pass = _passes[_order[position]];
+		for (const Access& access : pass.accesses)
+		{
+			Resource& resource = _resources[access.resource];
+			if (!resource.imported && !resource.target)
+				resource.target = pool.Acquire(resource.desc);
+		}
+		if (pass.barrierBits)
+			RenderDevice::Get().Barrier(pass.barrierBits);
+
+		{
+			GpuScope scope(profiler, pass.name);
+			pass.execute(context);
+		}
+
+		for (const Access& access : pass.accesses)
+		{
+			Resource& resource = _resources[access.resource];
+			if (!resource.imported && resource.target && resource.lastUse == (int)position)
+			{
+				pool.Release(resource.target);
+				resource.target = nullptr;
+			}
+		}
+	}
+}
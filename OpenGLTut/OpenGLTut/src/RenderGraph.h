@@ -0,0 +1,137 @@
+#pragma once
+#include <functional>
+#include <vector>
+#include "Framebuffer.h"
+#include "RenderTargetPool.h"
+
+class GpuProfiler;
+class RenderGraph;
+
+// How a pass touches a texture, decides which barriers go in front of it
+enum RenderGraphAccess {
+	// Drawn into as the color (and depth) attachment of its framebuffer
+	RENDER_GRAPH_ATTACHMENT,
+	// Read with texture() or texelFetch
+	RENDER_GRAPH_SAMPLED,
+	// Read or written with imageLoad and imageStore, writes need a glMemoryBarrier before anything sees them
+	RENDER_GRAPH_IMAGE
+};
+
+// Index of a texture declared in a graph, valid until the graph is reset
+typedef unsigned int RenderGraphResource;
+
+// What a pass sees while it executes
+class RenderGraphContext
+{
+private:
+	const RenderGraph& _graph;
+public:
+	RenderGraphContext(const RenderGraph& graph) : _graph(graph) {};
+
+	// nullptr for an imported window framebuffer or texture
+	Framebuffer* GetTarget(RenderGraphResource resource) const;
+	unsigned int GetTexture(RenderGraphResource resource) const;
+	const FramebufferDesc& GetDesc(RenderGraphResource resource) const;
+	// Binds the framebuffer of the resource and sets the viewport to its size
+	void BindTarget(RenderGraphResource resource) const;
+};
+
+// Frame graph of passes and the textures they read and write. Passes and transient textures are declared
+// every frame, Compile then orders the passes by their dependencies, drops the ones nothing that reaches an
+// imported texture depends on and works out when each transient texture is first and last used. Execute
+// runs the passes, taking transient textures from a render target pool right before their first use and
+// giving them back right after their last, so textures whose lifetimes don't overlap share one target.
+// Writes through image stores get the memory barrier the next access needs, issued through RenderDevice::Barrier.
+class RenderGraph
+{
+public:
+	typedef std::function<void(const RenderGraphContext&)> ExecuteFunction;
+private:
+	struct Resource
+	{
+		const char* name;
+		FramebufferDesc desc;
+		// Imported targets live outside the graph, nullptr with imported set is the window's framebuffer
+		// unless texture is set
+		bool imported;
+		Framebuffer* target;
+		// Imported texture without a framebuffer, only read and written by shaders
+		unsigned int texture;
+		// Execution order positions of the first and last pass that use it, set by Compile
+		int firstUse;
+		int lastUse;
+	};
+	struct Access
+	{
+		RenderGraphResource resource;
+		RenderGraphAccess access;
+		bool write;
+	};
+	struct Pass
+	{
+		const char* name;
+		ExecuteFunction execute;
+		std::vector<Access> accesses;
+		// Kept even when nothing reads what it writes
+		bool sideEffects;
+		// Set by Compile
+		bool culled;
+		unsigned int barrierBits;
+	};
+
+	std::vector<Resource> _resources;
+	std::vector<Pass> _passes;
+	// Indices of the passes that run, in execution order
+	std::vector<unsigned int> _order;
+	bool _compiled;
+
+	// Reused by Compile
+	std::vector<std::vector<unsigned int>> _dependents;
+	std::vector<unsigned int> _dependencyCounts;
+
+	unsigned long long _transientMemory;
+	unsigned long long _peakMemory;
+
+	friend class RenderGraphContext;
+	void AddDependency(unsigned int from, unsigned int to);
+	void ComputeMemory();
+public:
+	RenderGraph();
+	RenderGraph(const RenderGraph&) = delete;
+	RenderGraph& operator=(const RenderGraph&) = delete;
+
+	// Forgets every pass and resource, the next frame declares them again
+	void Reset();
+
+	// Texture the graph allocates, it only exists between its first and last use. Names are kept as pointers.
+	RenderGraphResource CreateTexture(const char* name, const FramebufferDesc& desc);
+	// Target owned by the caller, target nullptr is the window's framebuffer of the given size.
+	// Passes that write an imported texture are never culled.
+	RenderGraphResource ImportTarget(const char* name, Framebuffer* target, unsigned int width = 0, unsigned int height = 0);
+	// Texture owned by the caller that passes only sample or access as an image, it can't be bound as a target.
+	// The size is kept in the desc and the format is left at its default.
+	RenderGraphResource ImportTexture(const char* name, unsigned int texture, unsigned int width, unsigned int height);
+
+	// Passes run in the order they are added unless their reads and writes say otherwise
+	unsigned int AddPass(const char* name, const ExecuteFunction& execute);
+	// A read sees what the passes added before it wrote
+	void Read(unsigned int pass, RenderGraphResource resource, RenderGraphAccess access = RENDER_GRAPH_SAMPLED);
+	// Writing a texture an earlier pass wrote draws on top of it, the earlier pass runs first
+	void Write(unsigned int pass, RenderGraphResource resource, RenderGraphAccess access = RENDER_GRAPH_ATTACHMENT);
+	// For passes whose results leave the graph some other way (readbacks, queries)
+	inline void SetSideEffects(unsigned int pass) { _passes[pass].sideEffects = true; };
+
+	// Orders and culls the passes and computes the lifetimes of transient textures
+	void Compile();
+	// Runs the passes on the thread that owns the context, each one in a GPU timer scope when profiler is given
+	void Execute(RenderTargetPool& pool, GpuProfiler* profiler = nullptr);
+
+	inline const FramebufferDesc& GetDesc(RenderGraphResource resource) const { return _resources[resource].desc; };
+	inline unsigned int GetPassCount() const { return (unsigned int)_passes.size(); };
+	inline unsigned int GetExecutedPassCount() const { return (unsigned int)_order.size(); };
+	inline bool IsCulled(unsigned int pass) const { return _passes[pass].culled; };
+	// Bytes the transient textures of the passes that run would take if each had a target of its own
+	inline unsigned long long GetTransientMemory() const { return _transientMemory; };
+	// Bytes of the transient targets alive at the same time at worst, what aliasing brings it down to
+	inline unsigned long long GetPeakMemory() const { return _peakMemory; };
+};
@@ -0,0 +1,100 @@
+#include "RenderStats.h"
+#include "imgui/imgui.h"
+#include <fstream>
+#include <iostream>
+
+RenderStatsFrame RenderStats::s_frame;
+std::mutex RenderStats::s_mutex;
+std::deque<RenderStatsFrame> RenderStats::s_history;
+
+static const char* STATE_CHANGE_NAMES[STATE_CHANGE_COUNT] = { "shader_binds", "vertex_array_binds", "texture_binds", "buffer_binds", "render_state_changes" };
+
+void RenderStats::EndFrame()
+{
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		s_history.push_back(s_frame);
+		if (s_history.size() > HISTORY_SIZE)
+			s_history.pop_front();
+	}
+
+	unsigned long long next = s_frame.frameIndex + 1;
+	s_frame = RenderStatsFrame();
+	s_frame.frameIndex = next;
+}
+
+RenderStatsFrame RenderStats::GetLastFrame()
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+	return s_history.empty() ? RenderStatsFrame() : s_history.back();
+}
+
+void RenderStats::DrawImGuiOverlay()
+{
+	RenderStatsFrame frame = GetLastFrame();
+
+	ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x - 10.0f, 10.0f), ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+	ImGui::SetNextWindowBgAlpha(0.5f);
+	ImGui::Begin("Render stats", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoMove);
+	ImGui::Text("Frame %llu", frame.frameIndex);
+	ImGui::Text("Draw calls %u, triangles %llu", frame.drawCalls, frame.triangles);
+	ImGui::Text("Binds: shader %u, vertex array %u, texture %u, buffer %u, render state %u", frame.stateChanges[STATE_SHADER],
+		frame.stateChanges[STATE_VERTEX_ARRAY], frame.stateChanges[STATE_TEXTURE], frame.stateChanges[STATE_BUFFER], frame.stateChanges[STATE_RENDER]);
+	ImGui::Text("Uniform uploads %u", frame.uniformUploads);
+	ImGui::Text("Uploaded: buffers %.1f KB, textures %.1f KB", frame.bufferBytes / 1024.0, frame.textureBytes / 1024.0);
+	if (ImGui::Button("Dump CSV"))
+		ExportCsv("render_stats.csv");
+	ImGui::SameLine();
+	if (ImGui::Button("Dump JSON"))
+		ExportJson("render_stats.json");
+	ImGui::End();
+}
+
+bool RenderStats::ExportCsv(const std::string& filePath)
+{
+	std::ofstream file(filePath);
+	if (!file)
+	{
+		std::cout << "Could not write " << filePath << std::endl;
+		return false;
+	}
+
+	file << "frame,draw_calls,triangles";
+	for (const char* name : STATE_CHANGE_NAMES)
+		file << "," << name;
+	file << ",uniform_uploads,buffer_bytes,texture_bytes" << std::endl;
+
+	std::lock_guard<std::mutex> lock(s_mutex);
+	for (const RenderStatsFrame& frame : s_history)
+	{
+		file << frame.frameIndex << "," << frame.drawCalls << "," << frame.triangles;
+		for (unsigned int count : frame.stateChanges)
+			file << "," << count;
+		file << "," << frame.uniformUploads << "," << frame.bufferBytes << "," << frame.textureBytes << std::endl;
+	}
+	return true;
+}
+
+bool RenderStats::ExportJson(const std::string& filePath)
+{
+	std::ofstream file(filePath);
+	if (!file)
+	{
+		std::cout << "Could not write " << filePath << std::endl;
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(s_mutex);
+	file << "[";
+	for (size_t i = 0; i < s_history.size(); i++)
+	{
+		const RenderStatsFrame& frame = s_history[i];
+		file << (i ? "," : "") << "\n{\"frame\":" << frame.frameIndex << ",\"draw_calls\":" << frame.drawCalls << ",\"triangles\":" << frame.triangles;
+		for (int kind = 0; kind < STATE_CHANGE_COUNT; kind++)
+			file << ",\"" << STATE_CHANGE_NAMES[kind] << "\":" << frame.stateChanges[kind];
+		file << ",\"uniform_uploads\":" << frame.uniformUploads << ",\"buffer_bytes\":" << frame.bufferBytes
+			<< ",\"texture_bytes\":" << frame.textureBytes << "}";
+	}
+	file << "\n]" << std::endl;
+	return true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <deque>
+#include <mutex>
+#include <string>
+
+// STATE_RENDER counts pipeline binds that changed fixed function state
+enum StateChange { STATE_SHADER, STATE_VERTEX_ARRAY, STATE_TEXTURE, STATE_BUFFER, STATE_RENDER, STATE_CHANGE_COUNT };
+
+struct RenderStatsFrame
+{
+	unsigned long long frameIndex = 0;
+	// GL draw calls, a multi draw counts once
+	unsigned int drawCalls = 0;
+	// Triangles the CPU knows about, indirect draws are decided on the GPU and aren't included
+	unsigned long long triangles = 0;
+	unsigned int stateChanges[STATE_CHANGE_COUNT] = {};
+	unsigned int uniformUploads = 0;
+	unsigned long long bufferBytes = 0;
+	unsigned long long textureBytes = 0;
+};
+
+// Counters the GL wrappers bump as they issue calls. They are only written by the thread that owns the
+// context, EndFrame publishes the frame so other threads can read it.
+class RenderStats
+{
+public:
+	// Frames kept for the dumps
+	static const unsigned int HISTORY_SIZE = 600;
+private:
+	static RenderStatsFrame s_frame;
+	static std::mutex s_mutex;
+	static std::deque<RenderStatsFrame> s_history;
+public:
+	static inline void CountDraw(unsigned long long triangles, unsigned int drawCalls = 1)
+	{
+		s_frame.drawCalls += drawCalls;
+		s_frame.triangles += triangles;
+	};
+	static inline void CountStateChange(StateChange kind) { s_frame.stateChanges[kind]++; };
+	static inline void CountUniformUpload() { s_frame.uniformUploads++; };
+	static inline void CountBufferUpload(unsigned long long bytes) { s_frame.bufferBytes += bytes; };
+	static inline void CountTextureUpload(unsigned long long bytes) { s_frame.textureBytes += bytes; };
+
+	// Publishes the counters of the frame that was just submitted and starts counting the next one
+	static void EndFrame();
+	static RenderStatsFrame GetLastFrame();
+
+	// Small window with the last frame's counters and buttons for the dumps
+	static void DrawImGuiOverlay();
+	static bool ExportCsv(const std::string& filePath);
+	static bool ExportJson(const std::string& filePath);
+};
@@ -0,0 +1,71 @@
+#include "RenderTargetPool.h"
+#include "Utils.h"
+
+RenderTargetPool::RenderTargetPool(unsigned int maxIdleFrames) : _frame(0), _maxIdleFrames(maxIdleFrames)
+{
+}
+
+Framebuffer* RenderTargetPool::Acquire(const FramebufferDesc& desc)
+{
+	for (Entry& entry : _entries)
+	{
+		if (!entry.inUse && entry.target->getDesc() == desc)
+		{
+			entry.inUse = true;
+			return entry.target.get();
+		}
+	}
+	Entry entry;
+	entry.target.reset(new Framebuffer(desc));
+	entry.inUse = true;
+	entry.lastUsed = _frame;
+	_entries.push_back(std::move(entry));
+	return _entries.back().target.get();
+}
+
+void RenderTargetPool::Release(Framebuffer* target)
+{
+	for (Entry& entry : _entries)
+	{
+		if (entry.target.get() == target)
+		{
+			ASSERT(entry.inUse);
+			entry.inUse = false;
+			entry.lastUsed = _frame;
+			return;
+		}
+	}
+	ASSERT(false);
+}
+
+void RenderTargetPool::EndFrame()
+{
+	_frame++;
+	for (size_t i = 0; i < _entries.size();)
+	{
+		if (!_entries[i].inUse && _frame - _entries[i].lastUsed > _maxIdleFrames)
+		{
+			_entries[i] = std::move(_entries.back());
+			_entries.pop_back();
+		}
+		else
+		{
+			i++;
+		}
+	}
+}
+
+void RenderTargetPool::Clear()
+{
+	for (const Entry& entry : _entries)
+		ASSERT(!entry.inUse);
+	_entries.clear();
+}
+
+unsigned long long RenderTargetPool::GetMemorySize() const
+{
+	unsigned long long size = 0;
+	for (const Entry& entry : _entries)
+		size += entry.target->getDesc().GetMemorySize();
+	return size;
+}
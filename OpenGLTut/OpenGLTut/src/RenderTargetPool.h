@@ -0,0 +1,39 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "Framebuffer.h"
+
+// Transient render targets shared by passes that only need them for part of a frame. Acquire hands out an
+// idle target with the same description or creates one, Release gives it back for the next pass to reuse,
+// so a chain of passes alternates between a few targets instead of allocating every frame. Targets that
+// sat idle for a while are deleted in EndFrame, a resize doesn't keep the old sizes around.
+class RenderTargetPool
+{
+private:
+	struct Entry
+	{
+		std::unique_ptr<Framebuffer> target;
+		bool inUse;
+		// EndFrame count when the target was last released
+		unsigned long long lastUsed;
+	};
+	std::vector<Entry> _entries;
+	unsigned long long _frame;
+	unsigned int _maxIdleFrames;
+public:
+	RenderTargetPool(unsigned int maxIdleFrames = 60);
+	RenderTargetPool(const RenderTargetPool&) = delete;
+	RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+	// Valid until it is released or the pool goes away, on the thread that owns the context
+	Framebuffer* Acquire(const FramebufferDesc& desc);
+	void Release(Framebuffer* target);
+	// Deletes targets nobody acquired for maxIdleFrames frames
+	void EndFrame();
+	// Deletes every target, none may be in use
+	void Clear();
+
+	inline unsigned int GetTargetCount() const { return (unsigned int)_entries.size(); };
+	// Bytes of video memory the pooled targets take
+	unsigned long long GetMemorySize() const;
+};
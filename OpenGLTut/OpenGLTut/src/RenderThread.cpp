@@ -0,0 +1,141 @@
+#include "RenderThread.h"
+#include "Utils.h"
+#include "Profiler.h"
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+// Weight of the newest frame in the smoothed latency
+static const double LATENCY_SMOOTHING = 0.1;
+
+RenderThread::RenderThread(GLFWwindow* window, const std::function<void(FramePacket&)>& renderFrame, bool threaded)
+	: _window(window), _renderFrame(renderFrame), _threaded(threaded && window), _writeIndex(0), _readIndex(0), _running(true),
+	_swapInterval(-2), _latency(0.0)
+{
+	_submitted[0] = _submitted[1] = false;
+	if (!_threaded)
+		return;
+
+	// A context can only be current on one thread at a time
+	glfwMakeContextCurrent(nullptr);
+	_thread = std::thread(&RenderThread::Loop, this);
+}
+
+RenderThread::~RenderThread()
+{
+	Stop();
+}
+
+void RenderThread::Present(FramePacket& packet)
+{
+	if (_window && packet.swapInterval != _swapInterval)
+	{
+		_swapInterval = packet.swapInterval;
+		glfwSwapInterval(_swapInterval);
+	}
+
+	{
+		PROFILE_SCOPE("Render frame");
+		_renderFrame(packet);
+	}
+	if (_window)
+	{
+		PROFILE_SCOPE("Swap buffers");
+		glfwSwapBuffers(_window);
+	}
+
+	if (packet.waitForGpu)
+	{
+		PROFILE_SCOPE("Wait for GPU");
+		GLCall(GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+		GLenum result;
+		do
+		{
+			result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000);
+		} while (result == GL_TIMEOUT_EXPIRED);
+		GLCall(glDeleteSync(fence));
+	}
+
+	// Nothing reaches a screen without a window
+	if (!_window)
+		return;
+	double latency = glfwGetTime() - packet.inputTime;
+	std::lock_guard<std::mutex> lock(_mutex);
+	_latency = _latency == 0.0 ? latency : _latency + (latency - _latency) * LATENCY_SMOOTHING;
+}
+
+void RenderThread::Loop()
+{
+	glfwMakeContextCurrent(_window);
+	PROFILE_THREAD("Render");
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_changed.wait(lock, [this]() { return _submitted[_readIndex] || !_running; });
+			// Stop still waits for the last packet, so nothing that was submitted gets dropped
+			if (!_submitted[_readIndex])
+				break;
+		}
+
+		Present(_packets[_readIndex]);
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_submitted[_readIndex] = false;
+			_readIndex ^= 1;
+		}
+		_changed.notify_all();
+	}
+
+	glfwMakeContextCurrent(nullptr);
+}
+
+FramePacket& RenderThread::BeginFrame()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_changed.wait(lock, [this]() { return !_submitted[_writeIndex]; });
+	return _packets[_writeIndex];
+}
+
+void RenderThread::Submit()
+{
+	if (!_threaded)
+	{
+		Present(_packets[_writeIndex]);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_submitted[_writeIndex] = true;
+		_writeIndex ^= 1;
+	}
+	_changed.notify_all();
+}
+
+void RenderThread::WaitIdle()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_changed.wait(lock, [this]() { return !_submitted[0] && !_submitted[1]; });
+}
+
+double RenderThread::GetLatency()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _latency;
+}
+
+void RenderThread::Stop()
+{
+	if (!_thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_running = false;
+	}
+	_changed.notify_all();
+	_thread.join();
+	glfwMakeContextCurrent(_window);
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "FramePacket.h"
+
+struct GLFWwindow;
+
+// Owns the GL context on a thread of its own, renders and presents frame N while the main thread polls
+// events and simulates frame N + 1. The two packets are used in turn so neither side ever waits on a
+// packet the other one is still using, the main thread only blocks once it gets a full frame ahead.
+class RenderThread
+{
+private:
+	GLFWwindow* _window;
+	std::function<void(FramePacket&)> _renderFrame;
+	bool _threaded;
+
+	FramePacket _packets[2];
+	// Submitted packets that haven't been presented yet
+	bool _submitted[2];
+	unsigned int _writeIndex;
+	unsigned int _readIndex;
+	bool _running;
+
+	// Only touched by the presenting thread
+	int _swapInterval;
+	// Smoothed input to present latency in seconds
+	double _latency;
+
+	std::mutex _mutex;
+	std::condition_variable _changed;
+	std::thread _thread;
+
+	void Loop();
+	void Present(FramePacket& packet);
+public:
+	// The window's context has to be current on the calling thread, it is handed over to the render thread.
+	// Without threaded every packet is rendered inside Submit, which keeps the frame easy to debug.
+	// Without a window (headless rendering) nothing is presented and packets are always rendered inside Submit.
+	RenderThread(GLFWwindow* window, const std::function<void(FramePacket&)>& renderFrame, bool threaded = true);
+	~RenderThread();
+
+	// Packet for the next frame, blocks while the render thread still draws from it
+	FramePacket& BeginFrame();
+	// Queues the packet returned by BeginFrame for rendering
+	void Submit();
+	// Blocks until every submitted packet has been presented
+	void WaitIdle();
+	// Time from polling a frame's input until the frame was presented (and finished on the GPU when the packet asked for that)
+	double GetLatency();
+	// Renders everything that was submitted, then makes the context current on the calling thread again
+	void Stop();
+};
@@ -1,5 +1,11 @@
 #include "Renderer.h"
 #include "Utils.h"
+#include "GpuCulling.h"
+#include "CommandList.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include "RenderDevice.h"
+#include <algorithm>
 
 Renderer::Renderer()
 {
@@ -9,22 +15,134 @@ Renderer::~Renderer()
 {
 }
 
-void Renderer::Draw(DrawMode mode, VertexArray& va, unsigned int count, Shader& shader) const
+void Renderer::Draw(DrawMode mode, VertexArray& va, unsigned int count, Shader& shader, unsigned int first) const
 {
+	PROFILE_SCOPE("Renderer::Draw");
 	va.Bind();
 	shader.Bind();
-	
+	DrawRange(mode, count, first);
+}
+
+void Renderer::DrawRange(DrawMode mode, unsigned int count, unsigned int first) const
+{
 	if (mode == DrawMode::ELEMENTS) 
+		RenderDevice::Get().DrawElements(count, first);
+	else if(mode == DrawMode::ARRAYS)
+		RenderDevice::Get().DrawArrays(count, first);
+	RenderStats::CountDraw(count / 3);
+}
+
+void Renderer::DrawMulti(VertexArray& va, Shader& shader, const int* counts, const void* const* offsets, unsigned int drawCount) const
+{
+	PROFILE_SCOPE("Renderer::DrawMulti");
+	if (drawCount == 0)
+		return;
+
+	va.Bind();
+	shader.Bind();
+	DrawRanges(counts, offsets, drawCount);
+}
+
+void Renderer::DrawRanges(const int* counts, const void* const* offsets, unsigned int drawCount) const
+{
+	RenderDevice::Get().MultiDrawElements(counts, offsets, drawCount);
+
+	unsigned long long indices = 0;
+	for (unsigned int i = 0; i < drawCount; i++)
+		indices += counts[i];
+	RenderStats::CountDraw(indices / 3);
+}
+
+void Renderer::DrawIndirect(VertexArray& va, Shader& shader, const ShaderStorageBuffer& commands, const ShaderStorageBuffer* drawCount, unsigned int maxDrawCount) const
+{
+	PROFILE_SCOPE("Renderer::DrawIndirect");
+	va.Bind();
+	shader.Bind();
+	commands.BindAs(GL_DRAW_INDIRECT_BUFFER);
+
+	if (drawCount)
 	{
-		GLCall(glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr));
+		drawCount->BindAs(GL_PARAMETER_BUFFER_ARB);
+		RenderDevice::Get().MultiDrawElementsIndirectCount(maxDrawCount, sizeof(DrawElementsIndirectCommand));
 	}
-	else if(mode == DrawMode::ARRAYS)
+	else
 	{
-		GLCall(glDrawArrays(GL_TRIANGLES, 0, count));
+		RenderDevice::Get().MultiDrawElementsIndirect(maxDrawCount, sizeof(DrawElementsIndirectCommand));
 	}
+	// The GPU decides how many of the draws survive, the triangles aren't known here
+	RenderStats::CountDraw(0);
 }
 
 void Renderer::Clear() const
 {
-	GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+	RenderDevice::Get().Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void Renderer::Execute(const std::vector<const CommandList*>& lists, const RenderResources& resources, UniformBuffer& uniforms, unsigned int uniformBinding)
+{
+	PROFILE_SCOPE("Renderer::Execute");
+	_mergedCommands.clear();
+	_mergedUniforms.clear();
+	_mergedRangeCounts.clear();
+	_mergedRangeOffsets.clear();
+	for (const CommandList* list : lists)
+	{
+		// Lists pad their blocks to the alignment, so rebasing keeps every offset aligned
+		unsigned int base = (unsigned int)_mergedUniforms.size();
+		unsigned int rangeBase = (unsigned int)_mergedRangeCounts.size();
+		const std::vector<unsigned char>& data = list->GetUniformData();
+		_mergedUniforms.insert(_mergedUniforms.end(), data.begin(), data.end());
+		_mergedRangeCounts.insert(_mergedRangeCounts.end(), list->GetRangeCounts().begin(), list->GetRangeCounts().end());
+		_mergedRangeOffsets.insert(_mergedRangeOffsets.end(), list->GetRangeOffsets().begin(), list->GetRangeOffsets().end());
+		for (RenderCommand command : list->GetCommands())
+		{
+			command.uniformOffset += base;
+			command.firstRange += rangeBase;
+			_mergedCommands.push_back(command);
+		}
+	}
+	if (_mergedCommands.empty())
+		return;
+
+	std::stable_sort(_mergedCommands.begin(), _mergedCommands.end(),
+		[](const RenderCommand& a, const RenderCommand& b) { return a.sortKey < b.sortKey; });
+
+	uniforms.Upload(_mergedUniforms.data(), (unsigned int)_mergedUniforms.size());
+
+	const unsigned short NONE = 0xffff;
+	unsigned short pipelineID = NONE, vertexArrayID = NONE, textureID = NONE;
+	const VertexArray* boundVertexArray = nullptr;
+	// Callers bind programs directly to set their uniforms
+	Pipeline::InvalidateBindings();
+	for (const RenderCommand& command : _mergedCommands)
+	{
+		if (command.pipelineID != pipelineID)
+		{
+			pipelineID = command.pipelineID;
+			const Pipeline* pipeline = resources.GetPipeline(pipelineID);
+			pipeline->Bind();
+			if (pipeline->GetVertexFormat())
+			{
+				boundVertexArray = pipeline->GetVertexFormat();
+				vertexArrayID = NONE;
+			}
+		}
+		if (command.vertexArrayID != vertexArrayID)
+		{
+			vertexArrayID = command.vertexArrayID;
+			resources.BindVertexArray(vertexArrayID, boundVertexArray);
+		}
+		if (command.textureID != textureID)
+		{
+			resources.BindTextures(command.textureID, textureID);
+			textureID = command.textureID;
+		}
+
+		uniforms.BindRange(uniformBinding, command.uniformOffset, sizeof(ObjectUniforms));
+		// Multi draws are a mesh's visible meshlets, single ranges a whole LOD level or mesh
+		if (command.rangeCount > 0)
+			DrawRanges(&_mergedRangeCounts[command.firstRange], &_mergedRangeOffsets[command.firstRange], command.rangeCount);
+		else
+			DrawRange(command.mode, command.count, command.first);
+	}
 }
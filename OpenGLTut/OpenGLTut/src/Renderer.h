@@ -1,6 +1,13 @@
 #pragma once
 #include "Shader.h"
 #include "VertexArray.h"
+#include "ShaderStorageBuffer.h"
+#include "UniformBuffer.h"
+#include <vector>
+
+class CommandList;
+class RenderResources;
+struct RenderCommand;
 
 enum DrawMode {
 	ELEMENTS, ARRAYS
@@ -9,10 +16,29 @@ enum DrawMode {
 class Renderer
 {
 private:
+	std::vector<RenderCommand> _mergedCommands;
+	std::vector<unsigned char> _mergedUniforms;
+	std::vector<int> _mergedRangeCounts;
+	std::vector<const void*> _mergedRangeOffsets;
+
+	// Draw a range or several ranges of what is bound, shared by Draw, DrawMulti and the commands of Execute
+	void DrawRange(DrawMode mode, unsigned int count, unsigned int first) const;
+	void DrawRanges(const int* counts, const void* const* offsets, unsigned int drawCount) const;
 public:
 	Renderer();
 	~Renderer();
 
-	void Draw(DrawMode mode, VertexArray& va, unsigned int count, Shader& shader) const;
+	// first is an index offset for ELEMENTS and a vertex offset for ARRAYS, it selects a sub range
+	// of the bound buffers (for example one LOD level out of a shared index buffer)
+	void Draw(DrawMode mode, VertexArray& va, unsigned int count, Shader& shader, unsigned int first = 0) const;
+	// Draws several ranges of the bound index buffer in one call, offsets are in bytes
+	void DrawMulti(VertexArray& va, Shader& shader, const int* counts, const void* const* offsets, unsigned int drawCount) const;
+	// Submits up to maxDrawCount indexed draws stored in commands, when drawCount is given the
+	// actual number of draws is read from it on the GPU
+	void DrawIndirect(VertexArray& va, Shader& shader, const ShaderStorageBuffer& commands, const ShaderStorageBuffer* drawCount, unsigned int maxDrawCount) const;
 	void Clear() const;
+
+	// Merges command lists recorded on other threads, uploads their uniform data once and issues
+	// the draws sorted by state, binding shaders, vertex arrays and textures only when they change
+	void Execute(const std::vector<const CommandList*>& lists, const RenderResources& resources, UniformBuffer& uniforms, unsigned int uniformBinding = 1);
 };
@@ -0,0 +1,21 @@
+#include "SamplerCache.h"
+
+std::vector<SamplerCache::Entry> SamplerCache::s_samplers;
+
+unsigned int SamplerCache::Get(const SamplerDesc& desc)
+{
+	for (const Entry& entry : s_samplers)
+	{
+		if (entry.desc == desc)
+			return entry.sampler;
+	}
+	s_samplers.push_back({ desc, RenderDevice::Get().CreateSampler(desc) });
+	return s_samplers.back().sampler;
+}
+
+void SamplerCache::ReleaseAll()
+{
+	for (const Entry& entry : s_samplers)
+		RenderDevice::Get().DeleteSampler(entry.sampler);
+	s_samplers.clear();
+}
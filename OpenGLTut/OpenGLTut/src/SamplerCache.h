@@ -0,0 +1,23 @@
+#pragma once
+#include <vector>
+#include "RenderDevice.h"
+
+// Sampler objects shared by everything that samples with the same parameters. Asking for a description that
+// was asked for before gives the same sampler, so textures that sample alike bind the same object and switching
+// between them leaves the sampler binding alone. Samplers live on the current device until ReleaseAll.
+class SamplerCache
+{
+private:
+	struct Entry
+	{
+		SamplerDesc desc;
+		unsigned int sampler;
+	};
+	// A handful of descriptions at most, a linear search beats hashing them
+	static std::vector<Entry> s_samplers;
+public:
+	static unsigned int Get(const SamplerDesc& desc);
+	// Deletes every sampler, before the device they were made on goes away
+	static void ReleaseAll();
+	inline static unsigned int GetCount() { return (unsigned int)s_samplers.size(); };
+};
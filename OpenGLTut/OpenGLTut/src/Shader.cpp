@@ -1,49 +1,83 @@
 #include "Shader.h"
 #include "Utils.h"
-#include <GL/glew.h>
+#include "Profiler.h"
+#include "RenderStats.h"
+#include "RenderDevice.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
-#include <cstring>
 
 Shader::Shader(const std::string&  filePath)
-    : _filename(filePath), _rendererID(0)
+    : _filename(filePath), _rendererID(0), _isCompute(false)
 {
+    PROFILE_SCOPE("Shader::Shader");
     ShaderProgramSource source = ParseShader(filePath);
-    _rendererID = CreateShader(source.VertexSource, source.FragmentSource);
+    // A file with a compute section is a compute program, it can't be mixed with the graphics stages
+    _isCompute = !source.ComputeSource.empty();
+    _rendererID = RenderDevice::Get().CreateProgram(source.VertexSource, source.FragmentSource, source.ComputeSource);
 }
 
 Shader::~Shader()
 {
-    GLCall(glDeleteProgram(_rendererID));
+    RenderDevice::Get().DeleteProgram(_rendererID);
 }
 
 void Shader::Bind() const
 {
-    GLCall(glUseProgram(_rendererID));
+    RenderStats::CountStateChange(STATE_SHADER);
+    RenderDevice::Get().UseProgram(_rendererID);
 }
 
 void Shader::Unbind() const
 {
-    GLCall(glDeleteProgram(_rendererID));
+    RenderDevice::Get().UseProgram(0);
 }
 
 void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3) const
 {
-    GLCall(int location = glGetUniformLocation(_rendererID, name.c_str()));
-    GLCall(glUniform4f(location, v0, v1, v2, v3));
+    RenderStats::CountUniformUpload();
+    float values[] = { v0, v1, v2, v3 };
+    RenderDevice::Get().SetUniform(_rendererID, name, UNIFORM_4F, values, 1);
 }
 
 void Shader::SetUniform2f(const std::string& name, float v0, float v1) const
 {
-    GLCall(int location = glGetUniformLocation(_rendererID, name.c_str()));
-    GLCall(glUniform2f(location, v0, v1));
+    RenderStats::CountUniformUpload();
+    float values[] = { v0, v1 };
+    RenderDevice::Get().SetUniform(_rendererID, name, UNIFORM_2F, values, 1);
 }
  
+void Shader::SetUniform1i(const std::string& name, int v0) const
+{
+    RenderStats::CountUniformUpload();
+    RenderDevice::Get().SetUniform(_rendererID, name, UNIFORM_1I, &v0, 1);
+}
+
+void Shader::SetUniform1ui(const std::string& name, unsigned int v0) const
+{
+    RenderStats::CountUniformUpload();
+    RenderDevice::Get().SetUniform(_rendererID, name, UNIFORM_1UI, &v0, 1);
+}
+
+void Shader::SetUniform4fv(const std::string& name, int count, const float* v) const
+{
+    RenderStats::CountUniformUpload();
+    RenderDevice::Get().SetUniform(_rendererID, name, UNIFORM_4FV, v, count);
+}
+
 void Shader::SetUniformMatrix4fv(const std::string& name, bool transpose, float* v) const
 {
-    GLCall(int location = glGetUniformLocation(_rendererID, name.c_str()));
-    GLCall(glUniformMatrix4fv(location, 1, transpose, v));
+    RenderStats::CountUniformUpload();
+    // Devices take column major matrices
+    float matrix[16];
+    for (int i = 0; i < 16; i++)
+        matrix[i] = transpose ? v[(i % 4) * 4 + i / 4] : v[i];
+    RenderDevice::Get().SetUniform(_rendererID, name, UNIFORM_MATRIX4FV, matrix, 1);
+}
+
+void Shader::SetUniformBlockBinding(const std::string& name, unsigned int binding) const
+{
+    RenderDevice::Get().SetUniformBlockBinding(_rendererID, name, binding);
 }
 
 ShaderProgramSource Shader::ParseShader(const std::string & filepath) {
@@ -51,12 +85,12 @@ ShaderProgramSource Shader::ParseShader(const std::string & filepath) {
 
     enum class ShaderType
     {
-        NONE = -1, VERTEX = 0, FRAGMENT = 1
+        NONE = -1, VERTEX = 0, FRAGMENT = 1, COMPUTE = 2
     };
 
     std::string line;
     ShaderType shaderType = ShaderType::NONE;
-    std::stringstream stringStream[2];
+    std::stringstream stringStream[3];
 
     // Loop through each line of the file
     while (getline(stream, line)) {
@@ -67,69 +101,17 @@ ShaderProgramSource Shader::ParseShader(const std::string & filepath) {
                 shaderType = ShaderType::VERTEX;
             if (line.find("fragment") != std::string::npos)
                 shaderType = ShaderType::FRAGMENT;
+            if (line.find("compute") != std::string::npos)
+                shaderType = ShaderType::COMPUTE;
         }
-        else {
+        else if (shaderType != ShaderType::NONE) {
             stringStream[(int)shaderType] << line << "\n";
         }
     }
 
     return { 
         stringStream[(int)ShaderType::VERTEX].str(), 
-        stringStream[(int)ShaderType::FRAGMENT].str() 
+        stringStream[(int)ShaderType::FRAGMENT].str(),
+        stringStream[(int)ShaderType::COMPUTE].str()
     };
 }
-
-unsigned int Shader::CompileShader(unsigned int type, const std::string& source) {
-    // Creates a shader object
-    GLCall(unsigned int shaderId = glCreateShader(type));
-
-    const char* src = source.c_str();
-    // Copies the source code provided to the shader, any source code prevously stored in the shader is removed
-    // It doesnt compile the source code, it simply copies it to the shader
-    GLCall(glShaderSource(shaderId, 1, &src, nullptr));
-    // Actually compiles the source code strings that have been copied into the shader
-    // Any compilation states (success, error) will be stored in the shader objects state
-    GLCall(glCompileShader(shaderId));
-
-    int shaderCompileStatus;
-    // Returns a parameter from the shader object (in this case, a compile status),
-    GLCall(glGetShaderiv(shaderId, GL_COMPILE_STATUS, &shaderCompileStatus));
-    if (shaderCompileStatus != GL_TRUE) {
-        int shaderLogLength;
-        GLCall(glGetShaderiv(shaderId, GL_INFO_LOG_LENGTH, &shaderLogLength));
-
-
-        char* message = (char*)alloca(shaderLogLength * sizeof(char));
-        // Returns the information log for a shader object
-        GLCall(glGetShaderInfoLog(shaderId, shaderLogLength, &shaderLogLength, message));
-        std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << " shader!" << std::endl;
-        std::cout << message << std::endl;
-
-        GLCall(glDeleteShader(shaderId));
-        return 0;
-    }
-
-    return shaderId;
-}
-
-unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader) {
-    // Reference: https://open.gl/drawing
-
-    // Creates an empty program object
-    GLCall(unsigned int program = glCreateProgram());
-
-    unsigned int vShader = CompileShader(GL_VERTEX_SHADER, vertexShader);
-    unsigned int fShader = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
-   
-    // Attaches actual shader object to the program
-    GLCall(glAttachShader(program, vShader));
-    GLCall(glAttachShader(program, fShader));
-
-    GLCall(glLinkProgram(program));
-    GLCall(glValidateProgram(program));
-
-    GLCall(glDeleteShader(vShader));
-    GLCall(glDeleteShader(fShader));
-
-    return program;
-};
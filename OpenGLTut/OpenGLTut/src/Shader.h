@@ -4,6 +4,7 @@
 struct ShaderProgramSource {
     std::string VertexSource;
     std::string FragmentSource;
+    std::string ComputeSource;
 };
 
 class Shader
@@ -11,6 +12,7 @@ class Shader
 private:
     unsigned int _rendererID;
     std::string _filename;
+    bool _isCompute;
 public:
     Shader(const std::string& filePath);
     ~Shader();
@@ -20,9 +22,13 @@ public:
 
     void SetUniform4f(const std::string& name, float v1, float v2, float v3, float v4) const;
 	void SetUniform2f(const std::string& name, float v0, float v1) const;
+    void SetUniform1i(const std::string& name, int v0) const;
+    void SetUniform1ui(const std::string& name, unsigned int v0) const;
+    void SetUniform4fv(const std::string& name, int count, const float* v) const;
     void SetUniformMatrix4fv(const std::string& name, bool transpose, float* v) const;
+    void SetUniformBlockBinding(const std::string& name, unsigned int binding) const;
+
+    inline bool IsCompute() const { return _isCompute; };
 private:
     ShaderProgramSource ParseShader(const std::string& filepath);
-    static unsigned int CompileShader(unsigned int type, const std::string& source);
-    unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
 };
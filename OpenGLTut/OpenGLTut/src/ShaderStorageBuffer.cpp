@@ -0,0 +1,51 @@
+#include "ShaderStorageBuffer.h"
+#include "Utils.h"
+#include "RenderStats.h"
+#include "RenderDevice.h"
+
+ShaderStorageBuffer::ShaderStorageBuffer(const void* data, unsigned int size) : _size(size)
+{
+	_rendererID = RenderDevice::Get().CreateBuffer(GL_SHADER_STORAGE_BUFFER, data, size, GL_DYNAMIC_DRAW);
+	if (data)
+		RenderStats::CountBufferUpload(size);
+}
+
+ShaderStorageBuffer::~ShaderStorageBuffer()
+{
+	RenderDevice::Get().DeleteBuffer(_rendererID);
+}
+
+void ShaderStorageBuffer::Bind() const
+{
+	RenderStats::CountStateChange(STATE_BUFFER);
+	RenderDevice::Get().BindBuffer(GL_SHADER_STORAGE_BUFFER, _rendererID);
+}
+
+void ShaderStorageBuffer::Unbind() const
+{
+	RenderDevice::Get().BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void ShaderStorageBuffer::BindBase(unsigned int target, unsigned int index) const
+{
+	RenderStats::CountStateChange(STATE_BUFFER);
+	RenderDevice::Get().BindBufferBase(target, index, _rendererID);
+}
+
+void ShaderStorageBuffer::BindAs(unsigned int target) const
+{
+	RenderStats::CountStateChange(STATE_BUFFER);
+	RenderDevice::Get().BindBuffer(target, _rendererID);
+}
+
+void ShaderStorageBuffer::Update(const void* data, unsigned int offset, unsigned int size) const
+{
+	RenderDevice::Get().UpdateBuffer(GL_SHADER_STORAGE_BUFFER, _rendererID, offset, size, data);
+	RenderStats::CountBufferUpload(size);
+}
+
+void ShaderStorageBuffer::Clear() const
+{
+	// Fills the whole buffer with zeros on the GPU, no client memory is involved
+	RenderDevice::Get().ClearBuffer(GL_SHADER_STORAGE_BUFFER, _rendererID);
+}
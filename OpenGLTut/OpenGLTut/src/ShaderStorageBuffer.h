@@ -0,0 +1,26 @@
+#pragma once
+
+// Generic GPU buffer used by compute passes, the same storage can also be bound as an
+// indirect draw buffer, a parameter buffer or an atomic counter buffer
+class ShaderStorageBuffer
+{
+	private:
+		unsigned int _rendererID;
+		unsigned int _size;
+	public:
+		ShaderStorageBuffer(const void* data, unsigned int size);
+		~ShaderStorageBuffer();
+
+		void Bind() const;
+		void Unbind() const;
+
+		// Binds the buffer to an indexed binding point (GL_SHADER_STORAGE_BUFFER, GL_ATOMIC_COUNTER_BUFFER...)
+		void BindBase(unsigned int target, unsigned int index) const;
+		void BindAs(unsigned int target) const;
+
+		void Update(const void* data, unsigned int offset, unsigned int size) const;
+		void Clear() const;
+
+		inline unsigned int getSize() const { return _size; };
+		inline unsigned int getRendererID() const { return _rendererID; };
+};
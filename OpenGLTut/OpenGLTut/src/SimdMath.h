@@ -0,0 +1,39 @@
+#pragma once
+#include <glm/ext/matrix_float4x4.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_MATH_SSE 1
+#include <emmintrin.h>
+#endif
+
+// out = a * b for column major matrices, out may alias either input
+inline void MultiplyMatrix(const glm::mat4& a, const glm::mat4& b, glm::mat4& out)
+{
+#ifdef SIMD_MATH_SSE
+	const float* pa = &a[0][0];
+	const float* pb = &b[0][0];
+	__m128 a0 = _mm_loadu_ps(pa);
+	__m128 a1 = _mm_loadu_ps(pa + 4);
+	__m128 a2 = _mm_loadu_ps(pa + 8);
+	__m128 a3 = _mm_loadu_ps(pa + 12);
+
+	__m128 columns[4];
+	for (int c = 0; c < 4; c++)
+	{
+		// Every column of the result is the columns of a weighted by one column of b
+		__m128 r = _mm_mul_ps(a0, _mm_set1_ps(pb[c * 4]));
+		r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(pb[c * 4 + 1])));
+		r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(pb[c * 4 + 2])));
+		r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(pb[c * 4 + 3])));
+		columns[c] = r;
+	}
+
+	float* po = &out[0][0];
+	_mm_storeu_ps(po, columns[0]);
+	_mm_storeu_ps(po + 4, columns[1]);
+	_mm_storeu_ps(po + 8, columns[2]);
+	_mm_storeu_ps(po + 12, columns[3]);
+#else
+	out = a * b;
+#endif
+}
@@ -0,0 +1,536 @@
+#include "SoftwareDevice.h"
+#include "GLCapture.h"
+#include "Profiler.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+SoftwareDevice::SoftwareDevice(unsigned int width, unsigned int height, const ParallelForFunction& parallelFor) :
+	_nextName(1), _program(0), _vertexArray(0), _texture(0), _depthTest(false), _depthWrite(true), _cullFace(false), _errors(0),
+	_parallelFor(parallelFor), _rasterizer(width, height, parallelFor)
+{
+}
+
+bool SoftwareDevice::Check(bool condition, const char* call, const char* message)
+{
+	if (condition)
+		return true;
+	if (_errors++ < PRINTED_ERRORS)
+		std::cout << "Software device: " << call << ": " << message << std::endl;
+	return false;
+}
+
+std::vector<unsigned char>* SoftwareDevice::FindBuffer(unsigned int buffer)
+{
+	auto found = _buffers.find(buffer);
+	return found != _buffers.end() ? &found->second : nullptr;
+}
+
+const void* SoftwareDevice::ProgramUniforms::FindUniform(const std::string& name) const
+{
+	auto uniform = _program.uniforms.find(name);
+	return uniform != _program.uniforms.end() ? uniform->second.data() : nullptr;
+}
+
+const unsigned char* SoftwareDevice::ProgramUniforms::FindBlock(const std::string& name, unsigned int& size) const
+{
+	// Blocks nobody assigned a binding to use binding 0, like in GL
+	auto binding = _program.blockBindings.find(name);
+	auto range = _device._uniformRanges.find(binding != _program.blockBindings.end() ? binding->second : 0);
+	if (range == _device._uniformRanges.end())
+		return nullptr;
+	auto buffer = _device._buffers.find(range->second.buffer);
+	if (buffer == _device._buffers.end() || range->second.offset >= buffer->second.size())
+		return nullptr;
+	size = std::min(range->second.size, (unsigned int)buffer->second.size() - range->second.offset);
+	return buffer->second.data() + range->second.offset;
+}
+
+unsigned int SoftwareDevice::CreateBuffer(unsigned int target, const void* data, unsigned int size, unsigned int /*usage*/)
+{
+	unsigned int buffer = _nextName++;
+	std::vector<unsigned char>& storage = _buffers[buffer];
+	if (data)
+		storage.assign((const unsigned char*)data, (const unsigned char*)data + size);
+	else
+		storage.assign(size, 0);
+	_boundBuffers[target] = buffer;
+	return buffer;
+}
+
+void SoftwareDevice::DeleteBuffer(unsigned int buffer)
+{
+	// Queued draws were vertex shaded already, they don't read buffers anymore
+	Check(_buffers.erase(buffer) != 0, "delete_buffer", "unknown buffer");
+	for (auto& bound : _boundBuffers)
+	{
+		if (bound.second == buffer)
+			bound.second = 0;
+	}
+}
+
+void SoftwareDevice::BindBuffer(unsigned int target, unsigned int buffer)
+{
+	if (buffer == 0 || Check(FindBuffer(buffer) != nullptr, "bind_buffer", "unknown buffer"))
+		_boundBuffers[target] = buffer;
+}
+
+void SoftwareDevice::BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer)
+{
+	BindBufferRange(target, index, buffer, 0, ~0u);
+}
+
+void SoftwareDevice::BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, unsigned int offset, unsigned int size)
+{
+	if (!Check(FindBuffer(buffer) != nullptr, "bind_buffer_range", "unknown buffer"))
+		return;
+	_boundBuffers[target] = buffer;
+	if (target == GL_UNIFORM_BUFFER)
+		_uniformRanges[index] = { buffer, offset, size };
+}
+
+void SoftwareDevice::ResizeBuffer(unsigned int /*target*/, unsigned int buffer, unsigned int size, unsigned int /*usage*/)
+{
+	std::vector<unsigned char>* storage = FindBuffer(buffer);
+	if (Check(storage != nullptr, "resize_buffer", "unknown buffer"))
+		storage->assign(size, 0);
+}
+
+void SoftwareDevice::UpdateBuffer(unsigned int /*target*/, unsigned int buffer, unsigned int offset, unsigned int size, const void* data)
+{
+	std::vector<unsigned char>* storage = FindBuffer(buffer);
+	if (!Check(storage != nullptr, "update_buffer", "unknown buffer"))
+		return;
+	if (Check((unsigned long long)offset + size <= storage->size(), "update_buffer", "write past the end of the buffer") && size > 0)
+		memcpy(storage->data() + offset, data, size);
+}
+
+void SoftwareDevice::ClearBuffer(unsigned int /*target*/, unsigned int buffer)
+{
+	std::vector<unsigned char>* storage = FindBuffer(buffer);
+	if (Check(storage != nullptr, "clear_buffer", "unknown buffer"))
+		std::fill(storage->begin(), storage->end(), (unsigned char)0);
+}
+
+unsigned int SoftwareDevice::CreateVertexArray()
+{
+	unsigned int vertexArray = _nextName++;
+	_vertexArrays[vertexArray].indexBuffer = 0;
+	return vertexArray;
+}
+
+void SoftwareDevice::DeleteVertexArray(unsigned int vertexArray)
+{
+	Check(_vertexArrays.erase(vertexArray) != 0, "delete_vertex_array", "unknown vertex array");
+	if (_vertexArray == vertexArray)
+		_vertexArray = 0;
+}
+
+void SoftwareDevice::BindVertexArray(unsigned int vertexArray)
+{
+	if (vertexArray == 0 || Check(_vertexArrays.count(vertexArray) != 0, "bind_vertex_array", "unknown vertex array"))
+		_vertexArray = vertexArray;
+}
+
+void SoftwareDevice::SetVertexAttributes(unsigned int vertexArray, unsigned int buffer, const VertexAttribute* attributes, unsigned int count)
+{
+	if (count == 0)
+		return;
+	// Same split as the GL 4.5 device, a binding per call named after its first attribute
+	SetVertexFormat(vertexArray, attributes[0].index, attributes, count);
+	SetVertexBuffer(vertexArray, attributes[0].index, buffer, 0, attributes[0].stride);
+}
+
+void SoftwareDevice::SetVertexFormat(unsigned int vertexArray, unsigned int binding, const VertexAttribute* attributes, unsigned int count)
+{
+	auto state = _vertexArrays.find(vertexArray);
+	if (!Check(state != _vertexArrays.end(), "set_vertex_format", "unknown vertex array"))
+		return;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		// A location set again replaces its old format, the divisor belongs to the binding
+		std::vector<VertexAttribute>& existing = state->second.attributes;
+		VertexAttribute attribute = attributes[i];
+		attribute.divisor = attributes[0].divisor;
+		size_t slot = 0;
+		while (slot < existing.size() && existing[slot].index != attribute.index)
+			slot++;
+		if (slot == existing.size())
+		{
+			existing.push_back(attribute);
+			state->second.bindings.push_back(binding);
+		}
+		else
+		{
+			existing[slot] = attribute;
+			state->second.bindings[slot] = binding;
+		}
+	}
+}
+
+void SoftwareDevice::SetVertexBuffer(unsigned int vertexArray, unsigned int binding, unsigned int buffer, unsigned int offset, unsigned int stride)
+{
+	auto state = _vertexArrays.find(vertexArray);
+	if (Check(state != _vertexArrays.end(), "set_vertex_buffer", "unknown vertex array"))
+		state->second.vertexBuffers[binding] = { buffer, offset, stride };
+}
+
+void SoftwareDevice::SetIndexBuffer(unsigned int vertexArray, unsigned int buffer)
+{
+	auto state = _vertexArrays.find(vertexArray);
+	if (Check(state != _vertexArrays.end(), "set_index_buffer", "unknown vertex array"))
+		state->second.indexBuffer = buffer;
+}
+
+unsigned int SoftwareDevice::CreateTexture2D(const void* pixels, int width, int height, int channels)
+{
+	PROFILE_SCOPE("SoftwareDevice::CreateTexture2D");
+	unsigned int texture = _nextName++;
+	_textures[texture].reset(new SoftwareTexture((const unsigned char*)pixels, (unsigned int)width, (unsigned int)height, channels));
+	_texture = texture;
+	return texture;
+}
+
+void SoftwareDevice::DeleteTexture(unsigned int texture)
+{
+	// Queued triangles still sample it
+	_rasterizer.Flush();
+	Check(_textures.erase(texture) != 0, "delete_texture", "unknown texture");
+	if (_texture == texture)
+		_texture = 0;
+}
+
+void SoftwareDevice::BindTextures(unsigned int first, const unsigned int* textures, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i++)
+	{
+		unsigned int texture = textures ? textures[i] : 0;
+		if ((texture == 0 || Check(_textures.count(texture) != 0, "bind_textures", "unknown texture")) && first + i == 0)
+			_texture = texture;
+	}
+}
+
+unsigned int SoftwareDevice::CreateSampler(const SamplerDesc& desc)
+{
+	unsigned int sampler = _nextName++;
+	_samplers[sampler] = desc;
+	return sampler;
+}
+
+void SoftwareDevice::DeleteSampler(unsigned int sampler)
+{
+	Check(_samplers.erase(sampler) != 0, "delete_sampler", "unknown sampler");
+}
+
+void SoftwareDevice::BindSamplers(unsigned int /*first*/, const unsigned int* samplers, unsigned int count)
+{
+	for (unsigned int i = 0; samplers && i < count; i++)
+	{
+		if (samplers[i] == 0)
+			continue;
+		auto sampler = _samplers.find(samplers[i]);
+		if (Check(sampler != _samplers.end(), "bind_samplers", "unknown sampler"))
+			Check(sampler->second.wrapS == GL_REPEAT && sampler->second.wrapT == GL_REPEAT, "bind_samplers", "only GL_REPEAT wrapping is supported");
+	}
+}
+
+unsigned int SoftwareDevice::CreateProgram(const std::string& vertexSource, const std::string& fragmentSource, const std::string& computeSource)
+{
+	unsigned int program = _nextName++;
+	if (computeSource.empty())
+		_programs[program].shader.reset(SoftwareShader::Create(vertexSource, fragmentSource));
+	else
+		_programs[program];
+	if (!_programs[program].shader)
+		std::cout << "Software device: no C++ shader implements program " << program << ", its draws are skipped" << std::endl;
+	return program;
+}
+
+void SoftwareDevice::DeleteProgram(unsigned int program)
+{
+	// Queued triangles still run its shader
+	_rasterizer.Flush();
+	Check(_programs.erase(program) != 0, "delete_program", "unknown program");
+	if (_program == program)
+		_program = 0;
+}
+
+void SoftwareDevice::UseProgram(unsigned int program)
+{
+	if (program == 0 || Check(_programs.count(program) != 0, "use_program", "unknown program"))
+		_program = program;
+}
+
+void SoftwareDevice::SetUniform(unsigned int program, const std::string& name, UniformType type, const void* values, int count)
+{
+	auto found = _programs.find(program);
+	if (!Check(found != _programs.end(), "set_uniform", "unknown program"))
+		return;
+	std::vector<unsigned char>& value = found->second.uniforms[name];
+	const unsigned char* bytes = (const unsigned char*)values;
+	value.assign(bytes, bytes + GLCapture::GetUniformWords(type, count) * 4);
+}
+
+void SoftwareDevice::SetUniformBlockBinding(unsigned int program, const std::string& name, unsigned int binding)
+{
+	auto found = _programs.find(program);
+	if (Check(found != _programs.end(), "set_uniform_block_binding", "unknown program"))
+		found->second.blockBindings[name] = binding;
+}
+
+void SoftwareDevice::FetchAttributes(const AttributeSource* sources, unsigned int sourceCount, unsigned int vertex, unsigned int instance, SoftwareVertexInput& input)
+{
+	for (glm::vec4& attribute : input.attributes)
+		attribute = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+	for (unsigned int s = 0; s < sourceCount; s++)
+	{
+		const VertexAttribute& attribute = sources[s].attribute;
+		unsigned int componentSize = (attribute.type == GL_BYTE || attribute.type == GL_UNSIGNED_BYTE) ? 1 : 4;
+		unsigned int components = std::min(4u, attribute.count);
+		unsigned int stride = attribute.stride ? attribute.stride : componentSize * attribute.count;
+		unsigned int element = attribute.divisor ? instance / attribute.divisor : vertex;
+		unsigned long long offset = attribute.offset + (unsigned long long)element * stride;
+		// Reads past the end give the default, like robust buffer access
+		if (offset + componentSize * components > sources[s].size)
+			continue;
+
+		const unsigned char* data = sources[s].data + offset;
+		glm::vec4& value = input.attributes[attribute.index];
+		for (unsigned int c = 0; c < components; c++)
+		{
+			const unsigned char* component = data + c * componentSize;
+			switch (attribute.type)
+			{
+			case GL_FLOAT:
+				memcpy(&value[c], component, 4);
+				break;
+			case GL_UNSIGNED_INT:
+			{
+				unsigned int integer;
+				memcpy(&integer, component, 4);
+				value[c] = (float)integer;
+				break;
+			}
+			case GL_INT:
+			{
+				int integer;
+				memcpy(&integer, component, 4);
+				value[c] = (float)integer;
+				break;
+			}
+			case GL_UNSIGNED_BYTE:
+				value[c] = attribute.normalized ? *component / 255.0f : (float)*component;
+				break;
+			case GL_BYTE:
+				value[c] = attribute.normalized ? std::max(-1.0f, (signed char)*component / 127.0f) : (float)(signed char)*component;
+				break;
+			}
+		}
+	}
+}
+
+void SoftwareDevice::Draw(const char* call, const unsigned int* indices, unsigned int count, unsigned int first, int baseVertex, unsigned int instance)
+{
+	count -= count % 3;
+	if (count == 0)
+		return;
+	auto program = _programs.find(_program);
+	if (!Check(program != _programs.end(), call, "no program in use"))
+		return;
+	// Reported when the program was created
+	const SoftwareShader* shader = program->second.shader.get();
+	if (!shader)
+		return;
+	auto vertexArray = _vertexArrays.find(_vertexArray);
+	if (!Check(vertexArray != _vertexArrays.end(), call, "no vertex array bound"))
+		return;
+
+	SoftwareDrawState state;
+	state.shader = shader;
+	auto texture = _textures.find(_texture);
+	state.texture = texture != _textures.end() ? texture->second.get() : nullptr;
+	state.depthTest = _depthTest;
+	state.depthWrite = _depthWrite;
+	state.cullBackFaces = _cullFace;
+	if (!Check(shader->PrepareDraw(ProgramUniforms(*this, program->second), state.constants), call, "a uniform the shader reads isn't set"))
+		return;
+
+	// Only the vertices between the smallest and the largest index get shaded
+	long long minVertex = first, maxVertex = (long long)first + count - 1;
+	if (indices)
+	{
+		unsigned int minIndex = ~0u, maxIndex = 0;
+		for (unsigned int i = 0; i < count; i++)
+		{
+			minIndex = std::min(minIndex, indices[i]);
+			maxIndex = std::max(maxIndex, indices[i]);
+		}
+		minVertex = (long long)minIndex + baseVertex;
+		maxVertex = (long long)maxIndex + baseVertex;
+		if (!Check(minVertex >= 0, call, "negative vertex index"))
+			return;
+	}
+
+	AttributeSource sources[SOFTWARE_MAX_ATTRIBUTES];
+	unsigned int sourceCount = 0;
+	const VertexArrayState& attributes = vertexArray->second;
+	for (size_t a = 0; a < attributes.attributes.size(); a++)
+	{
+		if (attributes.attributes[a].index >= SOFTWARE_MAX_ATTRIBUTES)
+			continue;
+		auto binding = attributes.vertexBuffers.find(attributes.bindings[a]);
+		if (!Check(binding != attributes.vertexBuffers.end(), call, "no vertex buffer attached to the attribute's binding"))
+			continue;
+		std::vector<unsigned char>* buffer = FindBuffer(binding->second.buffer);
+		if (!Check(buffer != nullptr, call, "attribute buffer was deleted"))
+			continue;
+		VertexAttribute attribute = attributes.attributes[a];
+		attribute.offset += binding->second.offset;
+		attribute.stride = binding->second.stride;
+		sources[sourceCount++] = { attribute, buffer->data(), (unsigned int)buffer->size() };
+	}
+
+	unsigned int vertexCount = (unsigned int)(maxVertex - minVertex + 1);
+	SoftwareVertexOutput* vertices = nullptr;
+	unsigned int* triangleIndices = nullptr;
+	_rasterizer.AddDraw(state, vertexCount, count, vertices, triangleIndices);
+	for (unsigned int i = 0; i < count; i++)
+		triangleIndices[i] = indices ? (unsigned int)((long long)indices[i] + baseVertex - minVertex) : i;
+
+	unsigned int firstVertex = (unsigned int)minVertex;
+	auto shadeVertices = [&](unsigned int begin, unsigned int end)
+	{
+		SoftwareVertexInput input;
+		for (unsigned int v = begin; v < end; v++)
+		{
+			FetchAttributes(sources, sourceCount, firstVertex + v, instance, input);
+			shader->ShadeVertex(state.constants, input, vertices[v]);
+		}
+	};
+	if (_parallelFor && vertexCount >= PARALLEL_VERTEX_COUNT)
+		_parallelFor(vertexCount, PARALLEL_VERTEX_COUNT / 4, shadeVertices);
+	else
+		shadeVertices(0, vertexCount);
+}
+
+void SoftwareDevice::DrawElements(unsigned int count, unsigned int first)
+{
+	auto vertexArray = _vertexArrays.find(_vertexArray);
+	if (!Check(vertexArray != _vertexArrays.end(), "draw_elements", "no vertex array bound"))
+		return;
+	std::vector<unsigned char>* indices = FindBuffer(vertexArray->second.indexBuffer);
+	if (!Check(indices != nullptr, "draw_elements", "the vertex array has no index buffer"))
+		return;
+	if (!Check(((unsigned long long)first + count) * 4 <= indices->size(), "draw_elements", "indices past the end of the index buffer"))
+		return;
+	Draw("draw_elements", (const unsigned int*)indices->data() + first, count, 0, 0, 0);
+}
+
+void SoftwareDevice::DrawArrays(unsigned int count, unsigned int first)
+{
+	Draw("draw_arrays", nullptr, count, first, 0, 0);
+}
+
+void SoftwareDevice::MultiDrawElements(const int* counts, const void* const* offsets, unsigned int drawCount)
+{
+	for (unsigned int i = 0; i < drawCount; i++)
+		DrawElements((unsigned int)counts[i], (unsigned int)((size_t)offsets[i] / sizeof(unsigned int)));
+}
+
+void SoftwareDevice::DrawIndirect(const char* call, unsigned int drawCount, unsigned int stride)
+{
+	std::vector<unsigned char>* commands = FindBuffer(_boundBuffers[GL_DRAW_INDIRECT_BUFFER]);
+	if (!Check(commands != nullptr, call, "no draw indirect buffer bound"))
+		return;
+	auto vertexArray = _vertexArrays.find(_vertexArray);
+	if (!Check(vertexArray != _vertexArrays.end(), call, "no vertex array bound"))
+		return;
+	std::vector<unsigned char>* indices = FindBuffer(vertexArray->second.indexBuffer);
+	if (!Check(indices != nullptr, call, "the vertex array has no index buffer"))
+		return;
+
+	// count, instanceCount, firstIndex, baseVertex, baseInstance
+	const unsigned int COMMAND_SIZE = 5 * sizeof(unsigned int);
+	stride = stride ? stride : COMMAND_SIZE;
+	for (unsigned int i = 0; i < drawCount; i++)
+	{
+		if (!Check((unsigned long long)i * stride + COMMAND_SIZE <= commands->size(), call, "commands past the end of the buffer"))
+			return;
+		unsigned int command[5];
+		memcpy(command, commands->data() + (size_t)i * stride, COMMAND_SIZE);
+		if (!Check(((unsigned long long)command[2] + command[0]) * 4 <= indices->size(), call, "indices past the end of the index buffer"))
+			continue;
+		// Every instance is its own draw, the instanced attributes are the only thing that changes
+		for (unsigned int instance = 0; instance < command[1]; instance++)
+			Draw(call, (const unsigned int*)indices->data() + command[2], command[0], 0, (int)command[3], command[4] + instance);
+	}
+}
+
+void SoftwareDevice::MultiDrawElementsIndirect(unsigned int drawCount, unsigned int stride)
+{
+	DrawIndirect("multi_draw_indirect", drawCount, stride);
+}
+
+void SoftwareDevice::MultiDrawElementsIndirectCount(unsigned int maxDrawCount, unsigned int stride)
+{
+	std::vector<unsigned char>* parameters = FindBuffer(_boundBuffers[GL_PARAMETER_BUFFER_ARB]);
+	if (!Check(parameters != nullptr && parameters->size() >= sizeof(unsigned int), "multi_draw_indirect_count", "no parameter buffer bound"))
+		return;
+	unsigned int drawCount;
+	memcpy(&drawCount, parameters->data(), sizeof(drawCount));
+	DrawIndirect("multi_draw_indirect_count", std::min(drawCount, maxDrawCount), stride);
+}
+
+void SoftwareDevice::Clear(unsigned int mask)
+{
+	_rasterizer.Clear((mask & GL_COLOR_BUFFER_BIT) != 0, (mask & GL_DEPTH_BUFFER_BIT) != 0);
+}
+
+void SoftwareDevice::Enable(unsigned int capability)
+{
+	if (capability == GL_DEPTH_TEST)
+		_depthTest = true;
+	if (capability == GL_CULL_FACE)
+		_cullFace = true;
+}
+
+void SoftwareDevice::Disable(unsigned int capability)
+{
+	if (capability == GL_DEPTH_TEST)
+		_depthTest = false;
+	if (capability == GL_CULL_FACE)
+		_cullFace = false;
+}
+
+void SoftwareDevice::Flush()
+{
+	_rasterizer.Flush();
+}
+
+void SoftwareDevice::SetRenderState(const RenderState& state, unsigned int groups)
+{
+	const char* call = "set_render_state";
+	if (groups & RENDER_STATE_DEPTH_TEST)
+		_depthTest = state.depthTest;
+	if (groups & RENDER_STATE_DEPTH_WRITE)
+		_depthWrite = state.depthWrite;
+	if (groups & RENDER_STATE_CULL_FACE)
+		_cullFace = state.cullFace;
+	if (groups & RENDER_STATE_DEPTH_FUNC)
+		Check(state.depthFunc == GL_LESS, call, "only GL_LESS depth tests are supported");
+	if (groups & RENDER_STATE_BLEND)
+		Check(!state.blend, call, "blending is not supported");
+	if (groups & (RENDER_STATE_CULL_MODE | RENDER_STATE_FRONT_FACE))
+		Check(state.cullMode == GL_BACK && state.frontFace == GL_CCW, call, "only back faces of counter clockwise triangles are culled");
+	if (groups & RENDER_STATE_POLYGON_MODE)
+		Check(state.polygonMode == GL_FILL, call, "only filled polygons are supported");
+	if (groups & RENDER_STATE_STENCIL_TEST)
+		Check(!state.stencilTest, call, "there is no stencil buffer");
+}
+
+void SoftwareDevice::Barrier(unsigned int /*barriers*/)
+{
+	// Nothing writes through image or buffer stores here, every draw sees the ones before it
+}
@@ -0,0 +1,161 @@
+#pragma once
+#include "RenderDevice.h"
+#include "SoftwareRasterizer.h"
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Backend without GL that renders on the CPU into its own color and depth target, for machines without
+// a GPU. Buffers and textures live in memory, programs run as the SoftwareShader matching their GLSL
+// (programs without one, like compute programs, are created but their draws are skipped). Draws are
+// vertex shaded right away and rasterized by SoftwareRasterizer on Flush, Clear and ReadPixels.
+// Depth testing (GL_LESS), depth writes and culling of clockwise back faces are the only fixed function
+// state it knows, render states asking for more are reported. Its shaders sample texture unit 0 with
+// repeat wrapping and their own bilinear filter, samplers only get their wrap modes checked.
+class SoftwareDevice : public RenderDevice
+{
+public:
+	static const unsigned int PRINTED_ERRORS = 16;
+	// Draws with more vertices than this shade them on the job threads
+	static const unsigned int PARALLEL_VERTEX_COUNT = 4096;
+private:
+	// The buffer attached to one binding of a vertex array
+	struct VertexBinding
+	{
+		unsigned int buffer;
+		unsigned int offset;
+		unsigned int stride;
+	};
+
+	struct VertexArrayState
+	{
+		std::vector<VertexAttribute> attributes;
+		// Binding every attribute reads from
+		std::vector<unsigned int> bindings;
+		std::unordered_map<unsigned int, VertexBinding> vertexBuffers;
+		unsigned int indexBuffer;
+	};
+
+	struct Program
+	{
+		std::unique_ptr<SoftwareShader> shader;
+		// Values as they were set, UniformType decides the size
+		std::unordered_map<std::string, std::vector<unsigned char>> uniforms;
+		std::unordered_map<std::string, unsigned int> blockBindings;
+	};
+
+	struct BufferRange
+	{
+		unsigned int buffer;
+		unsigned int offset;
+		// ~0 for the whole buffer
+		unsigned int size;
+	};
+
+	// Uniforms of one program as its shader sees them
+	class ProgramUniforms : public SoftwareUniforms
+	{
+	private:
+		const SoftwareDevice& _device;
+		const Program& _program;
+	public:
+		ProgramUniforms(const SoftwareDevice& device, const Program& program) : _device(device), _program(program) {};
+		const void* FindUniform(const std::string& name) const override;
+		const unsigned char* FindBlock(const std::string& name, unsigned int& size) const override;
+	};
+
+	// An attribute ready to read, resolved once per draw. Offset and stride are those of the attached buffer.
+	struct AttributeSource
+	{
+		VertexAttribute attribute;
+		const unsigned char* data;
+		unsigned int size;
+	};
+
+	unsigned int _nextName;
+	std::unordered_map<unsigned int, std::vector<unsigned char>> _buffers;
+	std::unordered_map<unsigned int, VertexArrayState> _vertexArrays;
+	std::unordered_map<unsigned int, std::unique_ptr<SoftwareTexture>> _textures;
+	std::unordered_map<unsigned int, SamplerDesc> _samplers;
+	std::unordered_map<unsigned int, Program> _programs;
+	// Target -> bound buffer
+	std::unordered_map<unsigned int, unsigned int> _boundBuffers;
+	// Uniform block binding point -> bound range
+	std::unordered_map<unsigned int, BufferRange> _uniformRanges;
+	unsigned int _program;
+	unsigned int _vertexArray;
+	// Bound to unit 0, the only unit shaders sample
+	unsigned int _texture;
+	bool _depthTest;
+	bool _depthWrite;
+	bool _cullFace;
+	unsigned long long _errors;
+
+	ParallelForFunction _parallelFor;
+	SoftwareRasterizer _rasterizer;
+
+	bool Check(bool condition, const char* call, const char* message);
+	std::vector<unsigned char>* FindBuffer(unsigned int buffer);
+	// indices nullptr draws count vertices from first on, instance selects the attributes with a divisor
+	void Draw(const char* call, const unsigned int* indices, unsigned int count, unsigned int first, int baseVertex, unsigned int instance);
+	void DrawIndirect(const char* call, unsigned int drawCount, unsigned int stride);
+	static void FetchAttributes(const AttributeSource* sources, unsigned int sourceCount, unsigned int vertex, unsigned int instance, SoftwareVertexInput& input);
+public:
+	SoftwareDevice(unsigned int width, unsigned int height, const ParallelForFunction& parallelFor = nullptr);
+
+	RenderBackend GetBackend() const override { return BACKEND_SOFTWARE; };
+	const char* GetName() const override { return "Software"; };
+
+	unsigned int CreateBuffer(unsigned int target, const void* data, unsigned int size, unsigned int usage) override;
+	void DeleteBuffer(unsigned int buffer) override;
+	void BindBuffer(unsigned int target, unsigned int buffer) override;
+	void BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer) override;
+	void BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, unsigned int offset, unsigned int size) override;
+	void ResizeBuffer(unsigned int target, unsigned int buffer, unsigned int size, unsigned int usage) override;
+	void UpdateBuffer(unsigned int target, unsigned int buffer, unsigned int offset, unsigned int size, const void* data) override;
+	void ClearBuffer(unsigned int target, unsigned int buffer) override;
+
+	unsigned int CreateVertexArray() override;
+	void DeleteVertexArray(unsigned int vertexArray) override;
+	void BindVertexArray(unsigned int vertexArray) override;
+	void SetVertexAttributes(unsigned int vertexArray, unsigned int buffer, const VertexAttribute* attributes, unsigned int count) override;
+	void SetIndexBuffer(unsigned int vertexArray, unsigned int buffer) override;
+	void SetVertexFormat(unsigned int vertexArray, unsigned int binding, const VertexAttribute* attributes, unsigned int count) override;
+	void SetVertexBuffer(unsigned int vertexArray, unsigned int binding, unsigned int buffer, unsigned int offset, unsigned int stride) override;
+
+	unsigned int CreateTexture2D(const void* pixels, int width, int height, int channels) override;
+	void DeleteTexture(unsigned int texture) override;
+	void BindTextures(unsigned int first, const unsigned int* textures, unsigned int count) override;
+
+	unsigned int CreateSampler(const SamplerDesc& desc) override;
+	void DeleteSampler(unsigned int sampler) override;
+	void BindSamplers(unsigned int first, const unsigned int* samplers, unsigned int count) override;
+
+	unsigned int CreateProgram(const std::string& vertexSource, const std::string& fragmentSource, const std::string& computeSource) override;
+	void DeleteProgram(unsigned int program) override;
+	void UseProgram(unsigned int program) override;
+	void SetUniform(unsigned int program, const std::string& name, UniformType type, const void* values, int count) override;
+	void SetUniformBlockBinding(unsigned int program, const std::string& name, unsigned int binding) override;
+
+	void DrawElements(unsigned int count, unsigned int first) override;
+	void DrawArrays(unsigned int count, unsigned int first) override;
+	void MultiDrawElements(const int* counts, const void* const* offsets, unsigned int drawCount) override;
+	void MultiDrawElementsIndirect(unsigned int drawCount, unsigned int stride) override;
+	void MultiDrawElementsIndirectCount(unsigned int maxDrawCount, unsigned int stride) override;
+
+	void Clear(unsigned int mask) override;
+	void Enable(unsigned int capability) override;
+	void Disable(unsigned int capability) override;
+	void Flush() override;
+	void SetRenderState(const RenderState& state, unsigned int groups) override;
+	void Barrier(unsigned int barriers) override;
+
+	// Nothing to align to, std140 blocks only need 16 bytes
+	unsigned int GetUniformBufferOffsetAlignment() override { return 16; };
+
+	// RGBA rows of the target with the bottom row first, like Framebuffer::ReadPixels
+	inline void ReadPixels(std::vector<unsigned char>& pixels) { _rasterizer.ReadPixels(pixels); };
+	inline unsigned int GetWidth() const { return _rasterizer.GetWidth(); };
+	inline unsigned int GetHeight() const { return _rasterizer.GetHeight(); };
+	inline unsigned long long GetErrorCount() const { return _errors; };
+};
@@ -0,0 +1,488 @@
+#include "SoftwareRasterizer.h"
+#include "SimdMath.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX__)
+#define SOFTWARE_RASTER_AVX 1
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Lanes hold the values of neighbouring pixels in a row. Comparisons give masks, lanes with every bit set where true.
+#if defined(SOFTWARE_RASTER_AVX)
+static const unsigned int LANE_COUNT = 8;
+struct Lanes { __m256 v; };
+static inline Lanes LanesSet(float value) { return { _mm256_set1_ps(value) }; }
+static inline Lanes LanesRamp() { return { _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f) }; }
+static inline Lanes LanesMask(bool value) { return { _mm256_castsi256_ps(_mm256_set1_epi32(value ? -1 : 0)) }; }
+static inline Lanes LanesLoad(const float* values) { return { _mm256_loadu_ps(values) }; }
+static inline void LanesStore(float* values, Lanes a) { _mm256_storeu_ps(values, a.v); }
+static inline Lanes operator+(Lanes a, Lanes b) { return { _mm256_add_ps(a.v, b.v) }; }
+static inline Lanes operator-(Lanes a, Lanes b) { return { _mm256_sub_ps(a.v, b.v) }; }
+static inline Lanes operator*(Lanes a, Lanes b) { return { _mm256_mul_ps(a.v, b.v) }; }
+static inline Lanes operator>(Lanes a, Lanes b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+static inline Lanes operator<(Lanes a, Lanes b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+static inline Lanes operator>=(Lanes a, Lanes b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ) }; }
+static inline Lanes operator<=(Lanes a, Lanes b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+static inline Lanes operator==(Lanes a, Lanes b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ) }; }
+static inline Lanes operator&(Lanes a, Lanes b) { return { _mm256_and_ps(a.v, b.v) }; }
+static inline Lanes operator|(Lanes a, Lanes b) { return { _mm256_or_ps(a.v, b.v) }; }
+static inline unsigned int LanesBits(Lanes mask) { return (unsigned int)_mm256_movemask_ps(mask.v); }
+#elif defined(SIMD_MATH_SSE)
+static const unsigned int LANE_COUNT = 4;
+struct Lanes { __m128 v; };
+static inline Lanes LanesSet(float value) { return { _mm_set1_ps(value) }; }
+static inline Lanes LanesRamp() { return { _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f) }; }
+static inline Lanes LanesMask(bool value) { return { _mm_castsi128_ps(_mm_set1_epi32(value ? -1 : 0)) }; }
+static inline Lanes LanesLoad(const float* values) { return { _mm_loadu_ps(values) }; }
+static inline void LanesStore(float* values, Lanes a) { _mm_storeu_ps(values, a.v); }
+static inline Lanes operator+(Lanes a, Lanes b) { return { _mm_add_ps(a.v, b.v) }; }
+static inline Lanes operator-(Lanes a, Lanes b) { return { _mm_sub_ps(a.v, b.v) }; }
+static inline Lanes operator*(Lanes a, Lanes b) { return { _mm_mul_ps(a.v, b.v) }; }
+static inline Lanes operator>(Lanes a, Lanes b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+static inline Lanes operator<(Lanes a, Lanes b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+static inline Lanes operator>=(Lanes a, Lanes b) { return { _mm_cmpge_ps(a.v, b.v) }; }
+static inline Lanes operator<=(Lanes a, Lanes b) { return { _mm_cmple_ps(a.v, b.v) }; }
+static inline Lanes operator==(Lanes a, Lanes b) { return { _mm_cmpeq_ps(a.v, b.v) }; }
+static inline Lanes operator&(Lanes a, Lanes b) { return { _mm_and_ps(a.v, b.v) }; }
+static inline Lanes operator|(Lanes a, Lanes b) { return { _mm_or_ps(a.v, b.v) }; }
+static inline unsigned int LanesBits(Lanes mask) { return (unsigned int)_mm_movemask_ps(mask.v); }
+#else
+// One pixel at a time, masks are 1 or 0
+static const unsigned int LANE_COUNT = 1;
+struct Lanes { float v; };
+static inline Lanes LanesSet(float value) { return { value }; }
+static inline Lanes LanesRamp() { return { 0.0f }; }
+static inline Lanes LanesMask(bool value) { return { value ? 1.0f : 0.0f }; }
+static inline Lanes LanesLoad(const float* values) { return { *values }; }
+static inline void LanesStore(float* values, Lanes a) { *values = a.v; }
+static inline Lanes operator+(Lanes a, Lanes b) { return { a.v + b.v }; }
+static inline Lanes operator-(Lanes a, Lanes b) { return { a.v - b.v }; }
+static inline Lanes operator*(Lanes a, Lanes b) { return { a.v * b.v }; }
+static inline Lanes operator>(Lanes a, Lanes b) { return LanesMask(a.v > b.v); }
+static inline Lanes operator<(Lanes a, Lanes b) { return LanesMask(a.v < b.v); }
+static inline Lanes operator>=(Lanes a, Lanes b) { return LanesMask(a.v >= b.v); }
+static inline Lanes operator<=(Lanes a, Lanes b) { return LanesMask(a.v <= b.v); }
+static inline Lanes operator==(Lanes a, Lanes b) { return LanesMask(a.v == b.v); }
+static inline Lanes operator&(Lanes a, Lanes b) { return { a.v * b.v }; }
+static inline Lanes operator|(Lanes a, Lanes b) { return { std::max(a.v, b.v) }; }
+static inline unsigned int LanesBits(Lanes mask) { return mask.v != 0.0f ? 1u : 0u; }
+#endif
+
+static inline unsigned int FirstBit(unsigned int bits)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, bits);
+	return (unsigned int)index;
+#else
+	return (unsigned int)__builtin_ctz(bits);
+#endif
+}
+
+// Triangles are clipped against the near plane and a guard band around the viewport, past the guard band
+// window coordinates get large enough for the edge functions to lose precision. A vertex is inside a plane
+// when dot(plane, position) >= 0.
+static const float GUARD_BAND = 2.0f;
+static const unsigned int CLIP_PLANE_COUNT = 5;
+// The far plane and the viewport itself only reject whole triangles, the per pixel depth range test handles
+// what crosses the far plane and the viewport clamps the rest
+static const unsigned int REJECT_PLANE_COUNT = 10;
+static const glm::vec4 PLANES[REJECT_PLANE_COUNT] = {
+	{ 0.0f, 0.0f, 1.0f, 1.0f },
+	{ 1.0f, 0.0f, 0.0f, GUARD_BAND }, { -1.0f, 0.0f, 0.0f, GUARD_BAND }, { 0.0f, 1.0f, 0.0f, GUARD_BAND }, { 0.0f, -1.0f, 0.0f, GUARD_BAND },
+	{ 0.0f, 0.0f, -1.0f, 1.0f },
+	{ 1.0f, 0.0f, 0.0f, 1.0f }, { -1.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f, 1.0f }, { 0.0f, -1.0f, 0.0f, 1.0f }
+};
+static const unsigned int CLIP_PLANE_BITS = (1u << CLIP_PLANE_COUNT) - 1;
+
+static inline unsigned int OutCode(const glm::vec4& position)
+{
+	unsigned int code = 0;
+	for (unsigned int plane = 0; plane < REJECT_PLANE_COUNT; plane++)
+	{
+		if (glm::dot(PLANES[plane], position) < 0.0f)
+			code |= 1u << plane;
+	}
+	return code;
+}
+
+static inline float SnapToSubpixel(float value)
+{
+	return std::floor(value * 16.0f + 0.5f) * (1.0f / 16.0f);
+}
+
+static inline unsigned int PackColor(const glm::vec4& color)
+{
+	unsigned int packed = 0;
+	for (int c = 0; c < 4; c++)
+		packed |= (unsigned int)(std::min(1.0f, std::max(0.0f, color[c])) * 255.0f + 0.5f) << (c * 8);
+	return packed;
+}
+
+SoftwareRasterizer::SoftwareRasterizer(unsigned int width, unsigned int height, const ParallelForFunction& parallelFor) :
+	_width(std::max(1u, width)), _height(std::max(1u, height)), _clearColor(false), _clearDepth(false), _parallelFor(parallelFor), _batchCount(0)
+{
+	_pitch = (_width + LANE_COUNT - 1) / LANE_COUNT * LANE_COUNT;
+	_tilesX = (_width + TILE_SIZE - 1) / TILE_SIZE;
+	_tilesY = (_height + TILE_SIZE - 1) / TILE_SIZE;
+	_color.assign((size_t)_pitch * _height, 0);
+	_depth.assign((size_t)_pitch * _height, 1.0f);
+}
+
+void SoftwareRasterizer::RunParallel(unsigned int count, unsigned int batchSize, const std::function<void(unsigned int, unsigned int)>& kernel)
+{
+	if (_parallelFor)
+	{
+		_parallelFor(count, batchSize, kernel);
+		return;
+	}
+	for (unsigned int begin = 0; begin < count; begin += batchSize)
+		kernel(begin, std::min(count, begin + batchSize));
+}
+
+void SoftwareRasterizer::AddDraw(const SoftwareDrawState& state, unsigned int vertexCount, unsigned int indexCount, SoftwareVertexOutput*& vertices, unsigned int*& indices)
+{
+	unsigned int triangleCount = indexCount / 3;
+	if (!_triangleDraws.empty() && _triangleDraws.size() + triangleCount > MAX_QUEUED_TRIANGLES)
+		Flush();
+
+	unsigned int draw = (unsigned int)_draws.size();
+	size_t firstVertex = _vertices.size();
+	size_t firstIndex = _indices.size();
+	_draws.push_back({ state, (unsigned int)firstVertex });
+	_vertices.resize(firstVertex + vertexCount);
+	_indices.resize(firstIndex + (size_t)triangleCount * 3);
+	_triangleDraws.insert(_triangleDraws.end(), triangleCount, draw);
+	vertices = _vertices.data() + firstVertex;
+	indices = _indices.data() + firstIndex;
+}
+
+void SoftwareRasterizer::Clear(bool color, bool depth)
+{
+	// Draws queued before the clear have to land before it
+	if (!_triangleDraws.empty())
+		Flush();
+	_clearColor = _clearColor || color;
+	_clearDepth = _clearDepth || depth;
+}
+
+void SoftwareRasterizer::Flush()
+{
+	PROFILE_SCOPE("SoftwareRasterizer::Flush");
+	unsigned int triangleCount = (unsigned int)_triangleDraws.size();
+	if (triangleCount == 0 && !_clearColor && !_clearDepth)
+		return;
+
+	_batchCount = (triangleCount + SETUP_BATCH - 1) / SETUP_BATCH;
+	if (_batches.size() < _batchCount)
+		_batches.resize(_batchCount);
+	{
+		PROFILE_SCOPE("Triangle setup");
+		RunParallel(triangleCount, SETUP_BATCH, [this](unsigned int begin, unsigned int end)
+		{
+			SetupTriangles(_batches[begin / SETUP_BATCH], begin, end);
+		});
+	}
+	{
+		PROFILE_SCOPE("Rasterize tiles");
+		RunParallel(_tilesX * _tilesY, 1, [this](unsigned int begin, unsigned int end)
+		{
+			for (unsigned int tile = begin; tile < end; tile++)
+				RasterizeTile(tile);
+		});
+	}
+
+	_clearColor = false;
+	_clearDepth = false;
+	_draws.clear();
+	_vertices.clear();
+	_indices.clear();
+	_triangleDraws.clear();
+	_batchCount = 0;
+}
+
+void SoftwareRasterizer::ReadPixels(std::vector<unsigned char>& pixels)
+{
+	Flush();
+	pixels.resize((size_t)_width * _height * 4);
+	// Texels are stored red first in memory, rows only lose their padding
+	for (unsigned int y = 0; y < _height; y++)
+		memcpy(&pixels[(size_t)y * _width * 4], &_color[(size_t)y * _pitch], (size_t)_width * 4);
+}
+
+void SoftwareRasterizer::SetupTriangles(SetupBatch& batch, unsigned int begin, unsigned int end)
+{
+	batch.triangles.clear();
+	batch.bins.resize(_tilesX * _tilesY);
+	for (std::vector<unsigned int>& bin : batch.bins)
+		bin.clear();
+
+	for (unsigned int triangle = begin; triangle < end; triangle++)
+	{
+		unsigned int draw = _triangleDraws[triangle];
+		const SoftwareVertexOutput* first = &_vertices[_draws[draw].firstVertex];
+		const SoftwareVertexOutput* vertices[3] = { first + _indices[triangle * 3], first + _indices[triangle * 3 + 1], first + _indices[triangle * 3 + 2] };
+
+		unsigned int codes[3] = { OutCode(vertices[0]->position), OutCode(vertices[1]->position), OutCode(vertices[2]->position) };
+		if (codes[0] & codes[1] & codes[2])
+			continue;
+		unsigned int clipPlanes = (codes[0] | codes[1] | codes[2]) & CLIP_PLANE_BITS;
+		if (!clipPlanes)
+		{
+			AddTriangle(batch, draw, vertices);
+			continue;
+		}
+
+		// Sutherland-Hodgman, every plane adds at most one vertex to the polygon
+		unsigned int varyingCount = std::min(SOFTWARE_MAX_VARYINGS, _draws[draw].state.shader->GetVaryingCount());
+		SoftwareVertexOutput polygons[2][3 + CLIP_PLANE_COUNT];
+		unsigned int count = 3;
+		for (unsigned int i = 0; i < 3; i++)
+			polygons[0][i] = *vertices[i];
+		unsigned int current = 0;
+		for (unsigned int plane = 0; plane < CLIP_PLANE_COUNT && count >= 3; plane++)
+		{
+			if (!(clipPlanes & (1u << plane)))
+				continue;
+			const SoftwareVertexOutput* input = polygons[current];
+			SoftwareVertexOutput* output = polygons[current ^ 1];
+			unsigned int outputCount = 0;
+			for (unsigned int i = 0; i < count; i++)
+			{
+				const SoftwareVertexOutput& a = input[i];
+				const SoftwareVertexOutput& b = input[(i + 1) % count];
+				float distanceA = glm::dot(PLANES[plane], a.position);
+				float distanceB = glm::dot(PLANES[plane], b.position);
+				if (distanceA >= 0.0f)
+					output[outputCount++] = a;
+				if ((distanceA >= 0.0f) != (distanceB >= 0.0f))
+				{
+					float t = distanceA / (distanceA - distanceB);
+					SoftwareVertexOutput& crossing = output[outputCount++];
+					crossing.position = a.position + (b.position - a.position) * t;
+					for (unsigned int v = 0; v < varyingCount; v++)
+						crossing.varyings[v] = a.varyings[v] + (b.varyings[v] - a.varyings[v]) * t;
+				}
+			}
+			count = outputCount;
+			current ^= 1;
+		}
+
+		const SoftwareVertexOutput* polygon = polygons[current];
+		for (unsigned int i = 1; i + 1 < count; i++)
+		{
+			const SoftwareVertexOutput* fan[3] = { &polygon[0], &polygon[i], &polygon[i + 1] };
+			AddTriangle(batch, draw, fan);
+		}
+	}
+}
+
+void SoftwareRasterizer::AddTriangle(SetupBatch& batch, unsigned int draw, const SoftwareVertexOutput* const* vertices)
+{
+	const SoftwareDrawState& state = _draws[draw].state;
+	TriangleSetup setup;
+	float z[3], invW[3];
+	for (int i = 0; i < 3; i++)
+	{
+		const glm::vec4& position = vertices[i]->position;
+		// Only a vertex exactly at the eye survives near clipping with w = 0
+		if (position.w <= 0.0f)
+			return;
+		invW[i] = 1.0f / position.w;
+		setup.x[i] = SnapToSubpixel((position.x * invW[i] * 0.5f + 0.5f) * _width);
+		setup.y[i] = SnapToSubpixel((position.y * invW[i] * 0.5f + 0.5f) * _height);
+		z[i] = position.z * invW[i] * 0.5f + 0.5f;
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+		int start = (i + 1) % 3, end = (i + 2) % 3;
+		setup.edgeA[i] = setup.y[start] - setup.y[end];
+		setup.edgeB[i] = setup.x[end] - setup.x[start];
+	}
+	// Twice the signed area, positive for counter clockwise triangles
+	float area = setup.edgeA[0] * (setup.x[0] - setup.x[1]) + setup.edgeB[0] * (setup.y[0] - setup.y[1]);
+	if (area == 0.0f)
+		return;
+	if (area < 0.0f)
+	{
+		if (state.cullBackFaces)
+			return;
+		for (int i = 0; i < 3; i++)
+		{
+			setup.edgeA[i] = -setup.edgeA[i];
+			setup.edgeB[i] = -setup.edgeB[i];
+		}
+		area = -area;
+	}
+	for (int i = 0; i < 3; i++)
+		setup.topLeft[i] = setup.edgeA[i] > 0.0f || (setup.edgeA[i] == 0.0f && setup.edgeB[i] < 0.0f);
+
+	// Pixel i has its center at i + 0.5
+	float minX = std::min(setup.x[0], std::min(setup.x[1], setup.x[2])), maxX = std::max(setup.x[0], std::max(setup.x[1], setup.x[2]));
+	float minY = std::min(setup.y[0], std::min(setup.y[1], setup.y[2])), maxY = std::max(setup.y[0], std::max(setup.y[1], setup.y[2]));
+	setup.minX = std::max(0, (int)std::ceil(minX - 0.5f));
+	setup.minY = std::max(0, (int)std::ceil(minY - 0.5f));
+	setup.maxX = std::min((int)_width - 1, (int)std::floor(maxX - 0.5f));
+	setup.maxY = std::min((int)_height - 1, (int)std::floor(maxY - 0.5f));
+	if (setup.minX > setup.maxX || setup.minY > setup.maxY)
+		return;
+
+	float invArea = 1.0f / area;
+	setup.z = z[0];
+	setup.zE1 = (z[1] - z[0]) * invArea;
+	setup.zE2 = (z[2] - z[0]) * invArea;
+	setup.invW = invW[0];
+	setup.invWE1 = (invW[1] - invW[0]) * invArea;
+	setup.invWE2 = (invW[2] - invW[0]) * invArea;
+	setup.invWdx = setup.edgeA[1] * setup.invWE1 + setup.edgeA[2] * setup.invWE2;
+	setup.invWdy = setup.edgeB[1] * setup.invWE1 + setup.edgeB[2] * setup.invWE2;
+	setup.varyingCount = std::min(SOFTWARE_MAX_VARYINGS, state.shader->GetVaryingCount());
+	for (unsigned int v = 0; v < setup.varyingCount; v++)
+	{
+		float values[3] = { vertices[0]->varyings[v] * invW[0], vertices[1]->varyings[v] * invW[1], vertices[2]->varyings[v] * invW[2] };
+		setup.varyings[v] = values[0];
+		setup.varyingsE1[v] = (values[1] - values[0]) * invArea;
+		setup.varyingsE2[v] = (values[2] - values[0]) * invArea;
+		setup.varyingsDx[v] = setup.edgeA[1] * setup.varyingsE1[v] + setup.edgeA[2] * setup.varyingsE2[v];
+		setup.varyingsDy[v] = setup.edgeB[1] * setup.varyingsE1[v] + setup.edgeB[2] * setup.varyingsE2[v];
+	}
+	setup.draw = draw;
+
+	unsigned int index = (unsigned int)batch.triangles.size();
+	batch.triangles.push_back(setup);
+	for (unsigned int tileY = setup.minY / TILE_SIZE; tileY <= setup.maxY / TILE_SIZE; tileY++)
+	{
+		for (unsigned int tileX = setup.minX / TILE_SIZE; tileX <= setup.maxX / TILE_SIZE; tileX++)
+			batch.bins[tileY * _tilesX + tileX].push_back(index);
+	}
+}
+
+void SoftwareRasterizer::RasterizeTile(unsigned int tile)
+{
+	int minX = (int)((tile % _tilesX) * TILE_SIZE);
+	int minY = (int)((tile / _tilesX) * TILE_SIZE);
+	int maxX = std::min((int)_width, minX + (int)TILE_SIZE) - 1;
+	int maxY = std::min((int)_height, minY + (int)TILE_SIZE) - 1;
+
+	for (int y = minY; y <= maxY; y++)
+	{
+		size_t row = (size_t)y * _pitch;
+		if (_clearColor)
+			std::fill(&_color[row + minX], &_color[row + maxX] + 1, 0u);
+		if (_clearDepth)
+			std::fill(&_depth[row + minX], &_depth[row + maxX] + 1, 1.0f);
+	}
+
+	for (unsigned int b = 0; b < _batchCount; b++)
+	{
+		const SetupBatch& batch = _batches[b];
+		for (unsigned int index : batch.bins[tile])
+			RasterizeTriangle(batch.triangles[index], minX, minY, maxX, maxY);
+	}
+}
+
+void SoftwareRasterizer::RasterizeTriangle(const TriangleSetup& triangle, int tileMinX, int tileMinY, int tileMaxX, int tileMaxY)
+{
+	int minX = std::max(triangle.minX, tileMinX), maxX = std::min(triangle.maxX, tileMaxX);
+	int minY = std::max(triangle.minY, tileMinY), maxY = std::min(triangle.maxY, tileMaxY);
+	if (minX > maxX || minY > maxY)
+		return;
+
+	const SoftwareDrawState& state = _draws[triangle.draw].state;
+	// Groups start at multiples of the lane count from the tile corner, the tile size is one too,
+	// so a group never reaches into the next tile
+	int startX = tileMinX + (minX - tileMinX) / (int)LANE_COUNT * (int)LANE_COUNT;
+
+	Lanes zero = LanesSet(0.0f), one = LanesSet(1.0f);
+	Lanes firstX = LanesSet((float)startX + 0.5f) + LanesRamp();
+	Lanes groupStep = LanesSet((float)LANE_COUNT);
+	Lanes columnMin = LanesSet((float)minX), columnMax = LanesSet((float)maxX + 1.0f);
+	Lanes edgeA[3], edgeStep[3], topLeft[3];
+	for (int i = 0; i < 3; i++)
+	{
+		edgeA[i] = LanesSet(triangle.edgeA[i]);
+		edgeStep[i] = LanesSet(triangle.edgeA[i] * LANE_COUNT);
+		topLeft[i] = LanesMask(triangle.topLeft[i]);
+	}
+	Lanes z0 = LanesSet(triangle.z), zE1 = LanesSet(triangle.zE1), zE2 = LanesSet(triangle.zE2);
+
+	float e1Values[LANE_COUNT], e2Values[LANE_COUNT], zValues[LANE_COUNT];
+	SoftwareFragmentInput fragment;
+	for (int y = minY; y <= maxY; y++)
+	{
+		float centerY = (float)y + 0.5f;
+		Lanes edges[3];
+		for (int i = 0; i < 3; i++)
+		{
+			int start = (i + 1) % 3;
+			edges[i] = edgeA[i] * (firstX - LanesSet(triangle.x[start])) + LanesSet(triangle.edgeB[i] * (centerY - triangle.y[start]));
+		}
+		Lanes centerX = firstX;
+		float* depthRow = &_depth[(size_t)y * _pitch];
+		unsigned int* colorRow = &_color[(size_t)y * _pitch];
+
+		for (int x = startX; x <= maxX; x += LANE_COUNT)
+		{
+			Lanes covered = (centerX > columnMin) & (centerX < columnMax);
+			for (int i = 0; i < 3; i++)
+				covered = covered & ((edges[i] > zero) | ((edges[i] == zero) & topLeft[i]));
+
+			if (LanesBits(covered))
+			{
+				Lanes z = z0 + edges[1] * zE1 + edges[2] * zE2;
+				covered = covered & (z >= zero) & (z <= one);
+				if (state.depthTest)
+					covered = covered & (z < LanesLoad(depthRow + x));
+
+				unsigned int bits = LanesBits(covered);
+				if (bits)
+				{
+					LanesStore(e1Values, edges[1]);
+					LanesStore(e2Values, edges[2]);
+					LanesStore(zValues, z);
+				}
+				while (bits)
+				{
+					unsigned int lane = FirstBit(bits);
+					bits &= bits - 1;
+
+					float e1 = e1Values[lane], e2 = e2Values[lane];
+					float w = 1.0f / (triangle.invW + e1 * triangle.invWE1 + e2 * triangle.invWE2);
+					for (unsigned int v = 0; v < triangle.varyingCount; v++)
+					{
+						float value = (triangle.varyings[v] + e1 * triangle.varyingsE1[v] + e2 * triangle.varyingsE2[v]) * w;
+						fragment.varyings[v] = value;
+						fragment.ddx[v] = (triangle.varyingsDx[v] - value * triangle.invWdx) * w;
+						fragment.ddy[v] = (triangle.varyingsDy[v] - value * triangle.invWdy) * w;
+					}
+					colorRow[x + lane] = PackColor(state.shader->ShadeFragment(state.constants, fragment, state.texture));
+					// Like GL, depth is only written while the test is on
+					if (state.depthTest && state.depthWrite)
+						depthRow[x + lane] = zValues[lane];
+				}
+			}
+
+			centerX = centerX + groupStep;
+			for (int i = 0; i < 3; i++)
+				edges[i] = edges[i] + edgeStep[i];
+		}
+	}
+}
+
+const char* SoftwareRasterizer::GetSimdName()
+{
+#if defined(SOFTWARE_RASTER_AVX)
+	return "AVX, 8 pixels";
+#elif defined(SIMD_MATH_SSE)
+	return "SSE2, 4 pixels";
+#else
+	return "scalar";
+#endif
+}
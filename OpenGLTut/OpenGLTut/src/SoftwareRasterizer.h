@@ -0,0 +1,116 @@
+#pragma once
+#include "SoftwareShader.h"
+#include "JobSystem.h"
+#include <vector>
+
+// Everything the triangles of a draw need once the device state moved on
+struct SoftwareDrawState
+{
+	const SoftwareShader* shader;
+	const SoftwareTexture* texture;
+	bool depthTest;
+	bool depthWrite;
+	// Counter clockwise triangles face front, like the GL default
+	bool cullBackFaces;
+	unsigned char constants[SOFTWARE_CONSTANTS_SIZE];
+};
+
+// Tiled CPU rasterizer. Draws are queued with their shaded vertices, Flush then clips, sets up and bins
+// the triangles into screen tiles in parallel batches and rasterizes every tile as its own job, so no two
+// threads ever touch the same pixels. Coverage and depth are tested for several pixels at once with
+// SSE (4 wide) or AVX (8 wide) edge functions, the covered pixels are shaded one by one.
+class SoftwareRasterizer
+{
+public:
+	static const unsigned int TILE_SIZE = 64;
+	// Triangles one setup job takes, binning keeps submission order inside a batch and batches stay in order
+	static const unsigned int SETUP_BATCH = 1024;
+	// Queuing more than this flushes first, it bounds the memory of a frame
+	static const unsigned int MAX_QUEUED_TRIANGLES = 128 * 1024;
+private:
+	struct QueuedDraw
+	{
+		SoftwareDrawState state;
+		unsigned int firstVertex;
+	};
+
+	// A triangle in window coordinates ready for the tiles, clipping may turn one queued triangle into several
+	struct TriangleSetup
+	{
+		// Snapped to 1/16 pixel
+		float x[3];
+		float y[3];
+		// Edge i is opposite vertex i and starts at vertex (i + 1) % 3, it is positive inside the triangle:
+		// E_i(px, py) = edgeA[i] * (px - x[start]) + edgeB[i] * (py - y[start])
+		float edgeA[3];
+		float edgeB[3];
+		// Pixel centers exactly on a top or left edge are inside, on the other edges outside
+		bool topLeft[3];
+		// Values at vertex 0 and their change per unit of E_1 and E_2 (the barycentrics times twice the area).
+		// Varyings are divided by w so they interpolate linearly in screen space.
+		float z, zE1, zE2;
+		float invW, invWE1, invWE2;
+		float varyings[SOFTWARE_MAX_VARYINGS];
+		float varyingsE1[SOFTWARE_MAX_VARYINGS];
+		float varyingsE2[SOFTWARE_MAX_VARYINGS];
+		// Screen space gradients of 1/w and of the divided varyings, for the fragment derivatives
+		float invWdx, invWdy;
+		float varyingsDx[SOFTWARE_MAX_VARYINGS];
+		float varyingsDy[SOFTWARE_MAX_VARYINGS];
+		// Pixels whose centers can be covered, inclusive
+		int minX, minY, maxX, maxY;
+		unsigned int draw;
+		unsigned int varyingCount;
+	};
+
+	// Output of one setup job, bins hold indices into triangles, one bin per tile
+	struct SetupBatch
+	{
+		std::vector<TriangleSetup> triangles;
+		std::vector<std::vector<unsigned int>> bins;
+	};
+
+	unsigned int _width;
+	unsigned int _height;
+	// Rows are padded to a whole number of SIMD groups, so a group never reads past its row
+	unsigned int _pitch;
+	unsigned int _tilesX;
+	unsigned int _tilesY;
+	std::vector<unsigned int> _color;
+	std::vector<float> _depth;
+	bool _clearColor;
+	bool _clearDepth;
+	ParallelForFunction _parallelFor;
+
+	std::vector<QueuedDraw> _draws;
+	std::vector<SoftwareVertexOutput> _vertices;
+	// Three per triangle, relative to the first vertex of the triangle's draw
+	std::vector<unsigned int> _indices;
+	std::vector<unsigned int> _triangleDraws;
+	std::vector<SetupBatch> _batches;
+	unsigned int _batchCount;
+
+	void RunParallel(unsigned int count, unsigned int batchSize, const std::function<void(unsigned int, unsigned int)>& kernel);
+	void SetupTriangles(SetupBatch& batch, unsigned int begin, unsigned int end);
+	void AddTriangle(SetupBatch& batch, unsigned int draw, const SoftwareVertexOutput* const* vertices);
+	void RasterizeTile(unsigned int tile);
+	void RasterizeTriangle(const TriangleSetup& triangle, int tileMinX, int tileMinY, int tileMaxX, int tileMaxY);
+public:
+	// Without parallelFor everything runs on the calling thread
+	SoftwareRasterizer(unsigned int width, unsigned int height, const ParallelForFunction& parallelFor = nullptr);
+
+	// Queues a draw of indexCount / 3 triangles. The caller writes vertexCount shaded vertices and the
+	// indices into them to the returned pointers, before anything else is called on the rasterizer.
+	void AddDraw(const SoftwareDrawState& state, unsigned int vertexCount, unsigned int indexCount, SoftwareVertexOutput*& vertices, unsigned int*& indices);
+	// Applies in order with the draws. Color clears to transparent black and depth to 1, the GL defaults.
+	void Clear(bool color, bool depth);
+	// Rasterizes everything queued, the draw states and vertices can be reused after
+	void Flush();
+	// Flushes, then copies out RGBA rows with the bottom row first, like glReadPixels
+	void ReadPixels(std::vector<unsigned char>& pixels);
+
+	inline unsigned int GetWidth() const { return _width; };
+	inline unsigned int GetHeight() const { return _height; };
+	// Which instruction set the inner loop was built for
+	static const char* GetSimdName();
+};
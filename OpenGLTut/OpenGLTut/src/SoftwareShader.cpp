@@ -0,0 +1,211 @@
+#include "SoftwareShader.h"
+#include "SimdMath.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+SoftwareTexture::SoftwareTexture(const unsigned char* pixels, unsigned int width, unsigned int height, int channels)
+{
+	Level base = { std::max(1u, width), std::max(1u, height) };
+	base.texels.resize((size_t)base.width * base.height, 0xFF000000u);
+	if (pixels)
+	{
+		for (size_t i = 0; i < (size_t)width * height; i++)
+		{
+			const unsigned char* texel = pixels + i * channels;
+			unsigned int alpha = channels == 4 ? texel[3] : 0xFF;
+			base.texels[i] = texel[0] | (texel[1] << 8) | (texel[2] << 16) | (alpha << 24);
+		}
+	}
+	_levels.push_back(std::move(base));
+
+	// Box filtered down to 1x1, odd sizes repeat their last row or column
+	while (_levels.back().width > 1 || _levels.back().height > 1)
+	{
+		const Level& source = _levels.back();
+		Level level = { std::max(1u, source.width / 2), std::max(1u, source.height / 2) };
+		level.texels.resize((size_t)level.width * level.height);
+		for (unsigned int y = 0; y < level.height; y++)
+		{
+			unsigned int y0 = std::min(source.height - 1, y * 2), y1 = std::min(source.height - 1, y * 2 + 1);
+			for (unsigned int x = 0; x < level.width; x++)
+			{
+				unsigned int x0 = std::min(source.width - 1, x * 2), x1 = std::min(source.width - 1, x * 2 + 1);
+				unsigned int quad[4] = { source.texels[y0 * source.width + x0], source.texels[y0 * source.width + x1],
+					source.texels[y1 * source.width + x0], source.texels[y1 * source.width + x1] };
+				unsigned int texel = 0;
+				for (unsigned int shift = 0; shift < 32; shift += 8)
+				{
+					unsigned int sum = 2;
+					for (unsigned int corner : quad)
+						sum += (corner >> shift) & 0xFF;
+					texel |= (sum / 4) << shift;
+				}
+				level.texels[y * level.width + x] = texel;
+			}
+		}
+		_levels.push_back(std::move(level));
+	}
+}
+
+static inline unsigned int Wrap(int coordinate, unsigned int size)
+{
+	// Power of two sizes, the usual case, need no division
+	if ((size & (size - 1)) == 0)
+		return (unsigned int)coordinate & (size - 1);
+	int wrapped = coordinate % (int)size;
+	return wrapped < 0 ? wrapped + size : wrapped;
+}
+
+glm::vec4 SoftwareTexture::Sample(float u, float v, float dudx, float dvdx, float dudy, float dvdy) const
+{
+	// The longer footprint axis in texels decides the level. Rounding half its log2 (the squared length is
+	// used) to the nearest level is floor(log2(2 * footprint)) / 2, the float exponent gives that floor.
+	float width = (float)_levels[0].width, height = (float)_levels[0].height;
+	float lengthX = dudx * dudx * width * width + dvdx * dvdx * height * height;
+	float lengthY = dudy * dudy * width * width + dvdy * dvdy * height * height;
+	float footprint = std::max(lengthX, lengthY);
+	unsigned int levelIndex = 0;
+	if (footprint > 1.0f)
+	{
+		float doubled = std::min(footprint * 2.0f, 1e30f);
+		unsigned int bits;
+		memcpy(&bits, &doubled, sizeof(bits));
+		int exponent = (int)((bits >> 23) & 0xFF) - 127;
+		levelIndex = std::min((unsigned int)_levels.size() - 1, (unsigned int)exponent / 2);
+	}
+	const Level& level = _levels[levelIndex];
+
+	float x = u * level.width - 0.5f;
+	float y = v * level.height - 0.5f;
+	float floorX = std::floor(x), floorY = std::floor(y);
+	float weightX = x - floorX, weightY = y - floorY;
+	// Far outside [0, 1] the float has no fraction left and wrapping is meaningless anyway
+	if (std::fabs(floorX) > 1e8f || std::fabs(floorY) > 1e8f)
+		floorX = floorY = 0.0f;
+	unsigned int x0 = Wrap((int)floorX, level.width), x1 = Wrap((int)floorX + 1, level.width);
+	unsigned int y0 = Wrap((int)floorY, level.height), y1 = Wrap((int)floorY + 1, level.height);
+	const unsigned int* row0 = &level.texels[(size_t)y0 * level.width];
+	const unsigned int* row1 = &level.texels[(size_t)y1 * level.width];
+
+	glm::vec4 result;
+#ifdef SIMD_MATH_SSE
+	// Every texel is widened to four floats, the two lerps then run on all channels at once
+	__m128i zero = _mm_setzero_si128();
+	auto unpack = [zero](unsigned int texel)
+	{
+		return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((int)texel), zero), zero));
+	};
+	__m128 t00 = unpack(row0[x0]), t10 = unpack(row0[x1]), t01 = unpack(row1[x0]), t11 = unpack(row1[x1]);
+	__m128 wx = _mm_set1_ps(weightX), wy = _mm_set1_ps(weightY);
+	__m128 bottom = _mm_add_ps(t00, _mm_mul_ps(_mm_sub_ps(t10, t00), wx));
+	__m128 top = _mm_add_ps(t01, _mm_mul_ps(_mm_sub_ps(t11, t01), wx));
+	__m128 color = _mm_mul_ps(_mm_add_ps(bottom, _mm_mul_ps(_mm_sub_ps(top, bottom), wy)), _mm_set1_ps(1.0f / 255.0f));
+	_mm_storeu_ps(&result.x, color);
+#else
+	unsigned int texels[4] = { row0[x0], row0[x1], row1[x0], row1[x1] };
+	for (int c = 0; c < 4; c++)
+	{
+		float t00 = (float)((texels[0] >> (c * 8)) & 0xFF), t10 = (float)((texels[1] >> (c * 8)) & 0xFF);
+		float t01 = (float)((texels[2] >> (c * 8)) & 0xFF), t11 = (float)((texels[3] >> (c * 8)) & 0xFF);
+		float bottom = t00 + (t10 - t00) * weightX;
+		float top = t01 + (t11 - t01) * weightX;
+		result[c] = (bottom + (top - bottom) * weightY) * (1.0f / 255.0f);
+	}
+#endif
+	return result;
+}
+
+// Basic.shader and Batched.shader: transforms by u_projection * u_view * u_model and samples the bound
+// texture with the interpolated texture coordinates. Batched reads u_model and the material index from
+// ObjectBlock and tints with the color of that element of MaterialBlock.
+class TexturedShader : public SoftwareShader
+{
+private:
+	bool _modelFromBlock;
+public:
+	TexturedShader(bool modelFromBlock) : _modelFromBlock(modelFromBlock) {};
+
+	const char* GetName() const override { return _modelFromBlock ? "Batched" : "Basic"; };
+	unsigned int GetVaryingCount() const override { return 2; };
+
+	bool PrepareDraw(const SoftwareUniforms& uniforms, unsigned char* constants) const override
+	{
+		const void* view = uniforms.FindUniform("u_view");
+		const void* projection = uniforms.FindUniform("u_projection");
+		const void* model = nullptr;
+		glm::vec4 color(1.0f);
+		if (_modelFromBlock)
+		{
+			// std140: u_model at 0, u_materialIndex right after it, a Material is one vec4
+			unsigned int size = 0, materialsSize = 0;
+			const unsigned char* block = uniforms.FindBlock("ObjectBlock", size);
+			const unsigned char* materials = uniforms.FindBlock("MaterialBlock", materialsSize);
+			unsigned int materialIndex = 0;
+			if (block && size >= sizeof(glm::mat4) + sizeof(unsigned int))
+				memcpy(&materialIndex, block + sizeof(glm::mat4), sizeof(unsigned int));
+			if (!block || size < sizeof(glm::mat4) + sizeof(unsigned int) || !materials || (materialIndex + 1) * sizeof(glm::vec4) > materialsSize)
+				return false;
+			model = block;
+			memcpy(&color, materials + materialIndex * sizeof(glm::vec4), sizeof(glm::vec4));
+		}
+		else
+		{
+			model = uniforms.FindUniform("u_model");
+		}
+		if (!view || !projection || !model)
+			return false;
+
+		glm::mat4 matrices[3];
+		memcpy(&matrices[0], projection, sizeof(glm::mat4));
+		memcpy(&matrices[1], view, sizeof(glm::mat4));
+		memcpy(&matrices[2], model, sizeof(glm::mat4));
+		MultiplyMatrix(matrices[0], matrices[1], matrices[0]);
+		MultiplyMatrix(matrices[0], matrices[2], matrices[0]);
+		memcpy(constants, &matrices[0], sizeof(glm::mat4));
+		memcpy(constants + sizeof(glm::mat4), &color, sizeof(glm::vec4));
+		return true;
+	};
+
+	void ShadeVertex(const unsigned char* constants, const SoftwareVertexInput& input, SoftwareVertexOutput& output) const override
+	{
+		glm::mat4 modelViewProjection;
+		memcpy(&modelViewProjection, constants, sizeof(glm::mat4));
+		output.position = modelViewProjection * input.attributes[0];
+		output.varyings[0] = input.attributes[1].x;
+		output.varyings[1] = input.attributes[1].y;
+	};
+
+	glm::vec4 ShadeFragment(const unsigned char* constants, const SoftwareFragmentInput& input, const SoftwareTexture* texture) const override
+	{
+		// Sampling with no texture bound gives opaque black in GL as well
+		glm::vec4 color;
+		memcpy(&color, constants + sizeof(glm::mat4), sizeof(glm::vec4));
+		if (!texture)
+			return glm::vec4(0.0f, 0.0f, 0.0f, 1.0f) * color;
+		return texture->Sample(input.varyings[0], input.varyings[1], input.ddx[0], input.ddx[1], input.ddy[0], input.ddy[1]) * color;
+	};
+};
+
+// A program is implemented by the shader of the first entry whose snippets both appear in its sources
+struct SoftwareShaderMatch
+{
+	const char* vertexSnippet;
+	const char* fragmentSnippet;
+	SoftwareShader* (*create)();
+};
+
+static const SoftwareShaderMatch SHADER_MATCHES[] = {
+	{ "uniform mat4 u_model;", "texture(customTexture, textureCord)", []() -> SoftwareShader* { return new TexturedShader(false); } },
+	{ "uniform ObjectBlock", "texture(customTexture, textureCord)", []() -> SoftwareShader* { return new TexturedShader(true); } }
+};
+
+SoftwareShader* SoftwareShader::Create(const std::string& vertexSource, const std::string& fragmentSource)
+{
+	for (const SoftwareShaderMatch& match : SHADER_MATCHES)
+	{
+		if (vertexSource.find(match.vertexSnippet) != std::string::npos && fragmentSource.find(match.fragmentSnippet) != std::string::npos)
+			return match.create();
+	}
+	return nullptr;
+}
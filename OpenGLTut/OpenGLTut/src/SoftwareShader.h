@@ -0,0 +1,88 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+// Attribute locations a software shader can read
+static const unsigned int SOFTWARE_MAX_ATTRIBUTES = 4;
+// Floats a vertex hands to the fragments, interpolated perspective correct
+static const unsigned int SOFTWARE_MAX_VARYINGS = 8;
+// Bytes of uniforms a draw keeps, triangles are shaded long after later calls changed the uniforms
+static const unsigned int SOFTWARE_CONSTANTS_SIZE = 256;
+
+// RGBA8 texture with its full mip chain. Coordinates repeat like GL_REPEAT, sampling is bilinear in
+// the nearest mip level.
+class SoftwareTexture
+{
+private:
+	struct Level
+	{
+		unsigned int width;
+		unsigned int height;
+		// One RGBA texel per value, red in the lowest byte
+		std::vector<unsigned int> texels;
+	};
+	std::vector<Level> _levels;
+public:
+	// 3 or 4 channels, rows tightly packed with the first row at v = 0 like glTexImage2D takes them
+	SoftwareTexture(const unsigned char* pixels, unsigned int width, unsigned int height, int channels);
+
+	// The screen space derivatives of the coordinates pick the mip level, components are in [0, 1]
+	glm::vec4 Sample(float u, float v, float dudx, float dvdx, float dudy, float dvdy) const;
+
+	inline unsigned int GetWidth() const { return _levels[0].width; };
+	inline unsigned int GetHeight() const { return _levels[0].height; };
+	inline unsigned int GetLevelCount() const { return (unsigned int)_levels.size(); };
+};
+
+// What a shader reads its uniforms from when a draw is prepared
+class SoftwareUniforms
+{
+public:
+	virtual ~SoftwareUniforms() {};
+	// The values as they were set, matrices column major, nullptr when the uniform was never set
+	virtual const void* FindUniform(const std::string& name) const = 0;
+	// The buffer range bound to the block's binding point, nullptr when none is
+	virtual const unsigned char* FindBlock(const std::string& name, unsigned int& size) const = 0;
+};
+
+// Attributes are converted to float and default to (0, 0, 0, 1) like GLSL inputs
+struct SoftwareVertexInput
+{
+	glm::vec4 attributes[SOFTWARE_MAX_ATTRIBUTES];
+};
+
+struct SoftwareVertexOutput
+{
+	// Clip space, like gl_Position
+	glm::vec4 position;
+	float varyings[SOFTWARE_MAX_VARYINGS];
+};
+
+// ddx and ddy are the screen space derivatives of the varyings, texture sampling needs them for the mip level
+struct SoftwareFragmentInput
+{
+	float varyings[SOFTWARE_MAX_VARYINGS];
+	float ddx[SOFTWARE_MAX_VARYINGS];
+	float ddy[SOFTWARE_MAX_VARYINGS];
+};
+
+// C++ version of a GLSL program for the software device. Shaders are stateless, everything a draw
+// needs is copied into its constants when the draw is issued, so one shader is shared by all threads.
+class SoftwareShader
+{
+public:
+	virtual ~SoftwareShader() {};
+
+	virtual const char* GetName() const = 0;
+	virtual unsigned int GetVaryingCount() const = 0;
+	// Copies the uniforms the shader uses into constants, at most SOFTWARE_CONSTANTS_SIZE bytes.
+	// Returns false when one of them is missing and the draw should be skipped.
+	virtual bool PrepareDraw(const SoftwareUniforms& uniforms, unsigned char* constants) const = 0;
+	virtual void ShadeVertex(const unsigned char* constants, const SoftwareVertexInput& input, SoftwareVertexOutput& output) const = 0;
+	// texture is the one bound when the draw was issued, nullptr when none was
+	virtual glm::vec4 ShadeFragment(const unsigned char* constants, const SoftwareFragmentInput& input, const SoftwareTexture* texture) const = 0;
+
+	// Picks the C++ shader that implements the GLSL sources, caller owns it, nullptr when there is none
+	static SoftwareShader* Create(const std::string& vertexSource, const std::string& fragmentSource);
+};
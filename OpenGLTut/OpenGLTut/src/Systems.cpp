@@ -0,0 +1,133 @@
+#include "Systems.h"
+#include "Components.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <glm/geometric.hpp>
+
+// Entities recorded into one command list
+static const unsigned int RECORD_BATCH_SIZE = 1024;
+
+void TransformSystem::Update(Registry& registry, const ParallelForFunction& parallelFor)
+{
+	PROFILE_SCOPE("TransformSystem::Update");
+	registry.Transforms().Update(parallelFor);
+}
+
+unsigned int RenderSystem::GatherCullingObjects(Registry& registry, std::vector<GpuObjectData>& objects, std::vector<glm::mat4>& transforms, float alpha)
+{
+	ComponentPool<MeshComponent>& meshes = registry.Pool<MeshComponent>();
+	ComponentPool<BoundsComponent>& bounds = registry.Pool<BoundsComponent>();
+	TransformStorage& storage = registry.Transforms();
+
+	objects.resize(meshes.Size());
+	transforms.resize(meshes.Size());
+
+	// Walks the mesh pool in dense order, the other components are looked up through their sparse arrays
+	const Entity* entities = meshes.Entities();
+	const MeshComponent* meshData = meshes.Data();
+	const glm::mat4* worldMatrices = storage.WorldMatrices();
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < meshes.Size(); i++)
+	{
+		Entity entity = entities[i];
+		if (!bounds.Has(entity) || !storage.Has(entity))
+			continue;
+
+		glm::mat4 world = alpha < 1.0f ? storage.InterpolatedWorldMatrix(entity, alpha) : worldMatrices[storage.IndexOf(entity)];
+		const BoundsComponent& bound = bounds.Get(entity);
+		float scale = std::max(glm::length(glm::vec3(world[0])), std::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+
+		objects[count].boundingSphere = glm::vec4(glm::vec3(world * glm::vec4(bound.center, 1.0f)), bound.radius * scale);
+		objects[count].meshIndex = meshData[i].meshIndex;
+		transforms[count] = world;
+		count++;
+	}
+
+	objects.resize(count);
+	transforms.resize(count);
+	return count;
+}
+
+void RenderSystem::RecordDraws(Registry& registry, const RenderView& view, const std::vector<MeshDraw>& meshDraws,
+	std::vector<CommandList>& lists, unsigned int uniformAlignment, float alpha, const ParallelForFunction& parallelFor)
+{
+	ComponentPool<MeshComponent>& meshes = registry.Pool<MeshComponent>();
+	ComponentPool<BoundsComponent>& bounds = registry.Pool<BoundsComponent>();
+	TransformStorage& storage = registry.Transforms();
+
+	unsigned int count = meshes.Size();
+	unsigned int batches = (count + RECORD_BATCH_SIZE - 1) / RECORD_BATCH_SIZE;
+	if (lists.size() != batches || (batches > 0 && lists[0].GetUniformAlignment() != uniformAlignment))
+		lists.assign(batches, CommandList(uniformAlignment));
+
+	// Only reads the pools, the sparse lookups below are safe from any number of threads.
+	// The LOD level of entity i is only written by the batch that holds i.
+	const Entity* entities = meshes.Entities();
+	MeshComponent* meshData = meshes.Data();
+	const glm::mat4* worldMatrices = storage.WorldMatrices();
+	auto kernel = [&](unsigned int begin, unsigned int end)
+	{
+		PROFILE_SCOPE("RenderSystem::RecordDraws batch");
+		CommandList& list = lists[begin / RECORD_BATCH_SIZE];
+		list.Clear();
+		MeshletDrawList meshletDraws;
+		for (unsigned int i = begin; i < end; i++)
+		{
+			Entity entity = entities[i];
+			if (!storage.Has(entity) || meshData[i].meshIndex >= meshDraws.size())
+				continue;
+
+			glm::mat4 world = alpha < 1.0f ? storage.InterpolatedWorldMatrix(entity, alpha) : worldMatrices[storage.IndexOf(entity)];
+			float scale = std::max(glm::length(glm::vec3(world[0])), std::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+			glm::vec3 center = glm::vec3(world[3]);
+			if (bounds.Has(entity))
+			{
+				const BoundsComponent& bound = bounds.Get(entity);
+				center = glm::vec3(world * glm::vec4(bound.center, 1.0f));
+				if (!view.frustum.IntersectsSphere(center, bound.radius * scale))
+					continue;
+			}
+
+			const MeshDraw& draw = meshDraws[meshData[i].meshIndex];
+			unsigned int first = draw.first, drawCount = draw.count, levelIndex = 0;
+			if (draw.lodChain && !draw.lodChain->levels.empty())
+			{
+				// Errors are in object space, scaling the object up is the same as moving it closer
+				unsigned int& lod = meshData[i].lod;
+				if (view.lodSelector)
+					lod = view.lodSelector->Select(*draw.lodChain, glm::distance(center, view.position) / std::max(scale, 0.0001f), view.projectionScale, lod);
+				else
+					lod = 0;
+				levelIndex = std::min(lod, (unsigned int)draw.lodChain->levels.size() - 1);
+				const LODLevel& level = draw.lodChain->levels[levelIndex];
+				first += level.firstIndex;
+				drawCount = level.indexCount;
+			}
+
+			if (draw.meshlets && levelIndex < draw.meshlets->size())
+			{
+				(*draw.meshlets)[levelIndex].Cull(world, view.frustum, view.position, meshletDraws, first);
+				if (meshletDraws.counts.empty())
+					continue;
+				// A single range is an ordinary draw, the culled meshlets were at its ends
+				if (meshletDraws.counts.size() > 1)
+				{
+					list.DrawMulti(draw.pipelineID, draw.vertexArrayID, draw.textureID, draw.materialIndex, meshletDraws.counts.data(),
+						meshletDraws.offsets.data(), (unsigned int)meshletDraws.counts.size(), world);
+					continue;
+				}
+				first = (unsigned int)((size_t)meshletDraws.offsets[0] / sizeof(unsigned int));
+				drawCount = (unsigned int)meshletDraws.counts[0];
+			}
+			list.Draw(draw.pipelineID, draw.vertexArrayID, draw.textureID, draw.materialIndex, draw.mode, first, drawCount, world);
+		}
+	};
+
+	if (parallelFor)
+		parallelFor(count, RECORD_BATCH_SIZE, kernel);
+	else
+	{
+		for (unsigned int begin = 0; begin < count; begin += RECORD_BATCH_SIZE)
+			kernel(begin, std::min(count, begin + RECORD_BATCH_SIZE));
+	}
+}
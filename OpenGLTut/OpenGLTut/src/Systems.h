@@ -0,0 +1,67 @@
+#pragma once
+#include <vector>
+#include <glm/ext/matrix_float4x4.hpp>
+#include "Registry.h"
+#include "TransformStorage.h"
+#include "GpuCulling.h"
+#include "CommandList.h"
+#include "Frustum.h"
+#include "LODSelector.h"
+#include "Meshlet.h"
+
+// How the meshes referenced by MeshComponent::meshIndex are drawn on the CPU path
+struct MeshDraw
+{
+	unsigned short pipelineID;
+	unsigned short vertexArrayID;
+	unsigned short textureID;
+	// See MaterialInstance::index
+	unsigned int materialIndex;
+	DrawMode mode;
+	unsigned int first;
+	unsigned int count;
+	// Levels of detail of an indexed mesh, nullptr draws first and count as they are. Level ranges
+	// start at first, the chain's indices are what was uploaded there.
+	const LODChain* lodChain;
+	// Meshlets of every LOD level (a single culler for first and count without a chain), see
+	// MeshletBuilder::BuildLODs. nullptr draws the whole range.
+	const std::vector<MeshletCuller>* meshlets;
+};
+
+// Where the draws are recorded from
+struct RenderView
+{
+	Frustum frustum;
+	glm::vec3 position;
+	// Pixels per world unit at distance 1, see LODSelector::ProjectionScale
+	float projectionScale;
+	// Picks the level of meshes that have a LOD chain, without one they draw their finest level
+	const LODSelector* lodSelector;
+
+	RenderView(const glm::mat4& viewProjection, const glm::vec3& position, float projectionScale = 0.0f, const LODSelector* lodSelector = nullptr)
+		: frustum(viewProjection), position(position), projectionScale(projectionScale), lodSelector(lodSelector) {};
+};
+
+// Systems work on dense index ranges [begin, end), ranges don't overlap so they can be handed to different threads
+class TransformSystem
+{
+public:
+	// Only transforms that changed (and their children) are recomputed, see TransformStorage::Update
+	static void Update(Registry& registry, const ParallelForFunction& parallelFor = nullptr);
+};
+
+class RenderSystem
+{
+public:
+	// Writes the culling input of every entity that has a mesh, bounds and a transform, returns how many were written.
+	// alpha blends between the world matrices before and after the last transform update.
+	static unsigned int GatherCullingObjects(Registry& registry, std::vector<GpuObjectData>& objects, std::vector<glm::mat4>& transforms, float alpha = 1.0f);
+
+	// Frustum culls every mesh entity and records its draw, each batch of entities fills its own list
+	// so recording runs on the job threads. lists is resized to the number of batches.
+	// Meshes with a LOD chain draw the level the view's selector picks, MeshComponent::lod keeps each
+	// instance's level from one frame to the next. Meshes with meshlets have them culled per instance
+	// and their visible ranges recorded as one multi draw.
+	static void RecordDraws(Registry& registry, const RenderView& view, const std::vector<MeshDraw>& meshDraws,
+		std::vector<CommandList>& lists, unsigned int uniformAlignment, float alpha = 1.0f, const ParallelForFunction& parallelFor = nullptr);
+};
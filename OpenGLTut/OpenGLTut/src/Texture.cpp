@@ -1,20 +1,28 @@
 #include "Texture.h"
 #include "Utils.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include "RenderDevice.h"
 #include <iostream>
 #include "vendor/stb_image/stb_image.h"
 
 Texture::Texture(std::string src, int width, int height, int channels) : 
 	_rendererId(0), _fileSrc(src), _width(width), _height(height), _channels(channels)
 {
+	PROFILE_SCOPE("Texture::Texture");
 	unsigned char* texture = stbi_load(src.c_str(), &_width, &_height, &_channels, 0);
-	
-	GLCall(glGenTextures(1, &_rendererId));
-	GLCall(glBindTexture(GL_TEXTURE_2D, _rendererId));
+	// Gray images are expanded, devices only take RGB and RGBA
+	if (texture && _channels < 3)
+	{
+		stbi_image_free(texture);
+		texture = stbi_load(src.c_str(), &_width, &_height, &_channels, 3);
+		_channels = 3;
+	}
 
 	if (texture)
 	{
-		GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, _width, _height, 0, GL_RGB, GL_UNSIGNED_BYTE, texture))
-		GLCall(glGenerateMipmap(GL_TEXTURE_2D));
+		_rendererId = RenderDevice::Get().CreateTexture2D(texture, _width, _height, _channels);
+		RenderStats::CountTextureUpload((unsigned long long)_width * _height * _channels);
 	}
 	else
 	{
@@ -24,16 +32,27 @@ Texture::Texture(std::string src, int width, int height, int channels) :
 	stbi_image_free(texture);
 }
 
+Texture::Texture(const unsigned char* pixels, int width, int height, int channels) :
+	_rendererId(0), _width(width), _height(height), _channels(channels)
+{
+	PROFILE_SCOPE("Texture::Texture");
+	_rendererId = RenderDevice::Get().CreateTexture2D(pixels, _width, _height, _channels);
+	RenderStats::CountTextureUpload((unsigned long long)_width * _height * _channels);
+}
+
 Texture::~Texture()
 {
+	if (_rendererId)
+		RenderDevice::Get().DeleteTexture(_rendererId);
 }
 
-void Texture::Bind() const
+void Texture::Bind(unsigned int unit) const
 {
-	GLCall(glBindTexture(GL_TEXTURE_2D, _rendererId));
+	RenderStats::CountStateChange(STATE_TEXTURE);
+	RenderDevice::Get().BindTexture(unit, _rendererId);
 };
 
-void Texture::Unbind() const
+void Texture::Unbind(unsigned int unit) const
 {
-	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	RenderDevice::Get().BindTexture(unit, 0);
 }
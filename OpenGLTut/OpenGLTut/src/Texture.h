@@ -11,9 +11,14 @@ private:
 	int _channels;
 public:
 	Texture(std::string src, int width, int height, int channels);
+	// Texture from pixels already in memory, channels is 3 (RGB) or 4 (RGBA)
+	Texture(const unsigned char* pixels, int width, int height, int channels);
 	~Texture();
 
-	void Bind() const;
-	void Unbind() const;
+	// Binds to the texture unit, several textures at once go through RenderDevice::BindTextures
+	void Bind(unsigned int unit = 0) const;
+	void Unbind(unsigned int unit = 0) const;
+
+	inline unsigned int getRendererID() const { return _rendererId; };
 
 };
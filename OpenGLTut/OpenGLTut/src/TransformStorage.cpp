@@ -0,0 +1,314 @@
+#include "TransformStorage.h"
+#include "SimdMath.h"
+#include <algorithm>
+#include <cmath>
+#include <glm/trigonometric.hpp>
+
+// Same matrix as translate * rotate(X) * rotate(Y) * rotate(Z) * scale, written out so it doesn't take three matrix products
+static glm::mat4 ComposeLocalMatrix(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale)
+{
+	float sx = std::sin(glm::radians(rotation.x)), cx = std::cos(glm::radians(rotation.x));
+	float sy = std::sin(glm::radians(rotation.y)), cy = std::cos(glm::radians(rotation.y));
+	float sz = std::sin(glm::radians(rotation.z)), cz = std::cos(glm::radians(rotation.z));
+
+	glm::mat4 m;
+	m[0] = glm::vec4(cy * cz, sx * sy * cz + cx * sz, -cx * sy * cz + sx * sz, 0.0f) * scale.x;
+	m[1] = glm::vec4(-cy * sz, -sx * sy * sz + cx * cz, cx * sy * sz + sx * cz, 0.0f) * scale.y;
+	m[2] = glm::vec4(sy, -sx * cy, cx * cy, 0.0f) * scale.z;
+	m[3] = glm::vec4(position, 1.0f);
+	return m;
+}
+
+// Values of _dirty
+static const unsigned char CLEAN = 0;
+static const unsigned char LOCAL_CHANGED = 1;
+static const unsigned char PARENT_CHANGED = 2;
+// Added since the last update, has no previous world matrix to blend from yet
+static const unsigned char ADDED = 3;
+
+// Transforms of one depth are updated in batches of this many
+static const unsigned int UPDATE_BATCH_SIZE = 256;
+
+TransformStorage::TransformStorage() : _maxDepth(0), _structureChanged(false)
+{
+}
+
+void TransformStorage::Add(Entity entity, const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale)
+{
+	Insert(entity);
+	_positions.push_back(position);
+	_rotations.push_back(rotation);
+	_scales.push_back(scale);
+	_localMatrices.push_back(glm::mat4(1.0f));
+	_worldMatrices.push_back(glm::mat4(1.0f));
+	_previousWorldMatrices.push_back(glm::mat4(1.0f));
+	_parents.push_back(NULL_ENTITY);
+	_parentIndices.push_back(INVALID_SPARSE_INDEX);
+	_firstChild.push_back(0);
+	_childCount.push_back(0);
+	_depths.push_back(0);
+	_dirty.push_back(ADDED);
+	_dirtyEntities.push_back(entity);
+
+	// A new root at the end only breaks the depth ranges once there is a hierarchy
+	if (_maxDepth > 0)
+		_structureChanged = true;
+}
+
+void TransformStorage::Remove(Entity entity)
+{
+	// _updated holds dense indices, which the swap below would invalidate
+	SettlePreviousMatrices();
+
+	unsigned int hole = Erase(entity);
+	_positions[hole] = _positions.back();
+	_rotations[hole] = _rotations.back();
+	_scales[hole] = _scales.back();
+	_localMatrices[hole] = _localMatrices.back();
+	_worldMatrices[hole] = _worldMatrices.back();
+	_previousWorldMatrices[hole] = _previousWorldMatrices.back();
+	_parents[hole] = _parents.back();
+	_dirty[hole] = _dirty.back();
+	_positions.pop_back();
+	_rotations.pop_back();
+	_scales.pop_back();
+	_localMatrices.pop_back();
+	_worldMatrices.pop_back();
+	_previousWorldMatrices.pop_back();
+	_parents.pop_back();
+	_parentIndices.pop_back();
+	_firstChild.pop_back();
+	_childCount.pop_back();
+	_depths.pop_back();
+	_dirty.pop_back();
+
+	// Children of the removed transform become roots when the order is rebuilt
+	if (_maxDepth > 0)
+		_structureChanged = true;
+}
+
+void TransformStorage::SetParent(Entity entity, Entity parent)
+{
+	_parents[IndexOf(entity)] = parent;
+	_structureChanged = true;
+	MarkDirty(entity);
+}
+
+void TransformStorage::SetPosition(Entity entity, const glm::vec3& position)
+{
+	_positions[IndexOf(entity)] = position;
+	MarkDirty(entity);
+}
+
+void TransformStorage::SetRotation(Entity entity, const glm::vec3& rotation)
+{
+	_rotations[IndexOf(entity)] = rotation;
+	MarkDirty(entity);
+}
+
+void TransformStorage::SetScale(Entity entity, const glm::vec3& scale)
+{
+	_scales[IndexOf(entity)] = scale;
+	MarkDirty(entity);
+}
+
+void TransformStorage::MarkDirty(Entity entity)
+{
+	unsigned int index = IndexOf(entity);
+	if (_dirty[index] == LOCAL_CHANGED || _dirty[index] == ADDED)
+		return;
+	_dirty[index] = LOCAL_CHANGED;
+	_dirtyEntities.push_back(entity);
+}
+
+void TransformStorage::SortBreadthFirst()
+{
+	unsigned int count = Size();
+
+	// Children lists in the current order, transforms whose parent is gone become roots
+	std::vector<unsigned int> childStart(count + 1, 0);
+	std::vector<unsigned int> parentOf(count, INVALID_SPARSE_INDEX);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		Entity parent = _parents[i];
+		if (parent != NULL_ENTITY && Has(parent) && parent != _dense[i])
+			parentOf[i] = IndexOf(parent);
+		else
+			_parents[i] = NULL_ENTITY;
+		if (parentOf[i] != INVALID_SPARSE_INDEX)
+			childStart[parentOf[i] + 1]++;
+	}
+	for (unsigned int i = 0; i < count; i++)
+		childStart[i + 1] += childStart[i];
+	std::vector<unsigned int> children(childStart[count]);
+	std::vector<unsigned int> fill(childStart.begin(), childStart.end() - 1);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		if (parentOf[i] != INVALID_SPARSE_INDEX)
+			children[fill[parentOf[i]]++] = i;
+	}
+
+	std::vector<unsigned int> order;
+	order.reserve(count);
+	std::vector<unsigned char> visited(count, 0);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		if (parentOf[i] == INVALID_SPARSE_INDEX)
+		{
+			order.push_back(i);
+			visited[i] = 1;
+		}
+	}
+	for (size_t head = 0; head < order.size() || order.size() < count; head++)
+	{
+		// Whatever is left after the queue drains is part of a parent cycle, the cycle is cut at its first transform
+		if (head == order.size())
+		{
+			for (unsigned int i = 0; i < count; i++)
+			{
+				if (!visited[i])
+				{
+					_parents[i] = NULL_ENTITY;
+					parentOf[i] = INVALID_SPARSE_INDEX;
+					order.push_back(i);
+					visited[i] = 1;
+					break;
+				}
+			}
+		}
+		unsigned int node = order[head];
+		for (unsigned int c = childStart[node]; c < childStart[node + 1]; c++)
+		{
+			if (!visited[children[c]])
+			{
+				order.push_back(children[c]);
+				visited[children[c]] = 1;
+			}
+		}
+	}
+
+	std::vector<unsigned int> newIndex(count);
+	for (unsigned int i = 0; i < count; i++)
+		newIndex[order[i]] = i;
+
+	auto permute = [&](auto& values)
+	{
+		auto copy = values;
+		for (unsigned int i = 0; i < count; i++)
+			values[i] = copy[order[i]];
+	};
+	permute(_dense);
+	permute(_positions);
+	permute(_rotations);
+	permute(_scales);
+	permute(_localMatrices);
+	permute(_worldMatrices);
+	permute(_previousWorldMatrices);
+	permute(_parents);
+	permute(_dirty);
+	for (unsigned int i = 0; i < count; i++)
+		_sparse[EntityIndex(_dense[i])] = i;
+
+	_maxDepth = 0;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		unsigned int oldParent = parentOf[order[i]];
+		_parentIndices[i] = oldParent == INVALID_SPARSE_INDEX ? INVALID_SPARSE_INDEX : newIndex[oldParent];
+		_depths[i] = _parentIndices[i] == INVALID_SPARSE_INDEX ? 0 : _depths[_parentIndices[i]] + 1;
+		_maxDepth = std::max(_maxDepth, _depths[i]);
+		_childCount[i] = 0;
+		_firstChild[i] = 0;
+	}
+	for (unsigned int i = 0; i < count; i++)
+	{
+		unsigned int parent = _parentIndices[i];
+		if (parent == INVALID_SPARSE_INDEX)
+			continue;
+		if (_childCount[parent] == 0)
+			_firstChild[parent] = i;
+		_childCount[parent]++;
+	}
+}
+
+void TransformStorage::SettlePreviousMatrices()
+{
+	for (unsigned int index : _updated)
+		_previousWorldMatrices[index] = _worldMatrices[index];
+	_updated.clear();
+}
+
+glm::mat4 TransformStorage::InterpolatedWorldMatrix(Entity entity, float alpha) const
+{
+	unsigned int index = IndexOf(entity);
+	return _previousWorldMatrices[index] * (1.0f - alpha) + _worldMatrices[index] * alpha;
+}
+
+void TransformStorage::Update(const ParallelForFunction& parallelFor)
+{
+	SettlePreviousMatrices();
+
+	if (_structureChanged)
+	{
+		SortBreadthFirst();
+		_structureChanged = false;
+	}
+
+	if (_dirtyEntities.empty())
+		return;
+
+	std::vector<std::vector<unsigned int>> levels(_maxDepth + 1);
+	for (Entity entity : _dirtyEntities)
+	{
+		if (!Has(entity))
+			continue;
+		unsigned int index = IndexOf(entity);
+		levels[_depths[index]].push_back(index);
+	}
+	_dirtyEntities.clear();
+
+	for (unsigned int depth = 0; depth <= _maxDepth; depth++)
+	{
+		std::vector<unsigned int>& level = levels[depth];
+		if (level.empty())
+			continue;
+
+		// Parents were finished on the previous depth, so every transform of this depth is independent
+		auto kernel = [&](unsigned int begin, unsigned int end)
+		{
+			for (unsigned int i = begin; i < end; i++)
+			{
+				unsigned int index = level[i];
+				unsigned char state = _dirty[index];
+				if (state != PARENT_CHANGED)
+					_localMatrices[index] = ComposeLocalMatrix(_positions[index], _rotations[index], _scales[index]);
+				if (state != ADDED)
+					_previousWorldMatrices[index] = _worldMatrices[index];
+				if (_parentIndices[index] == INVALID_SPARSE_INDEX)
+					_worldMatrices[index] = _localMatrices[index];
+				else
+					MultiplyMatrix(_worldMatrices[_parentIndices[index]], _localMatrices[index], _worldMatrices[index]);
+				if (state == ADDED)
+					_previousWorldMatrices[index] = _worldMatrices[index];
+			}
+		};
+		unsigned int count = (unsigned int)level.size();
+		if (parallelFor && count > UPDATE_BATCH_SIZE)
+			parallelFor(count, UPDATE_BATCH_SIZE, kernel);
+		else
+			kernel(0, count);
+
+		for (unsigned int index : level)
+		{
+			_dirty[index] = CLEAN;
+			for (unsigned int c = _firstChild[index]; c < _firstChild[index] + _childCount[index]; c++)
+			{
+				if (_dirty[c] == CLEAN)
+				{
+					_dirty[c] = PARENT_CHANGED;
+					levels[depth + 1].push_back(c);
+				}
+			}
+		}
+		_updated.insert(_updated.end(), level.begin(), level.end());
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <vector>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/matrix_float4x4.hpp>
+#include "Registry.h"
+#include "JobSystem.h"
+
+// Transform components stored as separate arrays per field, a system that only needs positions
+// or world matrices doesn't drag the rest of the transform through the cache.
+// Transforms can have a parent, the arrays are kept in breadth first order so parents always come
+// before their children, the children of a transform are contiguous and every depth is one range.
+class TransformStorage : public SparseSet
+{
+private:
+	std::vector<glm::vec3> _positions;
+	// Euler angles in degrees, applied in X, Y, Z order
+	std::vector<glm::vec3> _rotations;
+	std::vector<glm::vec3> _scales;
+	std::vector<glm::mat4> _localMatrices;
+	std::vector<glm::mat4> _worldMatrices;
+	// World matrices before the last update, rendering blends between the two
+	std::vector<glm::mat4> _previousWorldMatrices;
+
+	std::vector<Entity> _parents;
+	// Filled by SortBreadthFirst, dense indices
+	std::vector<unsigned int> _parentIndices;
+	std::vector<unsigned int> _firstChild;
+	std::vector<unsigned int> _childCount;
+	std::vector<unsigned int> _depths;
+	unsigned int _maxDepth;
+
+	// Entities whose local transform changed since the last update
+	std::vector<Entity> _dirtyEntities;
+	std::vector<unsigned char> _dirty;
+	bool _structureChanged;
+
+	// World matrices that changed during the last update, in dense indices
+	std::vector<unsigned int> _updated;
+
+	void MarkDirty(Entity entity);
+	void SortBreadthFirst();
+	// Transforms that moved in the last update stand still from now on unless they move again
+	void SettlePreviousMatrices();
+public:
+	TransformStorage();
+
+	void Add(Entity entity, const glm::vec3& position, const glm::vec3& rotation = glm::vec3(0.0f), const glm::vec3& scale = glm::vec3(1.0f));
+	void Remove(Entity entity) override;
+
+	void SetParent(Entity entity, Entity parent);
+	void SetPosition(Entity entity, const glm::vec3& position);
+	void SetRotation(Entity entity, const glm::vec3& rotation);
+	void SetScale(Entity entity, const glm::vec3& scale);
+
+	// Recomputes the local and world matrices of the changed transforms and everything below them,
+	// transforms that didn't change since the last call cost nothing
+	void Update(const ParallelForFunction& parallelFor = nullptr);
+
+	inline Entity GetParent(Entity entity) const { return _parents[IndexOf(entity)]; };
+	inline const glm::vec3& GetPosition(Entity entity) const { return _positions[IndexOf(entity)]; };
+	inline const glm::vec3& GetRotation(Entity entity) const { return _rotations[IndexOf(entity)]; };
+	inline const glm::vec3& GetScale(Entity entity) const { return _scales[IndexOf(entity)]; };
+	inline const glm::mat4& WorldMatrix(Entity entity) const { return _worldMatrices[IndexOf(entity)]; };
+	// alpha 0 is the world matrix before the last update, 1 the current one
+	glm::mat4 InterpolatedWorldMatrix(Entity entity, float alpha) const;
+
+	inline const glm::vec3* Positions() const { return _positions.data(); };
+	inline const glm::vec3* Rotations() const { return _rotations.data(); };
+	inline const glm::vec3* Scales() const { return _scales.data(); };
+	inline const glm::mat4* WorldMatrices() const { return _worldMatrices.data(); };
+	inline const glm::mat4* PreviousWorldMatrices() const { return _previousWorldMatrices.data(); };
+	inline const std::vector<unsigned int>& GetUpdated() const { return _updated; };
+};
@@ -0,0 +1,52 @@
+#include "UniformBuffer.h"
+#include "Utils.h"
+#include "RenderStats.h"
+#include "RenderDevice.h"
+
+UniformBuffer::UniformBuffer(unsigned int size) : _size(size)
+{
+	_rendererID = RenderDevice::Get().CreateBuffer(GL_UNIFORM_BUFFER, nullptr, size, GL_STREAM_DRAW);
+}
+
+UniformBuffer::~UniformBuffer()
+{
+	RenderDevice::Get().DeleteBuffer(_rendererID);
+}
+
+void UniformBuffer::Bind() const
+{
+	RenderStats::CountStateChange(STATE_BUFFER);
+	RenderDevice::Get().BindBuffer(GL_UNIFORM_BUFFER, _rendererID);
+}
+
+void UniformBuffer::Unbind() const
+{
+	RenderDevice::Get().BindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UniformBuffer::Upload(const void* data, unsigned int size)
+{
+	if (size > _size)
+		_size = size;
+	RenderDevice& device = RenderDevice::Get();
+	device.ResizeBuffer(GL_UNIFORM_BUFFER, _rendererID, _size, GL_STREAM_DRAW);
+	device.UpdateBuffer(GL_UNIFORM_BUFFER, _rendererID, 0, size, data);
+	RenderStats::CountBufferUpload(size);
+}
+
+void UniformBuffer::Update(const void* data, unsigned int offset, unsigned int size)
+{
+	RenderDevice::Get().UpdateBuffer(GL_UNIFORM_BUFFER, _rendererID, offset, size, data);
+	RenderStats::CountBufferUpload(size);
+}
+
+void UniformBuffer::BindRange(unsigned int index, unsigned int offset, unsigned int size) const
+{
+	RenderStats::CountStateChange(STATE_BUFFER);
+	RenderDevice::Get().BindBufferRange(GL_UNIFORM_BUFFER, index, _rendererID, offset, size);
+}
+
+unsigned int UniformBuffer::GetOffsetAlignment()
+{
+	return RenderDevice::Get().GetUniformBufferOffsetAlignment();
+}
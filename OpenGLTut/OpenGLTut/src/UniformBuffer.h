@@ -0,0 +1,25 @@
+#pragma once
+
+class UniformBuffer
+{
+	private:
+		unsigned int _rendererID;
+		unsigned int _size;
+	public:
+		UniformBuffer(unsigned int size);
+		~UniformBuffer();
+
+		void Bind() const;
+		void Unbind() const;
+
+		// Replaces the whole content, the storage is orphaned (and grown when needed) so the
+		// driver doesn't wait for draws that still read last frame's data
+		void Upload(const void* data, unsigned int size);
+		// Overwrites part of the content in place, for data that mostly stays the same between frames
+		void Update(const void* data, unsigned int offset, unsigned int size);
+		void BindRange(unsigned int index, unsigned int offset, unsigned int size) const;
+
+		// Offsets passed to BindRange have to be a multiple of this
+		static unsigned int GetOffsetAlignment();
+		inline unsigned int getSize() const { return _size; };
+};
@@ -2,7 +2,14 @@
 
 #include <GL/glew.h>
 
-#define ASSERT(x) if (!(x)) __debugbreak();
+// Stops in the debugger on the failed check
+#ifdef _MSC_VER
+#define DEBUG_BREAK() __debugbreak()
+#else
+#define DEBUG_BREAK() __builtin_trap()
+#endif
+
+#define ASSERT(x) if (!(x)) DEBUG_BREAK();
 
 #define GLCall(x) GLClearError();\
 x;\
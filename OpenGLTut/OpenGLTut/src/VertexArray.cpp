@@ -1,42 +1,82 @@
 #include "VertexArray.h"
 #include "Utils.h"
+#include "RenderStats.h"
+#include "RenderDevice.h"
 
 VertexArray::VertexArray()
 {
-	GLCall(glGenVertexArrays(1, &_rendererID));
+	_rendererID = RenderDevice::Get().CreateVertexArray();
 }
 
 VertexArray::~VertexArray()
 {
-	GLCall(glDeleteVertexArrays(1, &_rendererID));
+	RenderDevice::Get().DeleteVertexArray(_rendererID);
 }
 
 void VertexArray::Bind() const
 {
-	GLCall(glBindVertexArray(_rendererID));
-		
+	RenderStats::CountStateChange(STATE_VERTEX_ARRAY);
+	RenderDevice::Get().BindVertexArray(_rendererID);
 }
 
 void VertexArray::Unbind() const
 {
-	GLCall(glBindVertexArray(0));
+	RenderDevice::Get().BindVertexArray(0);
 }
 
 void VertexArray::AddLayout(VertexBuffer& vb, VertexBufferLayout& layout, IndexBuffer* ib  )
 {
-	Bind();
-	vb.Bind();
+	SetAttributes(vb, layout, 0, 0);
 	if (ib)
 	{
-		ib->Bind();
+		RenderDevice::Get().SetIndexBuffer(_rendererID, ib->getRendererID());
 	}
+}
+
+void VertexArray::AddInstanceLayout(VertexBuffer& vb, VertexBufferLayout& layout, unsigned int firstAttrib)
+{
+	SetAttributes(vb, layout, firstAttrib, 1);
+}
+
+void VertexArray::SetFormat(const VertexBufferLayout& layout, unsigned int binding, unsigned int firstAttrib)
+{
+	std::vector<VertexAttribute> attributes = MakeAttributes(layout, firstAttrib, 0);
+	RenderDevice::Get().SetVertexFormat(_rendererID, binding, attributes.data(), (unsigned int)attributes.size());
+	if (binding >= _strides.size())
+		_strides.resize(binding + 1, 0);
+	_strides[binding] = (unsigned int)layout.GetStride();
+}
+
+void VertexArray::SetVertexBuffer(const VertexBuffer& vb, unsigned int binding, unsigned int offset)
+{
+	RenderStats::CountStateChange(STATE_BUFFER);
+	unsigned int stride = binding < _strides.size() ? _strides[binding] : 0;
+	RenderDevice::Get().SetVertexBuffer(_rendererID, binding, vb.getRendererID(), offset, stride);
+}
+
+void VertexArray::SetIndexBuffer(const IndexBuffer& ib)
+{
+	RenderStats::CountStateChange(STATE_BUFFER);
+	RenderDevice::Get().SetIndexBuffer(_rendererID, ib.getRendererID());
+}
+
+void VertexArray::SetAttributes(VertexBuffer& vb, VertexBufferLayout& layout, unsigned int firstAttrib, unsigned int divisor)
+{
+	std::vector<VertexAttribute> attributes = MakeAttributes(layout, firstAttrib, divisor);
+	RenderDevice::Get().SetVertexAttributes(_rendererID, vb.getRendererID(), attributes.data(), (unsigned int)attributes.size());
+}
+
+std::vector<VertexAttribute> VertexArray::MakeAttributes(const VertexBufferLayout& layout, unsigned int firstAttrib, unsigned int divisor)
+{
 	const auto& elements = layout.GetElements();
+	std::vector<VertexAttribute> attributes;
 	unsigned int offset = 0;
 	for (unsigned int i = 0; i < elements.size();i++)
 	{
 		auto element = elements[i];
-		GLCall(glEnableVertexAttribArray(i));
-		GLCall(glVertexAttribPointer(i, element.count, element.type, element.normalized, layout.GetStride(), (void *)offset));
+		bool integer = element.type == GL_UNSIGNED_INT;
+		attributes.push_back({ firstAttrib + i, element.count, element.type, element.normalized != 0, integer, (unsigned int)layout.GetStride(), offset, divisor });
 		offset += element.count * VertexBufferLayoutElement::GetSizeOfType(element.type);
 	}
+	return attributes;
 }
@@ -2,12 +2,16 @@
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
 #include "VertexBufferLayout.h"
+#include "RenderDevice.h"
+#include <vector>
 
 
 class VertexArray
 {
 private:
 	unsigned int _rendererID;
+	// Stride of every binding that has a format, SetVertexBuffer passes it on
+	std::vector<unsigned int> _strides;
 public:
 	VertexArray();
 	~VertexArray();
@@ -18,4 +22,16 @@ public:
 
 
 	void AddLayout( VertexBuffer& vb, VertexBufferLayout& layout, IndexBuffer* ib);
+	// Adds per-instance attributes starting at firstAttrib, they advance once per instance instead of once per vertex
+	void AddInstanceLayout(VertexBuffer& vb, VertexBufferLayout& layout, unsigned int firstAttrib);
+
+	// Format and buffers set apart so one vertex array serves every mesh with the same layout: SetFormat once,
+	// then SetVertexBuffer and SetIndexBuffer for each mesh before drawing it
+	void SetFormat(const VertexBufferLayout& layout, unsigned int binding = 0, unsigned int firstAttrib = 0);
+	void SetVertexBuffer(const VertexBuffer& vb, unsigned int binding = 0, unsigned int offset = 0);
+	void SetIndexBuffer(const IndexBuffer& ib);
+
+private:
+	void SetAttributes(VertexBuffer& vb, VertexBufferLayout& layout, unsigned int firstAttrib, unsigned int divisor);
+	static std::vector<VertexAttribute> MakeAttributes(const VertexBufferLayout& layout, unsigned int firstAttrib, unsigned int divisor);
 };
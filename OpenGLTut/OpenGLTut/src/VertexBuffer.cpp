@@ -1,24 +1,26 @@
 #include "VertexBuffer.h"
 #include "Utils.h"
+#include "RenderStats.h"
+#include "RenderDevice.h"
 
 VertexBuffer::VertexBuffer(const void* data, unsigned int size)
 {
-	GLCall(glGenBuffers(1, &_rendererID));
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, _rendererID));
-	GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+	_rendererID = RenderDevice::Get().CreateBuffer(GL_ARRAY_BUFFER, data, size, GL_STATIC_DRAW);
+	RenderStats::CountBufferUpload(size);
 }
 
 VertexBuffer::~VertexBuffer()
 {
-	GLCall(glDeleteBuffers(1, &_rendererID));
+	RenderDevice::Get().DeleteBuffer(_rendererID);
 }
 
 void VertexBuffer::Bind() const
 {
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, _rendererID));
+	RenderStats::CountStateChange(STATE_BUFFER);
+	RenderDevice::Get().BindBuffer(GL_ARRAY_BUFFER, _rendererID);
 }
  
 void VertexBuffer::Unbind() const
 {
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+	RenderDevice::Get().BindBuffer(GL_ARRAY_BUFFER, 0);
 }
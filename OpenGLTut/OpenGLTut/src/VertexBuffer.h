@@ -10,4 +10,6 @@ class VertexBuffer
 
 		void Bind() const;
 		void Unbind() const;
+
+		inline unsigned int getRendererID() const { return _rendererID; };
 };
\ No newline at end of file
@@ -14,6 +14,7 @@ struct VertexBufferLayoutElement
 		{
 			case GL_BYTE: return 4;
 			case GL_FLOAT: return 4;
+			case GL_UNSIGNED_INT: return 4;
 		}
 		ASSERT(false);
 		return 0;
@@ -26,7 +27,7 @@ private:
 	std::vector<VertexBufferLayoutElement> _elements;
 	unsigned int _stride;
 public:
-	VertexBufferLayout() {};
+	VertexBufferLayout() : _stride(0) {};
 	~VertexBufferLayout() {};
 
 	inline std::vector<VertexBufferLayoutElement> GetElements() const { return _elements; };
@@ -38,11 +39,20 @@ public:
 		_elements.push_back({ GL_BYTE, count, GL_TRUE,});
 		_stride += VertexBufferLayoutElement::GetSizeOfType(GL_BYTE) * count;
 	}
-
-	template<>
-	void Push<float>(unsigned int count)
-	{
-		_elements.push_back({ GL_FLOAT, count, GL_FALSE });
-		_stride += VertexBufferLayoutElement::GetSizeOfType(GL_FLOAT) * count;
-	}
 };
+
+// Specializations live at namespace scope, only MSVC accepts them inside the class
+template<>
+inline void VertexBufferLayout::Push<float>(unsigned int count)
+{
+	_elements.push_back({ GL_FLOAT, count, GL_FALSE });
+	_stride += VertexBufferLayoutElement::GetSizeOfType(GL_FLOAT) * count;
+}
+
+// Integer attributes are read by the shader as uint, they are never normalized
+template<>
+inline void VertexBufferLayout::Push<unsigned int>(unsigned int count)
+{
+	_elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
+	_stride += VertexBufferLayoutElement::GetSizeOfType(GL_UNSIGNED_INT) * count;
+}
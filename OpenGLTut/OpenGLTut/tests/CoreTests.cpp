@@ -0,0 +1,80 @@
+#include "Test.h"
+#include "Registry.h"
+#include "JobSystem.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+struct TestComponent
+{
+	int value;
+};
+
+TEST(RegistryReusesIndicesWithNewGenerations)
+{
+	Registry registry;
+	Entity first = registry.Create();
+	Entity second = registry.Create();
+	CHECK(registry.IsAlive(first) && registry.IsAlive(second));
+	CHECK(registry.GetAliveCount() == 2);
+
+	registry.Destroy(first);
+	CHECK(!registry.IsAlive(first));
+	Entity reused = registry.Create();
+	CHECK(EntityIndex(reused) == EntityIndex(first));
+	CHECK(EntityGeneration(reused) != EntityGeneration(first));
+	CHECK(registry.IsAlive(reused) && !registry.IsAlive(first));
+	CHECK(registry.GetAliveCount() == 2);
+}
+
+TEST(RegistryKeepsComponentsDense)
+{
+	Registry registry;
+	std::vector<Entity> entities;
+	for (int i = 0; i < 4; i++)
+	{
+		entities.push_back(registry.Create());
+		registry.Add<TestComponent>(entities.back(), { i });
+	}
+
+	// Removing from the middle moves the last component into the hole
+	registry.Remove<TestComponent>(entities[1]);
+	ComponentPool<TestComponent>& pool = registry.Pool<TestComponent>();
+	CHECK(pool.Size() == 3);
+	CHECK(!registry.Has<TestComponent>(entities[1]));
+	CHECK(pool.Entities()[1] == entities[3] && pool.Data()[1].value == 3);
+	CHECK(registry.Get<TestComponent>(entities[3]).value == 3);
+	CHECK(registry.Get<TestComponent>(entities[0]).value == 0);
+	CHECK(registry.Get<TestComponent>(entities[2]).value == 2);
+}
+
+TEST(ParallelForCoversEveryIndexOnce)
+{
+	JobSystem jobs(4);
+	const unsigned int count = 10007;
+	std::unique_ptr<std::atomic<int>[]> visits(new std::atomic<int>[count]);
+	for (unsigned int i = 0; i < count; i++)
+		visits[i] = 0;
+	jobs.ParallelFor(count, 64, [&](unsigned int first, unsigned int end)
+	{
+		for (unsigned int i = first; i < end; i++)
+			visits[i]++;
+	});
+
+	bool once = true;
+	for (unsigned int i = 0; i < count; i++)
+		once = once && visits[i] == 1;
+	CHECK(once);
+}
+
+TEST(JobsSignalTheirCounter)
+{
+	JobSystem jobs(4);
+	std::atomic<int> counter(0);
+	std::atomic<int> done(0);
+	for (int i = 0; i < 100; i++)
+		jobs.Run([&done]() { done++; }, &counter);
+	jobs.Wait(counter);
+	CHECK(counter == 0);
+	CHECK(done == 100);
+}
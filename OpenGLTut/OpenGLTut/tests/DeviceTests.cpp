@@ -0,0 +1,163 @@
+#include "Test.h"
+#include "NullDevice.h"
+#include "RecordingDevice.h"
+#include "CommandList.h"
+#include "Pipeline.h"
+#include "SamplerCache.h"
+#include "Texture.h"
+#include "UniformBuffer.h"
+#include "VertexBufferLayout.h"
+#include "Utils.h"
+#include <memory>
+#include <vector>
+
+// A vertex array with one float3 attribute and an index buffer, ready for indexed draws
+static unsigned int CreateIndexedVertexArray(RenderDevice& device)
+{
+	float vertices[9] = {};
+	unsigned int indices[3] = { 0, 1, 2 };
+	unsigned int vertexBuffer = device.CreateBuffer(GL_ARRAY_BUFFER, vertices, sizeof(vertices), GL_STATIC_DRAW);
+	unsigned int indexBuffer = device.CreateBuffer(GL_ELEMENT_ARRAY_BUFFER, indices, sizeof(indices), GL_STATIC_DRAW);
+	unsigned int vertexArray = device.CreateVertexArray();
+	VertexAttribute attribute = { 0, 3, GL_FLOAT, false, false, 3 * sizeof(float), 0, 0 };
+	device.SetVertexAttributes(vertexArray, vertexBuffer, &attribute, 1);
+	device.SetIndexBuffer(vertexArray, indexBuffer);
+	return vertexArray;
+}
+
+TEST(NullDeviceAcceptsValidDraws)
+{
+	NullDevice device;
+	unsigned int vertexArray = CreateIndexedVertexArray(device);
+	unsigned int program = device.CreateProgram("vertex", "fragment", "");
+	device.UseProgram(program);
+	device.BindVertexArray(vertexArray);
+	device.DrawElements(3, 0);
+	device.DrawArrays(3, 0);
+
+	CHECK(device.GetErrorCount() == 0);
+	CHECK(device.GetCallCount(CALL_CREATE_BUFFER) == 2);
+	CHECK(device.GetCallCount(CALL_DRAW_ELEMENTS) == 1);
+	CHECK(device.GetCallCount(CALL_DRAW_ARRAYS) == 1);
+	CHECK(device.GetUploadedBytes() == 9 * sizeof(float) + 3 * sizeof(unsigned int));
+}
+
+TEST(NullDeviceRejectsInvalidCalls)
+{
+	NullDevice device;
+	// No program and no vertex array
+	device.DrawElements(3, 0);
+	CHECK(device.GetErrorCount() == 1);
+
+	unsigned int program = device.CreateProgram("vertex", "fragment", "");
+	device.UseProgram(program);
+	unsigned int vertexArray = device.CreateVertexArray();
+	device.BindVertexArray(vertexArray);
+	// Indexed draw without an index buffer
+	device.DrawElements(3, 0);
+	CHECK(device.GetErrorCount() == 2);
+
+	unsigned char data[16] = {};
+	unsigned int dynamicBuffer = device.CreateBuffer(GL_UNIFORM_BUFFER, nullptr, 16, GL_DYNAMIC_DRAW);
+	device.UpdateBuffer(GL_UNIFORM_BUFFER, dynamicBuffer, 8, 16, data);
+	CHECK(device.GetErrorCount() == 3);
+	unsigned int staticBuffer = device.CreateBuffer(GL_ARRAY_BUFFER, data, 16, GL_STATIC_DRAW);
+	device.UpdateBuffer(GL_ARRAY_BUFFER, staticBuffer, 0, 16, data);
+	CHECK(device.GetErrorCount() == 4);
+
+	unsigned int texture = 0;
+	device.BindTextures(NullDevice::TEXTURE_UNITS, &texture, 1);
+	CHECK(device.GetErrorCount() == 5);
+	device.DeleteProgram(program);
+	device.UseProgram(program);
+	CHECK(device.GetErrorCount() == 6);
+	device.Barrier(0);
+	CHECK(device.GetErrorCount() == 7);
+	CHECK(device.GetCallCount(CALL_DRAW_ELEMENTS) == 2);
+}
+
+TEST(RecordingDeviceLogsAndForwards)
+{
+	RecordingDevice recorder;
+	unsigned int vertexArray = CreateIndexedVertexArray(recorder);
+	unsigned int program = recorder.CreateProgram("vertex", "fragment", "");
+	recorder.ClearCalls();
+
+	recorder.UseProgram(program);
+	recorder.BindVertexArray(vertexArray);
+	recorder.DrawElements(3, 0);
+	recorder.Barrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+	const std::vector<RecordedCall>& calls = recorder.GetCalls();
+	CHECK(calls.size() == 4);
+	if (calls.size() == 4)
+	{
+		CHECK(calls[0].call == CALL_USE_PROGRAM && calls[0].object == program);
+		CHECK(calls[1].call == CALL_BIND_VERTEX_ARRAY && calls[1].object == vertexArray);
+		CHECK(calls[2].call == CALL_DRAW_ELEMENTS && calls[2].arguments[0] == 3);
+		CHECK(calls[3].call == CALL_BARRIER && calls[3].arguments[0] == GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	}
+
+	// Without a target of its own the recorder forwards to a null device
+	CHECK(recorder.GetTarget().GetBackend() == BACKEND_NULL);
+	NullDevice& target = static_cast<NullDevice&>(recorder.GetTarget());
+	CHECK(target.GetCallCount(CALL_DRAW_ELEMENTS) == 1);
+	CHECK(target.GetErrorCount() == 0);
+}
+
+TEST(ExecuteSortsAndMergesState)
+{
+	NullDevice device;
+	RenderDeviceScope scope(&device);
+	{
+		Shader first("res/shaders/Batched.shader");
+		Shader second("res/shaders/Batched.shader");
+		PipelineDesc blended(&second);
+		blended.state.blend = true;
+
+		float vertices[15] = {};
+		unsigned int indices[6] = { 0, 1, 2, 2, 3, 4 };
+		VertexBuffer vertexBuffer(vertices, sizeof(vertices));
+		IndexBuffer indexBuffer(indices, 6);
+		VertexBufferLayout layout;
+		layout.Push<float>(3);
+		layout.Push<float>(2);
+		VertexArray vertexArray;
+		vertexArray.AddLayout(vertexBuffer, layout, &indexBuffer);
+		unsigned char pixels[4 * 4 * 4] = {};
+		Texture texture(pixels, 4, 4, 4);
+
+		RenderResources resources;
+		unsigned short opaqueID = resources.AddPipeline(Pipeline::Create(PipelineDesc(&first)));
+		unsigned short blendedID = resources.AddPipeline(Pipeline::Create(blended));
+		unsigned short vertexArrayID = resources.AddVertexArray(&vertexArray);
+		unsigned short textureID = resources.AddTexture(&texture);
+
+		// Alternating pipelines, sorting groups them so each is bound once
+		CommandList list(device.GetUniformBufferOffsetAlignment());
+		for (unsigned int i = 0; i < 6; i++)
+			list.Draw(i % 2 ? blendedID : opaqueID, vertexArrayID, textureID, 0, DrawMode::ELEMENTS, 0, 6, glm::mat4(1.0f));
+		int counts[2] = { 3, 3 };
+		const void* offsets[2] = { (const void*)0, (const void*)(3 * sizeof(unsigned int)) };
+		list.DrawMulti(opaqueID, vertexArrayID, textureID, 0, counts, offsets, 2, glm::mat4(1.0f));
+
+		UniformBuffer uniforms(8 * device.GetUniformBufferOffsetAlignment());
+		std::vector<const CommandList*> lists = { &list };
+		unsigned long long programs = device.GetCallCount(CALL_USE_PROGRAM);
+		unsigned long long states = device.GetCallCount(CALL_SET_RENDER_STATE);
+		unsigned long long vertexArrays = device.GetCallCount(CALL_BIND_VERTEX_ARRAY);
+		Renderer renderer;
+		renderer.Execute(lists, resources, uniforms);
+
+		CHECK(device.GetCallCount(CALL_USE_PROGRAM) - programs == 2);
+		// Everything on the first bind, the blend groups on the switch
+		CHECK(device.GetCallCount(CALL_SET_RENDER_STATE) - states == 2);
+		CHECK(device.GetCallCount(CALL_BIND_VERTEX_ARRAY) - vertexArrays == 1);
+		CHECK(device.GetCallCount(CALL_DRAW_ELEMENTS) == 6);
+		CHECK(device.GetCallCount(CALL_MULTI_DRAW_ELEMENTS) == 1);
+
+		Pipeline::ReleaseAll();
+		SamplerCache::ReleaseAll();
+	}
+	CHECK(device.GetErrorCount() == 0);
+}
@@ -0,0 +1,74 @@
+#include "Test.h"
+#include "Material.h"
+#include "NullDevice.h"
+#include "Pipeline.h"
+
+TEST(MaterialLayoutFollowsStd140)
+{
+	MaterialLayout layout;
+	layout.Push("roughness", MATERIAL_FLOAT, glm::vec4(0.5f));
+	layout.Push("scale", MATERIAL_VEC2);
+	layout.Push("color", MATERIAL_VEC4, glm::vec4(1.0f));
+	layout.Push("flags", MATERIAL_UINT, glm::vec4(3.0f));
+
+	const std::vector<MaterialParameter>& parameters = layout.GetParameters();
+	CHECK(parameters.size() == 4);
+	if (parameters.size() == 4)
+	{
+		CHECK(parameters[0].offset == 0);
+		CHECK(parameters[1].offset == 8);
+		CHECK(parameters[2].offset == 16);
+		CHECK(parameters[3].offset == 32);
+	}
+	CHECK(layout.GetStride() == 48);
+	CHECK(layout.Find("color") == 2 && layout.Find("missing") == -1);
+
+	const std::vector<unsigned char>& defaults = layout.GetDefaults();
+	CHECK(defaults.size() == 48);
+	CHECK(*(const float*)&defaults[0] == 0.5f && *(const float*)&defaults[16] == 1.0f);
+	CHECK(*(const unsigned int*)&defaults[32] == 3);
+}
+
+TEST(MaterialUploadSendsOnlyEditedRanges)
+{
+	NullDevice device;
+	RenderDeviceScope scope(&device);
+	{
+		unsigned int alignment = device.GetUniformBufferOffsetAlignment();
+		MaterialLayout layout;
+		layout.Push("color", MATERIAL_VEC4, glm::vec4(1.0f));
+		RenderResources resources;
+		MaterialSystem materials;
+		const Pipeline* pipeline = Pipeline::Create(PipelineDesc());
+		unsigned short firstTemplate = materials.AddTemplate(resources, pipeline, layout, 4);
+		unsigned short secondTemplate = materials.AddTemplate(resources, pipeline, layout, 4);
+		for (unsigned int i = 0; i < 4; i++)
+			materials.AddInstance(firstTemplate, 0);
+		unsigned short other = materials.AddInstance(secondTemplate, 0);
+
+		// Each template's range starts aligned for glBindBufferRange
+		CHECK(materials.GetInstance(other).index == 0);
+		CHECK(materials.GetBufferSize() == alignment + 4 * 16);
+
+		materials.Upload();
+		unsigned long long uploaded = device.GetUploadedBytes();
+		unsigned long long updates = device.GetCallCount(CALL_UPDATE_BUFFER);
+		CHECK(uploaded == materials.GetBufferSize());
+
+		// Neighbours go in one update, the other template's instance in a second one
+		materials.SetParameter(1, "color", glm::vec4(0.5f));
+		materials.SetParameter(2, "color", glm::vec4(0.25f));
+		materials.SetParameter(other, "color", glm::vec4(0.0f));
+		materials.Upload();
+		CHECK(device.GetCallCount(CALL_UPDATE_BUFFER) - updates == 2);
+		CHECK(device.GetUploadedBytes() - uploaded == 3 * 16);
+
+		// Nothing edited, nothing sent
+		materials.Upload();
+		CHECK(device.GetCallCount(CALL_UPDATE_BUFFER) - updates == 2);
+		CHECK(device.GetCallCount(CALL_BIND_BUFFER_RANGE) == 3 * 2);
+
+		Pipeline::ReleaseAll();
+	}
+	CHECK(device.GetErrorCount() == 0);
+}
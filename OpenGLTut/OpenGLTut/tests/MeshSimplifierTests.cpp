@@ -0,0 +1,137 @@
+#include "Test.h"
+#include "MeshSimplifier.h"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+// Flat grid of size x size quads in the xy plane, positions only
+static void BuildGrid(unsigned int size, std::vector<float>& vertices, std::vector<unsigned int>& indices)
+{
+	vertices.clear();
+	indices.clear();
+	for (unsigned int y = 0; y <= size; y++)
+	{
+		for (unsigned int x = 0; x <= size; x++)
+		{
+			vertices.push_back((float)x);
+			vertices.push_back((float)y);
+			vertices.push_back(0.0f);
+		}
+	}
+	for (unsigned int y = 0; y < size; y++)
+	{
+		for (unsigned int x = 0; x < size; x++)
+		{
+			unsigned int corner = y * (size + 1) + x;
+			unsigned int quad[6] = { corner, corner + 1, corner + size + 2, corner, corner + size + 2, corner + size + 1 };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+	}
+}
+
+static bool IndicesValid(const std::vector<unsigned int>& indices, unsigned int first, unsigned int count, unsigned int vertexCount)
+{
+	if (count % 3 != 0 || first + count > indices.size())
+		return false;
+	for (unsigned int i = first; i < first + count; i++)
+	{
+		if (indices[i] >= vertexCount)
+			return false;
+	}
+	return true;
+}
+
+TEST(SimplifyReducesFlatGrid)
+{
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+	BuildGrid(16, vertices, indices);
+	unsigned int vertexCount = (unsigned int)vertices.size() / 3;
+
+	float error = -1.0f;
+	std::vector<unsigned int> simplified = MeshSimplifier::Simplify(vertices.data(), vertexCount, 3, indices, (unsigned int)indices.size() / 4, 0.01f, &error);
+	CHECK(simplified.size() < indices.size());
+	CHECK(IndicesValid(simplified, 0, (unsigned int)simplified.size(), vertexCount));
+	// Every collapse stays in the plane
+	CHECK(error >= 0.0f && error <= 0.01f);
+}
+
+TEST(LODChainLevelsShrink)
+{
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+	BuildGrid(16, vertices, indices);
+	unsigned int vertexCount = (unsigned int)vertices.size() / 3;
+
+	LODChain chain = MeshSimplifier::GenerateLODChain(vertices.data(), vertexCount, 3, indices);
+	CHECK(chain.levels.size() >= 2);
+	CHECK(!chain.levels.empty() && chain.levels[0].indexCount == indices.size() && chain.levels[0].error == 0.0f);
+	for (size_t level = 0; level < chain.levels.size(); level++)
+	{
+		const LODLevel& found = chain.levels[level];
+		CHECK(IndicesValid(chain.indices, found.firstIndex, found.indexCount, vertexCount));
+		if (level > 0)
+			CHECK(found.indexCount < chain.levels[level - 1].indexCount);
+	}
+}
+
+TEST(LODChainSaveLoadRoundTrip)
+{
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+	BuildGrid(8, vertices, indices);
+	LODChain chain = MeshSimplifier::GenerateLODChain(vertices.data(), (unsigned int)vertices.size() / 3, 3, indices);
+
+	const char* filePath = "test_lod_chain.bin";
+	CHECK(chain.Save(filePath));
+	LODChain loaded;
+	CHECK(loaded.Load(filePath));
+	std::remove(filePath);
+	CHECK(loaded.indices == chain.indices);
+	CHECK(loaded.levels.size() == chain.levels.size());
+	for (size_t level = 0; level < loaded.levels.size() && level < chain.levels.size(); level++)
+	{
+		CHECK(loaded.levels[level].firstIndex == chain.levels[level].firstIndex);
+		CHECK(loaded.levels[level].indexCount == chain.levels[level].indexCount);
+		CHECK(loaded.levels[level].error == chain.levels[level].error);
+	}
+
+	LODChain missing;
+	CHECK(!missing.Load("does_not_exist.bin"));
+}
+
+TEST(LODChainLoadRejectsTruncatedFile)
+{
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+	BuildGrid(8, vertices, indices);
+	LODChain chain = MeshSimplifier::GenerateLODChain(vertices.data(), (unsigned int)vertices.size() / 3, 3, indices);
+
+	const char* filePath = "test_lod_chain_truncated.bin";
+	CHECK(chain.Save(filePath));
+	std::vector<char> bytes;
+	{
+		std::ifstream file(filePath, std::ios::binary);
+		bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+	// Drop the last index
+	{
+		std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+		file.write(bytes.data(), bytes.size() - sizeof(unsigned int));
+	}
+	LODChain truncated;
+	CHECK(!truncated.Load(filePath));
+	CHECK(truncated.levels.empty() && truncated.indices.empty());
+
+	// A header asking for more indices than the file holds
+	unsigned int header[3] = { 0x43444f4c, 1, 0x40000000 };
+	{
+		std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+		file.write((const char*)header, sizeof(header));
+	}
+	LODChain oversized;
+	CHECK(!oversized.Load(filePath));
+	std::remove(filePath);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+// Minimal test runner without dependencies. TEST defines a test and registers it, CHECK reports a failed
+// condition and lets the test go on. Tests run in the order their files were linked, from the working
+// directory the shaders are loaded relative to (OpenGLTut/OpenGLTut).
+typedef void (*TestFunction)();
+
+struct TestRegistrar
+{
+	TestRegistrar(const char* name, TestFunction function);
+};
+
+void ReportFailure(const char* file, int line, const char* condition);
+
+#define TEST(name) \
+	static void name(); \
+	static TestRegistrar name##Registrar(#name, name); \
+	static void name()
+
+#define CHECK(condition) do { if (!(condition)) ReportFailure(__FILE__, __LINE__, #condition); } while (0)
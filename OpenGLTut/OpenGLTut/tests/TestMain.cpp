@@ -0,0 +1,53 @@
+#include "Test.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct TestCase
+{
+	const char* name;
+	TestFunction function;
+};
+
+static std::vector<TestCase>& Tests()
+{
+	static std::vector<TestCase> tests;
+	return tests;
+}
+
+static unsigned int s_failures = 0;
+
+TestRegistrar::TestRegistrar(const char* name, TestFunction function)
+{
+	Tests().push_back({ name, function });
+}
+
+void ReportFailure(const char* file, int line, const char* condition)
+{
+	std::cout << file << "(" << line << "): CHECK(" << condition << ") failed" << std::endl;
+	s_failures++;
+}
+
+// Runs every test, or the ones whose names are given on the command line
+int main(int argc, char** argv)
+{
+	unsigned int failedTests = 0, run = 0;
+	for (const TestCase& test : Tests())
+	{
+		bool selected = argc < 2;
+		for (int i = 1; i < argc && !selected; i++)
+			selected = std::string(argv[i]) == test.name;
+		if (!selected)
+			continue;
+
+		unsigned int failures = s_failures;
+		test.function();
+		run++;
+		bool passed = s_failures == failures;
+		if (!passed)
+			failedTests++;
+		std::cout << (passed ? "[ pass ] " : "[ FAIL ] ") << test.name << std::endl;
+	}
+	std::cout << run - failedTests << " of " << run << " tests passed" << std::endl;
+	return failedTests == 0 && run > 0 ? 0 : 1;
+}